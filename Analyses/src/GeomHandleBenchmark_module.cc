@@ -0,0 +1,85 @@
+//
+// Measure the cost of constructing GeomHandles.  Each event constructs NRepeat handles for a few
+// commonly used detectors, once through GeomHandle (per-type detector slot) and once through the
+// service lookup that GeomHandle used to do on every construction: an art::ServiceHandle plus a
+// search of the GeometryService map keyed by the type name.  Results are printed at end of job.
+//
+// framework
+#include "art/Framework/Principal/Event.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Core/ModuleMacros.h"
+// Mu2e
+#include "GeometryService/inc/GeometryService.hh"
+#include "GeometryService/inc/GeomHandle.hh"
+#include "TrackerGeom/inc/Tracker.hh"
+#include "CalorimeterGeom/inc/Calorimeter.hh"
+#include "BFieldGeom/inc/BFieldManager.hh"
+// C++
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+namespace mu2e {
+
+  class GeomHandleBenchmark : public art::EDAnalyzer {
+    public:
+      explicit GeomHandleBenchmark(fhicl::ParameterSet const& pset);
+      void analyze(art::Event const& event) override;
+      void endJob() override;
+
+    private:
+      typedef std::chrono::high_resolution_clock Clock;
+      template <class DET> void time(double& handleTime, double& serviceTime);
+      unsigned _nrep; // number of handles constructed per detector type and event
+      double _trkHandle, _trkService; // accumulated ns
+      double _calHandle, _calService;
+      double _bfHandle, _bfService;
+      unsigned long _ncalls;
+      unsigned long _sum; // prevents the compiler from optimizing away the loops
+  };
+
+  GeomHandleBenchmark::GeomHandleBenchmark(fhicl::ParameterSet const& pset) :
+    art::EDAnalyzer{pset},
+    _nrep(pset.get<unsigned>("NRepeat",10000)),
+    _trkHandle(0.0), _trkService(0.0),
+    _calHandle(0.0), _calService(0.0),
+    _bfHandle(0.0), _bfService(0.0),
+    _ncalls(0), _sum(0)
+  {}
+
+  template <class DET> void GeomHandleBenchmark::time(double& handleTime, double& serviceTime) {
+    auto start = Clock::now();
+    for(unsigned irep=0;irep < _nrep; ++irep){
+      GeomHandle<DET> det;
+      _sum += reinterpret_cast<uintptr_t>(det.get()) & 0x1;
+    }
+    auto stop = Clock::now();
+    handleTime += std::chrono::duration<double,std::nano>(stop-start).count();
+    start = Clock::now();
+    for(unsigned irep=0;irep < _nrep; ++irep){
+      art::ServiceHandle<GeometryService> sg;
+      _sum += sg->hasElement<DET>();
+    }
+    stop = Clock::now();
+    serviceTime += std::chrono::duration<double,std::nano>(stop-start).count();
+  }
+
+  void GeomHandleBenchmark::analyze(art::Event const& event) {
+    time<Tracker>(_trkHandle,_trkService);
+    time<Calorimeter>(_calHandle,_calService);
+    time<BFieldManager>(_bfHandle,_bfService);
+    _ncalls += _nrep;
+  }
+
+  void GeomHandleBenchmark::endJob() {
+    if(_ncalls == 0) return;
+    std::cout << "GeomHandleBenchmark: " << _ncalls << " constructions per detector type (checksum " << _sum << ")" << std::endl
+      << "  ns/construction        GeomHandle   service lookup" << std::endl
+      << "  Tracker              " << _trkHandle/_ncalls << "  " << _trkService/_ncalls << std::endl
+      << "  Calorimeter          " << _calHandle/_ncalls << "  " << _calService/_ncalls << std::endl
+      << "  BFieldManager        " << _bfHandle/_ncalls  << "  " << _bfService/_ncalls  << std::endl;
+  }
+}
+
+DEFINE_ART_MODULE(mu2e::GeomHandleBenchmark);
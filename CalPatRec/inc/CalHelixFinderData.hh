@@ -12,6 +12,7 @@
 #include "RecoDataProducts/inc/StrawHitCollection.hh"
 #include "RecoDataProducts/inc/StrawHitIndex.hh"
 #include "RecoDataProducts/inc/ComboHit.hh"
+#include "RecoDataProducts/inc/TrackerHitIndex.hh"
 #include "RecoDataProducts/inc/StrawHit.hh"
 #include "DataProducts/inc/Helicity.hh"
 
@@ -125,6 +126,7 @@ namespace mu2e {
     const ComboHitCollection*         _chcol;
     // const StrawHitPositionCollection* _shpos;
     const StrawHitFlagCollection*     _shfcol;
+    const TrackerHitIndex*            _hitIndex;
     
     TrkErrCode                        _fit;	    // fit status code from last fit
 //-----------------------------------------------------------------------------
@@ -181,6 +183,7 @@ namespace mu2e {
     const ComboHitCollection*         chcol () { return _chcol ; }
     // const StrawHitPositionCollection* shpos () { return _shpos ; }
     const StrawHitFlagCollection*     shfcol() { return _shfcol; }
+    const TrackerHitIndex*            hitIndex() { return _hitIndex; }
 
     bool          fitIsValid        () { return _sxy.qn() > 0; }
     bool          weightedFitIsValid() { return _sxy.qn() > 0; }
@@ -17,6 +17,7 @@
 #include "RecoDataProducts/inc/HelixVal.hh"
 #include "RecoDataProducts/inc/TimeCluster.hh"
 #include "RecoDataProducts/inc/HelixSeed.hh"
+#include "RecoDataProducts/inc/TrackerHitIndex.hh"
 
 #include "RecoDataProducts/inc/StrawHitPositionCollection.hh"
 #include "RecoDataProducts/inc/StereoHit.hh"
@@ -95,6 +96,7 @@ namespace mu2e {
     // std::string                           _shpLabel;
     std::string                           _shfLabel;
     std::string                           _timeclLabel;
+    std::string                           _thiLabel;     // shared TrackerHitIndex; if empty or missing, the hits are indexed here
     
     int                                   _minNHitsTimeCluster; //min nhits within a TimeCluster after check of Delta-ray hits
 
@@ -112,6 +114,8 @@ namespace mu2e {
     const StrawHitFlagCollection*         _shfcol;
     // const StrawHitPositionCollection*     _shpcol;
     const TimeClusterCollection*          _timeclcol;
+    TrackerHitIndex                       _localIndex;
+    const TrackerHitIndex*                _thi;
 
     HelixTraj*                            _helTraj;
     CalHelixFinderAlg                     _hfinder;	
@@ -25,6 +25,7 @@ namespace art {
 #include "RecoDataProducts/inc/HelixVal.hh"
 
 #include "RecoDataProducts/inc/ComboHit.hh"
+#include "RecoDataProducts/inc/TrackerHitIndex.hh"
 #include "RecoDataProducts/inc/StrawHitFlag.hh"
 #include "RecoDataProducts/inc/StrawHit.hh"
 
@@ -93,6 +94,7 @@ namespace mu2e {
     std::string      _shfLabel;
     // std::string      _shpLabel;
     std::string      _ccmLabel; // caloClusterModuleLabel
+    std::string      _thiLabel; // shared TrackerHitIndex; if empty or missing, the hits are indexed here
 
     StrawHitFlag     _hsel;
     StrawHitFlag     _bkgsel;
@@ -124,6 +126,10 @@ namespace mu2e {
     const Tracker*                        _tracker;     // straw tracker geometry
     const Calorimeter*                    _calorimeter; // cached pointer to the calorimeter geometry
 
+    TrackerHitIndex                       _localIndex;
+    const TrackerHitIndex*                _thi;
+    std::vector<ComboHitIndex>            _candidates;  // hits in the time window of a cluster
+
     const CaloCluster*                     cl;
 //-----------------------------------------------------------------------------
 // diagnostics 
@@ -18,6 +18,7 @@ namespace fhicl {
 #include "RecoDataProducts/inc/StrawHit.hh"
 #include "RecoDataProducts/inc/StrawHitFlag.hh"
 #include "RecoDataProducts/inc/TimeCluster.hh"
+#include "CalPatRec/inc/ObjectPool.hh"
 #include "TrackerGeom/inc/Straw.hh"
 
 namespace mu2e {
@@ -155,7 +156,12 @@ namespace mu2e {
       int                            fDeltaIndex;
       float                          fChi2All;
 
-      DeltaSeed() {
+      DeltaSeed() { Init(); }
+//-----------------------------------------------------------------------------
+// reset to the default state, seeds are reused by the ObjectPool
+// clearing the lists keeps their capacity
+//-----------------------------------------------------------------------------
+      void Init() {
 	fType             =  0;
 	fGood             =  1;
 	fNHitsTot         =  0;
@@ -169,9 +175,16 @@ namespace mu2e {
 	fMinTime          = 1.e10;
 	fMaxTime          = -1.;
 	fMaxDriftTime     = -1.;
+	fHitData[0]       = NULL;
+	fHitData[1]       = NULL;
+	fPos[0]           = NULL;
+	fPos[1]           = NULL;
+	CofM              = XYZVec();
 	for (int face=0; face<kNFaces; face++) {
 	  fFaceProcessed[face] = 0;
 	  panelz        [face] = NULL;
+	  hitlist       [face].clear();
+	  fMcPart       [face].clear();
 	}
 	fDeltaIndex       = -1;
 	fChi21            = -1;
@@ -246,6 +259,7 @@ namespace mu2e {
       const Tracker*                tracker;
       std::string                   strawDigiMCCollectionTag;
       std::string                   ptrStepPointMCVectorCollectionTag;
+      ObjectPool<DeltaSeed>         seedPool;            // owns the seeds, recycled every event
       std::vector<DeltaSeed*>       seedHolder [kNStations];
       std::vector<DeltaCandidate>   deltaCandidateHolder;
       PanelZ_t                      oTracker[kNStations][kNFaces][kNPanelsPerFace];
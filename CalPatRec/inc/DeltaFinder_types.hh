@@ -13,6 +13,7 @@ namespace fhicl {
 #include "RecoDataProducts/inc/StereoHit.hh"
 #include "RecoDataProducts/inc/ComboHit.hh"
 #include "RecoDataProducts/inc/TimeCluster.hh"
+#include "CalPatRec/inc/ObjectPool.hh"
 #include "TrackerGeom/inc/Straw.hh"
 #include "TrackerGeom/inc/Tracker.hh"
 
@@ -150,7 +151,12 @@ namespace mu2e {
       int                            fDeltaIndex;
       float                          fChi2All;
 
-      DeltaSeed() {
+      DeltaSeed() { Init(); }
+//-----------------------------------------------------------------------------
+// reset to the default state, seeds are reused by the ObjectPool
+// clearing the lists keeps their capacity
+//-----------------------------------------------------------------------------
+      void Init() {
 	fType             =  0;
 	fGood             =  1;
 	fNHitsTot         =  0;
@@ -164,9 +170,14 @@ namespace mu2e {
 	fMinTime          = 1.e10;
 	fMaxTime          = -1.;
 	fMaxDriftTime     = -1.;
+	fHitData[0]       = NULL;
+	fHitData[1]       = NULL;
+	CofM              = CLHEP::Hep3Vector();
 	for (int face=0; face<kNFaces; face++) {
 	  fFaceProcessed[face] = 0;
 	  panelz        [face] = NULL;
+	  hitlist       [face].clear();
+	  fMcPart       [face].clear();
 	}
 	fDeltaIndex       = -1;
 	fChi21            = -1;
@@ -241,6 +252,7 @@ namespace mu2e {
       const Tracker*                tracker;
       std::string                   strawDigiMCCollectionTag;
       std::string                   ptrStepPointMCVectorCollectionTag;
+      ObjectPool<DeltaSeed>         seedPool   [kNStations]; // own the seeds, recycled every event
       std::vector<DeltaSeed*>       seedHolder [kNStations];
       std::vector<DeltaCandidate>   deltaCandidateHolder;
       PanelZ_t                      oTracker[kNStations][kNFaces][kNPanelsPerFace];
@@ -0,0 +1,39 @@
+///////////////////////////////////////////////////////////////////////////////
+// event-scoped pool of reusable objects
+// objects are handed out in order and all recycled at once by clear(), typically
+// at the beginning of the next event. Their storage (including the capacity of any
+// std::vector members) is kept, so in the steady state no heap allocation happens.
+// addresses are stable for the lifetime of the pool
+// T must be default-constructible and provide Init(), resetting it to the default state
+///////////////////////////////////////////////////////////////////////////////
+#ifndef __CalPatRec_ObjectPool_hh__
+#define __CalPatRec_ObjectPool_hh__
+
+#include <cstddef>
+#include <deque>
+
+namespace mu2e {
+
+  template <class T> class ObjectPool {
+  public:
+    ObjectPool() : fNUsed(0) {}
+    // returns an object in its default state
+    T* create() {
+      if (fNUsed == fStore.size()) {
+	fStore.emplace_back();
+	return &fStore[fNUsed++];
+      }
+      T* obj = &fStore[fNUsed++];
+      obj->Init();
+      return obj;
+    }
+    // recycle all objects; pointers obtained before must not be used afterwards
+    void   clear()          { fNUsed = 0; }
+    std::size_t nUsed    () const { return fNUsed; }
+    std::size_t nAllocated() const { return fStore.size(); }
+  private:
+    std::deque<T> fStore;
+    std::size_t        fNUsed;
+  };
+}
+#endif
@@ -22,6 +22,7 @@
 #include "RecoDataProducts/inc/StrawHit.hh"
 #include "RecoDataProducts/inc/ComboHit.hh"
 #include "RecoDataProducts/inc/StrawHitIndex.hh"
+#include "RecoDataProducts/inc/TrackerHitIndex.hh"
 #include "RecoDataProducts/inc/CaloCluster.hh"
 #include "TrackerGeom/inc/Straw.hh"
 #include "GeometryService/inc/GeometryService.hh"
@@ -73,10 +74,6 @@ namespace mu2e {
   };
 
   // comparison functor for sorting byuniquePanel ID
-  struct panelcomp : public std::binary_function<mu2e::ComboHit,mu2e::ComboHit,bool> {
-    bool operator()(mu2e::ComboHit const& p1, mu2e::ComboHit const& p2) { return p1.strawId().uniquePanel() < p2.strawId().uniquePanel(); }
-  };
-
 //-----------------------------------------------------------------------------
   void CalHelixFinderAlg::defineHelixParams(CalHelixFinderData& Helix) const {
 
@@ -1563,7 +1560,7 @@ namespace mu2e {
     if (fCaloTime > 0) clPhi = polyAtan2(fCaloY,fCaloX);
 
     const vector<StrawHitIndex>& shIndices = Helix._timeCluster->hits();
-    ChannelID cx, co;
+    const TrackerHitIndex*       hitIndex  = Helix.hitIndex();
 
     int     size           = Helix._timeCluster->nhits();
     int     nFiltPoints(0), nFiltStrawHits(0);
@@ -1572,9 +1569,9 @@ namespace mu2e {
     int loc;
     StrawHitFlag flag;
 
-    //sort the hits by z coordinate
-    ComboHitCollection ordChCol;
-    ordChCol.reserve(size);
+    //sort the hits by panel, using the hit index
+    vector<ComboHitIndex> ordHits;
+    ordHits.reserve(size);
 
     if (_debug >0 ){
       printf("-----------------------------------------------------------------------------------/n");
@@ -1620,29 +1617,21 @@ namespace mu2e {
 		 ch.pos().x(), ch.pos().y(), ch.pos().z());
 	}
 
-	ordChCol.push_back(ComboHit(ch));
+	ordHits.push_back(loc);
       }
     }
-    std::sort(ordChCol.begin(), ordChCol.end(),panelcomp());
+    std::sort(ordHits.begin(), ordHits.end(),
+	      [hitIndex](ComboHitIndex a, ComboHitIndex b) { return hitIndex->panelRank(a) < hitIndex->panelRank(b); });
 
-    for (unsigned i=0; i<ordChCol.size(); ++i) {
-      ComboHit& ch = ordChCol[i];
-
-      cx.Station                 = ch.strawId().station();//straw.id().getStation();
-      cx.Plane                   = ch.strawId().plane() % 2;//straw.id().getPlane() % 2;
-      cx.Face                    = ch.strawId().face();
-      cx.Panel                   = ch.strawId().panel();//straw.id().getPanel();
+    for (auto ich : ordHits) {
+      const ComboHit& ch = Helix.chcol()->at(ich);
 
       // get Z-ordered location
-      Helix.orderID(&cx, &co);
-     
-      int os       = co.Station; 
-      int of       = co.Face;
-      //FIXME!!! COMPARE OF WITH ch.sid().uniqueFace()
-      int op       = co.Panel;
-
-      int       stationId = os;
-      int       faceId    = of + stationId*StrawId::_nfaces*FaceZ_t::kNPlanesPerStation;//FaceZ_t::kNFaces;
+      uint16_t upanel = hitIndex->uniquePanel(ich);
+      int of       = TrackerHitIndex::orderedFace(upanel);
+      int op       = TrackerHitIndex::orderedPanel(upanel);
+
+      int       faceId    = TrackerHitIndex::faceId(upanel);
       //	int       panelId   = op + faceId*FaceZ_t::kNPanels;//PerFace;
       FaceZ_t*  fz        = &Helix._oTracker[faceId];
       PanelZ_t* pz        = &fz->panelZs[op];
@@ -14,6 +14,7 @@
 #include "GeometryService/inc/DetectorSystem.hh"
 #include "art/Framework/Core/ModuleMacros.h"
 #include "art_root_io/TFileService.h"
+#include "cetlib_except/exception.h"
 
 // conditions
 #include "ConditionsService/inc/AcceleratorParams.hh"
@@ -61,6 +62,7 @@ namespace mu2e {
     _shLabel            (pset.get<string>("StrawHitCollectionLabel"        )),
     _shfLabel           (pset.get<string>("StrawHitFlagCollectionLabel"    )),
     _timeclLabel        (pset.get<string>("TimeClusterCollectionLabel"     )),
+    _thiLabel           (pset.get<string>("TrackerHitIndexLabel"           )),
     _minNHitsTimeCluster(pset.get<int>   ("minNHitsTimeCluster"            )),
     _tpart              ((TrkParticle::type)(pset.get<int>("fitparticle"))),
     _fdir               ((TrkFitDirection::FitDirection)(pset.get<int>("fitdirection"))),
@@ -68,6 +70,7 @@ namespace mu2e {
       consumes<ComboHitCollection>(_shLabel);
       consumes<StrawHitFlagCollection>(_shfLabel);
       consumes<TimeClusterCollection>(_timeclLabel);
+      if (!_thiLabel.empty()) consumes<TrackerHitIndex>(_thiLabel);
 
       std::vector<int> helvals = pset.get<std::vector<int> >("Helicities",vector<int>{Helicity::neghel,Helicity::poshel}); //pset.get<std::vector<int> >("Helicities",vector<int>{Helicity::neghel,Helicity::poshel});
       for(auto hv : helvals) {
@@ -175,6 +178,22 @@ namespace mu2e {
 
     if (evt.getByLabel(_shLabel, _strawhitsH)) {
       _chcol = _strawhitsH.product();
+//-----------------------------------------------------------------------------
+// hit index: shared if the event has it, built here otherwise
+//-----------------------------------------------------------------------------
+      art::Handle<TrackerHitIndex> thiH;
+      if (!_thiLabel.empty()) evt.getByLabel(_thiLabel, thiH);
+      if (thiH.isValid()) {
+        _thi = thiH.product();
+        if (!_thi->indexes(_strawhitsH.id())) {
+          throw cet::exception("RECO")<<"mu2e::CalHelixFinder: TrackerHitIndex " << _thiLabel
+                                      << " doesn't index the ComboHitCollection " << _shLabel << endl;
+        }
+      }
+      else {
+        _localIndex.fill(*_chcol,_strawhitsH.id());
+        _thi = &_localIndex;
+      }
     }
     else {
       _chcol  = 0;
@@ -255,6 +274,7 @@ namespace mu2e {
     _hfResult._chcol  = _chcol;
     // _hfResult._shpos  = _shpcol;
     _hfResult._shfcol = _shfcol;
+    _hfResult._hitIndex = _thi;
 
     _data.nTimePeaks  = _timeclcol->size();
     for (int ipeak=0; ipeak<_data.nTimePeaks; ipeak++) {
@@ -16,6 +16,7 @@
 #include "art/Framework/Core/ModuleMacros.h"
 #include "art_root_io/TFileService.h"
 #include "art/Utilities/make_tool.h"
+#include "cetlib_except/exception.h"
 
 // conditions
 #include "ConditionsService/inc/AcceleratorParams.hh"
@@ -34,6 +35,8 @@
 
 #include "Mu2eUtilities/inc/polyAtan2.hh"
 
+#include <algorithm>
+
 using namespace std;
 
 using CLHEP::HepVector;
@@ -53,6 +56,7 @@ namespace mu2e {
     _shLabel         (pset.get<string>         ("StrawHitCollectionLabel"        )),
     _shfLabel        (pset.get<string>         ("StrawHitFlagCollectionLabel"    )),
     _ccmLabel        (pset.get<string>         ("caloClusterModuleLabel"         )),
+    _thiLabel        (pset.get<string>         ("TrackerHitIndexLabel"           )),
     _hsel            (pset.get<vector<string> >("HitSelectionBits"               )),
     _bkgsel          (pset.get<vector<string> >("BackgroundSelectionBits"        )),
     _mindt           (pset.get<double>         ("DtMin"                          )),
@@ -67,6 +71,7 @@ namespace mu2e {
   {
     consumes<ComboHitCollection>(_shLabel);
     consumes<CaloClusterCollection>(_ccmLabel);
+    if (!_thiLabel.empty()) consumes<TrackerHitIndex>(_thiLabel);
     produces<TimeClusterCollection>();
     // produces<CalTimePeakCollection>();
 
@@ -114,6 +119,22 @@ namespace mu2e {
     auto chcolH = evt.getValidHandle<ComboHitCollection>(_shLabel);
     if (chcolH.product() != 0){
       _data.chcol = chcolH.product();
+//-----------------------------------------------------------------------------
+// hit index: shared if the event has it, built here otherwise
+//-----------------------------------------------------------------------------
+      art::Handle<TrackerHitIndex> thiH;
+      if (!_thiLabel.empty()) evt.getByLabel(_thiLabel, thiH);
+      if (thiH.isValid()) {
+        _thi = thiH.product();
+        if (!_thi->indexes(chcolH.id())) {
+          throw cet::exception("RECO")<<"mu2e::CalTimePeakFinder: TrackerHitIndex " << _thiLabel
+                                      << " doesn't index the ComboHitCollection " << _shLabel << endl;
+        }
+      }
+      else {
+        _localIndex.fill(*_data.chcol,chcolH.id());
+        _thi = &_localIndex;
+      }
     }
     else {
       _data.chcol  = 0;
@@ -186,7 +207,7 @@ namespace mu2e {
 
     //    const char* oname = "CalTimePeakFinder::findTimePeaks";
 
-    int                 ncl, nch;
+    int                 ncl;
     double              time, dt, tof, zstraw, cl_time;//, stime;
     double              xcl, ycl, zcl/*, dz_cl*/;
     const CaloCluster*  cl;
@@ -205,7 +226,6 @@ namespace mu2e {
 //-----------------------------------------------------------------------------
 // Loop over calorimeter clusters
 //-----------------------------------------------------------------------------
-    nch   = _data.chcol->size();
     ncl   = _data.ccCollection->size();
 
     for (int ic=0; ic<ncl; ic++) {
@@ -232,9 +252,25 @@ namespace mu2e {
           // create time peak
           TimeCluster tpeak;
 //-----------------------------------------------------------------------------
+// the dt window over the z range of the hits bounds the hit time: take the
+// candidate hits from the time-ordered index (1 ns margin for the float
+// rounding), and test them in collection order
+//-----------------------------------------------------------------------------
+          double tofmin = (zcl-_thi->zMax())/_sinPitch/(CLHEP::c_light*_beta);
+          double tofmax = (zcl-_thi->zMin())/_sinPitch/(CLHEP::c_light*_beta);
+          if (tofmin > tofmax) std::swap(tofmin,tofmax);
+
+          float tmin = cl_time-tofmax+meanDriftTime-_maxdt-1.;
+          float tmax = cl_time-tofmin+meanDriftTime-_mindt+1.;
+
+          const vector<ComboHitIndex>& timeOrder = _thi->timeOrder();
+          _candidates.assign(timeOrder.begin()+_thi->lowerTimeRank(tmin),
+                             timeOrder.begin()+_thi->lowerTimeRank(tmax));
+          std::sort(_candidates.begin(),_candidates.end());
+//-----------------------------------------------------------------------------
 // record hits in time with each peak, and accept them if they have a minimum # of hits
 //-----------------------------------------------------------------------------
-          for(int istr=0; istr<nch;++istr) {
+          for(int istr : _candidates) {
 
             hit    = &_data.chcol->at(istr);
             time   = hit->time();
@@ -107,6 +107,7 @@ namespace mu2e {
     float                               _tdbuff; // following Dave - time division buffer
     
     DeltaFinder2Types::Data_t            _data;              // all data used
+    std::vector<HitData_t*>              _neighborHits;      // work space for getNeighborHits
     int                                 _testOrderPrinted;
 
     double                              _stationToCaloTOF[2][20];
@@ -408,7 +409,7 @@ namespace mu2e {
 //-----------------------------------------------------------------------------
 // new hit needs to be added, create a new "fake" seed for that
 //-----------------------------------------------------------------------------
-	    if (new_seed == NULL) new_seed = new DeltaSeed();
+	    if (new_seed == NULL) new_seed = _data.seedPool.create();
 	    
 	    new_seed->panelz[face]  = panelz;
 	    new_seed->fNHitsTot    += 1;
@@ -576,13 +577,10 @@ namespace mu2e {
     
     for (int is=0; is<kNStations; is++) {
       _data.nseeds_per_station[is] = 0;
-
-      for (auto ds=_data.seedHolder[is].begin(); ds!=_data.seedHolder[is].end(); ds++) {
-	delete *ds;
-      }
       _data.seedHolder[is].clear();
     }
 
+    _data.seedPool.clear();
     _data.deltaCandidateHolder.clear();
 //-----------------------------------------------------------------------------
 // process event
@@ -593,6 +591,10 @@ namespace mu2e {
     }
     
     runDeltaFinder();
+    if (_debugLevel > 0) {
+      printf(">>> DeltaFinder2::produce: N(seeds) used: %5lu allocated: %5lu\n",
+	     _data.seedPool.nUsed(),_data.seedPool.nAllocated());
+    }
 //-----------------------------------------------------------------------------
 // form output - copy input flag collection - do we need it ?
 //-----------------------------------------------------------------------------
@@ -799,7 +801,8 @@ namespace mu2e {
     
     DeltaFinder2Types::Intersection_t     res;
 
-    vector<HitData_t*> hits;
+    vector<HitData_t*>& hits = _neighborHits;
+    hits.clear();
 
     const HitData_t* hd1 = Seed->HitData(Face,0);
     const Straw* straw1  = hd1->fStraw;
@@ -951,7 +954,7 @@ namespace mu2e {
 //-----------------------------------------------------------------------------
 // new seed
 //-----------------------------------------------------------------------------
-	      DeltaSeed* seed = new DeltaSeed();
+	      DeltaSeed* seed = _data.seedPool.create();
 	      seed->fStation             =  Station;
 	      seed->fNumber              =  _data.seedHolder[Station].size();
 	      seed->fType                = 10*Face+f2;
@@ -19,6 +19,7 @@
 #include "TVector2.h"
 // data
 #include "RecoDataProducts/inc/ComboHit.hh"
+#include "RecoDataProducts/inc/TrackerHitIndex.hh"
 #include "RecoDataProducts/inc/StrawHit.hh"
 #include "RecoDataProducts/inc/StrawHitCollection.hh"
 #include "RecoDataProducts/inc/StrawHitPositionCollection.hh"
@@ -35,6 +36,9 @@
 #include "Mu2eUtilities/inc/ModuleHistToolBase.hh"
 #include "art/Utilities/make_tool.h"
 
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
+
 #include <algorithm>
 #include <cmath>
 #include "CLHEP/Vector/ThreeVector.h"
@@ -67,6 +71,7 @@ namespace mu2e {
     art::ProductToken<StrawHitCollection> const _shToken;
     art::ProductToken<ComboHitCollection> const _chToken;
     art::ProductToken<TimeClusterCollection> const _tpeakToken;
+    std::string                         _thiTag;               // shared hit index, if empty or missing the hits are indexed here
     int                                 _useTimePeaks;
     double                              _minCaloDt;
     double                              _maxCaloDt;
@@ -90,6 +95,7 @@ namespace mu2e {
     float                               _maxDtDs;              // low-P electron travel time between two stations
     int                                 _writeStrawHits;
     int                                 _filter;
+    int                                 _parallelSeedSearch;   // 1: search stations for seeds in parallel
 
     int                                 _debugLevel;
     int                                 _diagLevel;
@@ -99,8 +105,11 @@ namespace mu2e {
 // cache event/geometry objects
 //-----------------------------------------------------------------------------
     const ComboHitCollection*           _chcol ;
+    const TrackerHitIndex*              _thi;
+    TrackerHitIndex                     _localIndex;
     const TimeClusterCollection*        _tpeakcol;
     StrawHitFlagCollection*             _bkgfcol;  // output collection
+    StrawHitIndexMap                    _shmap;    // ComboHit -> StrawHit indices, reused across events
 
     const Tracker*                      _tracker;
     const DiskCalorimeter*              _calorimeter;
@@ -130,6 +139,7 @@ namespace mu2e {
     int          orderHits ();
 
     void         findSeeds (int Station, int Face);
+    void         findStationSeeds(int Station);
     void         findSeeds ();
 
     void         getNeighborHits(DeltaSeed* Seed, int Face1, int Face2, PanelZ_t* panelz);
@@ -162,6 +172,7 @@ namespace mu2e {
     _shToken{consumes<StrawHitCollection>(pset.get<string>("strawHitCollectionTag"))},
     _chToken{consumes<ComboHitCollection>(pset.get<string>("comboHitCollectionTag"))},
     _tpeakToken{consumes<TimeClusterCollection>(pset.get<string>("timePeakCollectionTag"))},
+    _thiTag                (pset.get<string>       ("trackerHitIndexTag"           )),
     _useTimePeaks          (pset.get<int>          ("useTimePeaks"                 )),
     _minCaloDt             (pset.get<double>       ("minCaloDt"                    )),
     _maxCaloDt             (pset.get<double>       ("maxCaloDt"                    )),
@@ -186,12 +197,14 @@ namespace mu2e {
     _maxDtDs               (pset.get<float>        ("maxDtDs"                      )),
     _writeStrawHits        (pset.get<int>          ("writeStrawHits"               )),
     _filter                (pset.get<int>          ("filter"                       )),
+    _parallelSeedSearch    (pset.get<int>          ("parallelSeedSearch"           )),
 
     _debugLevel            (pset.get<int>          ("debugLevel"                   )),
     _diagLevel             (pset.get<int>          ("diagLevel"                    )),
     _testOrder             (pset.get<int>          ("testOrder"                    ))
   {
     consumesMany<ComboHitCollection>(); // Necessary because fillStrawHitIndices calls getManyByType.
+    if (! _thiTag.empty()) consumes<TrackerHitIndex>(_thiTag);
 
     produces<StrawHitFlagCollection>("ComboHits");
     if(_writeStrawHits == 1) produces<StrawHitFlagCollection>("StrawHits");
@@ -302,61 +315,51 @@ namespace mu2e {
 // use only "good" hits 
 //-----------------------------------------------------------------------------
   int DeltaFinder::orderHits() {
-    ChannelID cx, co;
+//-----------------------------------------------------------------------------
+// loop over the panel buckets of the hit index: the z-ordered location is
+// that of the panel, within a panel the hits stay in the collection order
+//-----------------------------------------------------------------------------
+    for (int upanel=0; upanel<StrawId::_nupanels; ++upanel) {
+      if (_thi->nPanelHits(upanel) == 0)                    continue;
 
-    int nhits = _chcol->size();
-    for (int h=0; h<nhits; ++h) {
-      const ComboHit*         sh  = &(*_chcol)[h];
-
-      if (sh->energyDep() > _maxElectronHitEnergy)         continue;
-      if ( (sh->time() < _minT) || (sh->time() > _maxT) )  continue;
-
-      cx.Station                 = sh->strawId().station();  //straw->id().getStation();
-      cx.Plane                   = sh->strawId().plane() % 2;//straw->id().getPlane() % 2;
-      cx.Face                    = -1;
-      cx.Panel                   = sh->strawId().panel();    //straw->id().getPanel();
-      cx.Layer                   = sh->strawId().layer();    //straw->id().getLayer();
-
-					      // get Z-ordered location
-      orderID(&cx, &co);
-
-      int os       = co.Station;
-      int of       = co.Face;
-      int op       = co.Panel;
-      int ol       = co.Layer;
-
-      if (_useTimePeaks == 1) {
-        bool               intime(false);
-        int                nTPeaks  = _tpeakcol->size();
-        double             hitTime  = sh->time();
-        const CaloCluster* cl(nullptr);
-        int                iDisk(-1);
-
-        for (int i=0; i<nTPeaks; ++i){
-          cl    = _tpeakcol->at(i).caloCluster().get();
-          if (cl == nullptr) {
-            printf(">>> DeltaFinder::orderHits() no CaloCluster found within the time peak %i\n", i);
-            continue;
-          }
-          iDisk = cl->diskId();
-          double    dt = cl->time() - (hitTime + _stationToCaloTOF[iDisk][os]);
-          if ( (dt < _maxCaloDt) && (dt > _minCaloDt) ) {
-            intime = true;
-            break;
-          }
-        }
-        if (!intime)                                    continue;
-      }
+      int os       = TrackerHitIndex::station     (upanel);
+      int of       = TrackerHitIndex::orderedFace (upanel);
+      int op       = TrackerHitIndex::orderedPanel(upanel);
 
       PanelZ_t* pz = &_data.oTracker[os][of][op];
 
-      if ((os < 0) || (os >= kNStations     )) printf(" >>> ERROR: wrong station number: %i\n",os);
-      if ((of < 0) || (of >= kNFaces        )) printf(" >>> ERROR: wrong face    number: %i\n",of);
-      if ((op < 0) || (op >= kNPanelsPerFace)) printf(" >>> ERROR: wrong panel   number: %i\n",op);
-      if ((ol < 0) || (ol >= 2              )) printf(" >>> ERROR: wrong layer   number: %i\n",ol);
+      for (auto ih=_thi->panelBegin(upanel); ih!=_thi->panelEnd(upanel); ++ih) {
+        const ComboHit*         sh  = &(*_chcol)[*ih];
+
+        if (sh->energyDep() > _maxElectronHitEnergy)         continue;
+        if ( (sh->time() < _minT) || (sh->time() > _maxT) )  continue;
+
+        if (_useTimePeaks == 1) {
+          bool               intime(false);
+          int                nTPeaks  = _tpeakcol->size();
+          double             hitTime  = sh->time();
+          const CaloCluster* cl(nullptr);
+          int                iDisk(-1);
 
-      float sigw = sh->posRes(ComboHit::wire);// shp->posRes(StrawHitPosition::wire);
-      pz->fHitData.push_back(HitData_t(sh,/*shp,straw,*/sigw));
+          for (int i=0; i<nTPeaks; ++i){
+            cl    = _tpeakcol->at(i).caloCluster().get();
+            if (cl == nullptr) {
+              printf(">>> DeltaFinder::orderHits() no CaloCluster found within the time peak %i\n", i);
+              continue;
+            }
+            iDisk = cl->diskId();
+            double    dt = cl->time() - (hitTime + _stationToCaloTOF[iDisk][os]);
+            if ( (dt < _maxCaloDt) && (dt > _minCaloDt) ) {
+              intime = true;
+              break;
+            }
+          }
+          if (!intime)                                    continue;
+        }
+
+        float sigw = sh->posRes(ComboHit::wire);// shp->posRes(StrawHitPosition::wire);
+        pz->fHitData.push_back(HitData_t(sh,/*shp,straw,*/sigw));
+      }
     }
 
     return 0;
@@ -410,7 +413,7 @@ namespace mu2e {
 //-----------------------------------------------------------------------------
 // new hit needs to be added, create a new "fake" seed for that
 //-----------------------------------------------------------------------------
-	      if (new_seed == NULL) new_seed = new DeltaSeed();
+	      if (new_seed == NULL) new_seed = _data.seedPool[Station].create();
 
 	      new_seed->panelz[face]  = panelz;
 	      new_seed->fNHitsTot    += 1;
@@ -553,6 +556,22 @@ namespace mu2e {
     auto shH    = Evt.getValidHandle(_chToken);
     _chcol      = shH.product();
     _data.chcol = _chcol;  // FIXME
+//-----------------------------------------------------------------------------
+// hit index: shared if the event has it, built here otherwise
+//-----------------------------------------------------------------------------
+    art::Handle<TrackerHitIndex> thiH;
+    if (! _thiTag.empty()) Evt.getByLabel(_thiTag, thiH);
+    if (thiH.isValid()) {
+      _thi = thiH.product();
+      if (! _thi->indexes(shH.id())) {
+        throw cet::exception("RECO")<<"mu2e::DeltaFinder: TrackerHitIndex " << _thiTag
+                                    << " doesn't index the input ComboHitCollection" << endl;
+      }
+    }
+    else {
+      _localIndex.fill(*_chcol,shH.id());
+      _thi = &_localIndex;
+    }
 
     return (_chcol != 0);
   }
@@ -571,11 +590,8 @@ namespace mu2e {
 
     for (int is=0; is<kNStations; is++) {
       _data.nseeds_per_station[is] = 0;
-
-      for (auto ds=_data.seedHolder[is].begin(); ds!=_data.seedHolder[is].end(); ds++) {
-        delete *ds;
-      }
       _data.seedHolder[is].clear();
+      _data.seedPool[is].clear();
     }
 
     _data.deltaCandidateHolder.clear();
@@ -588,6 +604,14 @@ namespace mu2e {
     }
 
     runDeltaFinder();
+    if (_debugLevel > 0) {
+      size_t nused(0), nallocated(0);
+      for (int is=0; is<kNStations; is++) {
+	nused      += _data.seedPool[is].nUsed();
+	nallocated += _data.seedPool[is].nAllocated();
+      }
+      printf(">>> DeltaFinder::produce: N(seeds) used: %5lu allocated: %5lu\n",nused,nallocated);
+    }
 //-----------------------------------------------------------------------------
 // form output - copy input flag collection - do we need it ?
 //-----------------------------------------------------------------------------
@@ -645,13 +669,12 @@ namespace mu2e {
       // first, copy over the original flags
       unsigned nsh = shcol->size();
       std::unique_ptr<StrawHitFlagCollection> shfcol(new StrawHitFlagCollection(nsh));
-      std::vector<std::vector<StrawHitIndex> > shids;
-      _chcol->fillStrawHitIndices(Event,shids);
+      _chcol->fillStrawHitIndices(Event,_shmap);
       for(size_t ich = 0;ich < _chcol->size();++ich) {
     	StrawHitFlag flag = bkgfcol->at(ich);
     	flag.merge((*_chcol)[ich].flag());
-    	for(auto ish : shids[ich])
-    	  (*shfcol)[ish] = flag;
+    	for(auto ish = _shmap.begin(ich); ish != _shmap.end(ich); ++ish)
+    	  (*shfcol)[*ish] = flag;
       }
 
       Event.put(std::move(shfcol),"StrawHits");
@@ -1034,7 +1057,7 @@ namespace mu2e {
               //-----------------------------------------------------------------------------
               // new seed
               //-----------------------------------------------------------------------------
-              DeltaSeed* seed = new DeltaSeed();
+              DeltaSeed* seed = _data.seedPool[Station].create();
               seed->fStation             =  Station;
               seed->fNumber              =  _data.seedHolder[Station].size();
               seed->fType                = 10*Face+f2;
@@ -1097,9 +1120,8 @@ namespace mu2e {
 
               _data.seedHolder[Station].push_back(seed);
               //-----------------------------------------------------------------------------
-              // book-keeping: increment total number of found seeds
+              // book-keeping: the total number of found seeds is summed up in findSeeds()
               //-----------------------------------------------------------------------------
-              _data.nseeds                      += 1;
               _data.nseeds_per_station[Station] += 1;
             }
             // }
@@ -1244,7 +1266,30 @@ namespace mu2e {
 //-----------------------------------------------------------------------------
   void DeltaFinder::findSeeds() {
 
-    for (int s=0; s<kNStations; ++s) { 
+    if (_parallelSeedSearch) {
+      tbb::parallel_for(tbb::blocked_range<int>(0,kNStations),
+			[this](const tbb::blocked_range<int>& Range) {
+			  for (int s=Range.begin(); s!=Range.end(); ++s) findStationSeeds(s);
+			});
+    }
+    else {
+      for (int s=0; s<kNStations; ++s) findStationSeeds(s);
+    }
+//-----------------------------------------------------------------------------
+// merge: book-keeping of the total number of found seeds
+//-----------------------------------------------------------------------------
+    for (int s=0; s<kNStations; ++s) _data.nseeds += _data.nseeds_per_station[s];
+  }
+
+//-----------------------------------------------------------------------------
+// find seeds in station 's'
+// stations are independent until the seeds are connected, so this can run in
+// parallel over the stations: each station only touches its own panel hit data,
+// seed holder and seed pool, and the seed numbering is per station, so the
+// result doesn't depend on the execution order
+//-----------------------------------------------------------------------------
+  void DeltaFinder::findStationSeeds(int s) {
+
       for (int f1=0; f1<kNFaces-1; ++f1) {
 //-----------------------------------------------------------------------------
 // 'last' - number of seeds found so far
@@ -1418,7 +1463,6 @@ namespace mu2e {
 //-----------------------------------------------------------------------------
 	pruneSeeds(s);
       }
-    }
   }
 
   // unflagging preseed hits if seed is not completed?
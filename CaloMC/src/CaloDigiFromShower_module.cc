@@ -6,6 +6,12 @@
 //
 // The output is split between the different digitization boards
 //
+// Only the readouts with a signal get a waveform buffer. By default the noise is generated for every readout in each
+// event (noiseBankSize = 0). Optionally it is taken from a bank of noise samples generated once, starting at a random
+// offset for each readout and event: this is faster, but the windows of different readouts overlap, so their noise is
+// correlated. With the bank, a readout without signal is digitized directly from the bank, and only if its bank
+// window contains a sample above the amplitude threshold.
+//
 
 #include "art/Framework/Core/EDProducer.h"
 #include "art/Framework/Core/ModuleMacros.h"
@@ -25,10 +31,12 @@
 
 #include "CLHEP/Vector/ThreeVector.h"
 #include "CLHEP/Random/RandGaussQ.h"
+#include "CLHEP/Random/RandFlat.h"
 
 #include "TH2F.h"
 #include "TFile.h"
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <cmath>
@@ -61,9 +69,11 @@ namespace mu2e {
       endTimeBuffer_         (pset.get<double>     ("endTimeBuffer")),  // ns
       bufferDigi_            (pset.get<int>        ("bufferDigi")),  //# timestamps
       pulseIntegralSteps_    (pset.get<int>        ("pulseIntegralSteps")),         //# integral steps
+      noiseBankSize_         (pset.get<unsigned>   ("noiseBankSize",0)),  //# noise samples, 0 to generate noise every event
       diagLevel_             (pset.get<int>        ("diagLevel",0)),
       engine_                (createEngine( art::ServiceHandle<SeedService>()->getSeed() ) ),
       randGauss_             (engine_),
+      randFlat_              (engine_),
       pulseShape_(CaloPulseShape(digiSampling_,pulseIntegralSteps_))
     {
       produces<CaloDigiCollection>();
@@ -96,10 +106,12 @@ namespace mu2e {
     double                  endTimeBuffer_;
     int                     bufferDigi_;
     int                     pulseIntegralSteps_;
+    unsigned                noiseBankSize_;
 
     int                     diagLevel_;
     CLHEP::HepRandomEngine& engine_;
     CLHEP::RandGaussQ       randGauss_;
+    CLHEP::RandFlat         randFlat_;
     CaloPulseShape          pulseShape_;
 
     int                     maxADCCounts_;
@@ -109,15 +121,26 @@ namespace mu2e {
     int                     nROperCard_;
 
     std::vector< std::vector<double> > pulseDigitized_;
-    std::vector< std::vector<double> > waveforms_;
+
+    unsigned int                       nWaveforms_;
+    unsigned int                       waveformSize_;
+    std::vector< std::vector<double> > waveforms_;      // buffers of the active readouts, reused between events
+    std::vector<int>                   waveformIndex_;  // readout -> buffer, -1 if the readout is not active
+    std::vector<int>                   activeROs_;
+    std::vector<double>                noiseBank_;
+    std::vector<unsigned>              noiseBankPeaks_; // bank samples reaching the amplitude threshold
+    std::vector<unsigned>              noiseOffsets_;   // bank offset of each readout in this event
 
 
     void   resetWaveforms();
+    std::vector<double>& activeWaveform(int ROID);
+    void   makeNoiseBank();
     void   makeDigitization(const CaloShowerStepROCollection& caloShowerStepROs, CaloDigiCollection&);
     void   fillWaveforms(const CaloShowerStepROCollection& caloShowerStepROs);
     void   readoutResponse(int ROID, double energyCorr, double time);
     void   buildOutputDigi(CaloDigiCollection& caloDigiColl);
-    void   diag0(int iRO,std::vector<double>& itWave );
+    void   digitizeWaveform(int iRO, const double* itWave, int waveSize, CaloDigiCollection& caloDigiColl);
+    void   diag0(int iRO, const double* itWave, int waveSize);
     void   diag1(int iRO, double time, std::vector<int>& wf );
   };
 
@@ -165,25 +188,69 @@ namespace mu2e {
   //-------------------------------------------------
   void CaloDigiFromShower::resetWaveforms()
   {
-    unsigned int nWaveforms   = calorimeter_->nCrystal()*calorimeter_->caloInfo().nROPerCrystal();
-    unsigned int waveformSize = (mbtime_ - blindTime_ + endTimeBuffer_) / digiSampling_;
+    nWaveforms_   = calorimeter_->nCrystal()*calorimeter_->caloInfo().nROPerCrystal();
+    waveformSize_ = (mbtime_ - blindTime_ + endTimeBuffer_) / digiSampling_;
 
-    if (waveforms_.size() < nWaveforms || (waveforms_.size() && waveforms_[0].size() < waveformSize))
+    for (int iRO : activeROs_) waveformIndex_[iRO] = -1;
+    activeROs_.clear();
+    waveformIndex_.resize(nWaveforms_,-1);
+
+    if (addNoise_ && noiseBankSize_ > 0)
       {
-        waveforms_.clear();
-        for (unsigned int i=0;i< nWaveforms;++i) waveforms_.push_back(std::vector<double>(waveformSize,0.0));
+        if (noiseBank_.empty()) makeNoiseBank();
+        if (noiseBank_.size() < waveformSize_)
+          throw cet::exception("CATEGORY")<<"[CaloDigiFromShower] noiseBankSize "<<noiseBankSize_
+                                          <<" is smaller than the waveform size "<<waveformSize_<<"\n";
+
+        noiseOffsets_.resize(nWaveforms_);
+        const long nOffsets = noiseBank_.size() - waveformSize_ + 1;
+        for (unsigned int i=0; i<nWaveforms_; ++i) noiseOffsets_[i] = randFlat_.fireInt(nOffsets);
       }
 
+    //if we generate the noise every event, all readouts are active and filled with noise in readout order.
+    //The same happens without noise if a waveform of zeros can pass the thresholds.
+    if ((addNoise_ && noiseBankSize_ == 0) || (!addNoise_ && thresholdAmplitude_ <= 0))
+      for (unsigned int i=0; i<nWaveforms_; ++i) activeWaveform(i);
+  }
+
+
+  //-------------------------------------------------
+  // Waveform buffer of a readout, starting with its noise (noise_ is in mV, sample is in counts, noise must be positive)
+  std::vector<double>& CaloDigiFromShower::activeWaveform(int ROID)
+  {
+    if (waveformIndex_.at(ROID) >= 0) return waveforms_[waveformIndex_[ROID]];
+
+    waveformIndex_[ROID] = activeROs_.size();
+    if (activeROs_.size() == waveforms_.size()) waveforms_.emplace_back();
+    activeROs_.push_back(ROID);
 
-    //if we want noise, fill all waveforms with noise, noise_ is in mV, sample is in counts, noise must be positive
-    //otherwise simply reset the waveform to zero
+    std::vector<double>& waveform = waveforms_[waveformIndex_[ROID]];
+    waveform.resize(waveformSize_);
 
-    if (addNoise_)
-      for (unsigned int i=0; i<nWaveforms; ++i) std::generate(waveforms_[i].begin(),waveforms_[i].end(),
-                                                              [&] {return  std::max(0.0,randGauss_.fire(0.0,noise_)*mVToADC_);});
+    if (!addNoise_)
+      std::fill(waveform.begin(),waveform.end(),0);
+    else if (noiseBankSize_ == 0)
+      std::generate(waveform.begin(),waveform.end(),[&] {return  std::max(0.0,randGauss_.fire(0.0,noise_)*mVToADC_);});
     else
-      for (unsigned int i=0; i<nWaveforms; ++i) std::fill(waveforms_[i].begin(),waveforms_[i].end(),0);
+      std::copy_n(noiseBank_.begin()+noiseOffsets_[ROID],waveformSize_,waveform.begin());
+
+    return waveform;
+  }
+
+
+  //-------------------------------------------------
+  void CaloDigiFromShower::makeNoiseBank()
+  {
+    noiseBank_.resize(noiseBankSize_);
+    std::generate(noiseBank_.begin(),noiseBank_.end(),[&] {return  std::max(0.0,randGauss_.fire(0.0,noise_)*mVToADC_);});
+
+    // a waveform made of noise only can not pass the amplitude threshold unless one of these is in it
+    noiseBankPeaks_.clear();
+    for (unsigned i=0; i<noiseBank_.size(); ++i)
+      if (noiseBank_[i]*ADCTomV_ >= thresholdAmplitude_) noiseBankPeaks_.push_back(i);
 
+    if (diagLevel_ > 0) std::cout<<"[CaloDigiFromShower::makeNoiseBank] "<<noiseBankPeaks_.size()<<" of "
+                                 <<noiseBank_.size()<<" noise samples above the amplitude threshold"<<std::endl;
   }
 
 
@@ -208,91 +275,105 @@ namespace mu2e {
   {
     double                     pulseAmp       = energyCorr*energyScale_;
     double                     timeCorr       = time - blindTime_;
-    int                        startSample    = timeCorr/digiSampling_;
-    int                        precisionIndex = (timeCorr/digiSampling_ - int(timeCorr/digiSampling_))*pulseIntegralSteps_;
-    std::vector<double>&       waveform       = waveforms_.at(ROID);
+    double                     sampleTime     = timeCorr/digiSampling_;
+    // floor, not truncation, so pulses starting before the blind time get a valid template
+    int                        startSample    = std::floor(sampleTime);
+    int                        precisionIndex = std::min(int((sampleTime - startSample)*pulseIntegralSteps_), pulseIntegralSteps_-1);
     const std::vector<double>& pulse          = pulseShape_.pulseDigitized(precisionIndex);
-    int                        stopSample     = std::min(startSample+pulse.size(), waveform.size());
 
-    for (int timeSample = startSample; timeSample < stopSample; ++timeSample)
-      {
-        int     funcIdx   = timeSample - startSample;
-        double  funcValue = pulse.at(funcIdx);
-        double  wfAmp     = pulseAmp*funcValue;
-        double  ADCCounts = wfAmp*mVToADC_;
+    // part of the pulse inside the waveform
+    int firstSample = std::max(startSample,0);
+    int stopSample  = std::min(startSample+int(pulse.size()), int(waveformSize_));
+    if (firstSample >= stopSample) return;
 
-        waveform.at(timeSample) += ADCCounts;
-        if ( waveform.at(timeSample) > maxADCCounts_) waveform.at(timeSample) = maxADCCounts_;
-      }
+    double*       wave   = activeWaveform(ROID).data();
+    const double* func   = pulse.data();
+    const double  maxADC = maxADCCounts_;
 
+    // plain loop over contiguous arrays, vectorized by the compiler
+    for (int timeSample = firstSample; timeSample < stopSample; ++timeSample)
+      wave[timeSample] = std::min(wave[timeSample] + pulseAmp*func[timeSample-startSample]*mVToADC_, maxADC);
   }
 
 
   //----------------------------------------------------------------------------
   void CaloDigiFromShower::buildOutputDigi(CaloDigiCollection& caloDigiColl)
   {
-
-    for (unsigned int iRO=0; iRO<waveforms_.size(); ++iRO)
+    for (unsigned int iRO=0; iRO<nWaveforms_; ++iRO)
       {
+        if (waveformIndex_[iRO] >= 0)
+          {
+            digitizeWaveform(iRO, waveforms_[waveformIndex_[iRO]].data(), waveformSize_, caloDigiColl);
+            continue;
+          }
 
-        if (diagLevel_ > 5) std::cout<<"wfContent content (timesample: waveContent, funcValue)"<<std::endl;
-        if (diagLevel_ > 4) diag0(iRO,waveforms_.at(iRO));
+        // a readout without signal is its noise bank window, and is skipped without a peak in that window
+        if (!addNoise_) continue;
 
+        const unsigned offset = noiseOffsets_[iRO];
+        auto peak = std::lower_bound(noiseBankPeaks_.begin(), noiseBankPeaks_.end(), offset);
+        if (peak == noiseBankPeaks_.end() || *peak >= offset + waveformSize_) continue;
 
-        std::vector<double>& itWave = waveforms_.at(iRO);
+        digitizeWaveform(iRO, noiseBank_.data() + offset, waveformSize_, caloDigiColl);
+      }
+  }
 
-        int waveSize = itWave.size();
-        int timeSample(0);
-        while (timeSample < waveSize)
-          {
-            double waveContent = itWave.at(timeSample);
-            double funcValue   = waveContent*ADCTomV_;
 
-            if (diagLevel_ > 5 && waveContent > 0) printf("wfContent (%4i:  %4i, %9.3f) \n", timeSample, int(waveContent), funcValue);
-            if (funcValue < thresholdVoltage_) {++timeSample; continue;}
+  //----------------------------------------------------------------------------
+  void CaloDigiFromShower::digitizeWaveform(int iRO, const double* itWave, int waveSize, CaloDigiCollection& caloDigiColl)
+  {
+    if (diagLevel_ > 5) std::cout<<"wfContent content (timesample: waveContent, funcValue)"<<std::endl;
+    if (diagLevel_ > 4) diag0(iRO,itWave,waveSize);
+
+    int timeSample(0);
+    while (timeSample < waveSize)
+      {
+        double waveContent = itWave[timeSample];
+        double funcValue   = waveContent*ADCTomV_;
 
+        if (diagLevel_ > 5 && waveContent > 0) printf("wfContent (%4i:  %4i, %9.3f) \n", timeSample, int(waveContent), funcValue);
+        if (funcValue < thresholdVoltage_) {++timeSample; continue;}
 
-            // find the starting / stopping point of the peak
-            // the stopping point is the first value below the threshold _and_ the buffer is also below the threshold
 
-            int sampleStart = std::max(timeSample - bufferDigi_,0);
-            int sampleStop  = timeSample;
-            for (; sampleStop < waveSize; ++sampleStop)
-              {
-                int sampleCheck = std::min(sampleStop+bufferDigi_+1,waveSize-1);
-                double waveOverBuffer = *std::max_element(&itWave.at(sampleStop),&itWave.at(sampleCheck));
-                if (waveOverBuffer*ADCTomV_ < thresholdVoltage_) break;
-              }
-            sampleStop = std::min(sampleStop + bufferDigi_, waveSize-1);
+        // find the starting / stopping point of the peak
+        // the stopping point is the first value below the threshold _and_ the buffer is also below the threshold
 
-            timeSample = sampleStop+1;  //forward the scanning time
+        int sampleStart = std::max(timeSample - bufferDigi_,0);
+        int sampleStop  = timeSample;
+        for (; sampleStop < waveSize; ++sampleStop)
+          {
+            int sampleCheck = std::min(sampleStop+bufferDigi_+1,waveSize-1);
+            double waveOverBuffer = *std::max_element(itWave+sampleStop,itWave+sampleCheck);
+            if (waveOverBuffer*ADCTomV_ < thresholdVoltage_) break;
+          }
+        sampleStop = std::min(sampleStop + bufferDigi_, waveSize-1);
 
+        timeSample = sampleStop+1;  //forward the scanning time
 
-            if (sampleStop == sampleStart) continue;  //check if peak is acceptable and digitize
 
-            double sampleMax = *std::max_element(&itWave.at(sampleStart),&itWave.at(sampleStop));
-            if (sampleMax*ADCTomV_ < thresholdAmplitude_) continue;
+        if (sampleStop == sampleStart) continue;  //check if peak is acceptable and digitize
 
+        double sampleMax = *std::max_element(itWave+sampleStart,itWave+sampleStop);
+        if (sampleMax*ADCTomV_ < thresholdAmplitude_) continue;
 
-            int t0 = int(sampleStart*digiSampling_+ blindTime_);
-            std::vector<int> wf;
-            for (int i=sampleStart; i<=sampleStop; ++i) wf.push_back(int(itWave.at(i)));
 
-            caloDigiColl.emplace_back( CaloDigi(iRO,t0,wf) );
+        int t0 = int(sampleStart*digiSampling_+ blindTime_);
+        std::vector<int> wf(itWave+sampleStart, itWave+sampleStop+1);
 
-            if (diagLevel_ > 4) diag1(iRO,t0,wf);
-          }
+        caloDigiColl.emplace_back( CaloDigi(iRO,t0,wf) );
+
+        if (diagLevel_ > 4) diag1(iRO,t0,wf);
       }
   }
 
 
 
 
-  void CaloDigiFromShower::diag0(int iRO,std::vector<double>& itWave )
+  void CaloDigiFromShower::diag0(int iRO, const double* itWave, int waveSize)
   {
-    if (*std::max_element(itWave.begin(),itWave.end())<1) return;
+    if (*std::max_element(itWave,itWave+waveSize)<1) return;
     std::cout<<"CaloDigiFromShower::fillOutoutRO] Waveform content for readout "<<iRO<<std::endl;
-    for (const auto  &v : itWave) std::cout<<v<<" ";
+    for (int i=0; i<waveSize; ++i) std::cout<<itWave[i]<<" ";
     std::cout<<std::endl;
   }
 
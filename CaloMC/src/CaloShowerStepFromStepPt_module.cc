@@ -4,8 +4,9 @@
 //
 // Original author Bertrand Echenard
 //
-// Note: Replace std::map<art:Ptr<SimParticle, XXXXX> > by std::unordered_map<art::Ptr<SimParticle>, xxx> when the art::Ptr hashing
-//       function is implemented in a future release (recommended to not implement your own, it will clash with art)
+// Note: SimParticle lookups use hash maps with the mu2e::PtrHash functor (Mu2eUtilities/inc/PtrHash.hh), not a std::hash
+//       specialization, which would clash with the one art may provide in a future release. Steps are grouped by SimParticle
+//       and crystal by sorting, so the output order is the same as with the std::map used before.
 //
 //
 // This modules compresses calorimeter StepPointMCs into CaloShower objects, and flags "interesting" SimParticles.
@@ -43,11 +44,13 @@
 #include "MCDataProducts/inc/CaloShowerStepCollection.hh"
 #include "MCDataProducts/inc/PhysicalVolumeInfoMultiCollection.hh"
 #include "Mu2eUtilities/inc/PhysicalVolumeMultiHelper.hh"
+#include "Mu2eUtilities/inc/PtrHash.hh"
 
 
 #include "CLHEP/Vector/ThreeVector.h"
 #include "TH2F.h"
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <cmath>
@@ -90,6 +93,26 @@ namespace mu2e {
       std::vector<art::Ptr<SimParticle> >  sims_;
       std::unordered_set<int>              procs_;
     };
+
+    // Stable-sort the steps with less and call fn(steps of the group) for each group of equivalent steps,
+    // in increasing order. This replaces a std::map<key,std::vector<const StepPointMC*> > with the same
+    // iteration order, and the steps of a group in their original order.
+    template <class LESS, class FN>
+    void forEachGroup(std::vector<const StepPointMC*>& steps, LESS less, FN fn)
+    {
+      std::stable_sort(steps.begin(), steps.end(), less);
+      std::vector<const StepPointMC*> group;
+      for (auto first = steps.begin(); first != steps.end(); )
+        {
+          auto last = std::find_if(first, steps.end(), [&](const StepPointMC* step) {return less(*first,step);});
+          group.assign(first,last);
+          fn(group);
+          first = last;
+        }
+    }
+
+    bool lessVolume(const StepPointMC* a, const StepPointMC* b) {return a->volumeId() < b->volumeId();}
+    bool lessSim(const StepPointMC* a, const StepPointMC* b)    {return a->simParticle() < b->simParticle();}
   }
 
 
@@ -127,6 +150,7 @@ namespace mu2e {
 
     using HandleVector = std::vector<art::Handle<StepPointMCCollection>>;
     using SimPtr = art::Ptr<SimParticle>;
+    using AncestorVector = std::vector<std::pair<SimPtr,CaloCompressUtil>>;
 
     int const                                      numZSlices_;
     double const                                   deltaTime_;
@@ -161,8 +185,8 @@ namespace mu2e {
     void makeCompressedHits(const HandleVector&, const HandleVector&, CaloShowerStepCollection&,
                             CaloShowerStepCollection&, SimParticlePtrCollection&);
     void collectStepBySimAncestor(const Calorimeter&, const PhysicalVolumeMultiHelper& ,
-                                  const HandleVector&, std::map<SimPtr,CaloCompressUtil>&);
-    void collectStepBySim(const HandleVector&, std::map<SimPtr,std::vector<const StepPointMC*> >&);
+                                  const HandleVector&, AncestorVector&);
+    void collectSteps(const HandleVector&, std::vector<const StepPointMC*>&);
     bool isInsideCalorimeter(const Calorimeter& cal, const PhysicalVolumeMultiHelper&, const art::Ptr<SimParticle>&);
     bool isCompressible(int simPdgId, const  std::unordered_set<int>&, const  SimParticlePtrCollection&);
     void compressSteps(const Calorimeter&, CaloShowerStepCollection&, bool isCrystal,
@@ -278,8 +302,8 @@ namespace mu2e {
     // Collect the StepPointMC's produced by each SimParticle Ancestor
     //-----------------------------------------------------------------
 
-    std::map<SimPtr,CaloCompressUtil> crystalAncestorsMap;
-    collectStepBySimAncestor(cal,vi,crystalStepsHandles,crystalAncestorsMap);
+    AncestorVector crystalAncestors;
+    collectStepBySimAncestor(cal,vi,crystalStepsHandles,crystalAncestors);
 
     if (diagLevel_ == 99)  dumpAllInfo(crystalStepsHandles,cal);
 
@@ -289,7 +313,8 @@ namespace mu2e {
     //---------------------------------------------------------------------------------------------------------------
     int nCompress(0),nCompressAll(0);
 
-    for (const auto& iter : crystalAncestorsMap )
+    std::vector<const StepPointMC*> ancestorSteps;
+    for (const auto& iter : crystalAncestors )
       {
         const SimPtr&           sim  = iter.first;
         const CaloCompressUtil& info = iter.second;
@@ -297,13 +322,10 @@ namespace mu2e {
         bool doCompress = isCompressible(sim->pdgId(),info.processCodes(),info.sims());
         totalSim_ +=info.sims().size();
 
-        std::map<int,std::vector<const StepPointMC*> > crystalMap;
-        for (const StepPointMC* step : info.steps()) crystalMap[step->volumeId()].push_back(step);
-
-        for (const auto& iterCrystal : crystalMap)
+        ancestorSteps = info.steps();
+        forEachGroup(ancestorSteps, lessVolume, [&](std::vector<const StepPointMC*>& steps)
           {
-            int crid = iterCrystal.first;
-            std::vector<const StepPointMC*> steps = iterCrystal.second;
+            int crid = steps.front()->volumeId();
 
             if ( doCompress )
               {
@@ -329,15 +351,14 @@ namespace mu2e {
 
             else
               {
-                std::map<SimPtr, std::vector<const StepPointMC*> > newSimStepMap;
-                for (const StepPointMC* step : steps) newSimStepMap[step->simParticle()].push_back(step);
-                for (auto& iter : newSimStepMap)
+                forEachGroup(steps, lessSim, [&](std::vector<const StepPointMC*>& simSteps)
                   {
-                    compressSteps(cal, caloShowerStepMCs, true, crid, iter.first, iter.second);
-                    simsToKeep.push_back(iter.first);
-                  }
+                    const SimPtr& simD = simSteps.front()->simParticle();
+                    compressSteps(cal, caloShowerStepMCs, true, crid, simD, simSteps);
+                    simsToKeep.push_back(simD);
+                  });
               }
-          }
+          });
         ++nCompressAll;
         if (doCompress) ++nCompress;
       }
@@ -346,24 +367,18 @@ namespace mu2e {
     // Do the same for the readouts, but there is no need to compress
     //---------------------------------------------------------------
 
-    std::map<SimPtr,std::vector<const StepPointMC*> > simStepROMap;
-    collectStepBySim(readoutStepsHandles, simStepROMap);
+    std::vector<const StepPointMC*> readoutSteps;
+    collectSteps(readoutStepsHandles, readoutSteps);
 
-    for (const auto& iter : simStepROMap )
+    forEachGroup(readoutSteps, lessSim, [&](std::vector<const StepPointMC*>& simSteps)
       {
-        const SimPtr& sim = iter.first;
-        const std::vector<const StepPointMC*>& steps = iter.second;
-
-        std::map<int,std::vector<const StepPointMC*> > crystalMap;
-        for (const StepPointMC* step : steps) crystalMap[step->volumeId()].push_back(step);
-
-        for (const auto& iterCrystal : crystalMap)
+        const SimPtr& sim = simSteps.front()->simParticle();
+        forEachGroup(simSteps, lessVolume, [&](std::vector<const StepPointMC*>& steps)
           {
-            int ROID = iterCrystal.first;
-            std::vector<const StepPointMC*> steps = iterCrystal.second;
+            int ROID = steps.front()->volumeId();
             compressSteps(cal, caloROShowerStepMCs, false, ROID, sim, steps);
-          }
-      }
+          });
+      });
 
 
     if (diagLevel_ > 2) hEtot_->Fill(totalEdep_);
@@ -385,10 +400,11 @@ namespace mu2e {
   void CaloShowerStepFromStepPt::collectStepBySimAncestor(const Calorimeter& cal,
                                                           const PhysicalVolumeMultiHelper& vi,
                                                           const HandleVector& stepsHandles,
-                                                          std::map<SimPtr,CaloCompressUtil>& ancestorsMap)
+                                                          AncestorVector& ancestors)
   {
 
-    std::map<SimPtr,SimPtr> simToAncestorMap;
+    PtrMap<SimParticle,SimPtr>   simToAncestorMap;
+    PtrMap<SimParticle,unsigned> ancestorIndex;
 
 
     for ( HandleVector::const_iterator i=stepsHandles.begin(), e=stepsHandles.end(); i != e; ++i )
@@ -416,12 +432,17 @@ namespace mu2e {
               }
 
             for (const SimPtr& inspectedSim : inspectedSims) simToAncestorMap[inspectedSim] = sim;
-            ancestorsMap[sim].fill(&step,inspectedSims);
+
+            auto const index = ancestorIndex.emplace(sim,ancestors.size());
+            if (index.second) ancestors.emplace_back(sim,CaloCompressUtil());
+            ancestors[index.first->second].second.fill(&step,inspectedSims);
 
             totalEdep_ += step.totalEDep();
           }
       }
 
+    // process the ancestors in SimParticle order
+    std::sort(ancestors.begin(), ancestors.end(), [](const auto& a, const auto& b) {return a.first < b.first;});
   }
 
 
@@ -441,15 +462,15 @@ namespace mu2e {
 
 
   //-------------------------------------------------------------------------------------------------------------
-  void CaloShowerStepFromStepPt::collectStepBySim(const HandleVector& stepsHandles,
-                                                  std::map<SimPtr,std::vector<const StepPointMC* > >& simStepMap)
+  void CaloShowerStepFromStepPt::collectSteps(const HandleVector& stepsHandles,
+                                              std::vector<const StepPointMC* >& allSteps)
   {
     for ( HandleVector::const_iterator i=stepsHandles.begin(), e=stepsHandles.end(); i != e; ++i )
       {
         const art::Handle<StepPointMCCollection>& handle(*i);
         const StepPointMCCollection& steps(*handle);
 
-        for (const auto& step : steps ) simStepMap[step.simParticle()].push_back(&step);
+        for (const auto& step : steps ) allSteps.push_back(&step);
       }
   }
 
@@ -14,7 +14,6 @@
 #include "CLHEP/Vector/ThreeVector.h"
 #include "CLHEP/Vector/LorentzVector.h"
 #include "CLHEP/Random/RandomEngine.h"
-#include "CLHEP/Random/RandGeneral.h"
 #include "CLHEP/Units/PhysicalConstants.h"
 
 // Framework includes
@@ -40,6 +39,7 @@
 #include "Mu2eUtilities/inc/PionCaptureSpectrum.hh"
 #include "Mu2eUtilities/inc/SimpleSpectrum.hh"
 #include "Mu2eUtilities/inc/BinnedSpectrum.hh"
+#include "Mu2eUtilities/inc/RandAlias.hh"
 #include "Mu2eUtilities/inc/Table.hh"
 #include "Mu2eUtilities/inc/RootTreeSampler.hh"
 #include "GeneralUtilities/inc/RSNTIO.hh"
@@ -74,7 +74,7 @@ namespace mu2e {
 
     art::RandomNumberGenerator::base_engine_t& eng_;
 
-    CLHEP::RandGeneral  randSpectrum_;
+    RandAlias           randSpectrum_;
     CLHEP::RandFlat     randomFlat_;
     RandomUnitSphere    randomUnitSphere_;
     PionCaptureSpectrum pionCaptureSpectrum_;
@@ -116,7 +116,8 @@ namespace mu2e {
     , phimin_                    (pset.get<double>("phimin",  0. ))
     , phimax_                    (pset.get<double>("phimax", CLHEP::twopi ))
     , eng_(createEngine(art::ServiceHandle<SeedService>()->getSeed()))
-    , randSpectrum_       (eng_, spectrum_.getPDF(), spectrum_.getNbins())
+    , randSpectrum_       (eng_, spectrum_.getPDF(), spectrum_.getNbins(),
+                           RandAlias::interpolationFromName(psphys_.get<std::string>("spectrumInterpolation", "flat")))
     , randomFlat_         (eng_)
     , randomUnitSphere_   (eng_, czmin_,czmax_,phimin_,phimax_)
     , pionCaptureSpectrum_(&randomFlat_,&randomUnitSphere_)
@@ -14,7 +14,6 @@
 #include "CLHEP/Vector/ThreeVector.h"
 #include "CLHEP/Vector/LorentzVector.h"
 #include "CLHEP/Random/RandomEngine.h"
-#include "CLHEP/Random/RandGeneral.h"
 #include "CLHEP/Units/PhysicalConstants.h"
 
 // Framework includes
@@ -39,6 +38,7 @@
 #include "Mu2eUtilities/inc/MuonCaptureSpectrum.hh"
 #include "Mu2eUtilities/inc/SimpleSpectrum.hh"
 #include "Mu2eUtilities/inc/BinnedSpectrum.hh"
+#include "Mu2eUtilities/inc/RandAlias.hh"
 #include "Mu2eUtilities/inc/Table.hh"
 #include "Mu2eUtilities/inc/RootTreeSampler.hh"
 #include "GeneralUtilities/inc/RSNTIO.hh"
@@ -67,7 +67,7 @@ namespace mu2e {
     art::RandomNumberGenerator::base_engine_t& eng_;
     const double czmax_;
     const double czmin_;
-    CLHEP::RandGeneral*  randSpectrum_;
+    RandAlias*           randSpectrum_;
     RandomUnitSphere     randUnitSphere_;
     RandomUnitSphere     randUnitSphereExt_; //For photons, to limit cosz
     CLHEP::RandFlat      randFlat_;
@@ -151,7 +151,8 @@ namespace mu2e {
     // initialize binned spectrum - this needs to be done right
     parseSpectrumShape(psphys_);
 
-    randSpectrum_ = new CLHEP::RandGeneral(eng_, spectrum_.getPDF(), spectrum_.getNbins());
+    randSpectrum_ = new RandAlias(eng_, spectrum_.getPDF(), spectrum_.getNbins(),
+                                  RandAlias::interpolationFromName(psphys_.get<std::string>("spectrumInterpolation", "flat")));
 
     if ( doHistograms_ ) {
       art::ServiceHandle<art::TFileService> tfs;
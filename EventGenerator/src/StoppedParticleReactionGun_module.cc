@@ -11,7 +11,6 @@
 #include "CLHEP/Vector/ThreeVector.h"
 #include "CLHEP/Vector/LorentzVector.h"
 #include "CLHEP/Random/RandomEngine.h"
-#include "CLHEP/Random/RandGeneral.h"
 #include "CLHEP/Units/PhysicalConstants.h"
 
 #include "art/Framework/Core/EDProducer.h"
@@ -35,6 +34,7 @@
 #include "Mu2eUtilities/inc/SimpleSpectrum.hh"
 #include "Mu2eUtilities/inc/EjectedProtonSpectrum.hh"
 #include "Mu2eUtilities/inc/BinnedSpectrum.hh"
+#include "Mu2eUtilities/inc/RandAlias.hh"
 #include "Mu2eUtilities/inc/Table.hh"
 #include "Mu2eUtilities/inc/RootTreeSampler.hh"
 #include "GeneralUtilities/inc/RSNTIO.hh"
@@ -58,7 +58,7 @@ namespace mu2e {
     int               verbosityLevel_;
 
     art::RandomNumberGenerator::base_engine_t& eng_;
-    CLHEP::RandGeneral randSpectrum_;
+    RandAlias          randSpectrum_;
     RandomUnitSphere   randomUnitSphere_;
 
     RootTreeSampler<IO::StoppedParticleF> stops_;
@@ -93,7 +93,8 @@ namespace mu2e {
     , genId_(GenId::findByName(psphys_.get<std::string>("genId")))
     , verbosityLevel_(pset.get<int>("verbosityLevel", 0))
     , eng_(createEngine(art::ServiceHandle<SeedService>()->getSeed()))
-    , randSpectrum_(eng_, spectrum_.getPDF(), spectrum_.getNbins())
+    , randSpectrum_(eng_, spectrum_.getPDF(), spectrum_.getNbins(),
+                    RandAlias::interpolationFromName(psphys_.get<std::string>("spectrumInterpolation", "flat")))
     , randomUnitSphere_(eng_)
     , stops_(eng_, pset.get<fhicl::ParameterSet>("muonStops"))
     , doHistograms_       (pset.get<bool>("doHistograms",true ) )
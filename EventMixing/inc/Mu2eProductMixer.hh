@@ -28,6 +28,7 @@
 #include "MCDataProducts/inc/GenParticleCollection.hh"
 #include "MCDataProducts/inc/SimParticleCollection.hh"
 #include "MCDataProducts/inc/StepPointMCCollection.hh"
+#include "MCDataProducts/inc/CompactStepPointMC.hh"
 #include "MCDataProducts/inc/CaloShowerStepCollection.hh"
 #include "MCDataProducts/inc/ExtMonFNALSimHitCollection.hh"
 #include "MCDataProducts/inc/ProtonBunchIntensity.hh"
@@ -65,6 +66,8 @@ namespace mu2e {
       fhicl::Table<CollectionMixerConfig> genParticleMixer { fhicl::Name("genParticleMixer") };
       fhicl::Table<CollectionMixerConfig> simParticleMixer { fhicl::Name("simParticleMixer") };
       fhicl::Table<CollectionMixerConfig> stepPointMCMixer { fhicl::Name("stepPointMCMixer") };
+      // Compact inputs are expanded into ordinary StepPointMCCollections
+      fhicl::Table<CollectionMixerConfig> compactStepPointMCMixer { fhicl::Name("compactStepPointMCMixer") };
       fhicl::Table<CollectionMixerConfig> caloShowerStepMixer { fhicl::Name("caloShowerStepMixer") };
       fhicl::Table<CollectionMixerConfig> extMonSimHitMixer { fhicl::Name("extMonSimHitMixer") };
       fhicl::Table<CollectionMixerConfig> protonBunchIntensityMixer { fhicl::Name("protonBunchIntensityMixer") };
@@ -87,6 +90,10 @@ namespace mu2e {
                          StepPointMCCollection& out,
                          art::PtrRemapper const& remap);
 
+    bool mixCompactStepPointMCs(std::vector<CompactStepPointMCCollection const*> const& in,
+                                StepPointMCCollection& out,
+                                art::PtrRemapper const& remap);
+
     bool mixCaloShowerSteps(std::vector<CaloShowerStepCollection const*> const& in,
                             CaloShowerStepCollection& out,
                             art::PtrRemapper const& remap);
@@ -58,6 +58,11 @@ namespace mu2e {
         (e.inTag, e.resolvedInstanceName(), &Mu2eProductMixer::mixStepPointMCs, *this);
     }
 
+    for(const auto& e: conf.compactStepPointMCMixer().mixingMap()) {
+      helper.declareMixOp
+        (e.inTag, e.resolvedInstanceName(), &Mu2eProductMixer::mixCompactStepPointMCs, *this);
+    }
+
     for(const auto& e: conf.caloShowerStepMixer().mixingMap()) {
       helper.declareMixOp
         (e.inTag, e.resolvedInstanceName(), &Mu2eProductMixer::mixCaloShowerSteps, *this);
@@ -152,6 +157,31 @@ namespace mu2e {
     return true;
   }
 
+  //----------------------------------------------------------------
+  // Same as mixStepPointMCs(), but each input step is expanded into the
+  // full class on the way so that downstream modules see no difference.
+  bool Mu2eProductMixer::mixCompactStepPointMCs(std::vector<CompactStepPointMCCollection const*> const& in,
+                                                StepPointMCCollection& out,
+                                                art::PtrRemapper const& remap)
+  {
+    std::size_t nsteps(0);
+    for(const auto* col: in) {
+      nsteps += col->size();
+    }
+    out.reserve(out.size() + nsteps);
+
+    for(std::size_t ie=0; ie<in.size(); ++ie) {
+      const auto simOffset = simOffsets_[ie];
+      for(const auto& cstep: *in[ie]) {
+        out.emplace_back(cstep.toStepPointMC());
+        auto& step = out.back();
+        step.simParticle() = remap(step.simParticle(), simOffset);
+      }
+    }
+
+    return true;
+  }
+
   //----------------------------------------------------------------
   bool Mu2eProductMixer::mixCaloShowerSteps(std::vector<CaloShowerStepCollection const*> const& in,
                                             CaloShowerStepCollection& out,
@@ -5,7 +5,7 @@
 
 #include <ostream>
 #include <map>
-#include <queue>
+#include <vector>
 
 #include "canvas/Persistency/Common/Ptr.h"
 
@@ -17,30 +17,85 @@ namespace mu2e {
 
   namespace ExtMonFNAL {
 
+    class ExtMon;
+
     struct PixelTimedChargeDeposit {
       double time;
       double charge;
-      art::Ptr<SimParticle> particle;
+      unsigned pixel;    // index in the list of hit pixels
+      unsigned particle; // index in the particle table
 
-      PixelTimedChargeDeposit(double t, double c, const art::Ptr<SimParticle>& p)
-        : time(t), charge(c), particle(p)
+      PixelTimedChargeDeposit(double t, double c, unsigned pix, unsigned p)
+        : time(t), charge(c), pixel(pix), particle(p)
       {}
+    };
+
+    std::ostream& operator<<(std::ostream& os, const PixelTimedChargeDeposit& dep);
+
+    //================================================================
+    // Charge deposits of an event in all the hit pixels.
+    //
+    // Pixels are looked up in a dense buffer over the whole detector,
+    // numbered in ExtMonFNALPixelId order, which is reset through the
+    // list of hit pixels.  Contributing particles are stored once, in a
+    // table, and deposits refer to them by index.  After sort() the
+    // deposits of hit pixel i are [begin(i), end(i)) in time order, and
+    // the hit pixels are in ExtMonFNALPixelId order.
+    class PixelChargeCollection {
+    public:
+
+      // Sizes the pixel buffer
+      void setGeometry(const ExtMon& extmon);
+
+      void clear();
+
+      unsigned particleIndex(const art::Ptr<SimParticle>& particle);
+      const art::Ptr<SimParticle>& particle(unsigned i) const { return particles_[i]; }
+      unsigned numParticles() const { return particles_.size(); }
+
+      void addCharge(const ExtMonFNALPixelId& pix, double time, double charge, unsigned particle);
 
-      // We accumulated deposits in a priority_queue, and want earlier times
-      // to come out first.  Thus the inverted less-than definition:
-      bool operator<(const PixelTimedChargeDeposit& b) const {
-        return b.time < this->time;
+      // Another deposit in hit pixel i
+      void addCharge(unsigned i, double time, double charge, unsigned particle) {
+        deposits_.push_back(PixelTimedChargeDeposit(time, charge, i, particle));
       }
-    };
 
-    std::ostream& operator<<(std::ostream& os, const PixelTimedChargeDeposit& dep) {
-      return os<<"PTD("<<dep.time<<", "<<dep.charge<<", "<<dep.particle<<")";
-    }
+      void sort();
+
+      unsigned numPixels() const { return pixels_.size(); }
+      const ExtMonFNALPixelId& pixelId(unsigned i) const { return pixels_[i]; }
+
+      std::vector<PixelTimedChargeDeposit>& deposits() { return deposits_; }
+      const std::vector<PixelTimedChargeDeposit>& deposits() const { return deposits_; }
+      unsigned begin(unsigned i) const { return begin_[i]; }
+      unsigned end(unsigned i) const { return begin_[i+1]; }
+
+    private:
+      unsigned denseNumber(const ExtMonFNALPixelId& pix) const;
 
-    // Queue ordered by time
-    typedef std::priority_queue<PixelTimedChargeDeposit> PixelChargeHistory;
+      // geometry
+      std::vector<unsigned> planeModuleOffset_;
+      unsigned nxChips_ = 0;
+      unsigned nChipsPerModule_ = 0;
+      unsigned nColumns_ = 0;
+      unsigned nPixelsPerChip_ = 0;
 
-    typedef std::map<ExtMonFNALPixelId,PixelChargeHistory> PixelChargeCollection;
+      // dense pixel number => index in pixels_, or -1u
+      std::vector<unsigned> slot_;
+
+      std::vector<ExtMonFNALPixelId> pixels_;
+      std::vector<unsigned> dense_;
+      std::vector<unsigned> begin_;
+      std::vector<PixelTimedChargeDeposit> deposits_;
+
+      std::vector<art::Ptr<SimParticle> > particles_;
+      std::map<art::Ptr<SimParticle>, unsigned> particleIndex_;
+
+      // work space for sort()
+      std::vector<unsigned> order_;
+      std::vector<unsigned> rank_;
+      std::vector<PixelTimedChargeDeposit> sorted_;
+    };
 
   } // namespace ExtMonFNAL
 } // namespace mu2e
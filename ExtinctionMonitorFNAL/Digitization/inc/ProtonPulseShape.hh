@@ -8,6 +8,7 @@
 
 #include <string>
 #include <map>
+#include <vector>
 
 #include "CLHEP/Random/RandFlat.h"
 
@@ -65,7 +66,9 @@ namespace mu2e {
       double pulseHalfWidth_;
       bool messagePrinted_;
 
-      void apply(PixelChargeHistory *inout, const SimParticleParentGetter& pg, const art::Event& event);
+      // work space: time shift per particle of the charge collection
+      std::vector<double> shifts_;
+      std::vector<bool> shiftKnown_;
 
       double getTimeShiftForPrimary(const art::Ptr<SimParticle>& particle,
                                     const SimParticleParentGetter& pg,
@@ -81,6 +84,7 @@ namespace mu2e {
       ProtonPulseShape(const fhicl::ParameterSet& pset,
                        art::RandomNumberGenerator::base_engine_t& rng);
 
+      // Shifts the times of sorted deposits, and sorts them again
       void apply(PixelChargeCollection *inout, const art::Event& event);
     };
 
@@ -6,7 +6,7 @@
 #include <string>
 #include <cmath>
 #include <memory>
-#include <queue>
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 
@@ -58,21 +58,20 @@ namespace mu2e {
   namespace ExtMonFNAL {
 
     struct VerilogHit {
+      int bx;
       int pixelAddress;
       double twalk;
       double tot;
-      VerilogHit(int p, double tw, double width) : pixelAddress(p), twalk(tw), tot(width) {}
+      VerilogHit(int b, int p, double tw, double width) : bx(b), pixelAddress(p), twalk(tw), tot(width) {}
     };
 
-    struct VerilogHitAddrCmp {
+    struct VerilogHitBXAddrCmp {
       bool operator()(const VerilogHit& a, const VerilogHit& b) {
-        return a.pixelAddress < b.pixelAddress;
+        return (a.bx < b.bx) || ((a.bx == b.bx) && (a.pixelAddress < b.pixelAddress));
       }
     };
 
     typedef std::vector<VerilogHit>  VerilogHitCollection;
-    // BX => hits
-    typedef std::map<int, VerilogHitCollection>  VerilogHitMap;
 
     //================================================================
     class ExtMonFNALHitMaker : public art::EDProducer {
@@ -205,6 +204,13 @@ namespace mu2e {
 
       std::vector<double> planeTOFCorrection_;
 
+      // Reused between events
+      PixelChargeCollection pixcharges_;
+
+      // Truth of the hit being formed: particle index, charge
+      typedef std::vector<std::pair<unsigned, double> > ChargeContributions;
+      ChargeContributions parts_;
+
       void collectIonization(PixelChargeCollection *pixcharges,
                              const ExtMonFNALSimHitCollection& simhits);
 
@@ -217,25 +223,23 @@ namespace mu2e {
                      double charge,
                      double x_ro,
                      double y_ro,
-                     const art::Ptr<SimParticle>& particle);
+                     unsigned particle);
 
       void foldHitTimes(PixelChargeCollection *inout);
-      void foldHitTimes(PixelChargeHistory *inout);
 
-      // The input pixcharges collection gets eaten by this call
       void discriminate(ExtMonFNALRawHitCollection *outhits,
                         ExtMonFNALHitTruthAssn *outtruth,
                         art::ProductID outhitsPID,
                         const art::EDProductGetter* outhitsGetter,
-                        PixelChargeCollection& pixcharges);
+                        const PixelChargeCollection& pixcharges);
 
-      // The input PixelChargeHistory gets eaten by this call
+      // Deposits of hit pixel ipix of the sorted collection
       void discriminate(ExtMonFNALRawHitCollection *outhits,
                         ExtMonFNALHitTruthAssn *outtruth,
                         art::ProductID outhitsPID,
                         const art::EDProductGetter* outhitsGetter,
-                        const ExtMonFNALPixelId& pix,
-                        PixelChargeHistory& ch);
+                        const PixelChargeCollection& pixcharges,
+                        unsigned ipix);
 
       double hitTime_ns(unsigned iplane, double time) const {
         return (time - t0_ - planeTOFCorrection_[iplane]);
@@ -266,7 +270,17 @@ namespace mu2e {
       std::unique_ptr<std::ostream> chipSimFile_;
       ExtMonFNALChipId chipSimChipId_; // write out info for this single chip
       int chipSimProtonPulseNumber_;
-      VerilogHitMap vlhm_;
+      VerilogHitCollection vlhits_;
+
+      void addContribution(const PixelTimedChargeDeposit& dep) {
+        for(auto& p : parts_) {
+          if(p.first == dep.particle) {
+            p.second += dep.charge;
+            return;
+          }
+        }
+        parts_.push_back(std::make_pair(dep.particle, dep.charge));
+      }
 
       void addVerilogHit(const ExtMonFNALPixelId& pix, double tstart, double tend);
       void writeOutVerilogHits();
@@ -303,6 +317,8 @@ namespace mu2e {
         }
       }
 
+      pixcharges_.setGeometry(*extMon_);
+
       ConditionsHandle<ExtMonFNALConditions> cond("ignored");
       condExtMon_ = &*cond;
 
@@ -338,26 +354,26 @@ namespace mu2e {
 
       chipSimProtonPulseNumber_ = event.event();
 
-      // N.B.: to reduce memory footprint we can digitize one readout chip at a time
-      // instead of doing the whole detector in one go.  Would be an extra loop here.
-      PixelChargeCollection pixcharges;
-      collectIonization(&pixcharges, simhits);
+      // Only the hit pixels are visited, the cost does not depend on the detector size.
+      pixcharges_.clear();
+      collectIonization(&pixcharges_, simhits);
+      pixcharges_.sort();
 
       if(applyProtonPulseShape_) {
-        protonPulse_->apply(&pixcharges, event);
+        protonPulse_->apply(&pixcharges_, event);
       }
 
       // Brings all times onto a microbunch + margins on both sides.
       // Hits near microbunch boundaries are duplicated.
-      foldHitTimes(&pixcharges);
+      foldHitTimes(&pixcharges_);
 
       const art::ProductID hitsPID = event.getProductID<ExtMonFNALRawHitCollection>();
       const art::EDProductGetter *hitsGetter = event.productGetter(hitsPID);
-      discriminate(&*outHits, &*outTruth, hitsPID, hitsGetter, pixcharges);
+      discriminate(&*outHits, &*outTruth, hitsPID, hitsGetter, pixcharges_);
 
       if(chipSimInputsMode_) {
         writeOutVerilogHits();
-        vlhm_.clear();
+        vlhits_.clear();
       }
 
       noise_.add(&*outHits);
@@ -396,6 +412,8 @@ namespace mu2e {
 
       const double clusterCharge = totalCharge/nclusters_;
 
+      const unsigned particle = pixcharges->particleIndex(hit.simParticle());
+
       if(clusterCharge > 0) { // there are occasional energy deposits corresponding to < 1 pair, which can fluctuate to <0
         for(unsigned icluster=0; icluster<nclusters_; ++icluster) {
           const CLHEP::Hep3Vector pos = icluster*step + hit.localStartPosition();
@@ -416,7 +434,7 @@ namespace mu2e {
           // from the pixel vicinity.  Roughly account for this by adding driftTime.
           const double time = hit.startTime() + icluster*tstep + driftTime;
 
-          addCharge(pixcharges, hit.moduleId(), time, clusterCharge, x_ro, y_ro, hit.simParticle());
+          addCharge(pixcharges, hit.moduleId(), time, clusterCharge, x_ro, y_ro, particle);
         }
       }
     }
@@ -428,24 +446,16 @@ namespace mu2e {
                                         double charge,
                                         double x_ro,
                                         double y_ro,
-                                        const art::Ptr<SimParticle>& particle)
+                                        unsigned particle)
     {
       ExtMonFNALPixelId pix = extMon_->module().findPixel(mid, x_ro, y_ro);
       if(pix != ExtMonFNALPixelId()) {
-        (*pixcharges)[pix]
-          .push(PixelTimedChargeDeposit(time, charge, particle));
+        pixcharges->addCharge(pix, time, charge, particle);
       }
     }
 
     //================================================================
     void ExtMonFNALHitMaker::foldHitTimes(PixelChargeCollection* inout) {
-      for(PixelChargeCollection::iterator i=inout->begin(); i!=inout->end(); ++i) {
-        foldHitTimes(&i->second);
-      }
-    }
-
-    //================================================================
-    void ExtMonFNALHitMaker::foldHitTimes(PixelChargeHistory* inout) {
       // Here we bring hits from (-infty, +infty) to
       // (-margin, deBuncherPeriod + margin)
       //
@@ -462,32 +472,26 @@ namespace mu2e {
       // maxToT + max time of flight correction should be enough.
 
 
-      PixelChargeHistory& in(*inout);
-      PixelChargeHistory out;
-
       const double period = condAcc_->deBuncherPeriod;
       const double margin = maxToT_ * condExtMon_->clockTick();
 
-      while(!in.empty()) {
-        PixelTimedChargeDeposit dep = in.top();
+      std::vector<PixelTimedChargeDeposit>& deps = inout->deposits();
+      const unsigned ndeps = deps.size();
+      for(unsigned i=0; i<ndeps; ++i) {
         // A hit on [0, period]
-        dep.time = remainder(dep.time - period/2, period) + period/2;
-        out.push(dep);
+        const double time = remainder(deps[i].time - period/2, period) + period/2;
+        deps[i].time = time;
 
         // duplicate hits near the boundaries
-        if(dep.time < margin) {
-          dep.time = dep.time + period;
-          out.push(dep);
+        if(time < margin) {
+          inout->addCharge(deps[i].pixel, time + period, deps[i].charge, deps[i].particle);
         }
-        else if(period - dep.time < margin) {
-          dep.time = dep.time - period;
-          out.push(dep);
+        else if(period - time < margin) {
+          inout->addCharge(deps[i].pixel, time - period, deps[i].charge, deps[i].particle);
         }
-
-        in.pop();
       }
 
-      *inout = out;
+      inout->sort();
     }
 
     //================================================================
@@ -495,10 +499,10 @@ namespace mu2e {
                                           ExtMonFNALHitTruthAssn *outtruth,
                                           art::ProductID hitsPID,
                                           const art::EDProductGetter *hitsGetter,
-                                          PixelChargeCollection& pixcharges)
+                                          const PixelChargeCollection& pixcharges)
     {
-      for(PixelChargeCollection::iterator i=pixcharges.begin(); i!=pixcharges.end(); ++i) {
-        discriminate(outhits, outtruth, hitsPID, hitsGetter, i->first, i->second);
+      for(unsigned i=0; i<pixcharges.numPixels(); ++i) {
+        discriminate(outhits, outtruth, hitsPID, hitsGetter, pixcharges, i);
       }
     }
 
@@ -507,20 +511,26 @@ namespace mu2e {
                                           ExtMonFNALHitTruthAssn *outtruth,
                                           art::ProductID hitsPID,
                                           const art::EDProductGetter *hitsGetter,
-                                          const ExtMonFNALPixelId& pix,
-                                          PixelChargeHistory& ch)
+                                          const PixelChargeCollection& pixcharges,
+                                          unsigned ipix)
     {
       PixelToTCircuit cap(discriminatorThreshold_, qCalib_, totCalib_, condExtMon_->clockTick());
+      const ExtMonFNALPixelId& pix = pixcharges.pixelId(ipix);
       const unsigned iplane = pix.chip().module().plane();
 
-      double t = ch.top().time;
+      // time ordered deposits of the pixel
+      const std::vector<PixelTimedChargeDeposit>& deps = pixcharges.deposits();
+      unsigned next = pixcharges.begin(ipix);
+      const unsigned end = pixcharges.end(ipix);
 
-      while(!ch.empty()) {
+      double t = deps[next].time;
 
-        cap.wait(ch.top().time - t);
-        t = ch.top().time;
+      while(next != end) {
 
-        cap.addCharge(ch.top().charge);
+        cap.wait(deps[next].time - t);
+        t = deps[next].time;
+
+        cap.addCharge(deps[next].charge);
 
         //----------------------------------------------------------------
         if(cap.high()) { // Found LE
@@ -529,24 +539,23 @@ namespace mu2e {
           const int roStartTime = timeStamp(hitStart_ns);
 
           // add to the set of SimParticles
-          typedef std::map<art::Ptr<SimParticle>, double> ChargeMap;
-          ChargeMap parts;
-          parts[ch.top().particle] += ch.top().charge;
+          parts_.clear();
+          addContribution(deps[next]);
 
-          ch.pop();
+          ++next;
 
           //----------------------------------------------------------------
           // Merge charges that go in the same hit
 
-          while(!ch.empty() && (timeStamp(iplane, ch.top().time) <= timeStamp(iplane, t + cap.computeTrailingEdge()))) {
+          while((next != end) && (timeStamp(iplane, deps[next].time) <= timeStamp(iplane, t + cap.computeTrailingEdge()))) {
 
-            cap.wait(ch.top().time - t);
-            t = ch.top().time;
+            cap.wait(deps[next].time - t);
+            t = deps[next].time;
 
-            cap.addCharge(ch.top().charge);
-            parts[ch.top().particle] += ch.top().charge;
+            cap.addCharge(deps[next].charge);
+            addContribution(deps[next]);
 
-            ch.pop();
+            ++next;
           }
 
           //----------------------------------------------------------------
@@ -577,10 +586,15 @@ namespace mu2e {
             if(!cutClockEnabled_ || cutClockPassed(roStartTime)) {
               outhits->push_back(ExtMonFNALRawHit(pix, roStartTime, roToT));
 
-              // Record hit truth
-              for(ChargeMap::const_iterator t = parts.begin(); t != parts.end(); ++t) {
+              // Record hit truth, ordered by SimParticle
+              std::sort(parts_.begin(), parts_.end(),
+                        [&pixcharges](const ChargeContributions::value_type& a, const ChargeContributions::value_type& b) {
+                          return pixcharges.particle(a.first) < pixcharges.particle(b.first);
+                        });
+
+              for(ChargeContributions::const_iterator t = parts_.begin(); t != parts_.end(); ++t) {
 
-                outtruth->addSingle(t->first,
+                outtruth->addSingle(pixcharges.particle(t->first),
 
                                     art::Ptr<ExtMonFNALRawHit>(hitsPID,
                                                                outhits->size()-1,
@@ -596,7 +610,7 @@ namespace mu2e {
         }
         //----------------------------------------------------------------
         else {  // did not exceed the threshold, go on to the next charge
-          ch.pop();
+          ++next;
         }
       } // while(!empty)
 
@@ -631,7 +645,7 @@ namespace mu2e {
 
         const int pixelAddress = 336 * pix.col() + pix.row();
 
-        vlhm_[bx].push_back(VerilogHit(pixelAddress, twalk, tot));
+        vlhits_.push_back(VerilogHit(bx, pixelAddress, twalk, tot));
       }
     }
 
@@ -640,26 +654,24 @@ namespace mu2e {
 
       // The OVM input script wants to have a line for each clock tick
       // Therefore we do a fixed-size loop here and write out a lot of emtpy events.
+      // The hits, sorted by clock, are consumed as the loop goes.
+      std::stable_sort(vlhits_.begin(), vlhits_.end(), VerilogHitBXAddrCmp());
+      VerilogHitCollection::const_iterator i = vlhits_.begin();
+
       for(int localClock = 0; localClock < condExtMon_->numClockTicksPerDebuncherPeriod(); ++localClock) {
 
         const int ibx =  localClock + condExtMon_->numClockTicksPerDebuncherPeriod() * (chipSimProtonPulseNumber_ - 1);
 
         *chipSimFile_ <<"BX "<<ibx<<std::endl;
 
-        VerilogHitMap::const_iterator pd = vlhm_.find(ibx);
-        if(pd != vlhm_.end()) {
-
-          //NB: here we make a copy to apply non-const sort
-          VerilogHitCollection coll(pd->second);
-          std::sort(coll.begin(), coll.end(), VerilogHitAddrCmp());
-          for(VerilogHitCollection::const_iterator i = coll.begin(); i != coll.end(); ++i) {
-            *chipSimFile_<<i->pixelAddress
-                         <<"\t"
-                         <<std::fixed<<std::setprecision(0)
-                         <<i->twalk
-                         <<"\t"<<i->tot
-                         <<std::endl;
-          }
+        for(; (i != vlhits_.end()) && (i->bx <= ibx); ++i) {
+          if(i->bx < ibx) continue;
+          *chipSimFile_<<i->pixelAddress
+                       <<"\t"
+                       <<std::fixed<<std::setprecision(0)
+                       <<i->twalk
+                       <<"\t"<<i->tot
+                       <<std::endl;
         }
       }
     }
@@ -0,0 +1,132 @@
+// Charge deposits of an event in the hit pixels.
+//
+// Andrei Gaponenko, 2012
+
+#include "ExtinctionMonitorFNAL/Digitization/inc/PixelCharge.hh"
+
+#include <algorithm>
+
+#include "ExtinctionMonitorFNAL/Geometry/inc/ExtMonFNAL.hh"
+
+namespace mu2e {
+  namespace ExtMonFNAL {
+
+    //================================================================
+    std::ostream& operator<<(std::ostream& os, const PixelTimedChargeDeposit& dep) {
+      return os<<"PTD("<<dep.time<<", "<<dep.charge<<", "<<dep.pixel<<", "<<dep.particle<<")";
+    }
+
+    //================================================================
+    void PixelChargeCollection::setGeometry(const ExtMon& extmon) {
+      clear();
+
+      planeModuleOffset_.resize(extmon.nplanes());
+      unsigned nmodules = 0;
+      for(unsigned i=0; i<extmon.nplanes(); ++i) {
+        planeModuleOffset_[i] = nmodules;
+        nmodules += extmon.plane(i).nModules();
+      }
+
+      nxChips_ = extmon.module().nxChips();
+      nChipsPerModule_ = extmon.module().nxChips() * extmon.module().nyChips();
+      nColumns_ = extmon.chip().nColumns();
+      nPixelsPerChip_ = extmon.chip().nPixels();
+
+      slot_.assign(nmodules * nChipsPerModule_ * nPixelsPerChip_, -1u);
+    }
+
+    //================================================================
+    void PixelChargeCollection::clear() {
+      for(unsigned d : dense_) {
+        slot_[d] = -1u;
+      }
+      pixels_.clear();
+      dense_.clear();
+      begin_.clear();
+      deposits_.clear();
+      particles_.clear();
+      particleIndex_.clear();
+    }
+
+    //================================================================
+    // Ordered as ExtMonFNALPixelId: module, chip row, chip column, row, column
+    unsigned PixelChargeCollection::denseNumber(const ExtMonFNALPixelId& pix) const {
+      const unsigned module = planeModuleOffset_[pix.chip().module().plane()] + pix.chip().module().number();
+      const unsigned chip = module * nChipsPerModule_ + pix.chip().chipRow() * nxChips_ + pix.chip().chipCol();
+      return chip * nPixelsPerChip_ + pix.row() * nColumns_ + pix.col();
+    }
+
+    //================================================================
+    unsigned PixelChargeCollection::particleIndex(const art::Ptr<SimParticle>& particle) {
+      // consecutive hits usually come from the same particle
+      if(!particles_.empty() && (particles_.back() == particle)) {
+        return particles_.size() - 1;
+      }
+      auto res = particleIndex_.insert(std::make_pair(particle, unsigned(particles_.size())));
+      if(res.second) {
+        particles_.push_back(particle);
+      }
+      return res.first->second;
+    }
+
+    //================================================================
+    void PixelChargeCollection::addCharge(const ExtMonFNALPixelId& pix,
+                                          double time,
+                                          double charge,
+                                          unsigned particle)
+    {
+      const unsigned d = denseNumber(pix);
+      if(slot_[d] == -1u) {
+        slot_[d] = pixels_.size();
+        pixels_.push_back(pix);
+        dense_.push_back(d);
+      }
+      addCharge(slot_[d], time, charge, particle);
+    }
+
+    //================================================================
+    void PixelChargeCollection::sort() {
+      const unsigned npix = pixels_.size();
+
+      // hit pixels in the dense number order
+      order_.resize(npix);
+      for(unsigned i=0; i<npix; ++i) order_[i] = i;
+      std::sort(order_.begin(), order_.end(), [this](unsigned a, unsigned b) { return dense_[a] < dense_[b]; });
+
+      rank_.resize(npix);
+      for(unsigned i=0; i<npix; ++i) rank_[order_[i]] = i;
+
+      std::vector<ExtMonFNALPixelId> pixels(npix);
+      std::vector<unsigned> dense(npix);
+      for(unsigned i=0; i<npix; ++i) {
+        pixels[i] = pixels_[order_[i]];
+        dense[i] = dense_[order_[i]];
+        slot_[dense[i]] = i;
+      }
+      pixels_.swap(pixels);
+      dense_.swap(dense);
+
+      // group the deposits by pixel, keeping their order, then order them in time
+      begin_.assign(npix+1, 0);
+      for(auto& dep : deposits_) {
+        dep.pixel = rank_[dep.pixel];
+        ++begin_[dep.pixel+1];
+      }
+      for(unsigned i=0; i<npix; ++i) begin_[i+1] += begin_[i];
+
+      order_.assign(begin_.begin(), begin_.end() - 1);
+      sorted_.clear();
+      sorted_.resize(deposits_.size(), PixelTimedChargeDeposit(0., 0., 0, 0));
+      for(const auto& dep : deposits_) {
+        sorted_[order_[dep.pixel]++] = dep;
+      }
+      deposits_.swap(sorted_);
+
+      for(unsigned i=0; i<npix; ++i) {
+        std::stable_sort(deposits_.begin() + begin_[i], deposits_.begin() + begin_[i+1],
+                         [](const PixelTimedChargeDeposit& a, const PixelTimedChargeDeposit& b) { return a.time < b.time; });
+      }
+    }
+
+  } // namespace ExtMonFNAL
+} // namespace mu2e
@@ -53,28 +53,21 @@ namespace mu2e {
                  <<", pulseHalfWidth="<<pulseHalfWidth_<<std::endl;
       }
 
-      for(PixelChargeCollection::iterator i=inout->begin(); i!=inout->end(); ++i) {
-        apply(&i->second, pg, event);
-      }
-    }
-
-    //================================================================
-    void ProtonPulseShape::apply(PixelChargeHistory *inout,
-                                 const SimParticleParentGetter& pg,
-                                 const art::Event& event) {
-
-      PixelChargeHistory& in(*inout);
-      PixelChargeHistory out;
-      while(!in.empty()) {
-        PixelTimedChargeDeposit dep = in.top();
-
-        dep.time += getTimeShiftForPrimary(dep.particle, pg, event);
-
-        out.push(dep);
-        in.pop();
+      // The shift depends only on the particle.  Deposits are visited in
+      // pixel and time order, so offsets of new primaries are generated
+      // in the same order as when every deposit looked up its primary.
+      shifts_.assign(inout->numParticles(), 0.);
+      shiftKnown_.assign(inout->numParticles(), false);
+
+      for(auto& dep : inout->deposits()) {
+        if(!shiftKnown_[dep.particle]) {
+          shifts_[dep.particle] = getTimeShiftForPrimary(inout->particle(dep.particle), pg, event);
+          shiftKnown_[dep.particle] = true;
+        }
+        dep.time += shifts_[dep.particle];
       }
 
-      *inout = out;
+      inout->sort();
     }
 
     //================================================================
@@ -0,0 +1,47 @@
+// Look up the reco clusters of a plane stack inside a clock and
+// position window.  Each plane is stored as flat arrays sorted by
+// (clock, x), so a query costs a binary search per clock value in the
+// window plus the clusters in the x strip.
+//
+
+#ifndef ExtinctionMonitorFNAL_Reconstruction_ClusterWindowLookup_hh
+#define ExtinctionMonitorFNAL_Reconstruction_ClusterWindowLookup_hh
+
+#include <vector>
+
+namespace mu2e {
+
+  class ExtMonFNALRecoClusterCollection;
+
+  namespace ExtMonFNAL {
+
+    class ClusterWindowLookup {
+    public:
+
+      // Index the planes [firstPlane, firstPlane+nplanes) of the collection.
+      // The collection must stay available while the lookup is in use.
+      ClusterWindowLookup(const ExtMonFNALRecoClusterCollection& coll, unsigned firstPlane, unsigned nplanes);
+
+      // Appends to res the in-plane indices of the clusters of stack
+      // plane stackPlane with clockMin <= clock <= clockMax and
+      // position inside the closed box, in increasing order.
+      void find(std::vector<unsigned> *res, unsigned stackPlane,
+                int clockMin, int clockMax,
+                double xmin, double xmax, double ymin, double ymax) const;
+
+    private:
+      struct Entry {
+        int clock;
+        double x;
+        double y;
+        unsigned index; // in-plane cluster index
+      };
+      // entries of stack plane i are [begin_[i], begin_[i+1])
+      std::vector<Entry> entries_;
+      std::vector<unsigned> begin_;
+    };
+
+  } // namespace ExtMonFNAL
+} // namespace mu2e
+
+#endif/*ExtinctionMonitorFNAL_Reconstruction_ClusterWindowLookup_hh*/
@@ -0,0 +1,143 @@
+// Find straight line tracklets in one ExtMonFNAL plane stack.
+//
+// Seeds are cluster pairs in the first and last planes of the stack
+// (with maxMissedHits>0 the seed planes move inwards); the clusters in
+// the remaining planes compatible with the line through the seed are
+// added.  The road for each (seed planes, plane) configuration depends
+// only on the stack geometry and the search parameters and is computed
+// once.  With useRoads the seed partners and the added clusters are
+// fetched from a ClusterWindowLookup by clock and position window,
+// instead of looping over all the clusters of a plane.
+//
+// Factored out of EMFPatRecFromTracklets.
+
+#ifndef ExtinctionMonitorFNAL_Reconstruction_TrackletFinder_hh
+#define ExtinctionMonitorFNAL_Reconstruction_TrackletFinder_hh
+
+#include <vector>
+
+namespace mu2e {
+
+  class ExtMonFNALRecoCluster;
+  class ExtMonFNALRecoClusterCollection;
+  class ExtMonFNALPlaneStack;
+  class ExtMonFNALPixelChip;
+
+  namespace ExtMonFNAL {
+
+    class ClusterWindowLookup;
+
+    //================================================================
+    struct TrackletSearchPars {
+      int clusterClockTolerance;
+      double slopexmax;
+      double slopeymax;
+      double stackScatterAngleTolerance;
+      double alignmentToleranceX;
+      double alignmentToleranceY;
+      unsigned maxMissedHits;
+      bool useRoads;
+    };
+
+    //================================================================
+    // Cluster combinations, flat: one row of nplanes in-plane cluster
+    // indices (-1u for no cluster) per tracklet, stack plane numbering.
+    class TrackletCombinations {
+    public:
+      unsigned nplanes() const { return nplanes_; }
+      unsigned size() const { return seedConfig_.size(); }
+      const unsigned *row(unsigned i) const { return &rows_[i*nplanes_]; }
+      // the seed configuration the tracklet was found with
+      unsigned seedConfig(unsigned i) const { return seedConfig_[i]; }
+
+    private:
+      friend class TrackletFinder;
+      unsigned nplanes_ = 0;
+      std::vector<unsigned> rows_;
+      std::vector<unsigned> seedConfig_;
+    };
+
+    //================================================================
+    class TrackletFinder {
+    public:
+
+      // Optional hooks for the diagnostic histograms of the module
+      class Observer {
+      public:
+        virtual ~Observer() {}
+        // clock difference of the two clusters of a tested seed pair
+        virtual void seedClockDiff(int) {}
+        // clock difference between a seed cluster and a tested cluster
+        virtual void clusterClockDiff(int) {}
+        // position of an in-time tested cluster relative to the road
+        virtual void clusterInRoad(unsigned /*globalPlane*/, double /*dx*/, double /*dy*/,
+                                   double /*dxmax*/, double /*dymax*/) {}
+      };
+
+      TrackletFinder(const std::vector<double>& planeZ,
+                     unsigned planeNumberOffset,
+                     double xPitch,
+                     double yPitch,
+                     const TrackletSearchPars& pars);
+
+      TrackletFinder(const ExtMonFNALPlaneStack& stack,
+                     const ExtMonFNALPixelChip& chip,
+                     const TrackletSearchPars& pars);
+
+      unsigned nplanes() const { return planeZ_.size(); }
+      unsigned planeNumberOffset() const { return planeNumberOffset_; }
+      const TrackletSearchPars& pars() const { return pars_; }
+
+      // seed planes and the planes to add for a seed configuration
+      unsigned seedPlane(unsigned seedConfig) const { return seeds_[seedConfig].seedPlane; }
+      unsigned backPlane(unsigned seedConfig) const { return seeds_[seedConfig].backPlane; }
+      unsigned numAdditionalPlanes() const { return planeZ_.size() - 2; }
+      unsigned additionalPlane(unsigned seedConfig, unsigned i) const { return seeds_[seedConfig].roads[i].plane; }
+
+      void find(TrackletCombinations *res,
+                const ExtMonFNALRecoClusterCollection& coll,
+                Observer *obs = nullptr) const;
+
+    private:
+      // Tolerances on the line interpolated between the seed clusters,
+      // without the cluster size terms
+      struct Road {
+        unsigned plane;
+        double planeZ;
+        double dxtol1, dxtol2;
+        double dytol1, dytol2;
+      };
+      struct SeedConfig {
+        unsigned seedPlane;
+        unsigned backPlane;
+        std::vector<Road> roads;
+      };
+
+      void init();
+
+      void findCompatibleClusterIndices(std::vector<unsigned> *res,
+                                        const ExtMonFNALRecoCluster& c1,
+                                        const ExtMonFNALRecoCluster& c2,
+                                        const ExtMonFNALRecoClusterCollection& coll,
+                                        const ClusterWindowLookup *lookup,
+                                        const Road& road,
+                                        Observer *obs) const;
+
+      bool inTime(const ExtMonFNALRecoCluster& c1, const ExtMonFNALRecoCluster& c2, Observer *obs) const;
+
+      std::vector<double> planeZ_;
+      unsigned planeNumberOffset_;
+      double xPitch_;
+      double yPitch_;
+      TrackletSearchPars pars_;
+
+      // seed pair window
+      double dxmax_;
+      double dymax_;
+      std::vector<SeedConfig> seeds_;
+    };
+
+  } // namespace ExtMonFNAL
+} // namespace mu2e
+
+#endif/*ExtinctionMonitorFNAL_Reconstruction_TrackletFinder_hh*/
@@ -0,0 +1,55 @@
+// Look up the reco clusters of a plane stack inside a clock and position window.
+//
+
+#include "ExtinctionMonitorFNAL/Reconstruction/inc/ClusterWindowLookup.hh"
+
+#include <algorithm>
+
+#include "RecoDataProducts/inc/ExtMonFNALRecoClusterCollection.hh"
+
+namespace mu2e {
+  namespace ExtMonFNAL {
+
+    ClusterWindowLookup::ClusterWindowLookup(const ExtMonFNALRecoClusterCollection& coll,
+                                             unsigned firstPlane, unsigned nplanes)
+      : begin_(nplanes+1, 0)
+    {
+      for(unsigned plane=0; plane<nplanes; ++plane) {
+        const ExtMonFNALRecoClusterCollection::PlaneClusters clusters = coll.clusters(firstPlane + plane);
+        begin_[plane] = entries_.size();
+        for(unsigned ic=0; ic<clusters.size(); ++ic) {
+          const ExtMonFNALRecoCluster& cl = clusters[ic];
+          Entry e = { cl.clock(), cl.position().x(), cl.position().y(), ic };
+          entries_.push_back(e);
+        }
+        std::sort(entries_.begin() + begin_[plane], entries_.end(),
+                  [](const Entry& a, const Entry& b) { return a.clock < b.clock || (a.clock == b.clock && a.x < b.x); });
+      }
+      begin_[nplanes] = entries_.size();
+    }
+
+    void ClusterWindowLookup::find(std::vector<unsigned> *res, unsigned stackPlane,
+                                   int clockMin, int clockMax,
+                                   double xmin, double xmax, double ymin, double ymax) const
+    {
+      const std::size_t first = res->size();
+      auto i = entries_.begin() + begin_[stackPlane];
+      const auto end = entries_.begin() + begin_[stackPlane+1];
+      i = std::lower_bound(i, end, clockMin, [](const Entry& e, int clock) { return e.clock < clock; });
+      while(i != end && i->clock <= clockMax) {
+        // the clusters of one clock are sorted in x
+        const int clock = i->clock;
+        const auto clockEnd = std::upper_bound(i, end, clock, [](int c, const Entry& e) { return c < e.clock; });
+        auto j = std::lower_bound(i, clockEnd, xmin, [](const Entry& e, double x) { return e.x < x; });
+        for(; j != clockEnd && j->x <= xmax; ++j) {
+          if((ymin <= j->y) && (j->y <= ymax)) {
+            res->push_back(j->index);
+          }
+        }
+        i = clockEnd;
+      }
+      std::sort(res->begin() + first, res->end());
+    }
+
+  } // namespace ExtMonFNAL
+} // namespace mu2e
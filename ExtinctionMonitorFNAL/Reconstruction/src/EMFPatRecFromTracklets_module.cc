@@ -56,6 +56,7 @@
 #include "ExtinctionMonitorFNAL/Reconstruction/inc/PixelRecoUtils.hh"
 #include "ExtinctionMonitorFNAL/Reconstruction/inc/ClusterOnTrackPrecisionTool.hh"
 #include "ExtinctionMonitorFNAL/Reconstruction/inc/LinearRegression.hh"
+#include "ExtinctionMonitorFNAL/Reconstruction/inc/TrackletFinder.hh"
 
 #include "art_root_io/TFileService.h"
 #include "art/Framework/Services/Registry/ServiceHandle.h"
@@ -195,7 +196,7 @@ namespace mu2e {
     }
 
     //================================================================
-    class EMFPatRecFromTracklets : public art::EDProducer {
+    class EMFPatRecFromTracklets : public art::EDProducer, private TrackletFinder::Observer {
 
     public:
       explicit EMFPatRecFromTracklets(fhicl::ParameterSet const& pset)
@@ -222,6 +223,7 @@ namespace mu2e {
         , cutMinTrackProb_(pset.get<double>("cutMinTrackProb"))
 
         , maxMissedHits_(pset.get<unsigned>("maxMissedHits"))
+        , useRoads_(pset.get<bool>("useRoads", true))
 
         , hTrackletMultiplicity_()
         , hTrackletMatchSlopeX_()
@@ -275,6 +277,13 @@ namespace mu2e {
 
       unsigned maxMissedHits_;
 
+      // Fetch candidates from precomputed roads rather than looping over
+      // all cluster and tracklet pairs.  The histograms of the pairs
+      // then only see the candidates inside the roads.
+      bool useRoads_;
+      std::unique_ptr<TrackletFinder> finderUp_;
+      std::unique_ptr<TrackletFinder> finderDn_;
+
       //----------------------------------------------------------------
       HistTracklet htup_;
       HistTracklet htdn_;
@@ -299,17 +308,10 @@ namespace mu2e {
                       ExtMonFNALTrkFitCollection *tracks,
                       const art::Handle<ExtMonFNALRecoClusterCollection>& clusters);
 
-      Tracklets formTracklets(const ExtMonFNALPlaneStack& stack,
+      Tracklets formTracklets(const TrackletFinder& finder,
                               const art::Handle<ExtMonFNALRecoClusterCollection>& clusters);
 
-      // finds all clusters in stackPlane that are compatible with a straigth line track going through c1 and c2
-      std::vector<unsigned> findCompatibleClusterIndices(
-							 const ExtMonFNALRecoCluster& c1, 
-							 const ExtMonFNALRecoCluster& c2,
-							 const art::Handle<ExtMonFNALRecoClusterCollection>& coll,
-							 const ExtMonFNALPlaneStack& stack,
-							 unsigned stackPlane
-							 );
+      void matchTracklets(ExtMonFNALTrkFitCollection *tracks, const Tracklet& up, const Tracklet& dn);
 
       Tracklet createTracklet(const Tracklet& orig, const art::Ptr<ExtMonFNALRecoCluster>& cl);
 
@@ -317,7 +319,6 @@ namespace mu2e {
 
       double slopex(const Tracklet& tl);
 
-      bool inTime(const ExtMonFNALRecoCluster& c1, const ExtMonFNALRecoCluster& c2);
       bool inTime(const Tracklet& tl, const ExtMonFNALRecoCluster& cl);
       bool inTime(const Tracklet& tl1, const Tracklet& tl2);
 
@@ -326,6 +327,11 @@ namespace mu2e {
       ExtMonFNALTrkFitQuality evaluateFit(std::vector<ExtMonFNALTrkClusterResiduals> *residuals,
                                           const ExtMonFNALTrkParam& pars,
                                           const std::vector<art::Ptr<ExtMonFNALRecoCluster> >& clusters);
+
+      // TrackletFinder::Observer
+      virtual void seedClockDiff(int dt) override;
+      virtual void clusterClockDiff(int dt) override;
+      virtual void clusterInRoad(unsigned plane, double dx, double dy, double dxmax, double dymax) override;
     };
 
     //================================================================
@@ -357,6 +363,18 @@ namespace mu2e {
           lr_ = LinearRegression(extmon_, clTool_);
         }
 
+        TrackletSearchPars pars;
+        pars.clusterClockTolerance = clusterClockTolerance_;
+        pars.slopexmax = slopexmax_;
+        pars.slopeymax = slopeymax_;
+        pars.stackScatterAngleTolerance = stackScatterAngleTolerance_;
+        pars.alignmentToleranceX = alignmentToleranceX_;
+        pars.alignmentToleranceY = alignmentToleranceY_;
+        pars.maxMissedHits = maxMissedHits_;
+        pars.useRoads = useRoads_;
+        finderUp_.reset(new TrackletFinder(extmon_->up(), extmon_->chip(), pars));
+        finderDn_.reset(new TrackletFinder(extmon_->dn(), extmon_->chip(), pars));
+
         std::cout<<"EMFPatRecFromTracklets: spectrometer nominalMomentum = "
                  <<extmon_->spectrometerMagnet().nominalMomentum()
                  <<std::endl;
@@ -424,235 +442,109 @@ namespace mu2e {
                                             ExtMonFNALTrkFitCollection *tracks,
                                             const art::Handle<ExtMonFNALRecoClusterCollection>& coll)
     {
-      Tracklets tup = formTracklets(extmon_->up(), coll);
-      Tracklets tdn = formTracklets(extmon_->dn(), coll);
+      Tracklets tup = formTracklets(*finderUp_, coll);
+      Tracklets tdn = formTracklets(*finderDn_, coll);
       hTrackletMultiplicity_->Fill(tdn.size(), tup.size());
       htup_.fill(tup);
       htdn_.fill(tdn);
-      hudm_.fill(tup, tdn);
 
       // merge compatible tracklet pairs into tracks
-      for(Tracklets::const_iterator iup = tup.begin(); iup != tup.end(); ++iup) {
+      if(useRoads_) {
+        // downstream tracklets by slope; the candidates of an upstream
+        // tracklet are taken in the list order, as in the full loop
+        std::vector<const Tracklet*> dns;
+        std::vector<std::pair<double,unsigned> > dnSlopes;
         for(Tracklets::const_iterator idn = tdn.begin(); idn != tdn.end(); ++idn) {
-
-          const double dslopex = slopex(*iup) - slopex(*idn);
-          hTrackletMatchSlopeX_->Fill(dslopex);
-
-          if(inTime(*iup, *idn) && (std::abs(dslopex) < trackletMatchSlopeXTolerance_)) {
-
-            // Compute track parameter estimates
-            ExtMonFNALTrkParam trkpar = lr_.estimatePars(*iup, *idn);
-
-            // Compute fit quality and residuals
-            std::vector<art::Ptr<ExtMonFNALRecoCluster> > clusters;
-            addToClusters(&clusters, *idn);
-            addToClusters(&clusters, *iup);
-
-            std::vector<ExtMonFNALTrkClusterResiduals> residuals;
-            ExtMonFNALTrkFitQuality quality =
-              evaluateFit(&residuals, trkpar, clusters);
-
-            Genfun::CumulativeChiSquare pf(quality.ndf());
-            const double prob = 1. - pf(quality.chi2());
-            if(cutMinTrackProb_ <= prob) { // Accept the track
-              tracks->push_back(ExtMonFNALTrkFit(trkpar, quality, clusters, residuals));
-            } // if(fit quality)
-
-          } // if(inTime and slope match)
+          dnSlopes.push_back(std::make_pair(slopex(*idn), dns.size()));
+          dns.push_back(&*idn);
+        }
+        std::sort(dnSlopes.begin(), dnSlopes.end());
+
+        std::vector<unsigned> candidates;
+        for(Tracklets::const_iterator iup = tup.begin(); iup != tup.end(); ++iup) {
+          const double s = slopex(*iup);
+          const double margin = 1.e-12;
+          candidates.clear();
+          for(auto i = std::lower_bound(dnSlopes.begin(), dnSlopes.end(),
+                                        std::make_pair(s - trackletMatchSlopeXTolerance_ - margin, 0u));
+              (i != dnSlopes.end()) && (i->first <= s + trackletMatchSlopeXTolerance_ + margin); ++i) {
+            candidates.push_back(i->second);
+          }
+          std::sort(candidates.begin(), candidates.end());
+          for(unsigned idn : candidates) {
+            matchTracklets(tracks, *iup, *dns[idn]);
+          }
+        }
+      }
+      else {
+        for(Tracklets::const_iterator iup = tup.begin(); iup != tup.end(); ++iup) {
+          for(Tracklets::const_iterator idn = tdn.begin(); idn != tdn.end(); ++idn) {
+            matchTracklets(tracks, *iup, *idn);
+          }
         }
       }
 
     }
 
     //================================================================
-    Tracklets EMFPatRecFromTracklets::formTracklets(const ExtMonFNALPlaneStack& stack,
-                                                    const art::Handle<ExtMonFNALRecoClusterCollection>& coll)
-    {
-      Tracklets res;
-      const double dz = stack.plane_zoffset().back() - stack.plane_zoffset().front();
-      const double dxmax = std::abs(dz * slopexmax_);
-      const double dymax = std::abs(dz * slopeymax_);
-      typedef ExtMonFNALRecoClusterCollection::PlaneClusters PC;
-      // each vector is nplanes long and contains cluster indexes or -1u
-      // This is the list of cluster combinations found using previous seed planes
-      std::list< std::vector<unsigned> > foundCombinations;
-      for(unsigned seedPlane=0; seedPlane <= maxMissedHits_; ++seedPlane) {
-        unsigned backPlane = stack.nplanes() - maxMissedHits_  + seedPlane - 1;
-	const unsigned plane1 = stack.planeNumberOffset() + seedPlane;
-        const unsigned plane2 = stack.planeNumberOffset() + backPlane;
-
-
-	// This vector is used to simplify loooping over the non-seed planes
-	std::vector< unsigned > additionalPlanes ( stack.nplanes() -2, 0 );
-	for(unsigned count = 0, stackPlane=0; stackPlane < stack.nplanes(); ++stackPlane) {
-          if( stackPlane == seedPlane ) continue;
-          if( stackPlane == backPlane ) continue;
-	  additionalPlanes[count] = stackPlane; ++count;
-	}
-
-        const PC pc1 = coll->clusters(plane1);
-        const PC pc2 = coll->clusters(plane2);
-
-        // This will hold the list of cluster combinations found using this seed plane
-	std::list< std::vector<unsigned> > newCombinations;
-
-        // find seed pairs
-        for(unsigned i1 = 0; i1 < pc1.size(); ++i1) {
-          art::Ptr<ExtMonFNALRecoCluster> c1(coll, coll->globalIndex(plane1, i1));
-          for(unsigned i2 = 0; i2 < pc2.size(); ++i2) {
-            art::Ptr<ExtMonFNALRecoCluster> c2(coll, coll->globalIndex(plane2, i2));
-
-            hClockDiffTrackletSeedClusters_->Fill(c2->clock() - c1->clock());
-
-            if( (std::abs(c1->clock() - c2->clock()) <= clusterClockTolerance_) &&
-		(std::abs(c1->position().x() - c2->position().x()) < dxmax) &&
-		(std::abs(c1->position().y() - c2->position().y()) < dymax) )
-              {
-
-              // This will hold the list of cluster combinations found using this seed pair
-	      std::list< std::vector<unsigned> > newSeedCombinations;
-	
-	      for(unsigned p=0; p < stack.nplanes() - 2; ++p) {
-	        unsigned stackPlane = additionalPlanes[p];
-	        std::vector<unsigned> clusters = findCompatibleClusterIndices(*c1, *c2, coll, stack, stackPlane);
-
-                // This will hold the list of extra cluster combinations found using this plane
-	        std::list< std::vector<unsigned> > newPlaneCombinations;
-
-	        for( unsigned i = 0; i < clusters.size(); i++ ) {
-
-	          // check if this combination was found using an earlier seed plane
-	          bool notfound = true;
-	          for(auto comb = foundCombinations.begin(); comb != foundCombinations.end(); ++comb ) {
-	            if( (*comb)[seedPlane] == i1 &&
-	        	(*comb)[backPlane] == i2 &&
-	        	(*comb)[stackPlane] == i )
-	              {
-	        	notfound = false; break;
-	              }
-	          }
-
-	          if( notfound ) {
-	            if( newSeedCombinations.size() == 0 ) {
-		    // This is the first new combination using this seed pair
-	        	std::vector<unsigned> planes( stack.nplanes(), -1u );
-	        	planes[seedPlane] = i1;
-	        	planes[backPlane] = i2;
-	        	newSeedCombinations.push_back(planes);
-		    }
-		    for(auto comb = newSeedCombinations.begin(); comb != newSeedCombinations.end(); ++comb ) {
-		    // Form all possible coombinations of this plane's hits with those of earlier planes
-		    //  the 1st one can be included into the existing combinations will go into copies of them 
-	              if( i == 0 ) {
-	        	(*comb)[stackPlane] = i;
-	              } else {
-	        	std::vector<unsigned> planes( *comb );
-	        	planes[stackPlane] = i;
-	        	newPlaneCombinations.push_back(planes);
-	              }
-	            }
-
-	          } // if combination found
-	        } // additional plane clusters
-
-                newSeedCombinations.splice( newSeedCombinations.begin(), newPlaneCombinations );
-
-	      } // additional planes
-
-	      newCombinations.splice( newCombinations.begin(), newSeedCombinations );
-
-	    } // if seed ok
-          } // back plane clusters
-        } // seed plane clusters
-
-	// create new tracklets
-	for(auto comb = newCombinations.begin(); comb != newCombinations.end(); ++comb ) {
-	  // this piece of code can be replaced with an appropriate Tracklet constructor
-	  std::vector<art::Ptr<ExtMonFNALRecoCluster> > additionalClusters;
-          art::Ptr<ExtMonFNALRecoCluster> c1(coll, coll->globalIndex(plane1, (*comb)[seedPlane]));
-          art::Ptr<ExtMonFNALRecoCluster> c2(coll, coll->globalIndex(plane2, (*comb)[backPlane]));
-	  for(unsigned p=0; p < stack.nplanes() - 2; ++p) {
-	    unsigned stackPlane = additionalPlanes[p];
-	    if( (*comb)[stackPlane] == -1u ) continue;
-	    unsigned globalPlane = stack.planeNumberOffset() + stackPlane;
-	    additionalClusters.push_back(art::Ptr<ExtMonFNALRecoCluster>(coll, coll->globalIndex(globalPlane, (*comb)[stackPlane])));
-	  }
-	  if( additionalClusters.size() >= stack.nplanes() - maxMissedHits_  - 2 ) {
-	    Tracklet track(c1,c2);
-	    for( unsigned ic = 0; ic < additionalClusters.size(); ic++ ) {
-	      modifyInPlace(&track, additionalClusters[ic]);
-	    }
-	    res.push_back( track );
-	  }
-	} // new combinations
-
-	foundCombinations.splice( foundCombinations.begin(), newCombinations );
-
-      } // seed plane
-
-      return res;
-    }
-
-    //================================================================
-    std::vector<unsigned> EMFPatRecFromTracklets::findCompatibleClusterIndices(const ExtMonFNALRecoCluster& c1,
-									       const ExtMonFNALRecoCluster& c2,
-									       const art::Handle<ExtMonFNALRecoClusterCollection>& coll,
-									       const ExtMonFNALPlaneStack& stack,
-									       unsigned stackPlane
-									       )
+    void EMFPatRecFromTracklets::matchTracklets(ExtMonFNALTrkFitCollection *tracks,
+                                                const Tracklet& up,
+                                                const Tracklet& dn)
     {
-      const unsigned anchorPlane1 = c1.plane();
-      const unsigned anchorPlane2 = c2.plane();
-
-      const double planeZ = stack.plane_zoffset()[stackPlane];
-      AGDEBUG("Here: stackPlane="<<stackPlane<<", planeZ = "<<planeZ<<", seeds->size() = "<<seeds->size()
-              <<", anchorPlane1 = "<<anchorPlane1<<", anchorPlane2 = "<<anchorPlane2);
-
-      const double dxtol1 =  alignmentToleranceX_ + stackScatterAngleTolerance_ * std::abs(planeZ - stack.plane_zoffset()[anchorPlane1]);
-      const double dxtol2 =  alignmentToleranceX_ + stackScatterAngleTolerance_ * std::abs(planeZ - stack.plane_zoffset()[anchorPlane2]);
+      hudm_.fill(up, dn);
 
-      const double dytol1 =  alignmentToleranceY_ + stackScatterAngleTolerance_ * std::abs(planeZ - stack.plane_zoffset()[anchorPlane1]);
-      const double dytol2 =  alignmentToleranceY_ + stackScatterAngleTolerance_ * std::abs(planeZ - stack.plane_zoffset()[anchorPlane2]);
-      AGDEBUG("dxtol1 ="<<dxtol1<<", dxtol2 ="<<dxtol2<<", dytol1 = "<<dytol1<<", dytol2 = "<<dytol2);
+      const double dslopex = slopex(up) - slopex(dn);
+      hTrackletMatchSlopeX_->Fill(dslopex);
 
-      std::vector<unsigned> res;
+      if(inTime(up, dn) && (std::abs(dslopex) < trackletMatchSlopeXTolerance_)) {
 
-      const CLHEP::Hep3Vector& pos1 = c1.position();
-      const CLHEP::Hep3Vector& pos2 = c2.position();
-      AGDEBUG("pos1 = "<<pos1<<", pos2 = "<<pos2);
+        // Compute track parameter estimates
+        ExtMonFNALTrkParam trkpar = lr_.estimatePars(up, dn);
 
-      const double z1(pos1.z()), z2(pos2.z());
-      const double dz(z2-z1);
+        // Compute fit quality and residuals
+        std::vector<art::Ptr<ExtMonFNALRecoCluster> > clusters;
+        addToClusters(&clusters, dn);
+        addToClusters(&clusters, up);
 
-      const CLHEP::Hep3Vector interpolated = pos2 * (planeZ - z1)/dz + pos1 * (z2 - planeZ)/dz;
+        std::vector<ExtMonFNALTrkClusterResiduals> residuals;
+        ExtMonFNALTrkFitQuality quality =
+          evaluateFit(&residuals, trkpar, clusters);
 
-      const double dxmax1 = dxtol1 + 0.5*c1.xWidth()*extmon_->chip().xPitch();
-      const double dxmax2 = dxtol2 + 0.5*c2.xWidth()*extmon_->chip().xPitch();
-      // satisfy both constraints
-      const double dxmax(std::min(dxmax1, dxmax2));
+        Genfun::CumulativeChiSquare pf(quality.ndf());
+        const double prob = 1. - pf(quality.chi2());
+        if(cutMinTrackProb_ <= prob) { // Accept the track
+          tracks->push_back(ExtMonFNALTrkFit(trkpar, quality, clusters, residuals));
+        } // if(fit quality)
 
-      const double dymax1 = dytol1 + 0.5*c1.yWidth()*extmon_->chip().yPitch();
-      const double dymax2 = dytol2 + 0.5*c2.yWidth()*extmon_->chip().yPitch();
-      // satisfy both constraints
-      const double dymax(std::min(dymax1, dymax2));
-      AGDEBUG("dxmax="<<dxmax<<", dymax="<<dymax<<", interpolated="<<interpolated);
-
-      // find all clusters compatible with seed i
-      const unsigned int globalPlane = stackPlane + stack.planeNumberOffset();
-      const ExtMonFNALRecoClusterCollection::PlaneClusters& clusters = coll->clusters(globalPlane);
-      for(unsigned ic=0; ic<clusters.size(); ++ic) {
-	const ExtMonFNALRecoCluster& cl = clusters[ic];
-	if(inTime(c1, cl) || inTime(c2, cl)) {
-	  const double dx = interpolated.x() - cl.position().x();
-	  const double dy = interpolated.y() - cl.position().y();
+      } // if(inTime and slope match)
+    }
 
-	  hClusterAddXY_[globalPlane]->Fill(dx/dxmax, dy/dymax);
-	  hClusterAddXXMax_[globalPlane]->Fill(dxmax, dx);
-	  hClusterAddYYMax_[globalPlane]->Fill(dymax, dy);
+    //================================================================
+    Tracklets EMFPatRecFromTracklets::formTracklets(const TrackletFinder& finder,
+                                                    const art::Handle<ExtMonFNALRecoClusterCollection>& coll)
+    {
+      Tracklets res;
 
-	  if((std::abs(dx) < dxmax) && (std::abs(dy) < dymax) ) { res.push_back(ic); }
-	}
+      TrackletCombinations combinations;
+      finder.find(&combinations, *coll, this);
+
+      const unsigned offset = finder.planeNumberOffset();
+      for(unsigned ic = 0; ic < combinations.size(); ++ic) {
+        const unsigned *comb = combinations.row(ic);
+        const unsigned seedConfig = combinations.seedConfig(ic);
+        const unsigned seedPlane = finder.seedPlane(seedConfig);
+        const unsigned backPlane = finder.backPlane(seedConfig);
+
+        Tracklet track(art::Ptr<ExtMonFNALRecoCluster>(coll, coll->globalIndex(offset + seedPlane, comb[seedPlane])),
+                       art::Ptr<ExtMonFNALRecoCluster>(coll, coll->globalIndex(offset + backPlane, comb[backPlane])));
+        for(unsigned p = 0; p < finder.numAdditionalPlanes(); ++p) {
+          const unsigned stackPlane = finder.additionalPlane(seedConfig, p);
+          if(comb[stackPlane] == -1u) continue;
+          modifyInPlace(&track, art::Ptr<ExtMonFNALRecoCluster>(coll, coll->globalIndex(offset + stackPlane, comb[stackPlane])));
+        }
+        res.push_back(track);
       }
+
       return res;
     }
 
@@ -674,13 +566,6 @@ namespace mu2e {
       return dir.x()/dir.z();
     }
 
-    //================================================================
-    bool EMFPatRecFromTracklets::inTime(const ExtMonFNALRecoCluster& c1, const ExtMonFNALRecoCluster& c2) {
-      const int dt = c1.clock() - c2.clock();
-      hClockDiffClusterTracklet_->Fill(dt);
-      return (std::abs(dt) <= clusterClockTolerance_);
-    }
-
     //================================================================
     bool EMFPatRecFromTracklets::inTime(const Tracklet& tl, const ExtMonFNALRecoCluster& cl) {
       const int dtFirst = cl.clock() - tl.firstSeedCluster->clock();
@@ -756,6 +641,21 @@ namespace mu2e {
     } //evaluateFit()
 
     //================================================================
+    void EMFPatRecFromTracklets::seedClockDiff(int dt) {
+      hClockDiffTrackletSeedClusters_->Fill(dt);
+    }
+
+    void EMFPatRecFromTracklets::clusterClockDiff(int dt) {
+      hClockDiffClusterTracklet_->Fill(dt);
+    }
+
+    void EMFPatRecFromTracklets::clusterInRoad(unsigned plane, double dx, double dy, double dxmax, double dymax) {
+      hClusterAddXY_[plane]->Fill(dx/dxmax, dy/dymax);
+      hClusterAddXXMax_[plane]->Fill(dxmax, dx);
+      hClusterAddYYMax_[plane]->Fill(dymax, dy);
+    }
+
+    //================================================================
 
   } // end namespace ExtMonFNAL
 } // end namespace mu2e
@@ -0,0 +1,305 @@
+// Find straight line tracklets in one ExtMonFNAL plane stack.
+//
+// Original pattern recognition by Andrei Gaponenko
+
+#include "ExtinctionMonitorFNAL/Reconstruction/inc/TrackletFinder.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <tuple>
+
+#include "cetlib_except/exception.h"
+
+#include "RecoDataProducts/inc/ExtMonFNALRecoCluster.hh"
+#include "RecoDataProducts/inc/ExtMonFNALRecoClusterCollection.hh"
+#include "ExtinctionMonitorFNAL/Geometry/inc/ExtMonFNALPlaneStack.hh"
+#include "ExtinctionMonitorFNAL/Geometry/inc/ExtMonFNALPixelChip.hh"
+#include "ExtinctionMonitorFNAL/Reconstruction/inc/ClusterWindowLookup.hh"
+
+namespace mu2e {
+  namespace ExtMonFNAL {
+
+    namespace {
+      // Widen the lookup windows so that rounding can't lose a cluster
+      // that passes the exact cut
+      const double windowMargin = 1.e-9; // mm
+
+      // A cluster triplet of a combination, as seen by a later seed configuration
+      struct FoundKey {
+        unsigned seedConfig, plane, i1, i2, i;
+        bool operator<(const FoundKey& b) const {
+          return std::tie(seedConfig, plane, i1, i2, i) < std::tie(b.seedConfig, b.plane, b.i1, b.i2, b.i);
+        }
+      };
+    }
+
+    //================================================================
+    TrackletFinder::TrackletFinder(const std::vector<double>& planeZ,
+                                   unsigned planeNumberOffset,
+                                   double xPitch,
+                                   double yPitch,
+                                   const TrackletSearchPars& pars)
+      : planeZ_(planeZ)
+      , planeNumberOffset_(planeNumberOffset)
+      , xPitch_(xPitch)
+      , yPitch_(yPitch)
+      , pars_(pars)
+      , dxmax_(0.)
+      , dymax_(0.)
+    {
+      init();
+    }
+
+    TrackletFinder::TrackletFinder(const ExtMonFNALPlaneStack& stack,
+                                   const ExtMonFNALPixelChip& chip,
+                                   const TrackletSearchPars& pars)
+      : TrackletFinder(stack.plane_zoffset(), stack.planeNumberOffset(), chip.xPitch(), chip.yPitch(), pars)
+    {}
+
+    //================================================================
+    void TrackletFinder::init() {
+      const unsigned np = planeZ_.size();
+      if(np < 3 || pars_.maxMissedHits + 2 > np) {
+        throw cet::exception("RECO")<<"TrackletFinder: can't search with maxMissedHits = "<<pars_.maxMissedHits
+                                    <<" in a stack of "<<np<<" planes\n";
+      }
+
+      const double dz = planeZ_.back() - planeZ_.front();
+      dxmax_ = std::abs(dz * pars_.slopexmax);
+      dymax_ = std::abs(dz * pars_.slopeymax);
+
+      seeds_.clear();
+      for(unsigned seedPlane=0; seedPlane <= pars_.maxMissedHits; ++seedPlane) {
+        SeedConfig sc;
+        sc.seedPlane = seedPlane;
+        sc.backPlane = np - pars_.maxMissedHits + seedPlane - 1;
+        const double z1 = planeZ_[sc.seedPlane];
+        const double z2 = planeZ_[sc.backPlane];
+        for(unsigned stackPlane=0; stackPlane < np; ++stackPlane) {
+          if((stackPlane == sc.seedPlane) || (stackPlane == sc.backPlane)) continue;
+          Road r;
+          r.plane = stackPlane;
+          r.planeZ = planeZ_[stackPlane];
+          r.dxtol1 = pars_.alignmentToleranceX + pars_.stackScatterAngleTolerance * std::abs(r.planeZ - z1);
+          r.dxtol2 = pars_.alignmentToleranceX + pars_.stackScatterAngleTolerance * std::abs(r.planeZ - z2);
+          r.dytol1 = pars_.alignmentToleranceY + pars_.stackScatterAngleTolerance * std::abs(r.planeZ - z1);
+          r.dytol2 = pars_.alignmentToleranceY + pars_.stackScatterAngleTolerance * std::abs(r.planeZ - z2);
+          sc.roads.push_back(r);
+        }
+        seeds_.push_back(sc);
+      }
+    }
+
+    //================================================================
+    void TrackletFinder::find(TrackletCombinations *res,
+                              const ExtMonFNALRecoClusterCollection& coll,
+                              Observer *obs) const
+    {
+      const unsigned np = nplanes();
+      const int tol = pars_.clusterClockTolerance;
+      res->nplanes_ = np;
+      res->rows_.clear();
+      res->seedConfig_.clear();
+
+      std::unique_ptr<ClusterWindowLookup> lookup;
+      if(pars_.useRoads) {
+        lookup.reset(new ClusterWindowLookup(coll, planeNumberOffset_, np));
+      }
+
+      // cluster triplets of the combinations found with earlier seed configurations, sorted
+      std::vector<FoundKey> found;
+
+      std::vector<unsigned> partners;
+      std::vector<unsigned> compatible;
+      std::vector<unsigned> seedRows;  // combinations of the current seed pair
+      std::vector<unsigned> planeRows; // combinations added by the current plane
+      std::vector<unsigned> newRows;   // combinations of the current seed configuration
+      std::vector<unsigned> blocks;    // start of each seed pair in newRows
+
+      for(unsigned s=0; s < seeds_.size(); ++s) {
+        const SeedConfig& sc = seeds_[s];
+        const unsigned plane1 = planeNumberOffset_ + sc.seedPlane;
+        const unsigned plane2 = planeNumberOffset_ + sc.backPlane;
+        const ExtMonFNALRecoClusterCollection::PlaneClusters pc1 = coll.clusters(plane1);
+        const ExtMonFNALRecoClusterCollection::PlaneClusters pc2 = coll.clusters(plane2);
+
+        newRows.clear();
+        blocks.clear();
+
+        // find seed pairs
+        for(unsigned i1 = 0; i1 < pc1.size(); ++i1) {
+          const ExtMonFNALRecoCluster& c1 = pc1[i1];
+
+          partners.clear();
+          if(lookup) {
+            lookup->find(&partners, sc.backPlane, c1.clock() - tol, c1.clock() + tol,
+                         c1.position().x() - dxmax_ - windowMargin, c1.position().x() + dxmax_ + windowMargin,
+                         c1.position().y() - dymax_ - windowMargin, c1.position().y() + dymax_ + windowMargin);
+          }
+          else {
+            for(unsigned i2 = 0; i2 < pc2.size(); ++i2) partners.push_back(i2);
+          }
+
+          for(unsigned i2 : partners) {
+            const ExtMonFNALRecoCluster& c2 = pc2[i2];
+
+            if(obs) obs->seedClockDiff(c2.clock() - c1.clock());
+
+            if( (std::abs(c1.clock() - c2.clock()) <= tol) &&
+                (std::abs(c1.position().x() - c2.position().x()) < dxmax_) &&
+                (std::abs(c1.position().y() - c2.position().y()) < dymax_) )
+              {
+                seedRows.clear();
+
+                for(const Road& road : sc.roads) {
+                  findCompatibleClusterIndices(&compatible, c1, c2, coll, lookup.get(), road, obs);
+
+                  planeRows.clear();
+                  for(unsigned k = 0; k < compatible.size(); ++k) {
+                    const unsigned icl = compatible[k];
+
+                    // skip triplets already found using an earlier seed configuration
+                    const FoundKey key = { s, road.plane, i1, i2, icl };
+                    if(std::binary_search(found.begin(), found.end(), key)) continue;
+
+                    if(seedRows.empty()) {
+                      // This is the first new combination using this seed pair
+                      seedRows.resize(np, -1u);
+                      seedRows[sc.seedPlane] = i1;
+                      seedRows[sc.backPlane] = i2;
+                    }
+                    // The first compatible cluster goes into the existing
+                    // combinations, the others into copies of them
+                    const unsigned nrows = seedRows.size()/np;
+                    for(unsigned r = 0; r < nrows; ++r) {
+                      if(k == 0) {
+                        seedRows[r*np + road.plane] = icl;
+                      }
+                      else {
+                        planeRows.insert(planeRows.end(), seedRows.begin() + r*np, seedRows.begin() + (r+1)*np);
+                        planeRows[planeRows.size() - np + road.plane] = icl;
+                      }
+                    }
+                  } // compatible clusters
+
+                  // the copies go first
+                  planeRows.insert(planeRows.end(), seedRows.begin(), seedRows.end());
+                  seedRows.swap(planeRows);
+
+                } // additional planes
+
+                blocks.push_back(newRows.size());
+                newRows.insert(newRows.end(), seedRows.begin(), seedRows.end());
+
+              } // if seed ok
+          } // back plane clusters
+        } // seed plane clusters
+
+        // create the tracklets, the last seed pair first
+        const unsigned minAdded = np - pars_.maxMissedHits - 2;
+        for(unsigned b = blocks.size(); b-- > 0; ) {
+          const unsigned end = (b+1 < blocks.size()) ? blocks[b+1] : newRows.size();
+          for(unsigned row = blocks[b]; row < end; row += np) {
+            unsigned nadded = 0;
+            for(const Road& road : sc.roads) {
+              nadded += (newRows[row + road.plane] != -1u);
+            }
+            if(nadded >= minAdded) {
+              res->rows_.insert(res->rows_.end(), newRows.begin() + row, newRows.begin() + row + np);
+              res->seedConfig_.push_back(s);
+            }
+          }
+        }
+
+        // remember the triplets the later seed configurations would find again
+        for(unsigned row = 0; row < newRows.size(); row += np) {
+          for(unsigned s2 = s+1; s2 < seeds_.size(); ++s2) {
+            const SeedConfig& sc2 = seeds_[s2];
+            const unsigned i1 = newRows[row + sc2.seedPlane];
+            const unsigned i2 = newRows[row + sc2.backPlane];
+            if((i1 == -1u) || (i2 == -1u)) continue;
+            for(const Road& road : sc2.roads) {
+              const unsigned i = newRows[row + road.plane];
+              if(i != -1u) {
+                const FoundKey key = { s2, road.plane, i1, i2, i };
+                found.push_back(key);
+              }
+            }
+          }
+        }
+        std::sort(found.begin(), found.end());
+
+      } // seed configurations
+    }
+
+    //================================================================
+    void TrackletFinder::findCompatibleClusterIndices(std::vector<unsigned> *res,
+                                                      const ExtMonFNALRecoCluster& c1,
+                                                      const ExtMonFNALRecoCluster& c2,
+                                                      const ExtMonFNALRecoClusterCollection& coll,
+                                                      const ClusterWindowLookup *lookup,
+                                                      const Road& road,
+                                                      Observer *obs) const
+    {
+      const double planeZ = road.planeZ;
+
+      const CLHEP::Hep3Vector& pos1 = c1.position();
+      const CLHEP::Hep3Vector& pos2 = c2.position();
+
+      const double z1(pos1.z()), z2(pos2.z());
+      const double dz(z2-z1);
+
+      const CLHEP::Hep3Vector interpolated = pos2 * (planeZ - z1)/dz + pos1 * (z2 - planeZ)/dz;
+
+      const double dxmax1 = road.dxtol1 + 0.5*c1.xWidth()*xPitch_;
+      const double dxmax2 = road.dxtol2 + 0.5*c2.xWidth()*xPitch_;
+      // satisfy both constraints
+      const double dxmax(std::min(dxmax1, dxmax2));
+
+      const double dymax1 = road.dytol1 + 0.5*c1.yWidth()*yPitch_;
+      const double dymax2 = road.dytol2 + 0.5*c2.yWidth()*yPitch_;
+      // satisfy both constraints
+      const double dymax(std::min(dymax1, dymax2));
+
+      const unsigned int globalPlane = road.plane + planeNumberOffset_;
+      const ExtMonFNALRecoClusterCollection::PlaneClusters& clusters = coll.clusters(globalPlane);
+
+      res->clear();
+      if(lookup) {
+        // in time with either seed cluster
+        const int tol = pars_.clusterClockTolerance;
+        lookup->find(res, road.plane,
+                     std::min(c1.clock(), c2.clock()) - tol, std::max(c1.clock(), c2.clock()) + tol,
+                     interpolated.x() - dxmax - windowMargin, interpolated.x() + dxmax + windowMargin,
+                     interpolated.y() - dymax - windowMargin, interpolated.y() + dymax + windowMargin);
+      }
+      else {
+        for(unsigned ic=0; ic<clusters.size(); ++ic) res->push_back(ic);
+      }
+
+      // apply the exact cuts to the candidates, in place
+      unsigned nres = 0;
+      for(unsigned ic : *res) {
+        const ExtMonFNALRecoCluster& cl = clusters[ic];
+        if(inTime(c1, cl, obs) || inTime(c2, cl, obs)) {
+          const double dx = interpolated.x() - cl.position().x();
+          const double dy = interpolated.y() - cl.position().y();
+
+          if(obs) obs->clusterInRoad(globalPlane, dx, dy, dxmax, dymax);
+
+          if((std::abs(dx) < dxmax) && (std::abs(dy) < dymax) ) { (*res)[nres++] = ic; }
+        }
+      }
+      res->resize(nres);
+    }
+
+    //================================================================
+    bool TrackletFinder::inTime(const ExtMonFNALRecoCluster& c1, const ExtMonFNALRecoCluster& c2, Observer *obs) const {
+      const int dt = c1.clock() - c2.clock();
+      if(obs) obs->clusterClockDiff(dt);
+      return (std::abs(dt) <= pars_.clusterClockTolerance);
+    }
+
+  } // namespace ExtMonFNAL
+} // namespace mu2e
@@ -0,0 +1,131 @@
+//
+// Throughput of the ExtMonFNAL tracklet search with and without the road
+// tables, on a synthetic stack at several occupancies.  Also checks that
+// both searches find the same cluster combinations.
+//
+//   emfRoadBenchmark [nevents] [nclocks]
+//
+
+#include "ExtinctionMonitorFNAL/Reconstruction/inc/TrackletFinder.hh"
+#include "RecoDataProducts/inc/ExtMonFNALRecoCluster.hh"
+#include "RecoDataProducts/inc/ExtMonFNALRecoClusterCollection.hh"
+
+#include "CLHEP/Vector/ThreeVector.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace mu2e;
+using namespace mu2e::ExtMonFNAL;
+
+namespace {
+
+  // the upstream stack and the chip of the nominal geometry
+  const std::vector<double> planeZ{300., 400., 500., 600.};
+  const double xPitch = 0.25;
+  const double yPitch = 0.05;
+  const double halfX = 10.;
+  const double halfY = 5.;
+
+  // ntracks tracks and nnoise noise clusters per plane in each clock
+  ExtMonFNALRecoClusterCollection makeEvent(std::mt19937& gen, unsigned nclocks, unsigned ntracks, unsigned nnoise) {
+    std::uniform_real_distribution<double> fx(-halfX, halfX), fy(-halfY, halfY), slope(-0.01, 0.01);
+    std::normal_distribution<double> scatter(0., 0.05);
+    std::uniform_int_distribution<int> width(1, 3);
+
+    ExtMonFNALRecoClusterCollection coll(planeZ.size());
+    std::vector<std::vector<ExtMonFNALRecoCluster> > planes(planeZ.size());
+    for(unsigned clock = 0; clock < nclocks; ++clock) {
+      for(unsigned t = 0; t < ntracks; ++t) {
+        const double x0 = fx(gen), y0 = fy(gen), sx = slope(gen), sy = slope(gen);
+        for(unsigned p = 0; p < planeZ.size(); ++p) {
+          const double dz = planeZ[p] - planeZ.front();
+          CLHEP::Hep3Vector pos(x0 + sx*dz + scatter(gen), y0 + sy*dz + 0.2*scatter(gen), planeZ[p]);
+          planes[p].push_back(ExtMonFNALRecoCluster(art::Ptr<ExtMonFNALRawCluster>(), p, pos,
+                                                    width(gen), width(gen), clock));
+        }
+      }
+      for(unsigned p = 0; p < planeZ.size(); ++p) {
+        for(unsigned n = 0; n < nnoise; ++n) {
+          CLHEP::Hep3Vector pos(fx(gen), fy(gen), planeZ[p]);
+          planes[p].push_back(ExtMonFNALRecoCluster(art::Ptr<ExtMonFNALRawCluster>(), p, pos,
+                                                    width(gen), width(gen), clock));
+        }
+      }
+    }
+    for(const auto& plane : planes) {
+      for(const auto& cl : plane) coll.insert(cl);
+    }
+    return coll;
+  }
+
+  bool sameCombinations(const TrackletCombinations& a, const TrackletCombinations& b) {
+    if(a.size() != b.size()) return false;
+    for(unsigned i = 0; i < a.size(); ++i) {
+      if(a.seedConfig(i) != b.seedConfig(i)) return false;
+      for(unsigned p = 0; p < a.nplanes(); ++p) {
+        if(a.row(i)[p] != b.row(i)[p]) return false;
+      }
+    }
+    return true;
+  }
+
+}
+
+int main(int argc, char** argv) {
+
+  const unsigned nevents = argc > 1 ? std::atoi(argv[1]) : 100;
+  const unsigned nclocks = argc > 2 ? std::atoi(argv[2]) : 100;
+
+  // the EMFPatRecFromTracklets defaults
+  TrackletSearchPars pars;
+  pars.clusterClockTolerance = 0;
+  pars.slopexmax = 0.1;
+  pars.slopeymax = 0.1;
+  pars.stackScatterAngleTolerance = 0.005;
+  pars.alignmentToleranceX = 0.25;
+  pars.alignmentToleranceY = 0.05;
+  pars.maxMissedHits = 1;
+
+  pars.useRoads = true;
+  TrackletFinder roads(planeZ, 0, xPitch, yPitch, pars);
+  pars.useRoads = false;
+  TrackletFinder exhaustive(planeZ, 0, xPitch, yPitch, pars);
+
+  auto now = [](){ return std::chrono::steady_clock::now(); };
+  typedef std::chrono::duration<double> seconds;
+
+  std::cout << "emfRoadBenchmark: " << nevents << " events of " << nclocks << " clocks" << std::endl;
+
+  unsigned ndiff(0);
+  std::mt19937 gen(12345);
+  const unsigned occupancies[][2] = { {1, 0}, {2, 2}, {4, 8}, {8, 16} };
+  for(const auto& occ : occupancies) {
+    std::vector<ExtMonFNALRecoClusterCollection> events;
+    for(unsigned i = 0; i < nevents; ++i) events.push_back(makeEvent(gen, nclocks, occ[0], occ[1]));
+
+    std::vector<TrackletCombinations> resRoads(nevents), resFull(nevents);
+    auto t0 = now();
+    for(unsigned i = 0; i < nevents; ++i) roads.find(&resRoads[i], events[i]);
+    auto t1 = now();
+    for(unsigned i = 0; i < nevents; ++i) exhaustive.find(&resFull[i], events[i]);
+    auto t2 = now();
+
+    unsigned long ntracklets(0);
+    for(unsigned i = 0; i < nevents; ++i) {
+      ntracklets += resRoads[i].size();
+      ndiff += !sameCombinations(resRoads[i], resFull[i]);
+    }
+
+    std::cout << "  " << occ[0] << " tracks + " << occ[1] << " noise clusters per plane per clock: "
+              << ntracklets/double(nevents) << " tracklets/event" << std::endl
+              << "    roads      events/second: " << nevents/seconds(t1-t0).count() << std::endl
+              << "    exhaustive events/second: " << nevents/seconds(t2-t1).count() << std::endl;
+  }
+  std::cout << "  events with different combinations: " << ndiff << std::endl;
+
+  return ndiff == 0 ? 0 : 2;
+}
@@ -0,0 +1,114 @@
+// Convert StepPointMCCollections into the reduced precision
+// CompactStepPointMCCollection format used for event mixing inputs.
+// Each output keeps the instance name of its input, so that the
+// mixingMap of the compactStepPointMCMixer can be written the same
+// way as that of the stepPointMCMixer.
+//
+// At the end of the job the module reports the in-memory size of a
+// step in both formats and the largest rounding error seen for
+// position and time.
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+#include "cetlib_except/exception.h"
+
+#include "art/Framework/Core/EDProducer.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Principal/Event.h"
+#include "art/Framework/Principal/Handle.h"
+
+#include "MCDataProducts/inc/StepPointMCCollection.hh"
+#include "MCDataProducts/inc/CompactStepPointMC.hh"
+
+namespace mu2e {
+
+  class CompactStepPointMCs : public art::EDProducer {
+  public:
+
+    struct Config {
+      using Name=fhicl::Name;
+      using Comment=fhicl::Comment;
+
+      fhicl::Sequence<art::InputTag> inputs {
+        Name("inputs"),
+          Comment("A list of StepPointMCCollections to convert.  The output\n"
+                  "collections use the instance names of the inputs.\n")
+          };
+
+      fhicl::Atom<int> diagLevel {
+        Name("diagLevel"),
+          Comment("Print a summary at the end of the job if > 0"),
+          1
+          };
+    };
+
+    using Parameters = art::EDProducer::Table<Config>;
+    explicit CompactStepPointMCs(const Parameters& conf);
+
+    void produce(art::Event& evt) override;
+    void endJob() override;
+
+  private:
+    std::vector<art::InputTag> inputs_;
+    int diagLevel_;
+
+    unsigned long long nsteps_;
+    double maxPosError_;
+    double maxTimeError_;
+  };
+
+  //================================================================
+  CompactStepPointMCs::CompactStepPointMCs(const Parameters& conf)
+    : art::EDProducer{conf}
+    , inputs_(conf().inputs())
+    , diagLevel_(conf().diagLevel())
+    , nsteps_(0)
+    , maxPosError_(0.)
+    , maxTimeError_(0.)
+  {
+    for(const auto& intag : inputs_) {
+      produces<CompactStepPointMCCollection>(intag.instance());
+    }
+  }
+
+  //================================================================
+  void CompactStepPointMCs::produce(art::Event& event) {
+    for(const auto& intag : inputs_) {
+      auto ih = event.getValidHandle<StepPointMCCollection>(intag);
+
+      std::unique_ptr<CompactStepPointMCCollection> out(new CompactStepPointMCCollection());
+      out->reserve(ih->size());
+      for(const auto& step: *ih) {
+        out->emplace_back(step);
+        if(diagLevel_ > 0) {
+          const auto& cstep = out->back();
+          maxPosError_  = std::max(maxPosError_, (cstep.position() - step.position()).mag());
+          maxTimeError_ = std::max(maxTimeError_, std::abs(cstep.time() - step.time()));
+        }
+      }
+      nsteps_ += out->size();
+
+      event.put(std::move(out), intag.instance());
+    }
+  }
+
+  //================================================================
+  void CompactStepPointMCs::endJob() {
+    if(diagLevel_ > 0) {
+      std::cout<<"CompactStepPointMCs: converted "<<nsteps_<<" steps"
+               <<", sizeof(StepPointMC) = "<<sizeof(StepPointMC)
+               <<", sizeof(CompactStepPointMC) = "<<sizeof(CompactStepPointMC)
+               <<", max position error = "<<maxPosError_<<" mm"
+               <<", max time error = "<<maxTimeError_<<" ns"
+               <<std::endl;
+    }
+  }
+
+} // namespace mu2e
+
+DEFINE_ART_MODULE(mu2e::CompactStepPointMCs);
@@ -44,15 +44,17 @@
 #include "MCDataProducts/inc/CrvCoincidenceClusterMCCollection.hh"
 #include "MCDataProducts/inc/PrimaryParticle.hh"
 #include "MCDataProducts/inc/MCTrajectoryCollection.hh"
+#include "Mu2eUtilities/inc/PtrHash.hh"
 
 namespace mu2e {
   class CompressDigiMCs;
 
-  typedef std::set<art::Ptr<SimParticle> > SimParticleSet;
+  typedef PtrSet<SimParticle> SimParticleSet;
 
   class SimParticleSelector {
   public:
     SimParticleSelector(const SimParticleSet& simPartSet) {
+      m_keys.reserve(simPartSet.size());
       for (const auto& i_simPart : simPartSet) {
         cet::map_vector_key key = cet::map_vector_key(i_simPart.key());
         m_keys.insert(key);
@@ -63,7 +65,7 @@ namespace mu2e {
       return m_keys.find(key) != m_keys.end();
     }
 
-    const std::set<cet::map_vector_key>& keys() const {
+    const std::unordered_set<cet::map_vector_key, MapVectorKeyHash>& keys() const {
       return m_keys;
     }
 
@@ -72,14 +74,39 @@ namespace mu2e {
     }
 
   private:
-    std::set<cet::map_vector_key> m_keys;
+    std::unordered_set<cet::map_vector_key, MapVectorKeyHash> m_keys;
 
   };
 
-  typedef std::map<art::Ptr<mu2e::CaloShowerStep>, art::Ptr<mu2e::CaloShowerStep> > CaloShowerStepRemap;
+  // The old CaloShowerStep Ptrs index their collections densely, so the remapping
+  // is a vector of new Ptrs per input collection, indexed by the old key
+  class CaloShowerStepRemap {
+  public:
+    typedef art::Ptr<mu2e::CaloShowerStep> CaloShowerStepPtr;
+
+    std::vector<CaloShowerStepPtr>& addCollection(const art::ProductID& pid, size_t size) {
+      m_remaps.emplace_back(pid, std::vector<CaloShowerStepPtr>());
+      m_remaps.back().second.reserve(size);
+      return m_remaps.back().second;
+    }
+
+    const CaloShowerStepPtr& at(const CaloShowerStepPtr& oldPtr) const {
+      for (const auto& i_remap : m_remaps) {
+        if (i_remap.first == oldPtr.id() && oldPtr.key() < i_remap.second.size()) {
+          return i_remap.second[oldPtr.key()];
+        }
+      }
+      throw cet::exception("CompressDigiMCs") << "No remapping for CaloShowerStep " << oldPtr.id() << " " << oldPtr.key() << std::endl;
+    }
+
+  private:
+    std::vector<std::pair<art::ProductID, std::vector<CaloShowerStepPtr> > > m_remaps;
+  };
+
   typedef std::string InstanceLabel;
-  typedef std::map<cet::map_vector_key, cet::map_vector_key> KeyRemap;
-  typedef std::map<art::Ptr<mu2e::StepPointMC>, art::Ptr<mu2e::StepPointMC> > StepPointMCRemap;
+  typedef PtrMap<SimParticle, art::Ptr<SimParticle> > SimParticleRemap;
+  // The few StepPointMCs of one StrawDigiMC
+  typedef std::vector<std::pair<art::Ptr<mu2e::StepPointMC>, art::Ptr<mu2e::StepPointMC> > > StepPointMCRemap;
 }
 
 
@@ -184,9 +211,8 @@ private:
 
   // For CrvDigiMCs, there's a chance that the same StepPointMC will go into multiple CrvDigiMCs
   // This module didn't take this into account initially and so the same StepPointMC was being written out multiple times
-  // This std::set is used to make sure that this doesn't happen
-  std::set<art::Ptr<StepPointMC> > _crvStepPointMCsSeen;
-  std::map<art::Ptr<StepPointMC>, art::Ptr<StepPointMC> > _crvStepPointMCsMap;
+  // This map of the StepPointMCs already copied is used to make sure that this doesn't happen
+  PtrMap<StepPointMC, art::Ptr<StepPointMC> > _crvStepPointMCsMap;
 };
 
 
@@ -372,7 +398,6 @@ void mu2e::CompressDigiMCs::produce(art::Event & event)
 
 
   if (_crvDigiMCTag != "") {
-    _crvStepPointMCsSeen.clear();
     _crvStepPointMCsMap.clear();
 
     event.getByLabel(_crvDigiMCTag, _crvDigiMCsHandle);
@@ -407,10 +432,9 @@ void mu2e::CompressDigiMCs::produce(art::Event & event)
       art::ProductID i_product_id = oldCaloShowerSteps.id();
       _oldCaloShowerStepGetter[i_product_id] = event.productGetter(i_product_id);
 
-      for (CaloShowerStepCollection::const_iterator i_caloShowerStep = oldCaloShowerSteps->begin(); i_caloShowerStep != oldCaloShowerSteps->end(); ++i_caloShowerStep) {
-        art::Ptr<mu2e::CaloShowerStep> oldShowerStepPtr(i_product_id,  i_caloShowerStep - oldCaloShowerSteps->begin(), _oldCaloShowerStepGetter[i_product_id]);
-        art::Ptr<mu2e::CaloShowerStep> newShowerStepPtr = copyCaloShowerStep(*i_caloShowerStep);
-        caloShowerStepRemap[oldShowerStepPtr] = newShowerStepPtr;
+      auto& newShowerStepPtrs = caloShowerStepRemap.addCollection(i_product_id, oldCaloShowerSteps->size());
+      for (const auto& i_caloShowerStep : *oldCaloShowerSteps) {
+        newShowerStepPtrs.push_back(copyCaloShowerStep(i_caloShowerStep));
       }
     }
 
@@ -454,24 +478,22 @@ void mu2e::CompressDigiMCs::produce(art::Event & event)
   for (std::vector<art::InputTag>::const_iterator i_tag = _extraStepPointMCTags.begin(); i_tag != _extraStepPointMCTags.end(); ++i_tag) {
     const auto& stepPointMCs = event.getValidHandle<StepPointMCCollection>(*i_tag);
     for (const auto& stepPointMC : *stepPointMCs) {
-      for (const auto& simPartsToKeep : _simParticlesToKeep) {
-        const art::ProductID& oldProdID = simPartsToKeep.first;
-        if (stepPointMC.simParticle().id() != oldProdID) {
-          continue;
-        }
-        const SimParticleSet& alreadyKeptSimParts = simPartsToKeep.second;
-        for (const auto& alreadyKeptSimPart : alreadyKeptSimParts) {
-          if (stepPointMC.simParticle() == alreadyKeptSimPart) {
-            copyStepPointMC(stepPointMC, (*i_tag).instance() );
-          }
-        }
+      const auto& simPartsToKeep = _simParticlesToKeep.find(stepPointMC.simParticle().id());
+      if (simPartsToKeep != _simParticlesToKeep.end() && simPartsToKeep->second.count(stepPointMC.simParticle()) != 0) {
+        copyStepPointMC(stepPointMC, (*i_tag).instance() );
       }
     }
   }
 
   // Now compress the SimParticleCollections into their new collections
   KeyRemap* keyRemap = new KeyRemap;
-  SimParticleRemapping remap;
+  SimParticleRemap remap;
+  size_t n_sims_to_keep = 0;
+  for (const auto& simPartsToKeep : _simParticlesToKeep) {
+    n_sims_to_keep += simPartsToKeep.second.size();
+  }
+  remap.reserve(n_sims_to_keep);
+  keyRemap->reserve(n_sims_to_keep);
   unsigned int keep_size = 0;
   for (std::vector<art::InputTag>::const_iterator i_tag = _simParticleTags.begin(); i_tag != _simParticleTags.end(); ++i_tag) {
     keyRemap->clear();
@@ -603,8 +625,9 @@ void mu2e::CompressDigiMCs::produce(art::Event & event)
   if (_mcTrajectoryTag != "") {
     for (const auto& i_mcTrajectory : *_mcTrajectoriesHandle) {
       art::Ptr<SimParticle> oldSimPtr = i_mcTrajectory.first;
-      if (remap.find(oldSimPtr) != remap.end()) {
-        _newMCTrajectories->insert(std::pair<art::Ptr<SimParticle>, mu2e::MCTrajectory>(remap.at(oldSimPtr), i_mcTrajectory.second));
+      const auto& newSimPtrIter = remap.find(oldSimPtr);
+      if (newSimPtrIter != remap.end()) {
+        _newMCTrajectories->insert(std::pair<art::Ptr<SimParticle>, mu2e::MCTrajectory>(newSimPtrIter->second, i_mcTrajectory.second));
       }
     }
   }
@@ -652,39 +675,33 @@ void mu2e::CompressDigiMCs::produce(art::Event & event)
 void mu2e::CompressDigiMCs::copyStrawDigiMC(const mu2e::StrawDigiMC& old_straw_digi_mc) {
 
   StepPointMCRemap step_remap;
+  // copy each StepPointMC of this StrawDigiMC once
+  auto newStepPointMC = [&](const art::Ptr<StepPointMC>& old_step_point) {
+    for (const auto& i_remap : step_remap) {
+      if (i_remap.first == old_step_point) {
+        return i_remap.second;
+      }
+    }
+    if (old_step_point.isAvailable()) {
+      step_remap.emplace_back(old_step_point, copyStepPointMC( *old_step_point, _trackerOutputInstanceLabel ));
+    }
+    else { // this is a null Ptr but it should be added anyway to keep consistency (not expected for StrawDigis)
+      step_remap.emplace_back(old_step_point, old_step_point);
+    }
+    return step_remap.back().second;
+  };
 
   // Need to update the Ptrs for the StepPointMCs
   art::Ptr<StepPointMC> newTriggerStepPtr[StrawEnd::nends];
   for(int i_end=0;i_end<StrawEnd::nends;++i_end){
     StrawEnd::End end = static_cast<StrawEnd::End>(i_end);
-
-    const art::Ptr<StepPointMC>& old_step_point = old_straw_digi_mc.stepPointMC(end);
-    const auto& newStepPtrIter = step_remap.find(old_step_point);
-    if (newStepPtrIter == step_remap.end()) {
-      if (old_step_point.isAvailable()) {
-	step_remap[old_step_point] = copyStepPointMC( *old_step_point, _trackerOutputInstanceLabel );
-      }
-      else { // this is a null Ptr but it should be added anyway to keep consistency (not expected for StrawDigis)
-	step_remap[old_step_point] = old_step_point;
-      }
-    }
-    art::Ptr<StepPointMC> new_step_point = step_remap.at(old_step_point);
-    newTriggerStepPtr[i_end] = new_step_point;
+    newTriggerStepPtr[i_end] = newStepPointMC(old_straw_digi_mc.stepPointMC(end));
   }
 
   std::vector<art::Ptr<StepPointMC> > newWaveformStepPtrs;
+  newWaveformStepPtrs.reserve(old_straw_digi_mc.stepPointMCs().size());
   for (const auto& i_step_mc : old_straw_digi_mc.stepPointMCs()) {
-    const auto& newStepPtrIter = step_remap.find(i_step_mc);
-    if (newStepPtrIter == step_remap.end()) {
-      if (i_step_mc.isAvailable()) {
-	step_remap[i_step_mc] = copyStepPointMC( *i_step_mc, _trackerOutputInstanceLabel );
-      }
-      else { // this is a null Ptr but it should be added anyway to keep consistency (not expected for StrawDigis)
-	step_remap[i_step_mc] = i_step_mc;
-      }
-    }
-    art::Ptr<StepPointMC> new_step_point = step_remap.at(i_step_mc);
-    newWaveformStepPtrs.push_back(new_step_point);
+    newWaveformStepPtrs.push_back(newStepPointMC(i_step_mc));
   }
 
   StrawDigiMC new_straw_digi_mc(old_straw_digi_mc, newTriggerStepPtr, newWaveformStepPtrs); // copy everything except the Ptrs from the old StrawDigiMC
@@ -697,13 +714,14 @@ void mu2e::CompressDigiMCs::copyCrvDigiMC(const mu2e::CrvDigiMC& old_crv_digi_mc
   std::vector<art::Ptr<StepPointMC> > newStepPtrs;
   for (const auto& i_step_mc : old_crv_digi_mc.GetStepPoints()) {
     if (i_step_mc.isAvailable()) {
-      if (_crvStepPointMCsSeen.insert(i_step_mc).second == true) { // if we have inserted this StepPointMCPtrs (i.e. it hasn't already been seen)
+      auto newStepPtrIter = _crvStepPointMCsMap.find(i_step_mc);
+      if (newStepPtrIter == _crvStepPointMCsMap.end()) { // if this StepPointMC hasn't already been seen
         art::Ptr<StepPointMC> newStepPtr = copyStepPointMC(*i_step_mc, _crvOutputInstanceLabel);
         newStepPtrs.push_back(newStepPtr);
-        _crvStepPointMCsMap[i_step_mc] = newStepPtr;
+        _crvStepPointMCsMap.emplace(i_step_mc, newStepPtr);
       }
       else {
-        newStepPtrs.push_back(_crvStepPointMCsMap.at(i_step_mc));
+        newStepPtrs.push_back(newStepPtrIter->second);
       }
     }
     else { // this is a null Ptr but it should be added anyway to keep consistency (expected for CrvDigis)
@@ -806,15 +824,13 @@ art::Ptr<mu2e::StepPointMC> mu2e::CompressDigiMCs::copyStepPointMC(const mu2e::S
 
 void mu2e::CompressDigiMCs::keepSimParticle(const art::Ptr<SimParticle>& sim_ptr) {
 
-  // Also need to add all the parents too
-  _simParticlesToKeep[sim_ptr.id()].insert(sim_ptr);
-  art::Ptr<SimParticle> childPtr = sim_ptr;
-  art::Ptr<SimParticle> parentPtr = childPtr->parent();
+  // Also need to add all the parents too.  A SimParticle that is already kept
+  // has had its parents added, so we can stop there
+  SimParticleSet& simParticlesToKeep = _simParticlesToKeep[sim_ptr.id()];
+  art::Ptr<SimParticle> simPtr = sim_ptr;
 
-  while (parentPtr) {
-    _simParticlesToKeep[sim_ptr.id()].insert(parentPtr);
-    childPtr = parentPtr;
-    parentPtr = parentPtr->parent();
+  while (simPtr && simParticlesToKeep.insert(simPtr).second) {
+    simPtr = simPtr->parent();
   }
 }
 
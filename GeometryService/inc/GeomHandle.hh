@@ -19,10 +19,14 @@ namespace mu2e {
   class GeomHandle
   {
   public:
-    GeomHandle()
+    GeomHandle() : _detector(DetectorSlot<DET>::detector)
     {
-      art::ServiceHandle<GeometryService> sg;
-      _detector = sg->getElement<DET>();
+      // detectors added by the GeometryService are found in their slot; anything
+      // else goes through the service, which also reports the errors
+      if ( _detector == nullptr ) {
+        art::ServiceHandle<GeometryService> sg;
+        _detector = sg->getElement<DET>();
+      }
     }
     ~GeomHandle() { }
 
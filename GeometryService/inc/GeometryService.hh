@@ -10,6 +10,7 @@
 // C++ include files
 #include <string>
 #include <memory>
+#include <vector>
 
 // Framework include files
 #include "fhiclcpp/ParameterSet.h"
@@ -35,6 +36,15 @@ namespace mu2e {
   class Mu2eHall;
   class G4GeometryOptions;
 
+  // Per-type detector slot, filled by the GeometryService when the detector is added in
+  // preBeginRun and cleared when the service goes away.  Lets GeomHandle<DET> resolve the
+  // detector with one pointer load instead of a service lookup plus a string keyed map search.
+  template <class DET>
+  struct DetectorSlot {
+    static inline DET* detector = nullptr;
+    static void reset() { detector = nullptr; }
+  };
+
   class GeometryService {
 public:
     GeometryService(const fhicl::ParameterSet&, art::ActivityRegistry&);
@@ -138,6 +148,9 @@ private:
     // All of the detectors that we know about.
     DetMap _detectors;
 
+    // Reset functions of the DetectorSlots filled by this service.
+    std::vector<void (*)()> _slotResets;
+
     // Keep a count of how many runs we have seen.
     int _run_count;
 
@@ -148,6 +161,7 @@ private:
     // Don't need to expose definition of private template in header
     template <typename DET> void addDetector(std::unique_ptr<DET> d);
     template <typename DETALIAS, typename DET> void addDetectorAliasToBaseClass(std::unique_ptr<DET> d);
+    template <typename DET> void fillSlot(DET* d);
 
     // Some information that is provided through the GeometryService
     // should only be used inside GEANT jobs.  The following method is
@@ -102,6 +102,7 @@ namespace mu2e {
     _pset   (pset),
     standardMu2eDetector_( _pset.get<std::string>("simulatedDetector.tool_type") == "Mu2e"),
     _detectors(),
+    _slotResets(),
     _run_count()
   {
     iRegistry.sPreBeginRun.watch(this, &GeometryService::preBeginRun);
@@ -109,6 +110,8 @@ namespace mu2e {
   }
 
   GeometryService::~GeometryService(){
+    // don't leave dangling pointers in the detector slots
+    for(auto reset : _slotResets) reset();
   }
 
   // This template can be defined here because this is a private method which is only
@@ -121,8 +124,10 @@ namespace mu2e {
                                    << typeid(DET).name() << "\n";
     }
 
+      DET* det = d.get();
       DetectorPtr ptr(d.release());
       _detectors[typeid(DET).name()] = ptr;
+      fillSlot(det);
   }
 
   template <typename DETALIAS, typename DET>
@@ -138,6 +143,14 @@ namespace mu2e {
 
         std::string detectorName= typeid(DETALIAS).name() ;
         _detectors[detectorName] = it->second;
+        fillSlot(dynamic_cast<DETALIAS*>(it->second.get()));
+  }
+
+  template <typename DET>
+  void GeometryService::fillSlot(DET* d)
+  {
+    DetectorSlot<DET>::detector = d;
+    _slotResets.push_back(&DetectorSlot<DET>::reset);
   }
 
   void
@@ -0,0 +1,116 @@
+#ifndef MCDataProducts_CompactStepPointMC_hh
+#define MCDataProducts_CompactStepPointMC_hh
+//
+// A reduced precision copy of a StepPointMC, intended for the large
+// background frame files that are read by the event mixing jobs.
+//
+// All floating point members except the time are stored as float
+// instead of double and the volume id and process code are narrowed
+// to their useful widths.  On disk this roughly halves the size of a step before
+// compression; most of the mixing inputs are StepPointMCs, so this
+// translates directly into file size and I/O time of the mixing jobs.
+//
+// Conversions:
+//   StepPointMC -> CompactStepPointMC  rounds each member to float.
+//   CompactStepPointMC -> StepPointMC  is exact, so a compact step
+//   survives a round trip through the full class unchanged.
+//
+// Float precision is ~1e-7 relative; for positions inside the
+// detector (|x| < 20 m) this is below 2 microns, far below the
+// resolution of any digitization that consumes these steps.  The time
+// stays double: the neutron, photon and DIO frames have step times of
+// 1e5-1e9 ns, where a float can not resolve a ns, and the consumers
+// fold it modulo the microbunch.
+//
+
+#include <cstdint>
+#include <vector>
+#include <ostream>
+
+#include "MCDataProducts/inc/StepPointMC.hh"
+
+namespace mu2e {
+
+  class CompactStepPointMC {
+  public:
+
+    CompactStepPointMC():
+      _track(),
+      _volumeId(0),
+      _totalEnergyDeposit(0.f),
+      _nonIonizingEnergyDeposit(0.f),
+      _x(0.f), _y(0.f), _z(0.f),
+      _px(0.f), _py(0.f), _pz(0.f),
+      _time(0.),
+      _proper(0.f),
+      _stepLength(0.f),
+      _endProcessCode(ProcessCode::unknown){
+    }
+
+    explicit CompactStepPointMC( StepPointMC const& step ):
+      _track(step.simParticle()),
+      _volumeId(step.volumeId()),
+      _totalEnergyDeposit(step.totalEDep()),
+      _nonIonizingEnergyDeposit(step.nonIonizingEDep()),
+      _x(step.position().x()), _y(step.position().y()), _z(step.position().z()),
+      _px(step.momentum().x()), _py(step.momentum().y()), _pz(step.momentum().z()),
+      _time(step.time()),
+      _proper(step.properTime()),
+      _stepLength(step.stepLength()),
+      _endProcessCode(step.endProcessCode().id()){
+    }
+
+    // Expand to the full class.
+    StepPointMC toStepPointMC() const {
+      return StepPointMC( _track, _volumeId,
+                          _totalEnergyDeposit, _nonIonizingEnergyDeposit,
+                          _time, _proper,
+                          position(), momentum(),
+                          _stepLength,
+                          endProcessCode() );
+    }
+
+    // Accesor and modifier; the modifier is needed for event mixing.
+    art::Ptr<SimParticle> const& simParticle() const { return _track; }
+    art::Ptr<SimParticle>&       simParticle()       { return _track; }
+
+    StepPointMC::VolumeId_type volumeId()        const { return _volumeId; }
+    float                      totalEDep()       const { return _totalEnergyDeposit; }
+    float                      nonIonizingEDep() const { return _nonIonizingEnergyDeposit; }
+    CLHEP::Hep3Vector          position()        const { return CLHEP::Hep3Vector(_x,_y,_z); }
+    CLHEP::Hep3Vector          momentum()        const { return CLHEP::Hep3Vector(_px,_py,_pz); }
+    double                     time()            const { return _time; }
+    float                      properTime()      const { return _proper; }
+    float                      stepLength()      const { return _stepLength; }
+    ProcessCode                endProcessCode()  const {
+      return ProcessCode(static_cast<ProcessCode::enum_type>(_endProcessCode));
+    }
+
+    void print( std::ostream& ost, bool doEndl = true ) const;
+
+  private:
+
+    art::Ptr<SimParticle> _track;
+    uint32_t              _volumeId;
+    float                 _totalEnergyDeposit;
+    float                 _nonIonizingEnergyDeposit;
+    float                 _x, _y, _z;
+    float                 _px, _py, _pz;
+    double                _time;
+    float                 _proper;
+    float                 _stepLength;
+    uint16_t              _endProcessCode;
+
+  };
+
+  inline std::ostream& operator<<( std::ostream& ost,
+                                   CompactStepPointMC const& step){
+    step.print(ost,false);
+    return ost;
+  }
+
+  typedef std::vector<mu2e::CompactStepPointMC> CompactStepPointMCCollection;
+
+}
+
+#endif /* MCDataProducts_CompactStepPointMC_hh */
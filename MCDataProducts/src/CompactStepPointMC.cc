@@ -0,0 +1,33 @@
+//
+// A reduced precision copy of a StepPointMC for event mixing inputs.
+//
+
+#include "MCDataProducts/inc/CompactStepPointMC.hh"
+
+using namespace std;
+
+namespace mu2e {
+
+  void CompactStepPointMC::print( ostream& ost, bool doEndl ) const {
+
+    art::ProductID id = ( _track.isNonnull() ) ? _track.id()  : art::ProductID();
+    int key           = ( _track.isNonnull() ) ? _track.key() : -1;
+
+    ost << "  trackId: "                        << "( " << id << "," << key << ")"
+        << "  volumeId: "                       << _volumeId
+        << "  energy deposit: "                 << _totalEnergyDeposit
+        << "  non ionizing energy deposit: "    << _nonIonizingEnergyDeposit
+        << "  position: "                       << position()
+        << "  momentum: "                       << momentum()
+        << "  time: "                           << _time
+        << "  proper time: "                    << _proper
+        << "  step length: "                    << _stepLength
+        << "  end process: "                    << endProcessCode();
+
+    if ( doEndl ){
+      ost << endl;
+    }
+
+  }
+
+} // namespace mu2e
@@ -0,0 +1,81 @@
+//
+// Round trip of StepPointMC through CompactStepPointMC:
+//  - the time is kept exactly, also for the late steps (1e5-1e9 ns)
+//    of the neutron, photon and DIO frames, and so is the time
+//    folded modulo the microbunch;
+//  - the other floating point members are rounded to float;
+//  - a compact step survives a round trip through the full class.
+//
+// Returns a non-zero status if any of the checks fails.
+//
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "MCDataProducts/inc/CompactStepPointMC.hh"
+
+using namespace std;
+using namespace mu2e;
+
+namespace {
+
+  int nfail = 0;
+
+  void check(bool ok, const char* what) {
+    cout << (ok ? "  ok    " : "  FAIL  ") << what << endl;
+    if(!ok) ++nfail;
+  }
+
+  bool sameCompact(CompactStepPointMC const& a, CompactStepPointMC const& b) {
+    return a.volumeId() == b.volumeId() && a.totalEDep() == b.totalEDep()
+      && a.nonIonizingEDep() == b.nonIonizingEDep()
+      && a.position() == b.position() && a.momentum() == b.momentum()
+      && a.time() == b.time() && a.properTime() == b.properTime()
+      && a.stepLength() == b.stepLength() && a.endProcessCode() == b.endProcessCode();
+  }
+
+}
+
+int main() {
+
+  const double mbtime = 1695.; // microbunch period (ns)
+  // early steps, and late steps as in the neutron, photon and DIO frames
+  const vector<double> times = { 0.25, 512.123456789, 1694.987654321,
+                                 1.0e5 + 0.123456, 3.7e6 + 17.000321, 4.2e7 + 0.5,
+                                 3.7e8 + 123.456789, 1.2e9 + 0.000789 };
+
+  bool exactTime(true), exactFolded(true), roundedFloats(true), compactRoundTrip(true);
+  for(size_t i=0; i<times.size(); ++i) {
+    const double t = times[i];
+    StepPointMC step(art::Ptr<SimParticle>(), 1000+i, 1.2345678e-3, 1.e-6,
+                     t, 0.1*t,
+                     CLHEP::Hep3Vector(-3904.123456789, 12.3456789, 10175.987654321),
+                     CLHEP::Hep3Vector(10.123456789, -20.987654321, 95.5),
+                     1.23456789, ProcessCode(ProcessCode::eIoni));
+
+    CompactStepPointMC cstep(step);
+    StepPointMC full = cstep.toStepPointMC();
+
+    exactTime &= full.time() == t;
+    exactFolded &= fmod(full.time(), mbtime) == fmod(t, mbtime);
+    roundedFloats &= full.position() == CLHEP::Hep3Vector(float(step.position().x()),
+                                                          float(step.position().y()),
+                                                          float(step.position().z()))
+      && full.properTime() == float(step.properTime())
+      && full.totalEDep() == float(step.totalEDep());
+    compactRoundTrip &= sameCompact(CompactStepPointMC(full), cstep);
+
+    cout << "  time " << t << " ns: folded " << fmod(t, mbtime)
+         << " ns, after the round trip " << fmod(full.time(), mbtime)
+         << " ns, as float " << fmod(double(float(t)), mbtime) << " ns" << endl;
+  }
+
+  check(exactTime, "the time is kept exactly");
+  check(exactFolded, "the time folded modulo the microbunch is kept exactly");
+  check(roundedFloats, "the other members are rounded to float");
+  check(compactRoundTrip, "a compact step survives a round trip through the full class");
+
+  cout << (nfail == 0 ? "All checks passed" : "Some checks FAILED") << endl;
+  return nfail;
+}
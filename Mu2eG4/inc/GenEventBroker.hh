@@ -55,6 +55,7 @@ class GenEventBroker
     inline EventStash* getEventStash() const { return _stashForEventData; }
     inline int getStashSize() const { return eventStashSize; }//this can only be called after loadEvent is called in produce
     inline art::EDProductGetter const* getSimProductGetter() const { return _simProductGetter; }
+    inline bool usingStash() const { return usingG4MT; }//GenParticleCollections are handed out one per G4 event
     
   private:
     
@@ -23,6 +23,10 @@ namespace mu2e {
     //we need our own versions of these functions in order to correctly control the event loop
     void Mu2eG4WaitForEndEventLoopWorkers();
     void Mu2eG4RunTermination();
+
+    //initialize the master without starting G4's own worker threads;
+    //used when art threads act as the G4 workers (Mu2eG4MT)
+    void Mu2eG4InitializeMaster();
         
   private:
     
@@ -31,6 +31,7 @@ class Mu2eG4RunAction : public G4UserRunAction
 {
   public:
     Mu2eG4RunAction(const fhicl::ParameterSet& pset,
+                    const bool,
                     const bool,
                     CLHEP::Hep3Vector const&,
                     PhysicalVolumeHelper*,
@@ -51,6 +52,7 @@ class Mu2eG4RunAction : public G4UserRunAction
 
     const fhicl::ParameterSet& pset_;
     const bool use_G4MT_;
+    const bool masterFillsProcessInfo_;
     CLHEP::Hep3Vector const& originInWorld;
 
     PhysicalVolumeHelper* _physVolHelper;
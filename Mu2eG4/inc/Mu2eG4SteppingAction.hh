@@ -27,6 +27,7 @@
 // Forward declarations outside of mu2e namespace.
 class G4VPhysicalVolume;
 class G4Track;
+class G4StepPoint;
 
 namespace mu2e {
 
@@ -47,13 +48,26 @@ namespace mu2e {
                          const Mu2eG4TrajectoryControl& tc,
                          const Mu2eG4ResourceLimits& mu2elimits);
 
+    ~Mu2eG4SteppingAction();
+
     void UserSteppingAction(const G4Step*);
 
     void BeginOfEvent(StepPointMCCollection& outputHits, const SimParticleHelper& spHelper);
 
-    void BeginOfTrack();
+    // Trajectory points are only collected if recordTrajectory is true, i.e. if
+    // the track can pass the MCTrajectory momentum cut.
+    void BeginOfTrack(bool recordTrajectory);
     void EndOfTrack();
 
+    // Called before the trajectory is handed to the data product: resolves the
+    // points held back by the online thinning.  trackEnd is the final position of
+    // the track, in the Mu2e coordinate system.
+    void finishTrajectory(CLHEP::Hep3Vector const& trackEnd);
+
+    // The number of points that passed the minimum distance cuts, whether or not
+    // the online thinning kept them.  This is what mcTrajectoryMinSteps is applied to.
+    unsigned numTrajectoryCandidates() const { return numTrajectoryCandidates_; }
+
     int nKilledStepLimit() const { return numKilledTracks_; }
 
     // Called by G4_plugin.
@@ -93,6 +107,11 @@ namespace mu2e {
     int numKilledTracks_;
     bool stepLimitKillerVerbose_;
 
+    // Optional measurement of the time spent evaluating the cuts, printed at the end of job
+    bool timeSteppingCuts_;
+    unsigned long numTimedSteps_;
+    double cutsTime_; // ns
+
     // List of times for time virtual detector
     std::vector<double> tvd_time_;
     StepPointMCCollection* tvd_collection_;
@@ -104,6 +123,16 @@ namespace mu2e {
     VolumeCutMap mcTrajectoryVolumePtDistances_;
     // Store trajectory parameters at each G4Step; cleared at beginOfTrack time.
     std::vector<MCTrajectoryPoint> _trajectory;
+    bool recordTrajectory_;
+    unsigned numTrajectoryCandidates_;
+
+    // Online thinning: points after _trajectory.back() that are held back while
+    // the segment from it to the newest point stays within maxPointDeviation_ of them.
+    double maxPointDeviation_;
+    static constexpr unsigned maxPendingPoints = 64;
+    std::vector<MCTrajectoryPoint> pendingPoints_;
+    unsigned long numCandidatePoints_;
+    unsigned long numKeptPoints_;
 
     // Lists of events and tracks for which to enable debug printout.
     EventNumberList _debugEventList;
@@ -130,6 +159,13 @@ namespace mu2e {
 
     // per-volume or the default
     double mcTrajectoryMinDistanceCut(const G4VPhysicalVolume* vol) const;
+
+    // Apply the distance cut and the online thinning to the start of the current step
+    void addTrajectoryPoint(G4StepPoint const* prept);
+
+    // True if all pending points are within maxPointDeviation_ of the segment
+    // from the last kept point to pos.
+    bool pendingPointsWithin(CLHEP::Hep3Vector const& pos) const;
   };
 
 } // end namespace mu2e
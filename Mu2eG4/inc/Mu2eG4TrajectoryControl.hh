@@ -21,6 +21,9 @@ namespace mu2e {
     unsigned mcTrajectoryMinSteps() const { return mcTrajectoryMinSteps_; }
     double mcTrajectoryMomentumCut() const { return mcTrajectoryMomentumCut_; }
     double saveTrajectoryMomentumCut() const { return saveTrajectoryMomentumCut_; }
+    // Online thinning tolerance: dropped points are within this distance of
+    // the stored polyline.  0 disables the thinning.
+    double maxPointDeviation() const { return maxPointDeviation_; }
     const PerVolumeDistanceMap& perVolumeMinDistance() const { return perVolumeMinDistance_; }
 
   private:
@@ -29,6 +32,7 @@ namespace mu2e {
     unsigned mcTrajectoryMinSteps_;
     double mcTrajectoryMomentumCut_;
     double saveTrajectoryMomentumCut_;
+    double maxPointDeviation_;
     PerVolumeDistanceMap perVolumeMinDistance_;
   };
 
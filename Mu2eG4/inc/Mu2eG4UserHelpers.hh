@@ -27,6 +27,7 @@
 // Mu2e includes
 
 #include "MCDataProducts/inc/SimParticleCollection.hh"
+#include "Mu2eG4/inc/SimParticleStore.hh"
 
 class G4Track;
 class G4Step;
@@ -37,14 +38,13 @@ namespace mu2e {
 
     typedef SimParticleCollection::key_type    key_type;
     typedef SimParticleCollection::mapped_type mapped_type;
-    typedef std::map<key_type,mapped_type>     map_type;
 
     // Check consistency of mother-daughter pointers.
-    bool checkCrossReferences( bool doPrint, bool doThrow, map_type const& transientMap);
+    bool checkCrossReferences( bool doPrint, bool doThrow, SimParticleStore const& transientMap);
 
     // Debug printout.
     void printTrackInfo(G4Track const* const trk, std::string const& text,
-                        map_type const& transientMap,
+                        SimParticleStore const& transientMap,
                         cet::cpu_timer const& timer,
                         CLHEP::Hep3Vector const& mu2eOrigin,
                         bool isEnd=false, bool printTimers=true);
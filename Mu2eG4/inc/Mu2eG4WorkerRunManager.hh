@@ -0,0 +1,95 @@
+#ifndef Mu2eG4_WorkerRunManager_hh
+#define Mu2eG4_WorkerRunManager_hh
+//
+// A G4 worker run manager driven by an art worker thread, used by
+// Mu2eG4MT.  Each Mu2eG4WorkerThread of the module owns one of these;
+// it holds that thread's G4 state (navigators, physics vectors, user
+// actions, sensitive detectors) and simulates one art event at a time
+// on that thread.  The per-event inputs and outputs go through
+// a GenEventBroker and an EventStash of size 1 that belong to the
+// worker, exactly as in sequential Mu2eG4.
+//
+// G4 keeps its per-thread state in thread-local storage, so a worker
+// must only ever be used, and destroyed, on the thread that created it.
+//
+
+// Included from Geant4
+#include "G4WorkerRunManager.hh"
+#include "G4ThreeVector.hh"
+
+// Mu2e includes
+#include "Mu2eG4/inc/GenEventBroker.hh"
+#include "Mu2eG4/inc/EventStash.hh"
+#include "Mu2eG4/inc/SensitiveDetectorHelper.hh"
+#include "Mu2eG4/inc/Mu2eG4ResourceLimits.hh"
+
+#include "fhiclcpp/ParameterSet.h"
+
+#include <memory>
+#include <vector>
+
+namespace mu2e {
+
+  class ActionInitialization;
+  class Mu2eG4MTRunManager;
+  class PhysicalVolumeHelper;
+
+  class Mu2eG4WorkerRunManager : public G4WorkerRunManager {
+  public:
+
+    // Must be called on the thread that will use the worker, after
+    // that thread was set up with setUpThread().
+    Mu2eG4WorkerRunManager(const fhicl::ParameterSet& pset, int threadID);
+    virtual ~Mu2eG4WorkerRunManager();
+
+    // Give this thread its G4 thread id, UI and random engine, and
+    // build its copy of the geometry and physics vectors.  Must be
+    // called before the c'tor, on the same thread.
+    static void setUpThread(int threadID);
+
+    // Release this thread's copy of the geometry and physics vectors.
+    // Must be called after the worker was destroyed, on the same thread.
+    static void tearDownThread();
+
+    // Share the master's geometry and physics, build the user actions
+    // for this thread and initialize the kernel.
+    void initializeThread(Mu2eG4MTRunManager* masterRM,
+                          PhysicalVolumeHelper* physVolHelper,
+                          G4ThreeVector const& originInWorld,
+                          Mu2eG4ResourceLimits const& mu2eLimits,
+                          unsigned stageOffset);
+
+    // Start a G4 run for this thread if the art run has changed since
+    // the last event this thread simulated.
+    void beginRunIfNeeded(unsigned runNumber);
+
+    // End this thread's G4 run, if one is open.
+    void endRunIfNeeded();
+
+    // Simulate one event with the given seeds; the results are left in stash().
+    void processOneArtEvent(G4int eventID, long seed0, long seed1);
+
+    GenEventBroker& broker() { return genEventBroker_; }
+    EventStash& stash() { return stash_; }
+    int threadID() const { return threadID_; }
+
+  private:
+
+    fhicl::ParameterSet const& pset_;
+    int threadID_;
+    bool runStarted_;
+    unsigned runNumber_;
+
+    GenEventBroker genEventBroker_;
+    EventStash stash_;
+    std::vector<SensitiveDetectorHelper> sensitiveDetectorHelpers_;
+    std::unique_ptr<ActionInitialization> actionInit_;
+
+    // Private and unimplemented to prevent copying.
+    Mu2eG4WorkerRunManager( Mu2eG4WorkerRunManager const & );
+    Mu2eG4WorkerRunManager& operator=( Mu2eG4WorkerRunManager const & );
+  };
+
+} // end namespace mu2e
+
+#endif /* Mu2eG4_WorkerRunManager_hh */
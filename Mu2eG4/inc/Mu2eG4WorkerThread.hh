@@ -0,0 +1,54 @@
+#ifndef Mu2eG4_WorkerThread_hh
+#define Mu2eG4_WorkerThread_hh
+//
+// A thread that runs the functions it is given, one at a time, while
+// the caller waits.  Used by Mu2eG4MT: G4 keeps its per-thread state in
+// thread-local storage, so each G4 worker is created, used and
+// destroyed through one Mu2eG4WorkerThread, whatever art thread asks
+// for it.
+//
+// An exception thrown by a function is rethrown to the caller of run().
+//
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace mu2e {
+
+  class Mu2eG4WorkerThread {
+  public:
+
+    Mu2eG4WorkerThread();
+
+    // Waits for the function in progress, if any, and joins the thread.
+    ~Mu2eG4WorkerThread();
+
+    // Run f on this thread and wait for it to finish.  Calls from
+    // several threads are run one after the other.
+    void run(std::function<void()> const& f);
+
+  private:
+
+    void loop();
+
+    std::mutex runMutex_;            // one caller at a time
+    std::mutex mutex_;               // guards the members below
+    std::condition_variable cv_;
+    std::function<void()> const* job_;
+    bool jobDone_;
+    bool stop_;
+    std::exception_ptr error_;
+
+    std::thread thread_;
+
+    // Private and unimplemented to prevent copying.
+    Mu2eG4WorkerThread( Mu2eG4WorkerThread const & );
+    Mu2eG4WorkerThread& operator=( Mu2eG4WorkerThread const & );
+  };
+
+} // end namespace mu2e
+
+#endif /* Mu2eG4_WorkerThread_hh */
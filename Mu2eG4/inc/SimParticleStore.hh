@@ -0,0 +1,87 @@
+// Transient store of the SimParticles created during one G4 event.
+//
+// The keys of the particles made by the current stage are the G4 track
+// IDs plus the stage offset, so they are kept in a vector indexed by
+// key-base with a presence bitmap; G4 numbers its tracks sequentially,
+// so the vector is dense.  Particles with keys below the base, i.e.
+// those copied from the input of a previous stage, go to a std::map.
+// At the end of the event the particles are moved, not copied, into
+// the SimParticleCollection.
+//
+// The storage is kept between events so that its capacity is reused.
+
+#ifndef Mu2eG4_SimParticleStore_hh
+#define Mu2eG4_SimParticleStore_hh
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "MCDataProducts/inc/SimParticle.hh"
+#include "MCDataProducts/inc/SimParticleCollection.hh"
+
+namespace mu2e {
+
+  class SimParticleStore {
+  public:
+    typedef SimParticleCollection::key_type    key_type;
+    typedef SimParticleCollection::mapped_type mapped_type;
+    typedef SimParticleCollection::value_type  value_type;
+
+    SimParticleStore() : _base(0), _size(0) {}
+
+    // Drop the content and set the smallest key of the dense part.
+    void reset(unsigned base);
+
+    std::size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    // Null if the key is not present.
+    mapped_type*       find(key_type key);
+    mapped_type const* find(key_type key) const;
+
+    // Returns false, and does nothing, if the key is already present.
+    bool insert(key_type key, mapped_type&& sim);
+
+    // Default constructs the particle if it is not present; used by compressSimParticleCollection
+    mapped_type& operator[](key_type key);
+
+    // Call f(key, particle) for each particle
+    template <class F> void visit(F f) const {
+      for(auto const& i : _sparse) f(i.first, i.second);
+      for(std::size_t i=0; i<_dense.size(); ++i) {
+        if(_present[i]) f(_dense[i].first, _dense[i].second);
+      }
+    }
+
+    // Move all of the particles into the collection and reset the store.
+    void moveTo(SimParticleCollection& out);
+
+  private:
+    unsigned _base;
+    std::size_t _size;
+    std::vector<value_type> _dense;
+    std::vector<bool> _present;
+    std::map<key_type,mapped_type> _sparse;
+
+    // make room for the dense slot of the key, returns its index
+    std::size_t slot(unsigned key);
+  };
+
+  inline SimParticleStore::mapped_type* SimParticleStore::find(key_type key) {
+    return const_cast<mapped_type*>(static_cast<SimParticleStore const*>(this)->find(key));
+  }
+
+  inline SimParticleStore::mapped_type const* SimParticleStore::find(key_type key) const {
+    unsigned k = key.asUint();
+    if(k >= _base) {
+      std::size_t i = k - _base;
+      return (i < _dense.size() && _present[i]) ? &_dense[i].second : nullptr;
+    }
+    auto i = _sparse.find(key);
+    return (i != _sparse.end()) ? &i->second : nullptr;
+  }
+
+} // end namespace mu2e
+
+#endif /* Mu2eG4_SimParticleStore_hh */
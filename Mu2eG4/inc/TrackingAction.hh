@@ -24,6 +24,7 @@
 #include "Mu2eG4/inc/EventNumberList.hh"
 #include "Mu2eG4/inc/PhysicalVolumeHelper.hh"
 #include "Mu2eG4/inc/PhysicsProcessInfo.hh"
+#include "Mu2eG4/inc/SimParticleStore.hh"
 
 #include "art/Framework/Principal/Event.h"
 #include "art/Framework/Principal/Handle.h"
@@ -90,7 +91,6 @@ namespace mu2e {
 
     typedef SimParticleCollection::key_type    key_type;
     typedef SimParticleCollection::mapped_type mapped_type;
-    typedef std::map<key_type,mapped_type>     map_type;
 
     // Lists of events and tracks for which to enable debug printout.
     EventNumberList _debugList;
@@ -105,9 +105,9 @@ namespace mu2e {
     // Event timer.
     cet::cpu_timer _timer;
 
-    // Information about SimParticles is collected in this map
+    // Information about SimParticles is collected in this store
     // during the operation of G4.  This is not persistent.
-    map_type _transientMap;
+    SimParticleStore _transientMap;
 
     // Non-owning pointer to the collection of trajectories generated by G4.
     MCTrajectoryCollection* _trajectories;
@@ -97,7 +97,8 @@ namespace mu2e {
     {        
     
         int thread_ID = G4Threading::G4GetThreadId();
-        if (G4Threading::IsMasterThread() == true) {
+        //an ActionInitialization owned by a single worker (Mu2eG4MT) has only one set of objects
+        if (G4Threading::IsMasterThread() == true || numthreads == 1) {
             thread_ID = 0;
         }
         
@@ -121,7 +122,10 @@ namespace mu2e {
         TrackingAction* trackingAction = new TrackingAction(pset_, steppingAction, stageOffset, trajectoryControl_, mu2elimits_);
         SetUserAction(trackingAction);
         
-        SetUserAction( new Mu2eG4RunAction(pset_, use_G4MT_, originInWorld, _physVolHelper,
+        //in the stash MT mode BuildForMaster's run action fills the process tables
+        const bool masterFillsProcessInfo = use_G4MT_ && _genEventBroker->usingStash();
+
+        SetUserAction( new Mu2eG4RunAction(pset_, use_G4MT_, masterFillsProcessInfo, originInWorld, _physVolHelper,
                                            physics_Process_Info, trackingAction, steppingAction,
                                            sensitive_Detector_Helper) );
 
@@ -4,6 +4,10 @@
 #include <memory>
 #include <array>
 #include <vector>
+#include <bitset>
+#include <cstdlib>
+#include <map>
+#include <set>
 #include <algorithm>
 
 #include "cetlib_except/exception.h"
@@ -17,6 +21,7 @@
 #include "G4Track.hh"
 #include "G4Step.hh"
 #include "G4VProcess.hh"
+#include "G4VPhysicalVolume.hh"
 
 #include "Mu2eG4/inc/IMu2eG4Cut.hh"
 #include "Mu2eG4/inc/Mu2eG4ResourceLimits.hh"
@@ -35,6 +40,9 @@ namespace mu2e {
     using namespace std;
     typedef std::vector<fhicl::ParameterSet> PSVector;
 
+    // Build the cut tree described by pset, one IMu2eG4Cut object per node
+    std::unique_ptr<IMu2eG4Cut> createCutTree(const fhicl::ParameterSet& pset, const Mu2eG4ResourceLimits& lim);
+
     //================================================================
     // A common implementation for some of the required IMu2eG4Cut methods
     class IOHelper: virtual public IMu2eG4Cut {
@@ -171,7 +179,7 @@ namespace mu2e {
     {
       PSVector pars = pset.get<PSVector>("pars");
       for(const auto& p: pars) {
-        cuts_.emplace_back(createMu2eG4Cuts(p, lim));
+        cuts_.emplace_back(createCutTree(p, lim));
       }
     }
 
@@ -262,7 +270,7 @@ namespace mu2e {
     {
       PSVector pars = pset.get<PSVector>("pars");
       for(const auto& p: pars) {
-        cuts_.emplace_back(createMu2eG4Cuts(p, lim));
+        cuts_.emplace_back(createCutTree(p, lim));
       }
     }
 
@@ -731,37 +739,393 @@ namespace mu2e {
     }
 
     //================================================================
-  } // end namespace Mu2eG4Cuts
+    // An IOHelper that only manages the output of one writing node of a CompiledCut
+    class Output: virtual public IMu2eG4Cut,
+                  public IOHelper
+    {
+    public:
+      virtual bool steppingActionCut(const G4Step  *step) { return false; }
+      virtual bool stackingActionCut(const G4Track *trk) { return false; }
 
-  //================================================================
-  std::unique_ptr<IMu2eG4Cut> createMu2eG4Cuts(const fhicl::ParameterSet& pset, const Mu2eG4ResourceLimits& lim) {
-    using namespace Mu2eG4Cuts;
+      Output(const fhicl::ParameterSet& pset, const Mu2eG4ResourceLimits& lim)
+        : IOHelper(pset, lim)
+      {}
 
-    if(pset.is_empty()) return make_unique<Constant>(false, lim); // no cuts
+      void record(const G4Step *step) {
+        if(steppingOutput_) {
+          addHit(step);
+        }
+      }
+    };
+
+    //================================================================
+    // Set of PDG ids: a bit array for the common particles, a sorted
+    // vector for the rest (nuclei etc.)
+    class PdgIdSet {
+    public:
+      static constexpr int kDense = 4096;
+
+      explicit PdgIdSet(const std::vector<int>& ids) {
+        for(int id: ids) {
+          if(std::abs(id) < kDense) dense_.set(id+kDense);
+          else sparse_.push_back(id);
+        }
+        std::sort(sparse_.begin(), sparse_.end());
+      }
+
+      bool contains(int id) const {
+        return (std::abs(id) < kDense) ? dense_.test(id+kDense)
+          : std::binary_search(sparse_.begin(), sparse_.end(), id);
+      }
+
+    private:
+      std::bitset<2*kDense> dense_;
+      std::vector<int> sparse_;
+    };
+
+    //================================================================
+    // The whole cut tree compiled into a flat program when the job starts.
+    // Every leaf predicate becomes one instruction with explicit jump targets
+    // for its true and false outcomes, so that the union and intersection
+    // short circuits are encoded in the jumps and the evaluation is a single
+    // loop without virtual calls.  A node that writes StepPointMCs gets a
+    // kWrite instruction on its true exit.
+    //
+    // Within a run of sibling cuts that do not write anything the cheaper
+    // predicates are evaluated first.  The writing siblings keep their place,
+    // so the recorded hits are the same as with the cut tree.
+    class CompiledCut: virtual public IMu2eG4Cut {
+    public:
+      virtual bool steppingActionCut(const G4Step  *step) override;
+      virtual bool stackingActionCut(const G4Track *trk) override;
+
+      virtual void declareProducts(art::ProducesCollector& collector) override;
+      virtual void finishConstruction(const CLHEP::Hep3Vector& mu2eOriginInWorld) override;
+      virtual void beginEvent(const art::Event& evt, const SimParticleHelper& spHelper) override;
+      virtual void insertCutsDataIntoStash(int g4event_identifier, EventStash* stash_for_event_data) override;
+      virtual void deleteCutsData() override;
+
+      explicit CompiledCut(const fhicl::ParameterSet& pset, const Mu2eG4ResourceLimits& lim);
+
+    private:
+      enum Opcode { kPrimary, kKineticEnergy, kGlobalTime, kPdgId, kCharged, kNeutral,
+                    kVolume, kPlane, kObserverPlane, kWrite };
+
+      // jump targets that terminate the evaluation
+      enum Target { kFalse = -1, kTrue = -2 };
+
+      struct Instruction {
+        Opcode op;
+        bool negate;
+        unsigned index;  // into the per-opcode parameter vectors
+        double value;    // energy or time cut
+        int onTrue;
+        int onFalse;
+      };
+
+      const Mu2eG4ResourceLimits *mu2elimits_;
+      std::vector<Instruction> program_;
+      int entry_;
+
+      std::vector<std::unique_ptr<Output> > outputs_;
+      std::vector<PdgIdSet> pdgIdSets_;
+      std::vector<PlaneHelper> planes_;
+
+      // killer volumes: bit arrays indexed by the physical volume instance ID
+      std::vector<std::vector<std::string> > volumeNames_;
+      std::vector<std::vector<bool> > volumeBits_;
+
+      // charged (1), neutral (0) or not yet known (-1) for the common PDG ids
+      std::vector<signed char> chargeCache_;
+      std::map<int,bool> chargeCacheSparse_;
+      std::unique_ptr<GlobalConstantsHandle<ParticleDataTable> > pdt_;
+
+      int compile(const fhicl::ParameterSet& pset, int onTrue, int onFalse);
+      int emit(Opcode op, bool negate, unsigned index, double value, int onTrue, int onFalse);
+      static bool writes(const fhicl::ParameterSet& pset);
+      static int cost(const fhicl::ParameterSet& pset);
+
+      bool isCharged(int pdgId);
+      bool run(const G4Track* trk, const CLHEP::Hep3Vector& pos, const G4Step* step);
+    };
+
+    CompiledCut::CompiledCut(const fhicl::ParameterSet& pset, const Mu2eG4ResourceLimits& lim)
+      : mu2elimits_(&lim)
+      , entry_(kFalse)
+      , chargeCache_(2*PdgIdSet::kDense, -1)
+    {
+      entry_ = compile(pset, kTrue, kFalse);
+    }
+
+    bool CompiledCut::writes(const fhicl::ParameterSet& pset) {
+      if(!pset.get<string>("write", "").empty()) return true;
+      const string cuttype = pset.get<string>("type");
+      if((cuttype == "union") || (cuttype == "intersection")) {
+        for(const auto& p: pset.get<PSVector>("pars")) {
+          if(writes(p)) return true;
+        }
+      }
+      return false;
+    }
+
+    // rough relative cost of evaluating a cut, used to order the siblings
+    int CompiledCut::cost(const fhicl::ParameterSet& pset) {
+      const string cuttype = pset.get<string>("type");
+      if((cuttype == "union") || (cuttype == "intersection")) {
+        int sum = 0;
+        for(const auto& p: pset.get<PSVector>("pars")) {
+          sum += cost(p);
+        }
+        return sum;
+      }
+      if(cuttype == "constant") return 0;
+      if((cuttype == "primary") || (cuttype == "kineticEnergy") || (cuttype == "globalTime")) return 1;
+      if((cuttype == "pdgId") || (cuttype == "notPdgId")) return 2;
+      if((cuttype == "inVolume") || (cuttype == "notInVolume")) return 2;
+      if((cuttype == "plane") || (cuttype == "isCharged") || (cuttype == "isNeutral")) return 3;
+      return 6;
+    }
+
+    int CompiledCut::emit(Opcode op, bool negate, unsigned index, double value, int onTrue, int onFalse) {
+      program_.push_back(Instruction{op, negate, index, value, onTrue, onFalse});
+      return program_.size() - 1;
+    }
+
+    // Compile the cut described by pset, continuing at onTrue or onFalse
+    // depending on its result.  Returns the entry point of the cut.
+    int CompiledCut::compile(const fhicl::ParameterSet& pset, int onTrue, int onFalse) {
+      const string cuttype =  pset.get<string>("type");
+
+      // hits are recorded when the cut is satisfied
+      int onPass = onTrue;
+      if(!pset.get<string>("write", "").empty()) {
+        outputs_.emplace_back(make_unique<Output>(pset, *mu2elimits_));
+        const int next = (cuttype == "constant") ? (pset.get<bool>("value") ? onTrue : onFalse)
+          : (cuttype == "observerPlane") ? (pset.get<bool>("doNotCut") ? onFalse : onTrue)
+          : onTrue;
+        onPass = emit(kWrite, false, outputs_.size()-1, 0., next, next);
+      }
+
+      if((cuttype == "union") || (cuttype == "intersection")) {
+        const bool isUnion = (cuttype == "union");
+        PSVector pars = pset.get<PSVector>("pars");
+
+        // cheaper cuts first, within each run of siblings that don't write
+        auto begin = pars.begin();
+        while(begin != pars.end()) {
+          auto end = std::find_if(begin, pars.end(), writes);
+          std::stable_sort(begin, end, [](const fhicl::ParameterSet& a, const fhicl::ParameterSet& b)
+                           { return cost(a) < cost(b); });
+          begin = (end == pars.end()) ? end : end + 1;
+        }
+
+        // compile backwards so that the entry point of the next sibling is known
+        int next = isUnion ? onFalse : onPass; // an empty union is false, an empty intersection true
+        for(auto p = pars.rbegin(); p != pars.rend(); ++p) {
+          next = isUnion ? compile(*p, onPass, next) : compile(*p, next, onFalse);
+        }
+        return next;
+      }
+
+      if(cuttype == "constant") {
+        return (onPass != onTrue) ? onPass : (pset.get<bool>("value") ? onTrue : onFalse);
+      }
+
+      if(cuttype == "observerPlane") {
+        planes_.emplace_back(pset);
+        const int pass = (onPass != onTrue) ? onPass : (pset.get<bool>("doNotCut") ? onFalse : onTrue);
+        return emit(kObserverPlane, false, planes_.size()-1, 0., pass, onFalse);
+      }
+
+      if(cuttype == "plane") {
+        planes_.emplace_back(pset);
+        return emit(kPlane, false, planes_.size()-1, 0., onPass, onFalse);
+      }
+
+      if((cuttype == "inVolume") || (cuttype == "notInVolume")) {
+        volumeNames_.emplace_back(pset.get<std::vector<std::string> >("pars"));
+        return emit(kVolume, cuttype == "notInVolume", volumeNames_.size()-1, 0., onPass, onFalse);
+      }
+
+      if((cuttype == "pdgId") || (cuttype == "notPdgId")) {
+        pdgIdSets_.emplace_back(pset.get<std::vector<int> >("pars"));
+        return emit(kPdgId, cuttype == "notPdgId", pdgIdSets_.size()-1, 0., onPass, onFalse);
+      }
 
-    const string cuttype =  pset.get<string>("type");
+      if((cuttype == "isCharged") || (cuttype == "isNeutral")) {
+        if(!pdt_) pdt_ = make_unique<GlobalConstantsHandle<ParticleDataTable> >();
+        return emit(cuttype == "isCharged" ? kCharged : kNeutral, false, 0, 0., onPass, onFalse);
+      }
 
-    if(cuttype == "union") return make_unique<Union>(pset, lim);
-    if(cuttype == "intersection") return make_unique<Intersection>(pset, lim);
-    if(cuttype == "plane") return make_unique<Plane>(pset, lim);
-    if(cuttype == "observerPlane") return make_unique<ObserverPlane>(pset, lim);
+      if(cuttype == "kineticEnergy") return emit(kKineticEnergy, false, 0, pset.get<double>("cut"), onPass, onFalse);
+      if(cuttype == "globalTime") return emit(kGlobalTime, false, 0, pset.get<double>("cut"), onPass, onFalse);
+      if(cuttype == "primary") return emit(kPrimary, false, 0, 0., onPass, onFalse);
 
-    if(cuttype == "inVolume") return make_unique<VolumeCut>(pset, false, lim);
-    if(cuttype == "notInVolume") return make_unique<VolumeCut>(pset, true, lim);
+      throw cet::exception("CONFIG")<< "mu2e::createMu2eG4Cuts(): can not parse pset = "<<pset.to_string()<<"\n";
+    }
 
-    if(cuttype == "pdgId") return make_unique<ParticleIdCut>(pset, false, lim);
-    if(cuttype == "notPdgId") return make_unique<ParticleIdCut>(pset, true, lim);
+    bool CompiledCut::isCharged(int pdgId) {
+      signed char* cached = (std::abs(pdgId) < PdgIdSet::kDense) ? &chargeCache_[pdgId+PdgIdSet::kDense] : nullptr;
+      if(cached && (*cached >= 0)) return *cached;
+      if(!cached) {
+        const auto citer = chargeCacheSparse_.find(pdgId);
+        if(citer != chargeCacheSparse_.end()) return citer->second;
+      }
 
-    if(cuttype == "isNeutral") return make_unique<ParticleChargeCut<AcceptNeutral> >(pset, lim);
-    if(cuttype == "isCharged") return make_unique<ParticleChargeCut<AcceptCharged> >(pset, lim);
+      ParticleDataTable::maybe_ref info = (*pdt_)->particle(pdgId);
+      if(!info.isValid()) {
+        throw cet::exception("RUNTIME")<<"ParticleDataTable does onot have information for pdgId = "
+                                       << pdgId
+                                       << " in file "<<__FILE__<<" line "<<__LINE__
+                                       <<" function "<<__func__<<"()\n";
+      }
+      const bool result = AcceptCharged()(info.ref().charge());
+      if(cached) *cached = result;
+      else chargeCacheSparse_[pdgId] = result;
+      return result;
+    }
 
-    if(cuttype == "kineticEnergy") return make_unique<KineticEnergy>(pset, lim);
-    if(cuttype == "globalTime") return make_unique<GlobalTime>(pset, lim);
-    if(cuttype == "primary") return make_unique<PrimaryOnly>(pset, lim);
+    // step is null when called from the stacking action
+    bool CompiledCut::run(const G4Track* trk, const CLHEP::Hep3Vector& pos, const G4Step* step) {
+      int pc = entry_;
+      while(pc >= 0) {
+        const Instruction& in = program_[pc];
+        bool result = false;
+        switch(in.op) {
+        case kPrimary:
+          result = (trk->GetParentID() != 0);
+          break;
+        case kKineticEnergy:
+          result = (trk->GetKineticEnergy() < in.value);
+          break;
+        case kGlobalTime:
+          result = (trk->GetGlobalTime() > in.value);
+          break;
+        case kPdgId:
+          result = (pdgIdSets_[in.index].contains(trk->GetDefinition()->GetPDGEncoding()) != in.negate);
+          break;
+        case kCharged:
+          result = isCharged(trk->GetDefinition()->GetPDGEncoding());
+          break;
+        case kNeutral:
+          result = !isCharged(trk->GetDefinition()->GetPDGEncoding());
+          break;
+        case kVolume: {
+          // new primaries at stacking have no volume yet: they are not in any volume
+          const std::vector<bool>& bits = volumeBits_[in.index];
+          const G4VPhysicalVolume* vol = trk->GetVolume();
+          const bool inside = vol && (unsigned(vol->GetInstanceID()) < bits.size()) && bits[vol->GetInstanceID()];
+          result = inside != in.negate;
+          break;
+        }
+        case kPlane:
+          result = planes_[in.index].cut_impl(pos);
+          break;
+        case kObserverPlane:
+          // observer planes never cut in the stacking action
+          result = step
+            && planes_[in.index].cut_impl(step->GetPostStepPoint()->GetPosition())
+            && !planes_[in.index].cut_impl(step->GetPreStepPoint()->GetPosition());
+          break;
+        case kWrite:
+          // stacking cuts do not write
+          if(step) outputs_[in.index]->record(step);
+          break;
+        }
+        pc = result ? in.onTrue : in.onFalse;
+      }
+      return pc == kTrue;
+    }
+
+    bool CompiledCut::steppingActionCut(const G4Step *step) {
+      return run(step->GetTrack(), step->GetPostStepPoint()->GetPosition(), step);
+    }
+
+    bool CompiledCut::stackingActionCut(const G4Track *trk) {
+      return run(trk, trk->GetPosition(), nullptr);
+    }
+
+    void CompiledCut::declareProducts(art::ProducesCollector& collector) {
+      for(auto& out: outputs_) {
+        out->declareProducts(collector);
+      }
+    }
+
+    void CompiledCut::finishConstruction(const CLHEP::Hep3Vector& mu2eOriginInWorld) {
+      for(auto& out: outputs_) {
+        out->finishConstruction(mu2eOriginInWorld);
+      }
+      // The volumes exist only after G4 geometry is constructed
+      volumeBits_.clear();
+      for(const auto& names: volumeNames_) {
+        std::vector<bool> bits;
+        for(const auto& vol: names) {
+          const unsigned id = getPhysicalVolumeOrThrow(vol)->GetInstanceID();
+          if(id >= bits.size()) bits.resize(id+1, false);
+          bits[id] = true;
+        }
+        volumeBits_.emplace_back(std::move(bits));
+      }
+    }
+
+    void CompiledCut::beginEvent(const art::Event& evt, const SimParticleHelper& spHelper) {
+      for(auto& out: outputs_) {
+        out->beginEvent(evt, spHelper);
+      }
+    }
+
+    void CompiledCut::insertCutsDataIntoStash(int g4event_identifier, EventStash* stash_for_event_data) {
+      for(auto& out: outputs_) {
+        out->insertCutsDataIntoStash(g4event_identifier, stash_for_event_data);
+      }
+    }
+
+    void CompiledCut::deleteCutsData() {
+      for(auto& out: outputs_) {
+        out->deleteCutsData();
+      }
+    }
+
+    //================================================================
+    std::unique_ptr<IMu2eG4Cut> createCutTree(const fhicl::ParameterSet& pset, const Mu2eG4ResourceLimits& lim) {
+      const string cuttype =  pset.get<string>("type");
+
+      if(cuttype == "union") return make_unique<Union>(pset, lim);
+      if(cuttype == "intersection") return make_unique<Intersection>(pset, lim);
+      if(cuttype == "plane") return make_unique<Plane>(pset, lim);
+      if(cuttype == "observerPlane") return make_unique<ObserverPlane>(pset, lim);
+
+      if(cuttype == "inVolume") return make_unique<VolumeCut>(pset, false, lim);
+      if(cuttype == "notInVolume") return make_unique<VolumeCut>(pset, true, lim);
+
+      if(cuttype == "pdgId") return make_unique<ParticleIdCut>(pset, false, lim);
+      if(cuttype == "notPdgId") return make_unique<ParticleIdCut>(pset, true, lim);
+
+      if(cuttype == "isNeutral") return make_unique<ParticleChargeCut<AcceptNeutral> >(pset, lim);
+      if(cuttype == "isCharged") return make_unique<ParticleChargeCut<AcceptCharged> >(pset, lim);
+
+      if(cuttype == "kineticEnergy") return make_unique<KineticEnergy>(pset, lim);
+      if(cuttype == "globalTime") return make_unique<GlobalTime>(pset, lim);
+      if(cuttype == "primary") return make_unique<PrimaryOnly>(pset, lim);
+
+      if(cuttype == "constant") return make_unique<Constant>(pset, lim);
+
+      throw cet::exception("CONFIG")<< "mu2e::createMu2eG4Cuts(): can not parse pset = "<<pset.to_string()<<"\n";
+    }
+
+    //================================================================
+  } // end namespace Mu2eG4Cuts
+
+  //================================================================
+  // The cut tree is compiled unless the top level pset says "compile: false"
+  std::unique_ptr<IMu2eG4Cut> createMu2eG4Cuts(const fhicl::ParameterSet& pset, const Mu2eG4ResourceLimits& lim) {
+    using namespace Mu2eG4Cuts;
+
+    if(pset.is_empty()) return make_unique<Constant>(false, lim); // no cuts
 
-    if(cuttype == "constant") return make_unique<Constant>(pset, lim);
+    if(pset.get<bool>("compile", true)) return make_unique<CompiledCut>(pset, lim);
 
-    throw cet::exception("CONFIG")<< "mu2e::createMu2eG4Cuts(): can not parse pset = "<<pset.to_string()<<"\n";
+    return createCutTree(pset, lim);
   }
 
 } // end namespace mu2e
@@ -51,4 +51,17 @@ namespace mu2e {
         G4RunManager::TerminateEventLoop();
         G4RunManager::RunTermination();
     }
+    //G4MTRunManager::Initialize() ends with BeamOn(0), which creates and starts
+    //the G4 worker threads.  Here only the master is initialized; the pieces of
+    //InitializeEventLoop that the workers rely on are done by hand.
+    void Mu2eG4MTRunManager::Mu2eG4InitializeMaster()
+    {
+      if ( verboseLevel > 0 ) {
+        G4cout << __func__ << " called" << G4endl;
+      }
+        G4RunManager::Initialize();
+        MTkernel->SetUpDecayChannels();
+        PrepareCommandsStack();
+    }
+
 } // end namespace artg4
@@ -0,0 +1,534 @@
+// A Producer Module that runs Geant4 on art worker threads and adds its
+// output to the event.
+//
+// Unlike Mu2eG4 in runinMTMode, which simulates a whole stash of
+// GenParticleCollections inside one art event and hands the results
+// out over the following events, each art event is simulated by one
+// of a pool of G4 workers while the art thread that runs the module
+// waits for it.  The concurrency is set by art (-j / services.scheduler),
+// there is no stash and the generator writes one ordinary
+// GenParticleCollection per event.
+//
+// Notes:
+// 1) The G4 master is initialized once, in the first beginRun.  A G4
+//    worker is created when an event finds all the others busy, so
+//    there are at most as many workers as art threads.  G4 keeps its
+//    per-thread state in thread-local storage, so each worker lives
+//    on a thread of its own, a Mu2eG4WorkerThread, which creates,
+//    uses and destroys it; see Mu2eG4WorkerRunManager.
+// 2) The random seeds of an event are derived from the SeedService
+//    seed of this module and the art::EventID only, so the output of
+//    an event does not depend on the number of threads or on which
+//    thread simulated it.
+// 3) Visualization and storing of physics tables are only supported
+//    by Mu2eG4.
+//
+
+// Mu2e includes
+#include "MCDataProducts/inc/GenParticleCollection.hh"
+#include "Mu2eHallGeom/inc/Mu2eHall.hh"
+#include "Mu2eG4/inc/WorldMaker.hh"
+#include "Mu2eG4/inc/Mu2eWorld.hh"
+#include "Mu2eG4/inc/Mu2eStudyWorld.hh"
+#include "Mu2eG4/inc/IMu2eG4Cut.hh"
+#include "Mu2eG4/inc/SensitiveDetectorHelper.hh"
+#include "GeometryService/inc/GeometryService.hh"
+#include "GeometryService/inc/GeomHandle.hh"
+#include "GeometryService/inc/WorldG4.hh"
+#include "Mu2eG4/inc/ActionInitialization.hh"
+#include "Mu2eG4/inc/PhysicalVolumeHelper.hh"
+#include "Mu2eG4/inc/physicsListDecider.hh"
+#include "Mu2eG4/inc/preG4InitializeTasks.hh"
+#include "ConfigTools/inc/ConfigFileLookupPolicy.hh"
+#include "SeedService/inc/SeedService.hh"
+#include "Mu2eG4/inc/Mu2eG4ResourceLimits.hh"
+#include "Mu2eG4/inc/Mu2eG4TrajectoryControl.hh"
+#include "Mu2eG4/inc/Mu2eG4MultiStageParameters.hh"
+#include "Mu2eG4/inc/checkConfigRelics.hh"
+#include "Mu2eG4/inc/GenEventBroker.hh"
+#include "Mu2eG4/inc/EventStash.hh"
+#include "Mu2eG4/inc/Mu2eG4MTRunManager.hh"
+#include "Mu2eG4/inc/Mu2eG4WorkerRunManager.hh"
+#include "Mu2eG4/inc/Mu2eG4WorkerThread.hh"
+
+// Data products that will be produced by this module.
+#include "MCDataProducts/inc/StepPointMCCollection.hh"
+#include "MCDataProducts/inc/SimParticleCollection.hh"
+#include "MCDataProducts/inc/PhysicalVolumeInfoMultiCollection.hh"
+#include "MCDataProducts/inc/StatusG4.hh"
+#include "MCDataProducts/inc/StepInstanceName.hh"
+#include "MCDataProducts/inc/ExtMonFNALSimHitCollection.hh"
+#include "MCDataProducts/inc/MCTrajectoryCollection.hh"
+#include "MCDataProducts/inc/SimParticleRemapping.hh"
+
+// From art and its tool chain.
+#include "art/Framework/Principal/Event.h"
+#include "art/Framework/Principal/Handle.h"
+#include "art/Framework/Principal/Run.h"
+#include "art/Framework/Principal/SubRun.h"
+#include "art/Framework/Core/SharedProducer.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "canvas/Utilities/InputTag.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+// Geant4 includes
+#include "G4UImanager.hh"
+#include "G4VUserPhysicsList.hh"
+#include "G4ParticleHPManager.hh"
+#include "G4HadronicProcessStore.hh"
+
+// C++ includes.
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+  art::InputTag const invalid_tag{};
+
+  // splitmix64 finalizer
+  uint64_t mixBits(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+
+  // See Note 2.  The seeds are positive and never 0, which would
+  // terminate the seed list given to the engine.
+  std::array<long,2> eventSeeds(uint64_t baseSeed, art::EventID const& id) {
+    uint64_t h = mixBits(baseSeed);
+    h = mixBits(h ^ id.run());
+    h = mixBits(h ^ id.subRun());
+    h = mixBits(h ^ id.event());
+    const uint64_t h2 = mixBits(h);
+    return { { static_cast<long>(h >> 33) + 1, static_cast<long>(h2 >> 33) + 1 } };
+  }
+}
+
+namespace mu2e {
+
+  class Mu2eG4MT : public art::SharedProducer {
+  public:
+    Mu2eG4MT(fhicl::ParameterSet const& pSet, art::ProcessingFrame const&);
+
+  private:
+    void produce(art::Event& e, art::ProcessingFrame const&) override;
+    void endJob(art::ProcessingFrame const&) override;
+    void beginRun(art::Run &r, art::ProcessingFrame const&) override;
+    void endRun(art::Run &, art::ProcessingFrame const&) override;
+    void beginSubRun(art::SubRun &sr, art::ProcessingFrame const&) override;
+
+    // Do the G4 initialization that must be done only once per job, not once per run
+    void initializeG4( GeometryService& geom, art::Run const& run );
+
+    // A G4 worker and the thread it lives on.  See Note 1.
+    struct Worker {
+      Mu2eG4WorkerThread thread;
+      std::unique_ptr<Mu2eG4WorkerRunManager> runManager;
+    };
+
+    // Take a worker that is not simulating an event, creating one if
+    // they are all busy, and give it back when the event is done.
+    Worker& acquireWorker();
+    void releaseWorker(Worker& worker);
+
+    // Simulate the event with the given worker and put the output into it.
+    void simulate(Worker& worker, art::Event& event);
+
+    fhicl::ParameterSet pset_;
+
+    Mu2eG4ResourceLimits mu2elimits_;
+    Mu2eG4TrajectoryControl trajectoryControl_;
+    Mu2eG4MultiStageParameters multiStagePars_;
+
+    //these cut objects are used only to declare the data products;
+    //the ones used in the simulation are owned by the workers
+    std::unique_ptr<IMu2eG4Cut> stackingCuts_;
+    std::unique_ptr<IMu2eG4Cut> steppingCuts_;
+    std::unique_ptr<IMu2eG4Cut> commonCuts_;
+
+    int _rmvlevel;
+    string _g4Macro;
+    art::InputTag _generatorModuleLabel;
+
+    // Instance name of the timeVD StepPointMC data product.
+    const StepInstanceName _tvdOutputName;
+    std::vector<double> timeVDtimes_;
+
+    const bool    _standardMu2eDetector;
+    G4ThreeVector _originInWorld;
+
+    SeedService::seed_t baseSeed_;
+
+    std::unique_ptr<Mu2eG4MTRunManager> _masterRunManager;
+    G4VUserPhysicsList* physicsList_;
+
+    // Used by the master to declare products and set up the InstanceMap
+    std::vector<SensitiveDetectorHelper> _masterSDHelper;
+    PhysicalVolumeHelper _physVolHelper;
+
+    bool _g4Initialized;
+
+    std::mutex _workersMutex; // guards _workers and _freeWorkers
+    std::vector<std::unique_ptr<Worker> > _workers;
+    std::vector<Worker*> _freeWorkers;
+
+    // Worker initialization fills the shared master SensitiveDetectorHelper
+    std::mutex _workerInitMutex;
+
+    std::atomic<int> numExcludedEvents;
+
+  }; // end G4 header
+
+  Mu2eG4MT::Mu2eG4MT(fhicl::ParameterSet const& pSet, art::ProcessingFrame const&):
+    SharedProducer{pSet},
+    pset_(pSet),
+    mu2elimits_(pSet.get<fhicl::ParameterSet>("ResourceLimits")),
+    trajectoryControl_(pSet.get<fhicl::ParameterSet>("TrajectoryControl")),
+    multiStagePars_(pSet.get<fhicl::ParameterSet>("MultiStageParameters")),
+
+    stackingCuts_(createMu2eG4Cuts(pSet.get<fhicl::ParameterSet>("Mu2eG4StackingOnlyCut", {}), mu2elimits_)),
+    steppingCuts_(createMu2eG4Cuts(pSet.get<fhicl::ParameterSet>("Mu2eG4SteppingOnlyCut", {}), mu2elimits_)),
+    commonCuts_(createMu2eG4Cuts(pSet.get<fhicl::ParameterSet>("Mu2eG4CommonCut", {}), mu2elimits_)),
+
+    _rmvlevel(pSet.get<int>("debug.diagLevel",0)),
+    _g4Macro(pSet.get<std::string>("g4Macro","")),
+    _generatorModuleLabel(pSet.get<std::string>("generatorModuleLabel", "")),
+    _tvdOutputName(StepInstanceName::timeVD),
+    timeVDtimes_(pSet.get<std::vector<double> >("SDConfig.TimeVD.times")),
+    _standardMu2eDetector((art::ServiceHandle<GeometryService>())->isStandardMu2eDetector()),
+    baseSeed_(art::ServiceHandle<SeedService>()->getSeed()),
+    _masterRunManager(std::make_unique<Mu2eG4MTRunManager>()),
+    physicsList_(nullptr),
+    _physVolHelper(),
+    _g4Initialized(false),
+    numExcludedEvents(0)
+    {
+      if((_generatorModuleLabel == art::InputTag()) && multiStagePars_.genInputHits().empty()) {
+        throw cet::exception("CONFIG")
+          << "Error: both generatorModuleLabel and genInputHits are empty - nothing to do!\n";
+      }
+
+      _masterSDHelper.emplace_back(pSet.get<fhicl::ParameterSet>("SDConfig", fhicl::ParameterSet()));
+
+      auto& collector = producesCollector();
+      _masterSDHelper.front().declareProducts(collector);
+
+      produces<StatusG4>();
+      produces<SimParticleCollection>();
+
+      if(!timeVDtimes_.empty()) {
+        produces<StepPointMCCollection>(_tvdOutputName.name());
+      }
+
+      if(trajectoryControl_.produce()) {
+        produces<MCTrajectoryCollection>();
+      }
+
+      if(multiStagePars_.multiStage()) {
+        produces<SimParticleRemapping>();
+      }
+
+      stackingCuts_->declareProducts(collector);
+      steppingCuts_->declareProducts(collector);
+      commonCuts_->declareProducts(collector);
+
+      // Declare which products this module will read.
+      auto const& inputPhysVolTag = multiStagePars_.inputPhysVolumeMultiInfo();
+      if (inputPhysVolTag != invalid_tag) {
+        consumes<PhysicalVolumeInfoMultiCollection, art::InSubRun>(inputPhysVolTag);
+      }
+      auto const& inputSimParticlesTag = multiStagePars_.inputSimParticles();
+      if (inputSimParticlesTag != invalid_tag) {
+        consumes<SimParticleCollection>(inputSimParticlesTag);
+      }
+      auto const& inputMCTrajectoryTag = multiStagePars_.inputMCTrajectories();
+      if (inputMCTrajectoryTag != invalid_tag) {
+        consumes<MCTrajectoryCollection>(inputMCTrajectoryTag);
+      }
+      if (_generatorModuleLabel != invalid_tag) {
+        consumes<GenParticleCollection>(_generatorModuleLabel);
+      }
+      for (auto const& tag : multiStagePars_.genInputHits()) {
+        consumes<StepPointMCCollection>(tag);
+      }
+
+      produces<PhysicalVolumeInfoMultiCollection,art::InSubRun>();
+
+      async<art::InEvent>();
+    }
+
+
+  void Mu2eG4MT::beginRun(art::Run &run, art::ProcessingFrame const&) {
+
+    art::ServiceHandle<GeometryService> geom;
+    SimpleConfig const& config  = geom->config();
+    checkConfigRelics(config);
+
+    if ( !_g4Initialized ) {
+      initializeG4( *geom, run );
+    }
+
+    // Start the master's G4 run.  The workers start theirs when they
+    // see the first event of this run.
+    _masterRunManager->SetRunIDCounter(run.id().run());
+    if ( !_masterRunManager->ConfirmBeamOnCondition() ) {
+      throw cet::exception("G4MT")
+        << "Mu2eG4MT: G4 is not ready to begin " << run.id() << "\n";
+    }
+    _masterRunManager->ConstructScoringWorlds();
+    _masterRunManager->RunInitialization();
+
+    if ( !_g4Initialized ) {
+      stackingCuts_->finishConstruction(_originInWorld);
+      steppingCuts_->finishConstruction(_originInWorld);
+      commonCuts_->finishConstruction  (_originInWorld);
+      _g4Initialized = true;
+    }
+  }
+
+
+  void Mu2eG4MT::initializeG4( GeometryService& geom, art::Run const& run ){
+
+    if ( _rmvlevel > 0 ) {
+      mf::LogInfo logInfo("GEOM");
+      logInfo << "Initializing Geant4 for " << run.id()
+              << " with verbosity " << _rmvlevel << endl;
+      logInfo << " Configured simParticleNumberOffset = "<< multiStagePars_.simParticleNumberOffset() << endl;
+    }
+
+    G4VUserDetectorConstruction* allMu2e;
+
+    if (_standardMu2eDetector) {
+      geom.addWorldG4(*GeomHandle<Mu2eHall>());
+
+      allMu2e =
+        (new WorldMaker<Mu2eWorld>(std::make_unique<Mu2eWorld>(pset_, &(_masterSDHelper.front())),
+                                   std::make_unique<ConstructMaterials>(pset_)) );
+
+      _originInWorld = (GeomHandle<WorldG4>())->mu2eOriginInWorld();
+    }
+    else {
+      allMu2e =
+        (new WorldMaker<Mu2eStudyWorld>(std::make_unique<Mu2eStudyWorld>(pset_, &(_masterSDHelper.front())),
+                                        std::make_unique<ConstructMaterials>(pset_)) );
+
+      _originInWorld = G4ThreeVector(0.0,0.0,0.0);
+    }
+
+    preG4InitializeTasks(pset_);
+
+    _masterRunManager->SetVerboseLevel(_rmvlevel);
+    _masterRunManager->SetUserInitialization(allMu2e);
+
+    physicsList_ = physicsListDecider(pset_);
+    physicsList_->SetVerboseLevel(_rmvlevel);
+
+    G4ParticleHPManager::GetInstance()->SetVerboseLevel(_rmvlevel);
+    G4HadronicProcessStore::Instance()->SetVerbose(_rmvlevel);
+
+    _masterRunManager->SetUserInitialization(physicsList_);
+
+    // Only BuildForMaster is used from this one; the workers build
+    // their own actions.  It has no per-thread objects.
+    ActionInitialization* actioninit = new ActionInitialization(pset_,
+                                                                _masterSDHelper,
+                                                                nullptr, &_physVolHelper,
+                                                                true, 0, _originInWorld,
+                                                                mu2elimits_,
+                                                                multiStagePars_.simParticleNumberOffset()
+                                                                );
+    _masterRunManager->SetUserInitialization(actioninit);
+
+    // Any final G4 interactive commands; they are replayed on each worker.
+    if ( !_g4Macro.empty() ) {
+      G4String command("/control/execute ");
+      ConfigFileLookupPolicy path;
+      command += path(_g4Macro);
+      G4UImanager::GetUIpointer()->ApplyCommand(command);
+    }
+
+    _masterRunManager->Mu2eG4InitializeMaster();
+
+  } // end Mu2eG4MT::initializeG4
+
+
+  void Mu2eG4MT::beginSubRun(art::SubRun& sr, art::ProcessingFrame const&)
+  {
+    using Collection_t = PhysicalVolumeInfoMultiCollection;
+    auto mvi = std::make_unique<Collection_t>();
+
+    if(multiStagePars_.inputPhysVolumeMultiInfo() != invalid_tag) {
+      // Copy over data from the previous simulation stages
+      auto const& ih = sr.getValidHandle<Collection_t>(multiStagePars_.inputPhysVolumeMultiInfo());
+      mvi->reserve(1 + ih->size());
+      mvi->insert(mvi->begin(), ih->cbegin(), ih->cend());
+    }
+
+    // Append info for the current stage
+    mvi->emplace_back(multiStagePars_.simParticleNumberOffset(), _physVolHelper.persistentSingleStageInfo());
+
+    sr.put(std::move(mvi));
+  }
+
+
+  Mu2eG4MT::Worker& Mu2eG4MT::acquireWorker() {
+
+    Worker* worker = nullptr;
+    int threadID = 0;
+    {
+      std::lock_guard<std::mutex> lock(_workersMutex);
+      if ( !_freeWorkers.empty() ) {
+        worker = _freeWorkers.back();
+        _freeWorkers.pop_back();
+        return *worker;
+      }
+      _workers.push_back(std::make_unique<Worker>());
+      worker = _workers.back().get();
+      threadID = _workers.size() - 1;
+    }
+
+    if ( _rmvlevel > 0 ) {
+      mf::LogInfo("G4MT") << "Creating G4 worker " << threadID;
+    }
+    std::lock_guard<std::mutex> lock(_workerInitMutex);
+    worker->thread.run( [&]() {
+        Mu2eG4WorkerRunManager::setUpThread(threadID);
+        worker->runManager = std::make_unique<Mu2eG4WorkerRunManager>(pset_, threadID);
+        worker->runManager->initializeThread(_masterRunManager.get(), &_physVolHelper, _originInWorld,
+                                             mu2elimits_, multiStagePars_.simParticleNumberOffset());
+      });
+    return *worker;
+  }
+
+
+  void Mu2eG4MT::releaseWorker(Worker& worker) {
+    std::lock_guard<std::mutex> lock(_workersMutex);
+    _freeWorkers.push_back(&worker);
+  }
+
+
+  void Mu2eG4MT::produce(art::Event& event, art::ProcessingFrame const&) {
+
+    Worker& worker = acquireWorker();
+    try {
+      simulate(worker, event);
+    }
+    catch (...) {
+      releaseWorker(worker);
+      throw;
+    }
+    releaseWorker(worker);
+  }
+
+
+  // Create one G4 event on the worker's thread and copy its output to the art::event.
+  void Mu2eG4MT::simulate(Worker& worker, art::Event& event) {
+
+    Mu2eG4WorkerRunManager& runManager = *worker.runManager;
+
+    // ProductID and ProductGetter for the SimParticleCollection.
+    art::ProductID simPartId(event.getProductID<SimParticleCollection>());
+    art::EDProductGetter const* simProductGetter = event.productGetter(simPartId);
+
+    // StepPointMCCollection of input hits from the previous simulation stage
+    HitHandles genInputHits;
+    for(const auto& i : multiStagePars_.genInputHits()) {
+      genInputHits.emplace_back(event.getValidHandle<StepPointMCCollection>(i));
+    }
+
+    EventStash& stash = runManager.stash();
+    stash.initializeStash(1);
+    runManager.broker().loadEvent(genInputHits, simPartId, &event, _generatorModuleLabel, &stash, simProductGetter);
+
+    const auto seeds = eventSeeds(baseSeed_, event.id());
+    worker.thread.run( [&]() {
+        runManager.beginRunIfNeeded(event.run());
+        runManager.processOneArtEvent(event.id().event(), seeds[0], seeds[1]);
+      });
+
+    runManager.broker().setEventPtrToZero();
+
+    // The SimParticleHelper was made with this event's ProductID and
+    // getter, so the Ptrs need no reseating.
+    std::unique_ptr<SimParticleCollection> simsToCheck = std::move(stash.getSimPartCollection(0));
+
+    if (simsToCheck == nullptr) {
+      numExcludedEvents++;
+    } else {
+      event.put(std::move(stash.getG4Status(0)));
+      event.put(std::move(simsToCheck));
+
+      if(!timeVDtimes_.empty()) {
+        event.put(std::move(stash.getTVDHits(0)),stash.getTVDName(0));
+      }
+
+      if(trajectoryControl_.produce()) {
+        event.put(std::move(stash.getMCTrajCollection(0)));
+      }
+
+      if(multiStagePars_.multiStage()) {
+        event.put(std::move(stash.getSimParticleRemap(0)));
+      }
+
+      if(_masterSDHelper.front().extMonPixelsEnabled()) {
+        event.put(std::move(stash.getExtMonFNALSimHitCollection(0)));
+      }
+
+      stash.putSensitiveDetectorData(0, event, simProductGetter);
+      stash.putCutsData(0, event, simProductGetter);
+    }
+
+    stash.clearStash();
+
+  }//end Mu2eG4MT::simulate
+
+
+  // Tell G4 that this run is over.  The workers merge their runs into
+  // the master's, so they end theirs first.  No event is in flight.
+  void Mu2eG4MT::endRun(art::Run & run, art::ProcessingFrame const&){
+
+    for ( auto& worker : _workers ) {
+      if ( !worker->runManager ) continue;
+      worker->thread.run( [&]() { worker->runManager->endRunIfNeeded(); } );
+    }
+
+    _masterRunManager->Mu2eG4RunTermination();
+
+    G4cout << "at endRun: numExcludedEvents = " << numExcludedEvents << G4endl;
+  }
+
+
+  void Mu2eG4MT::endJob(art::ProcessingFrame const&){
+
+    // Yes, these are named endRun, but they are really endJob actions.
+    _physVolHelper.endRun();
+
+    G4cout << "Mu2eG4MT: simulated on " << _workers.size() << " G4 worker threads" << G4endl;
+
+    // The workers use the master's geometry and physics, so they are
+    // destroyed here, on their own threads, before the master.
+    for ( auto& worker : _workers ) {
+      worker->thread.run( [&]() {
+          if ( worker->runManager ) {
+            worker->runManager.reset();
+            Mu2eG4WorkerRunManager::tearDownThread();
+          }
+        });
+    }
+    _freeWorkers.clear();
+    _workers.clear();
+  }
+
+} // End of namespace mu2e
+
+DEFINE_ART_MODULE(mu2e::Mu2eG4MT);
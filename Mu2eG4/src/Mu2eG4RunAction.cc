@@ -30,6 +30,7 @@ namespace mu2e {
 
 Mu2eG4RunAction::Mu2eG4RunAction(const fhicl::ParameterSet& pset,
                                  const bool using_MT,
+                                 const bool master_fills_process_info,
                                  CLHEP::Hep3Vector const& origin_in_world,
                                  PhysicalVolumeHelper* phys_volume_helper,
                                  PhysicsProcessInfo* phys_process_info,
@@ -41,6 +42,7 @@ Mu2eG4RunAction::Mu2eG4RunAction(const fhicl::ParameterSet& pset,
     G4UserRunAction(),
     pset_(pset),
     use_G4MT_(using_MT),
+    masterFillsProcessInfo_(master_fills_process_info),
     originInWorld(origin_in_world),
     _physVolHelper(phys_volume_helper),
     _processInfo(phys_process_info),
@@ -75,6 +77,12 @@ void Mu2eG4RunAction::BeginOfRunAction(const G4Run* aRun)
           //BeginOfRunAction is called from Worker Threads only
 
           _sensitiveDetectorHelper->registerSensitiveDetectors();
+
+          //in the stash MT mode the master fills the process tables of all threads,
+          //see Mu2eG4MasterRunAction; a Mu2eG4MT worker fills its own
+          if (!masterFillsProcessInfo_) {
+            _processInfo->beginRun();
+          }
             
           _trackingAction->beginRun( _physVolHelper, _processInfo, originInWorld );
           _steppingAction->beginRun( _processInfo, originInWorld );
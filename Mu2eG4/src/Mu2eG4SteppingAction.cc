@@ -4,8 +4,10 @@
 //
 
 // C++ includes
+#include <algorithm>
 #include <cstdio>
 #include <cmath>
+#include <chrono>
 
 // Framework includes
 #include "messagefacility/MessageLogger/MessageLogger.h"
@@ -44,6 +46,9 @@ namespace mu2e {
     numTrackSteps_(),
     numKilledTracks_(),
     stepLimitKillerVerbose_(pset.get<bool>("debug.stepLimitKillerVerbose")),
+    timeSteppingCuts_(pset.get<bool>("debug.timeSteppingCuts", false)),
+    numTimedSteps_(),
+    cutsTime_(),
 
     // Things related to time virtual detector
     tvd_time_(timeVDtimes),
@@ -51,6 +56,11 @@ namespace mu2e {
     tvd_warning_printed_(false),
 
     trajectoryControl_(&trajectoryControl),
+    recordTrajectory_(false),
+    numTrajectoryCandidates_(),
+    maxPointDeviation_(trajectoryControl.maxPointDeviation()),
+    numCandidatePoints_(),
+    numKeptPoints_(),
 
     // Default values for parameters that are optional in the run time configuration.
     _debugEventList(pset.get<std::vector<int> >("debug.eventList", std::vector<int>())),
@@ -65,6 +75,17 @@ namespace mu2e {
     }
   }//end ctor
 
+  Mu2eG4SteppingAction::~Mu2eG4SteppingAction() {
+    if( timeSteppingCuts_ && (numTimedSteps_ > 0) ) {
+      G4cout << "Mu2eG4SteppingAction: cuts evaluated in " << numTimedSteps_ << " steps, "
+             << cutsTime_/numTimedSteps_ << " ns per step" << G4endl;
+    }
+    if( (maxPointDeviation_ > 0.) && (numCandidatePoints_ > 0) ) {
+      G4cout << "Mu2eG4SteppingAction: online trajectory thinning kept " << numKeptPoints_
+             << " of " << numCandidatePoints_ << " trajectory points" << G4endl;
+    }
+  }
+
   // A helper function to manage the printout.
   void Mu2eG4SteppingAction::printit( G4String const& s,
                                       G4int id,
@@ -101,11 +122,16 @@ namespace mu2e {
       }
   }
     
-  void Mu2eG4SteppingAction::BeginOfTrack() {
+  void Mu2eG4SteppingAction::BeginOfTrack(bool recordTrajectory) {
       numTrackSteps_ = 0;
+      recordTrajectory_ = recordTrajectory;
+      numTrajectoryCandidates_ = 0;
+      pendingPoints_.clear();
       const auto oldSize = _trajectory.size();
       _trajectory.clear();
-      _trajectory.reserve(oldSize + oldSize/8);
+      if(recordTrajectory_) {
+          _trajectory.reserve(oldSize + oldSize/8);
+      }
   }
 
   void Mu2eG4SteppingAction::EndOfTrack() {
@@ -131,21 +157,9 @@ namespace mu2e {
       G4StepPoint const* prept  = step->GetPreStepPoint();
       G4StepPoint const* postpt = step->GetPostStepPoint();
       
-      /// FIXME: Optimization: if the current track (not step!) has
-      /// initial momentum below the "g4.mcTrajectoryMomentumCut"
-      /// threshold, we can skip adding trajectory points completely.
-      /// NB: there is also "g4.saveTrajectoryMomentumCut".
-      /// Do we need to look at both of them?
-      //
       // Determine whether we add the current step to MCTrajectory
-      const double mcTrajCurrentCut = mcTrajectoryMinDistanceCut(prept->GetPhysicalVolume());
-      // In some cases we know to accept the point even without computing the distance
-      bool computeMCTrajDistance = (!_trajectory.empty()) && (mcTrajCurrentCut > 0.);
-      if(!computeMCTrajDistance || (((prept->GetPosition() - _mu2eOrigin) -  _trajectory.back().pos()).mag() >= mcTrajCurrentCut)) {
-          _trajectory.emplace_back ( prept->GetPosition() - _mu2eOrigin,
-                                    prept->GetGlobalTime(),
-                                    prept->GetKineticEnergy()
-                                    );
+      if(recordTrajectory_) {
+          addTrajectoryPoint(prept);
       }
 
       // Save hits in time virtual detector
@@ -155,9 +169,17 @@ namespace mu2e {
           }
       }
       
-      if(steppingCuts_->steppingActionCut(step)) {
-          killTrack(track, ProcessCode::mu2eKillerVolume, fStopAndKill);
-      } else if(commonCuts_->steppingActionCut(step)) {
+      std::chrono::steady_clock::time_point cutsStart;
+      if(timeSteppingCuts_) cutsStart = std::chrono::steady_clock::now();
+
+      const bool killedByCuts = steppingCuts_->steppingActionCut(step) || commonCuts_->steppingActionCut(step);
+
+      if(timeSteppingCuts_) {
+          cutsTime_ += std::chrono::duration<double,std::nano>(std::chrono::steady_clock::now() - cutsStart).count();
+          ++numTimedSteps_;
+      }
+
+      if(killedByCuts) {
           killTrack(track, ProcessCode::mu2eKillerVolume, fStopAndKill);
       } else if(killTooManySteps(track)) {
           killTrack( track, ProcessCode::mu2eMaxSteps, fStopAndKill);
@@ -310,6 +332,68 @@ namespace mu2e {
       std::swap( trajectory, _trajectory);
   }
 
+  void Mu2eG4SteppingAction::addTrajectoryPoint(G4StepPoint const* prept) {
+
+      const CLHEP::Hep3Vector pos(prept->GetPosition() - _mu2eOrigin);
+
+      // The distance cut is applied WRT the previous candidate, kept or not,
+      // so that the candidates are the points stored without thinning.
+      const double mcTrajCurrentCut = mcTrajectoryMinDistanceCut(prept->GetPhysicalVolume());
+      if((numTrajectoryCandidates_ > 0) && (mcTrajCurrentCut > 0.)) {
+          const MCTrajectoryPoint& last = pendingPoints_.empty() ? _trajectory.back() : pendingPoints_.back();
+          if((pos - last.pos()).mag() < mcTrajCurrentCut) return;
+      }
+      ++numTrajectoryCandidates_;
+      ++numCandidatePoints_;
+
+      const MCTrajectoryPoint point(pos, prept->GetGlobalTime(), prept->GetKineticEnergy());
+      if((maxPointDeviation_ <= 0.) || _trajectory.empty()) {
+          _trajectory.push_back(point);
+          ++numKeptPoints_;
+          return;
+      }
+
+      // Hold the point back as long as the segment from the last kept point
+      // to the newest one describes all the points in between.  Otherwise keep
+      // the previous point and start a new segment from it.  The number of
+      // held back points is bounded so that the test stays cheap.
+      if( !pendingPoints_.empty() &&
+          ((pendingPoints_.size() >= maxPendingPoints) || !pendingPointsWithin(pos)) ) {
+          _trajectory.push_back(pendingPoints_.back());
+          ++numKeptPoints_;
+          pendingPoints_.clear();
+      }
+      pendingPoints_.push_back(point);
+  }
+
+  bool Mu2eG4SteppingAction::pendingPointsWithin(CLHEP::Hep3Vector const& pos) const {
+
+      const CLHEP::Hep3Vector start(_trajectory.back().pos());
+      const CLHEP::Hep3Vector seg(pos - start);
+      const double seglen2 = seg.mag2();
+      const double maxdev2 = maxPointDeviation_*maxPointDeviation_;
+
+      for(const auto& p : pendingPoints_) {
+          const CLHEP::Hep3Vector d(p.pos() - start);
+          // distance to the closest point of the segment
+          const double f = (seglen2 > 0.) ? std::min(std::max(d.dot(seg)/seglen2, 0.), 1.) : 0.;
+          if((d - f*seg).mag2() > maxdev2) return false;
+      }
+      return true;
+  }
+
+  void Mu2eG4SteppingAction::finishTrajectory(CLHEP::Hep3Vector const& trackEnd) {
+
+      // The end point is added by TrackingAction; the held back points can be
+      // dropped if the last segment describes them.
+      if( !pendingPoints_.empty() &&
+          ((pendingPoints_.size() >= maxPendingPoints) || !pendingPointsWithin(trackEnd)) ) {
+          _trajectory.push_back(pendingPoints_.back());
+          ++numKeptPoints_;
+      }
+      pendingPoints_.clear();
+  }
+
   double Mu2eG4SteppingAction::mcTrajectoryMinDistanceCut(const G4VPhysicalVolume* vol) const {
       
       const auto it = mcTrajectoryVolumePtDistances_.find(vol);
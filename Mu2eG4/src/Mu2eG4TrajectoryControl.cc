@@ -11,6 +11,7 @@ namespace mu2e {
     , mcTrajectoryMinSteps_{produce_ ? pset.get<unsigned>("mcTrajectoryMinSteps") : std::numeric_limits<unsigned>::max() }
     , mcTrajectoryMomentumCut_{produce_ ? pset.get<double>("mcTrajectoryMomentumCut") : std::numeric_limits<double>::max() }
     , saveTrajectoryMomentumCut_{produce_ ? pset.get<double>("saveTrajectoryMomentumCut") : std::numeric_limits<double>::max() }
+    , maxPointDeviation_{produce_ ? pset.get<double>("maxPointDeviation", 0.) : 0. }
   {
     if(produce_) {
       const fhicl::ParameterSet& volumeCutsPS{pset.get<fhicl::ParameterSet>("perVolumeMinDistance")};
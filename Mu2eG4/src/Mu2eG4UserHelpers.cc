@@ -297,7 +297,7 @@ namespace mu2e {
     }
 
     void printTrackInfo(G4Track const* const trk, std::string const& text,
-                        map_type const& transientMap,
+                        SimParticleStore const& transientMap,
                         cet::cpu_timer const& timer,
                         CLHEP::Hep3Vector const& mu2eOrigin,
                         bool isEnd, bool printTimers) {
@@ -339,10 +339,9 @@ namespace mu2e {
 
       if ( isEnd ){
         cout << trk->GetProperTime() <<  " | ";
-        map_type::const_iterator i(transientMap.find(key_type(id)));
-        if ( i != transientMap.end() ){
-          SimParticle const& particle = i->second;
-          cout << particle.startGlobalTime() <<  " ";
+        SimParticle const* particle = transientMap.find(key_type(id));
+        if ( particle != nullptr ){
+          cout << particle->startGlobalTime() <<  " ";
         } else {
           cout << -1. <<  " ";
         }
@@ -364,17 +363,13 @@ namespace mu2e {
 
     }
 
-    bool checkCrossReferences( bool doPrint, bool doThrow, map_type const& transientMap ){
+    bool checkCrossReferences( bool doPrint, bool doThrow, SimParticleStore const& transientMap ){
 
       // Start by assuming we are ok; any error will turn this to false.
       bool ok(true);
 
       // Loop over all simulated particles.
-      for ( map_type::const_iterator i=transientMap.begin();
-            i!=transientMap.end(); ++i ){
-
-        // The next particle to look at.
-        SimParticle const& sim = i->second;
+      transientMap.visit([&](key_type const&, SimParticle const& sim){
 
         key_type const & simid = sim.id();
 
@@ -386,10 +381,10 @@ namespace mu2e {
 
           key_type parentId;
 
-          map_type::const_iterator fdi = transientMap.find(*j);
-          bool daugterFound = fdi !=transientMap.end();
+          SimParticle const* daughter = transientMap.find(*j);
+          bool daugterFound = daughter != nullptr;
           if (daugterFound) {
-            parentId = (fdi->second).parentId();
+            parentId = daughter->parentId();
           }
 
           if ( !daugterFound || parentId != simid ){
@@ -412,8 +407,8 @@ namespace mu2e {
         if ( sim.hasParent() ){
           key_type parentId = sim.parentId();
 
-          map_type::const_iterator fpi = transientMap.find(parentId);
-          bool parentFound = fpi != transientMap.end();
+          SimParticle const* parent = transientMap.find(parentId);
+          bool parentFound = parent != nullptr;
 
           if ( !parentFound ){
             ok = false;
@@ -427,7 +422,7 @@ namespace mu2e {
             }
           } else {
 
-            std::vector<key_type> const& mdau = (fpi->second).daughterIds();
+            std::vector<key_type> const& mdau = parent->daughterIds();
             bool inList(false);
 
             if (find(mdau.begin(), mdau.end(), simid)!=mdau.end()) {
@@ -450,7 +445,7 @@ namespace mu2e {
 
         }
 
-      }
+      });
 
       return ok;
 
@@ -0,0 +1,140 @@
+//
+// A G4 worker run manager driven by an art worker thread.
+//
+// Notes:
+// 1) The thread set up and initialization follow what
+//    G4MTRunManagerKernel::StartThread does for G4's own worker
+//    threads, except that the user actions come from an
+//    ActionInitialization that belongs to this worker.
+// 2) G4WorkerRunManager::GenerateEvent asks the master for seeds and
+//    event numbers.  Here the event is created directly and seeded
+//    from the art event, so its random sequence does not depend on
+//    which thread simulates it or on how many threads there are.
+// 3) G4 thread-local state can not be touched from another thread, so
+//    Mu2eG4MT starts and ends the run of a worker, and destroys it, on
+//    the worker's own Mu2eG4WorkerThread.
+//
+
+#include "Mu2eG4/inc/Mu2eG4WorkerRunManager.hh"
+#include "Mu2eG4/inc/Mu2eG4MTRunManager.hh"
+#include "Mu2eG4/inc/ActionInitialization.hh"
+
+#include "cetlib_except/exception.h"
+
+// Included from Geant4
+#include "G4Event.hh"
+#include "G4EventManager.hh"
+#include "G4UImanager.hh"
+#include "G4Threading.hh"
+#include "G4WorkerThread.hh"
+#include "G4VUserPhysicsList.hh"
+#include "G4VUserDetectorConstruction.hh"
+#include "G4VUserPrimaryGeneratorAction.hh"
+#include "Randomize.hh"
+#include "CLHEP/Random/MixMaxRng.h"
+
+using namespace std;
+
+namespace mu2e {
+
+  void Mu2eG4WorkerRunManager::setUpThread(int threadID) {
+    G4Threading::G4SetThreadId(threadID);
+    G4UImanager::GetUIpointer()->SetUpForAThread(threadID);
+    // The engine is reseeded for every event, see Note 2.
+    G4Random::setTheEngine(new CLHEP::MixMaxRng());
+    G4WorkerThread::BuildGeometryAndPhysicsVector();
+  }
+
+  void Mu2eG4WorkerRunManager::tearDownThread() {
+    G4WorkerThread::DestroyGeometryAndPhysicsVector();
+    G4UImanager::GetUIpointer()->SetUpForAThread(-1);
+  }
+
+  Mu2eG4WorkerRunManager::Mu2eG4WorkerRunManager(const fhicl::ParameterSet& pset, int threadID):
+    G4WorkerRunManager(),
+    pset_(pset),
+    threadID_(threadID),
+    runStarted_(false),
+    runNumber_(0),
+    genEventBroker_(false),
+    stash_(pset)
+  {
+    sensitiveDetectorHelpers_.emplace_back(pset.get<fhicl::ParameterSet>("SDConfig", fhicl::ParameterSet()));
+  }
+
+  Mu2eG4WorkerRunManager::~Mu2eG4WorkerRunManager()
+  {}
+
+  void Mu2eG4WorkerRunManager::initializeThread(Mu2eG4MTRunManager* masterRM,
+                                                PhysicalVolumeHelper* physVolHelper,
+                                                G4ThreeVector const& originInWorld,
+                                                Mu2eG4ResourceLimits const& mu2eLimits,
+                                                unsigned stageOffset) {
+
+    const G4VUserDetectorConstruction* detector = masterRM->GetUserDetectorConstruction();
+    G4RunManager::SetUserInitialization(const_cast<G4VUserDetectorConstruction*>(detector));
+
+    const G4VUserPhysicsList* physicsList = masterRM->GetUserPhysicsList();
+    SetUserInitialization(const_cast<G4VUserPhysicsList*>(physicsList));
+
+    // A single set of per-thread objects; Build() registers the actions
+    // with this thread's run manager.
+    actionInit_ = std::make_unique<ActionInitialization>(pset_,
+                                                         sensitiveDetectorHelpers_,
+                                                         &genEventBroker_, physVolHelper,
+                                                         true, 1, originInWorld,
+                                                         mu2eLimits,
+                                                         stageOffset);
+    actionInit_->Build();
+
+    Initialize();
+
+    // Replay the UI commands that were applied to the master.
+    std::vector<G4String> cmdCopy = masterRM->GetCommandStack();
+    for ( auto const& cmd : cmdCopy ) {
+      G4UImanager::GetUIpointer()->ApplyCommand(cmd);
+    }
+  }
+
+  void Mu2eG4WorkerRunManager::beginRunIfNeeded(unsigned runNumber) {
+    if ( runStarted_ && runNumber == runNumber_ ) return;
+
+    endRunIfNeeded(); // See Note 3.
+
+    SetRunIDCounter(runNumber);
+    if ( !ConfirmBeamOnCondition() ) {
+      throw cet::exception("G4MT")
+        << "Mu2eG4WorkerRunManager: G4 is not ready to begin run " << runNumber
+        << " on thread " << threadID_ << "\n";
+    }
+    ConstructScoringWorlds();
+    RunInitialization();
+
+    runStarted_ = true;
+    runNumber_ = runNumber;
+  }
+
+  void Mu2eG4WorkerRunManager::endRunIfNeeded() {
+    if ( !runStarted_ ) return;
+
+    TerminateEventLoop();
+    RunTermination();
+    runStarted_ = false;
+  }
+
+  void Mu2eG4WorkerRunManager::processOneArtEvent(G4int eventID, long seed0, long seed1) {
+
+    // See Note 2.
+    long seeds[3] = { seed0, seed1, 0 };
+    G4Random::setTheSeeds(seeds, -1);
+
+    currentEvent = new G4Event(eventID);
+    userPrimaryGeneratorAction->GeneratePrimaries(currentEvent);
+
+    eventManager->ProcessOneEvent(currentEvent);
+    AnalyzeEvent(currentEvent);
+    UpdateScoring();
+    TerminateOneEvent();
+  }
+
+} // end namespace mu2e
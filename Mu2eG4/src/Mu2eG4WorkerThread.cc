@@ -0,0 +1,68 @@
+//
+// A thread that runs the functions it is given, one at a time.
+//
+
+#include "Mu2eG4/inc/Mu2eG4WorkerThread.hh"
+
+namespace mu2e {
+
+  Mu2eG4WorkerThread::Mu2eG4WorkerThread():
+    job_(nullptr),
+    jobDone_(false),
+    stop_(false),
+    error_(),
+    thread_(&Mu2eG4WorkerThread::loop, this)
+  {}
+
+  Mu2eG4WorkerThread::~Mu2eG4WorkerThread() {
+    {
+      std::lock_guard<std::mutex> runLock(runMutex_);
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+  }
+
+  void Mu2eG4WorkerThread::run(std::function<void()> const& f) {
+    std::lock_guard<std::mutex> runLock(runMutex_);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    job_ = &f;
+    jobDone_ = false;
+    error_ = nullptr;
+    cv_.notify_all();
+    cv_.wait(lock, [this]{ return jobDone_; });
+
+    job_ = nullptr;
+    if ( error_ ) {
+      std::exception_ptr error = error_;
+      error_ = nullptr;
+      std::rethrow_exception(error);
+    }
+  }
+
+  void Mu2eG4WorkerThread::loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+      cv_.wait(lock, [this]{ return stop_ || (job_ != nullptr && !jobDone_); });
+      if ( stop_ ) return;
+
+      std::function<void()> const& f = *job_;
+      lock.unlock();
+      std::exception_ptr error;
+      try {
+        f();
+      }
+      catch (...) {
+        error = std::current_exception();
+      }
+      lock.lock();
+
+      error_ = error;
+      jobDone_ = true;
+      cv_.notify_all();
+    }
+  }
+
+} // end namespace mu2e
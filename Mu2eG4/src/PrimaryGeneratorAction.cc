@@ -111,7 +111,7 @@ namespace mu2e {
 void PrimaryGeneratorAction::setEventData()
     {
 
-        if (G4Threading::IsWorkerThread())//if this is being called by a worker thread, we are in MT mode
+        if (genEventBroker_->usingStash())//MT mode with a stash of GenParticleCollections
         {
             //get the instance of the GenParticleCollection that we need for this event
             GenEventBroker::GenParticleCollectionInstance genCollectionInstance = genEventBroker_->getNextGenPartCollectionInstance();
@@ -123,7 +123,7 @@ void PrimaryGeneratorAction::setEventData()
             genParticles_ = genCollectionInstance.genCollection;
 
         }
-        else//we are in sequential mode
+        else//sequential mode, or an art thread simulating its own event (Mu2eG4MT)
         {
             genParticles_ = genEventBroker_->getGenParticleHandle().isValid() ?
                             genEventBroker_->getGenParticleHandle().product() :
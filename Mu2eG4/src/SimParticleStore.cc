@@ -0,0 +1,75 @@
+#include "Mu2eG4/inc/SimParticleStore.hh"
+
+#include <algorithm>
+#include <iterator>
+
+namespace mu2e {
+
+  void SimParticleStore::reset(unsigned base) {
+    _base = base;
+    _size = 0;
+    _dense.clear();
+    _present.clear();
+    _sparse.clear();
+  }
+
+  std::size_t SimParticleStore::slot(unsigned key) {
+    std::size_t i = key - _base;
+    if(i >= _dense.size()) {
+      // G4 track IDs grow by one, grow geometrically to amortize the moves
+      std::size_t n = std::max(i+1, 2*_dense.size());
+      _dense.resize(n);
+      _present.resize(n, false);
+    }
+    return i;
+  }
+
+  bool SimParticleStore::insert(key_type key, mapped_type&& sim) {
+    unsigned k = key.asUint();
+    if(k < _base) {
+      if(!_sparse.emplace(key, std::move(sim)).second) return false;
+    }
+    else {
+      std::size_t i = slot(k);
+      if(_present[i]) return false;
+      _dense[i] = value_type(key, std::move(sim));
+      _present[i] = true;
+    }
+    ++_size;
+    return true;
+  }
+
+  SimParticleStore::mapped_type& SimParticleStore::operator[](key_type key) {
+    unsigned k = key.asUint();
+    if(k < _base) {
+      auto i = _sparse.emplace(key, mapped_type());
+      if(i.second) ++_size;
+      return i.first->second;
+    }
+    std::size_t i = slot(k);
+    if(!_present[i]) {
+      _dense[i] = value_type(key, mapped_type());
+      _present[i] = true;
+      ++_size;
+    }
+    return _dense[i].second;
+  }
+
+  void SimParticleStore::moveTo(SimParticleCollection& out) {
+    // Compact the present particles to the front of the dense vector, in key order,
+    // append the ones from the map and move the lot into the collection.
+    std::size_t n(0);
+    for(std::size_t i=0; i<_dense.size(); ++i) {
+      if(!_present[i]) continue;
+      if(n != i) _dense[n] = std::move(_dense[i]);
+      ++n;
+    }
+    _dense.resize(n);
+    for(auto& i : _sparse) {
+      _dense.emplace_back(i.first, std::move(i.second));
+    }
+    out.insert(std::make_move_iterator(_dense.begin()), std::make_move_iterator(_dense.end()));
+    reset(_base);
+  }
+
+} // end namespace mu2e
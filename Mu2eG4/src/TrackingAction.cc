@@ -195,7 +195,11 @@ void TrackingAction::beginRun(const PhysicalVolumeHelper* physVolHelper,
     Mu2eG4UserHelpers::controlTrajectorySaving(trk, _sizeLimit, _currentSize,
                                                _saveTrajectoryMomentumCut);
 
-    _steppingAction->BeginOfTrack();
+    // Do not collect trajectory points for a track that will fail the
+    // momentum cut in swapTrajectory.
+    SimParticle const* particle = _transientMap.find(_spHelper->particleKeyFromG4TrackID(trk->GetTrackID()));
+    _steppingAction->BeginOfTrack( (particle != nullptr) &&
+                                   (particle->startMomentum().vect().mag() >= _mcTrajectoryMomentumCut) );
 
     if ( !_debugList.inList() ) return;
     Mu2eG4UserHelpers::printTrackInfo( trk, "Start new Track: ", _transientMap, 
@@ -250,6 +254,9 @@ void TrackingAction::beginEvent(const art::Handle<SimParticleCollection>& inputS
     _spHelper             = &spHelper;
     _primaryHelper        = &primaryHelper;
     _trajectories         = &trajectories;
+
+    // Particles made by this stage are stored densely from the key of G4 track 0 up
+    _transientMap.reset(_spHelper->particleKeyFromG4TrackID(0).asUint());
       
     if(inputSimHandle.isValid()) {
       // We do not compress anything here, but use the call to reseat the pointers
@@ -293,8 +300,7 @@ void TrackingAction::beginEvent(const art::Handle<SimParticleCollection>& inputS
 void TrackingAction::endEvent(SimParticleCollection& persistentSims ){
     
     Mu2eG4UserHelpers::checkCrossReferences(true,true,_transientMap);
-    persistentSims.insert( _transientMap.begin(), _transientMap.end() );
-    _transientMap.clear();
+    _transientMap.moveTo(persistentSims);
       
     if ( !_debugList.inList() ) return;
 }
@@ -380,14 +386,6 @@ void TrackingAction::saveSimParticleStart(const G4Track* trk){
       G4cout << G4endl; // step related info is not available at this stage
     }
 
-    // Track should not yet be in the map.  Add a debug clause to skip this test?
-    if ( _transientMap.find(kid) != _transientMap.end() ){
-      throw cet::exception("RANGE")
-        << "SimParticle already in the event.  This should never happen. id is: "
-        << kid
-        << "\n";
-    }
-
     // Add this track to the transient data.
     CLHEP::HepLorentzVector p4(trk->GetMomentum(),trk->GetTotalEnergy());
 
@@ -414,29 +412,36 @@ void TrackingAction::saveSimParticleStart(const G4Track* trk){
 
     }
     
-    _transientMap.insert(std::make_pair(kid,SimParticle( kid,
-                                                         _stageOffset,
-                                                         parentPtr,
-                                                         ppdgId,
-                                                         genPtr,
-                                                         trk->GetPosition()-_mu2eOrigin,
-                                                         p4,
-                                                         trk->GetGlobalTime(),
-                                                         trk->GetProperTime(),
-                                                         _physVolHelper->index(trk),
-                                                         trk->GetTrackStatus(),
-                                                         creationCode)));
+    // Track should not yet be in the store.
+    bool inserted = _transientMap.insert(kid,SimParticle( kid,
+                                                          _stageOffset,
+                                                          parentPtr,
+                                                          ppdgId,
+                                                          genPtr,
+                                                          trk->GetPosition()-_mu2eOrigin,
+                                                          p4,
+                                                          trk->GetGlobalTime(),
+                                                          trk->GetProperTime(),
+                                                          _physVolHelper->index(trk),
+                                                          trk->GetTrackStatus(),
+                                                          creationCode));
+    if ( !inserted ){
+      throw cet::exception("RANGE")
+        << "SimParticle already in the event.  This should never happen. id is: "
+        << kid
+        << "\n";
+    }
 
     // If this track has a parent, tell the parent about this track.
     if ( parentPtr.isNonnull() ){
-      map_type::iterator i(_transientMap.find(SimParticleCollection::key_type(parentPtr.key())));
-      if ( i == _transientMap.end() ){
+      SimParticle* parent = _transientMap.find(SimParticleCollection::key_type(parentPtr.key()));
+      if ( parent == nullptr ){
         throw cet::exception("RANGE")
           << "Could not find parent SimParticle in PreUserTrackingAction.  id: "
           << parentPtr.key()
           << "\n";
       }
-      i->second.addDaughter(_spHelper->particlePtr(trk));
+      parent->addDaughter(_spHelper->particlePtr(trk));
     }
 }//saveSimParticleStart
 
@@ -450,9 +455,9 @@ void TrackingAction::saveSimParticleEnd(const G4Track* trk){
 
     key_type kid(_spHelper->particleKeyFromG4TrackID(trk->GetTrackID()));
 
-    // Find the particle in the map.
-    map_type::iterator i(_transientMap.find(kid));
-    if ( i == _transientMap.end() ){
+    // Find the particle in the store.
+    SimParticle* sim = _transientMap.find(kid);
+    if ( sim == nullptr ){
       throw cet::exception("RANGE")
         << "Could not find existing SimParticle in PostUserTrackingAction::saveSimParticleEnd()  id: "
         << kid
@@ -508,23 +513,23 @@ void TrackingAction::saveSimParticleEnd(const G4Track* trk){
     int nSteps = Mu2eG4UserHelpers::getNSteps(trk);
 
     // Add info about the end of the track.  Throw if SimParticle not already there.
-    i->second.addEndInfo( trk->GetPosition()-_mu2eOrigin,
-                          endMomentum,
-                          trk->GetGlobalTime(),
-                          trk->GetProperTime(),
-                          _physVolHelper->index(trk),
-                          trk->GetTrackStatus(),
-                          stoppingCode,
-                          endKE,
-                          nSteps,
-                          trk->GetTrackLength()
-                          );
+    sim->addEndInfo( trk->GetPosition()-_mu2eOrigin,
+                     endMomentum,
+                     trk->GetGlobalTime(),
+                     trk->GetProperTime(),
+                     _physVolHelper->index(trk),
+                     trk->GetTrackStatus(),
+                     stoppingCode,
+                     endKE,
+                     nSteps,
+                     trk->GetTrackLength()
+                     );
 
     if (trackingVerbosityLevel > 0) {
       G4int prec = G4cout.precision(15);
       G4cout << __func__
              << " particle "
-             << i->second.pdgId() << ", "
+             << sim->pdgId() << ", "
              << trk->GetParticleDefinition()->GetParticleName()
              << " stopped by " << stoppingCode << ", " << pname
              << " totE deposit " << fixed << trk->GetStep()->GetTotalEnergyDeposit()
@@ -537,8 +542,8 @@ void TrackingAction::saveSimParticleEnd(const G4Track* trk){
              << " vertex KE " << trk->GetVertexKineticEnergy()
              << " vertex direction " << trk->GetVertexMomentumDirection()
              << G4endl;
-      G4cout << __func__ << " track statuses: " << i->second.startG4Status()
-             << ", " << i->second.endG4Status()
+      G4cout << __func__ << " track statuses: " << sim->startG4Status()
+             << ", " << sim->endG4Status()
              << G4endl;
       G4cout << __func__
              << " step length " << trk->GetStepLength()
@@ -554,12 +559,11 @@ void TrackingAction::swapTrajectory(const G4Track* trk){
 
     key_type kid(_spHelper->particleKeyFromG4TrackID(trk->GetTrackID()));
 
-    const auto& trajectory = _steppingAction->trajectory();
-    if ( int(trajectory.size()) < _mcTrajectoryMinSteps ) return;
+    if ( int(_steppingAction->numTrajectoryCandidates()) < _mcTrajectoryMinSteps ) return;
 
-    // Find the particle in the map.
-    map_type::iterator i(_transientMap.find(kid));
-    if ( i == _transientMap.end() ){
+    // Find the particle in the store.
+    SimParticle const* particle = _transientMap.find(kid);
+    if ( particle == nullptr ){
       G4Event const* event = G4RunManager::GetRunManager()->GetCurrentEvent();
 
       mf::LogWarning("G4") << "TrackingAction::swapTrajectory: "
@@ -570,7 +574,7 @@ void TrackingAction::swapTrajectory(const G4Track* trk){
       return;
     }
 
-    CLHEP::HepLorentzVector const& p0 = i->second.startMomentum();
+    CLHEP::HepLorentzVector const& p0 = particle->startMomentum();
     if ( p0.vect().mag() < _mcTrajectoryMomentumCut ) return;
 
     art::Ptr<SimParticle> sim = _spHelper->particlePtr(trk);
@@ -588,6 +592,7 @@ void TrackingAction::swapTrajectory(const G4Track* trk){
     // The data product takes ownership of the array of points that was created in SteppingAction.
     // This leaves SteppingAction with an empty array.
     MCTrajectory& traj = retval.first->second;
+    _steppingAction->finishTrajectory( trk->GetPosition()-_mu2eOrigin );
     _steppingAction->swapTrajectory( traj.points() );
 
     // So far the trajectory holds the starting point of each step.
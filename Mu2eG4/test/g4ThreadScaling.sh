@@ -0,0 +1,46 @@
+#! /bin/bash
+#
+# Compare the throughput and peak memory of the two multithreaded G4 modes
+# as a function of the number of threads:
+#  - Mu2eG4MT, each art event simulated by one of a pool of G4 workers
+#        (Mu2eG4/fcl/g4test_03artMT.fcl, run with --nthreads N)
+#  - Mu2eG4 in runinMTMode, G4 worker threads filling a stash
+#        (Mu2eG4/fcl/g4test_03MT.fcl, numberOfThreads N)
+#
+# Usage: Mu2eG4/test/g4ThreadScaling.sh [nevents] [thread counts...]
+# Run from the base of a built Offline, after setup.sh.
+# The logs are written to g4scaling_<mode>_<N>.log; the summary is printed.
+#
+
+nevents=${1:-200}
+shift
+threads=${@:-1 2 4 8 16 32}
+
+summary() {
+  # Wall time per event from the TimeTracker summary, peak memory from
+  # MemoryTracker (or /usr/bin/time if MemoryTracker reported nothing).
+  local log=$1
+  local evtime=$(grep -m1 "Full event" $log | awk '{print $4}')
+  local vsz=$(grep -m1 "Peak virtual memory usage (VmPeak)" $log | awk '{print $NF}')
+  local rss=$(grep -m1 "Maximum resident set size" $log | awk '{print $NF}')
+  printf "%-8s %4s  mean event time %-10s  VmPeak %-10s  maxRSS(kB) %s\n" $2 $3 "$evtime" "$vsz" "$rss"
+}
+
+for n in $threads; do
+  log=g4scaling_artMT_${n}.log
+  /usr/bin/time -v mu2e -c Mu2eG4/fcl/g4test_03artMT.fcl -n $nevents \
+      --nthreads $n --nschedules $n >& $log
+  summary $log artMT $n
+
+  cat > g4scaling_stash.fcl <<FCL
+#include "Mu2eG4/fcl/g4test_03MT.fcl"
+physics.producers.g4run.numberOfThreads : $n
+services.TimeTracker : { printSummary : true }
+services.MemoryTracker : { }
+FCL
+  log=g4scaling_stash_${n}.log
+  /usr/bin/time -v mu2e -c g4scaling_stash.fcl -n $nevents >& $log
+  summary $log stash $n
+done
+
+rm -f g4scaling_stash.fcl
@@ -0,0 +1,76 @@
+#ifndef Mu2eUtilities_CounterRandomEngine_hh
+#define Mu2eUtilities_CounterRandomEngine_hh
+
+//
+// A counter-based random number engine: the Philox4x32-10 bijection of
+// Salmon et al. (Random123, SC11) behind the CLHEP engine interface, so
+// it can drive the usual CLHEP distributions.
+//
+// The i-th block of 4 random words of a stream is philox(counter, key),
+// with counter = (i, stream, substream), so there is no state to carry
+// from one stream to another: any (key, stream, substream) can be
+// started at any time, in any order, on any thread, and gives the same
+// numbers.  A typical use is key = a hash of the seed and the event id,
+// stream = the detector element, substream = what the numbers are used
+// for.  Each block gives two flat numbers with 53 random bits, in (0,1).
+//
+
+// C++ includes
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+// CLHEP includes
+#include "CLHEP/Random/RandomEngine.h"
+
+namespace mu2e {
+
+  class CounterRandomEngine : public CLHEP::HepRandomEngine {
+
+  public:
+
+    typedef std::array<uint32_t,4> Counter;
+    typedef std::array<uint32_t,2> Key;
+
+    explicit CounterRandomEngine(uint64_t key = 0);
+
+    // Select the key, or the stream of the current key.  Both restart
+    // the stream at its first number.
+    void setKey(uint64_t key);
+    void setStream(uint32_t stream, uint32_t substream = 0);
+
+    uint64_t key()       const { return (uint64_t(_key[1]) << 32) | _key[0]; }
+    uint32_t stream()    const { return _ctr[2]; }
+    uint32_t substream() const { return _ctr[3]; }
+
+    double flat() override;
+    void flatArray(const int size, double* vect) override;
+
+    // The seed is used as the key
+    void setSeed(long seed, int) override;
+    void setSeeds(const long* seeds, int) override;
+
+    void saveStatus(const char filename[] = "CounterRandomEngine.conf") const override;
+    void restoreStatus(const char filename[] = "CounterRandomEngine.conf") override;
+    void showStatus() const override;
+    std::string name() const override { return engineName(); }
+    static std::string engineName() { return "CounterRandomEngine"; }
+
+    // The Philox4x32-10 bijection, in place
+    static void philox(Counter& ctr, Key key);
+
+  private:
+
+    Key _key;
+    Counter _ctr;     // counter of the next block: block number (2 words), stream, substream
+    Counter _block;   // current block of random words
+    unsigned _next;   // next unused pair of words in _block; 2 = exhausted
+
+    void restart();
+    std::ostream& write(std::ostream& os) const;
+  };
+
+}
+
+#endif /* Mu2eUtilities_CounterRandomEngine_hh */
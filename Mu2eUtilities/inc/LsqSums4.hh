@@ -72,6 +72,11 @@ public:
 
   double chi2DofCircle();
   double chi2DofLine();
+//-----------------------------------------------------------------------------
+// leave-one-out: Chi2[i] = chi2DofLine() of the sums with the point
+// (X[i],Y[i],W[i]) removed, for N points at once, without copying the sums
+//-----------------------------------------------------------------------------
+  void   chi2DofLineWithout(int N, const float* X, const float* Y, const float* W, float* Chi2) const;
   //  ClassDef(LsqSums4,0)
 
 };
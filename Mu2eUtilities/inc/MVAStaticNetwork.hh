@@ -0,0 +1,58 @@
+#ifndef MVAStaticNetwork_HH
+#define MVAStaticNetwork_HH
+//
+//  Building blocks for MLPs compiled into the code.  Headers generated by
+//  Mu2eUtilities/python/mvaToHeader.py from TMVA weight files hold the weights as
+//  constexpr arrays and evaluate the network with these functions, with the same
+//  activation functions and normalization as MVATools.  The dimensions are known at
+//  compile time, so the loops are fully unrolled and vectorized
+//
+#include <algorithm>
+#include <cmath>
+
+namespace mu2e
+{
+  namespace MVAStatic
+  {
+    enum class Activation {tanh, sigmoid, relu};
+
+    template <Activation A, bool OLDMVA> inline float activation(float arg)
+    {
+      if (A == Activation::tanh)
+      {
+        if (OLDMVA) return std::tanh(arg);
+        float arg2 = arg * arg;
+        float a = arg * (135135.0f + arg2 * (17325.0f + arg2 * (378.0f + arg2)));
+        float b = 135135.0f + arg2 * (62370.0f + arg2 * (3150.0f + arg2 * 28.0f));
+        return arg > 4.97 ? 1.0f : (arg < -4.97 ? -1.0f : a/b);
+      }
+      if (A == Activation::sigmoid) return 1.0/(1.0+expf(-arg));
+      return std::max(0.0f,arg);
+    }
+
+    // y = activation(W x) for a hidden layer; x includes the bias node as its last entry,
+    // and the bias node of the next layer is appended to y
+    template <Activation A, bool OLDMVA, unsigned NOUT, unsigned NIN>
+    inline void hiddenLayer(const float (&w)[NOUT][NIN], const float (&x)[NIN], float (&y)[NOUT+1])
+    {
+      for (unsigned j=0;j<NOUT;++j)
+      {
+        float sum(0);
+        for (unsigned i=0;i<NIN;++i) sum += w[j][i]*x[i];
+        y[j] = activation<A,OLDMVA>(sum);
+      }
+      y[NOUT] = 1.0;
+    }
+
+    // output neuron: sigmoid for recent TMVA versions, linear for old ones
+    template <bool OLDMVA, unsigned NIN>
+    inline float outputLayer(const float (&w)[1][NIN], const float (&x)[NIN])
+    {
+      float y(0);
+      for (unsigned i=0;i<NIN;++i) y += w[0][i]*x[i];
+      if (OLDMVA) return y;
+      return 1.0/(1.0+expf(-y));
+    }
+  }
+}
+#endif
@@ -9,6 +9,7 @@
 #include <xercesc/util/PlatformUtils.hpp>
 #include <xercesc/parsers/XercesDOMParser.hpp>
 #include <xercesc/dom/DOMDocument.hpp>
+#include <cstddef>
 #include <vector>
 #include <string>
 namespace mu2e 
@@ -23,11 +24,26 @@ namespace mu2e
        explicit MVATools(fhicl::ParameterSet const&);
        explicit MVATools(const Config& conf);
 
+       // scratch space for the evaluation, owned by the caller.  One workspace per thread;
+       // it can be shared by several MVATools instances
+       struct Workspace {
+         std::vector<float> in_, x_, y_, pad_;
+       };
+
        virtual ~MVATools();
        void     initMVA();
+       // single evaluation, using a per-thread workspace
        float    evalMVA(const std::vector<float>&,MVAMask vmask=0xffffffff) const;
        float    evalMVA(const std::vector<double>&,MVAMask vmask=0xffffffff) const;
+       float    evalMVA(const std::vector<float>&,Workspace& ws,MVAMask vmask=0xffffffff) const;
+       // batched evaluation: nrows input rows of ncols values each (row-major, laid out
+       // like the single evaluation input), one output per row
+       void     evalMVA(const float* inputs, size_t nrows, size_t ncols, float* outputs,
+                        Workspace& ws, MVAMask vmask=0xffffffff) const;
+       void     evalMVA(const std::vector<float>& inputs, size_t ncols, std::vector<float>& outputs,
+                        Workspace& ws, MVAMask vmask=0xffffffff) const;
        void     showMVA()const;
+       unsigned nInputs() const { return voffset_.size(); }
        std::vector<std::string> const& titles() const { return title_;}     
        std::vector<std::string> const& labels() const { return label_;}     
  
@@ -39,13 +55,20 @@ namespace mu2e
        void   getOpts(xercesc::DOMDocument* xmlDoc);
        void   getNorm(xercesc::DOMDocument* xmlDoc);
        void   getWgts(xercesc::DOMDocument* xmlDoc);
-       float activation(float arg) const;
+       void   compile();
+       void   activate(float* y, size_t n) const;
+
+       // compiled layer: row-major (nout x stride) weights.  The input bias is column nin-1,
+       // rows are zero-padded to a multiple of the SIMD width
+       struct Layer {
+         unsigned nin, nout, stride;
+         std::vector<float> w;
+       };
+       static constexpr unsigned simdWidth_ = 8;
 
        std::string mvaWgtsFile_;
        std::vector<std::vector<float>> wgts_;
-       mutable std::vector<float> x_;
-       mutable std::vector<float> y_;
-       mutable std::vector<float> fv_;       
+       std::vector<Layer> layers_;
        std::vector<unsigned> layerToNeurons_;
        std::vector<unsigned> synapsessPerLayer_;       
        std::vector<float> voffset_;
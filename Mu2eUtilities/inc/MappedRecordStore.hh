@@ -0,0 +1,77 @@
+// A read-only, memory-mapped file of fixed size binary records.  It
+// is the on-disk format used by RootTreeSampler as an alternative to
+// ROOT ntuples: the file is mapped MAP_SHARED, so all the processes
+// on a node that sample the same store share a single copy of the
+// pages in the page cache, and nothing is read at construction time.
+//
+// File layout: a 64 byte header (see Header below) followed by
+// numRecords records of recordSize bytes each, in host byte order.
+// Stores are written with the makeRecordStore utility from a ROOT
+// tree produced by the stopped particle dumpers.
+//
+// The data start on a 64 byte boundary, so the records can be
+// accessed in place as an array of the original C++ structure.
+
+#ifndef Mu2eUtilities_MappedRecordStore_hh
+#define Mu2eUtilities_MappedRecordStore_hh
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace mu2e {
+
+  class MappedRecordStore {
+  public:
+
+    struct Header {
+      char          magic[8];        // "MU2ERTS1"
+      std::uint32_t version;
+      std::uint32_t recordSize;      // sizeof the stored C++ structure
+      std::uint32_t numBranchLeaves; // leaves of the branch it was made from
+      std::uint32_t reserved0;
+      std::uint64_t numRecords;
+      char          description[32]; // ROOT branch description, truncated
+    };
+    static_assert(sizeof(Header) == 64, "MappedRecordStore::Header must be 64 bytes");
+
+    static constexpr std::uint32_t currentVersion = 1;
+
+    // File name extension used to tell stores from ROOT files
+    static const std::string& extension();
+    static bool isStoreFileName(const std::string& fileName);
+
+    explicit MappedRecordStore(const std::string& fileName);
+    ~MappedRecordStore();
+
+    MappedRecordStore(const MappedRecordStore&) = delete;
+    MappedRecordStore& operator=(const MappedRecordStore&) = delete;
+
+    const std::string& fileName() const { return fileName_; }
+    const Header& header() const { return *static_cast<const Header*>(map_); }
+
+    std::size_t size() const { return header().numRecords; }
+    std::size_t recordSize() const { return header().recordSize; }
+    unsigned numBranchLeaves() const { return header().numBranchLeaves; }
+
+    // Start of the record array
+    const void* data() const { return static_cast<const char*>(map_) + sizeof(Header); }
+
+    // Helper for writers: a header followed by the records.
+    static void write(std::ostream& os,
+                      const void* records,
+                      std::size_t recordSize,
+                      std::size_t numRecords,
+                      unsigned numBranchLeaves,
+                      const std::string& description);
+
+  private:
+    std::string fileName_;
+    void* map_;
+    std::size_t mapSize_;
+  };
+
+}
+
+#endif /* Mu2eUtilities_MappedRecordStore_hh */
@@ -16,9 +16,9 @@
 #include "ConditionsService/inc/AcceleratorParams.hh"
 #include "GeneralUtilities/inc/EnumToStringSparse.hh"
 #include "Mu2eUtilities/inc/Table.hh"
+#include "Mu2eUtilities/inc/RandAlias.hh"
 
 // CLHEP includes
-#include "CLHEP/Random/RandGeneral.h"
 #include "CLHEP/Random/RandomEngine.h"
 
 // Framework includes
@@ -121,7 +121,7 @@ namespace mu2e {
 
     const std::vector<double> spectrum_;
 
-    CLHEP::RandGeneral randSpectrum_;
+    RandAlias randSpectrum_;
 
     // Modifiers
     double setTmin();
@@ -0,0 +1,55 @@
+// Hash functors for art::Ptr and cet::map_vector_key, and unordered
+// container aliases using them.
+//
+// These are deliberately named functors rather than std::hash
+// specializations, so that they can not clash with a std::hash<art::Ptr>
+// provided by a future art release.
+//
+// A Ptr is hashed on its ProductID and key, the same information its
+// operator== and operator< use.
+
+#ifndef Mu2eUtilities_PtrHash_hh
+#define Mu2eUtilities_PtrHash_hh
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "canvas/Persistency/Common/Ptr.h"
+#include "canvas/Persistency/Provenance/ProductID.h"
+#include "cetlib/map_vector.h"
+
+namespace mu2e {
+
+  namespace PtrHashDetail {
+    // splitmix64 finalizer: keys of one product are consecutive integers
+    inline std::size_t mix(std::uint64_t x) {
+      x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+      return x ^ (x >> 31);
+    }
+  }
+
+  struct PtrHash {
+    template<class T>
+    std::size_t operator()(art::Ptr<T> const& p) const {
+      return PtrHashDetail::mix( (std::uint64_t(p.id().value()) << 40) ^ std::uint64_t(p.key()) );
+    }
+  };
+
+  struct MapVectorKeyHash {
+    std::size_t operator()(cet::map_vector_key const& k) const {
+      return PtrHashDetail::mix(k.asUint());
+    }
+  };
+
+  template<class T>
+  using PtrSet = std::unordered_set<art::Ptr<T>, PtrHash>;
+
+  template<class T, class V>
+  using PtrMap = std::unordered_map<art::Ptr<T>, V, PtrHash>;
+
+}
+
+#endif /* Mu2eUtilities_PtrHash_hh */
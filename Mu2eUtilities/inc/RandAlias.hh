@@ -0,0 +1,112 @@
+#ifndef Mu2eUtilities_RandAlias_hh
+#define Mu2eUtilities_RandAlias_hh
+
+//
+// Draw random numbers from a binned distribution with the Walker/Vose
+// alias method: O(1) per draw, independent of the number of bins.
+//
+// The interface follows CLHEP::RandGeneral, so it can replace it
+// directly: the constructor takes an array of nBins (not necessarily
+// normalized) bin contents, and fire() returns a number in [0,1),
+// with bin i covering [i/nBins, (i+1)/nBins).  The position inside
+// the selected bin is
+//
+//   flat     - uniform, the same distribution as RandGeneral(IntType=0)
+//   discrete - the low edge of the bin, as RandGeneral(IntType=1)
+//   linear   - distributed with a slope estimated from the neighbouring
+//              bins.  The content of each bin is preserved, the density
+//              is continuous across bins for smooth spectra.
+//
+// Each draw uses two flat random numbers: one to choose the bin, one
+// for the position inside it.  fireN() draws a batch from a single
+// flatArray() call.
+//
+
+// C++ includes
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// CLHEP includes
+#include "CLHEP/Random/RandomEngine.h"
+
+namespace mu2e {
+
+  class RandAlias {
+
+  public:
+
+    enum Interpolation { flat, discrete, linear };
+
+    // "flat", "discrete" or "linear"
+    static Interpolation interpolationFromName(const std::string& name);
+
+    RandAlias(CLHEP::HepRandomEngine& engine,
+              const double* pdf,
+              std::size_t nBins,
+              Interpolation interpolation = flat);
+
+    RandAlias(CLHEP::HepRandomEngine& engine,
+              const std::vector<double>& pdf,
+              Interpolation interpolation = flat);
+
+    double fire() {
+      const double u1 = engine_->flat();
+      const double u2 = engine_->flat();
+      return shoot(u1, u2);
+    }
+
+    // Fill out[0..n) with independent draws.  The result is the same
+    // as n successive calls to fire().
+    void fireN(std::size_t n, double* out);
+    void fireN(std::size_t n, std::vector<double>& out) { out.resize(n); fireN(n, out.data()); }
+
+    std::size_t   nBins()         const { return prob_.size(); }
+    Interpolation interpolation() const { return interpolation_; }
+
+    // Probability of bin i after normalization
+    double binProbability(std::size_t i) const { return pdf_.at(i); }
+
+  private:
+
+    CLHEP::HepRandomEngine* engine_;
+    Interpolation interpolation_;
+
+    std::vector<double>   pdf_;   // normalized bin contents
+    std::vector<double>   prob_;  // probability to keep the column's own bin
+    std::vector<unsigned> alias_; // the other bin sharing the column
+    std::vector<double>   slope_; // in-bin slope of the density, linear mode only
+    std::vector<double>   flats_; // scratch for fireN()
+
+    void build();
+
+    // Map two flat numbers to a draw
+    double shoot(double u1, double u2) const {
+      const std::size_t n = prob_.size();
+      double x = u1*n;
+      std::size_t col = static_cast<std::size_t>(x);
+      if(col >= n) col = n-1; // u1 rounding close to 1
+      const std::size_t bin = (x - col < prob_[col]) ? col : alias_[col];
+      return (bin + inBin(bin, u2))/n;
+    }
+
+    double inBin(std::size_t bin, double u) const {
+      switch(interpolation_) {
+      case flat     : return u;
+      case discrete : return 0.;
+      case linear   : break;
+      }
+      // Invert the CDF of f(x) = 1 + b*(x-1/2) on [0,1):
+      // b/2 x^2 + (1-b/2) x - u = 0, written to be stable for b->0.
+      const double b = slope_[bin];
+      const double c = 1. - 0.5*b;
+      const double d = c + std::sqrt(c*c + 2.*b*u);
+      return (d > 0.) ? 2.*u/d : 0.;
+    }
+
+  };
+
+}
+
+#endif /* Mu2eUtilities_RandAlias_hh */
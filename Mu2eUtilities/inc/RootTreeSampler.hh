@@ -25,6 +25,16 @@
 // the feature (the default). If the number of inputs is less than
 // averageNumRecordsToUse, all input records are used.
 //
+// Input files with the MappedRecordStore extension (".rts") are not
+// read at all: they are memory mapped and sampled in place, so the
+// processes on a node share one copy of the records and all the
+// records are used.  This requires EventRecord==NtupleRecord and a
+// trivially copyable record type; averageNumRecordsToUse is ignored
+// for such inputs.  With the same engine state, a store made from a
+// tree gives the same sequence of records as the tree itself (without
+// averageNumRecordsToUse).  Use the makeRecordStore utility to
+// convert a tree.
+//
 // See StoppedParticleReactionGun_module.cc and InFlightParticleSampler_module.cc
 // for examples of use.
 //
@@ -33,6 +43,9 @@
 #ifndef RootTreeSampler_hh
 #define RootTreeSampler_hh
 
+#include <algorithm>
+#include <memory>
+#include <type_traits>
 #include <vector>
 
 #include "fhiclcpp/types/Atom.h"
@@ -52,6 +65,7 @@
 #include "TFile.h"
 
 #include "ConfigTools/inc/ConfigFileLookupPolicy.hh"
+#include "Mu2eUtilities/inc/MappedRecordStore.hh"
 
 namespace mu2e {
 
@@ -107,17 +121,39 @@ namespace mu2e {
     RootTreeSampler(art::RandomNumberGenerator::base_engine_t& engine,
                     const fhicl::ParameterSet& pset);
 
-    const EventRecord& fire() { return records_.at(randFlat_.fireInt(records_.size())); }
+    const EventRecord& fire() {
+      if(stores_.empty()) {
+        return records_.at(randFlat_.fireInt(records_.size()));
+      }
+      return mappedRecord(randFlat_.fireInt(numMapped_));
+    }
 
     typename std::vector<EventRecord>::size_type
-    numRecords() const { return records_.size(); }
+    numRecords() const { return stores_.empty() ? records_.size() : numMapped_; }
 
   private:
     CLHEP::RandFlat randFlat_;
     std::vector<EventRecord> records_;
 
+    // Memory mapped inputs, used instead of records_
+    std::vector<std::unique_ptr<MappedRecordStore> > stores_;
+    std::vector<std::size_t> storeEnds_; // cumulative record counts
+    std::size_t numMapped_ = 0;
+
     typedef std::vector<std::string> Strings;
 
+    // Returns false if the inputs are ROOT files
+    bool mapStores(const Strings& files, long averageNumRecordsToUse, int verbosityLevel);
+
+    const EventRecord& mappedRecord(std::size_t i) const {
+      std::size_t is = 0;
+      if(stores_.size() > 1) {
+        is = std::upper_bound(storeEnds_.begin(), storeEnds_.end(), i) - storeEnds_.begin();
+        i -= storeEnds_[is] - stores_[is]->size();
+      }
+      return static_cast<const EventRecord*>(stores_[is]->data())[i];
+    }
+
     long countInputRecords(const art::ServiceHandle<art::TFileService>& tfs,
                            const Strings& files,
                            const std::string& treeName);
@@ -349,6 +385,10 @@ namespace mu2e {
       throw cet::exception("BADCONFIG")<<"Error: no inputFiles";
     }
 
+    if(mapStores(inputFiles, averageNumRecordsToUse, verbosityLevel)) {
+      return;
+    }
+
     art::ServiceHandle<art::TFileService> tfs;
 
     double recordUseFraction = 1.;
@@ -457,6 +497,10 @@ namespace mu2e {
       throw cet::exception("BADCONFIG")<<"Error: no inputFiles";
     }
 
+    if(mapStores(inputFiles, averageNumRecordsToUse, verbosityLevel)) {
+      return;
+    }
+
     art::ServiceHandle<art::TFileService> tfs;
 
     double recordUseFraction = 1.;
@@ -549,6 +593,70 @@ namespace mu2e {
 
   } // Constructor (pset)
 
+  //================================================================
+  template<class EventRecord, class NtupleRecord>
+  bool RootTreeSampler<EventRecord, NtupleRecord>::mapStores(const Strings& inputFiles,
+                                                             long averageNumRecordsToUse,
+                                                             int verbosityLevel)
+  {
+    const auto numStores = std::count_if(inputFiles.begin(), inputFiles.end(),
+                                         [](const std::string& fn) { return MappedRecordStore::isStoreFileName(fn); });
+    if(numStores == 0) {
+      return false;
+    }
+    if(numStores != long(inputFiles.size())) {
+      throw cet::exception("BADCONFIG")<<"RootTreeSampler: can not mix record stores (\""
+                                       <<MappedRecordStore::extension()
+                                       <<"\") and ROOT files in inputFiles\n";
+    }
+
+    if constexpr(std::is_same<EventRecord,NtupleRecord>::value &&
+                 std::is_trivially_copyable<EventRecord>::value) {
+
+      for(const auto& fn : inputFiles) {
+        const std::string resolvedFileName = ConfigFileLookupPolicy()(fn);
+        auto store = std::make_unique<MappedRecordStore>(resolvedFileName);
+
+        if(store->recordSize() != sizeof(EventRecord)) {
+          throw cet::exception("BADINPUT")<<"RootTreeSampler: wrong record size: expect "
+                                          <<sizeof(EventRecord)<<", but record store \""
+                                          <<resolvedFileName<<"\" has "<<store->recordSize()
+                                          <<"\n";
+        }
+        if(store->numBranchLeaves() != NtupleRecord::numBranchLeaves()) {
+          throw cet::exception("BADINPUT")<<"RootTreeSampler: wrong number of leaves: expect "
+                                          <<NtupleRecord::numBranchLeaves()<<", but record store \""
+                                          <<resolvedFileName<<"\" has "<<store->numBranchLeaves()
+                                          <<"\n";
+        }
+
+        std::cout<<"RootTreeSampler: mapped "<<store->size()
+                 <<" records from "<<resolvedFileName
+                 <<std::endl;
+
+        numMapped_ += store->size();
+        storeEnds_.push_back(numMapped_);
+        stores_.emplace_back(std::move(store));
+      }
+
+      if(numMapped_ == 0) {
+        throw cet::exception("BADINPUT")<<"RootTreeSampler: no records in the input record stores\n";
+      }
+
+      if((averageNumRecordsToUse > 0) && (verbosityLevel > 0)) {
+        std::cout<<"RootTreeSampler: averageNumRecordsToUse is ignored for record stores, "
+                 <<"all "<<numMapped_<<" records are used"
+                 <<std::endl;
+      }
+
+      return true;
+    }
+    else {
+      throw cet::exception("BADCONFIG")<<"RootTreeSampler: record stores are only supported "
+                                       <<"for single, trivially copyable ntuple records\n";
+    }
+  }
+
   //================================================================
   template<class EventRecord, class NtupleRecord>
   long RootTreeSampler<EventRecord, NtupleRecord>::countInputRecords(const art::ServiceHandle<art::TFileService>& tfs,
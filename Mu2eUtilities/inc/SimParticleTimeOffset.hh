@@ -8,6 +8,8 @@
 
 #include <vector>
 #include <string>
+#include <array>
+#include <memory>
 
 #include "fhiclcpp/types/Atom.h"
 #include "fhiclcpp/types/Sequence.h"
@@ -15,6 +17,7 @@
 
 #include "canvas/Utilities/InputTag.h"
 #include "canvas/Persistency/Common/Ptr.h"
+#include "canvas/Persistency/Provenance/ProductID.h"
 
 #include "MCDataProducts/inc/SimParticleTimeMap.hh"
 
@@ -39,6 +42,10 @@ namespace mu2e {
     explicit SimParticleTimeOffset(const fhicl::ParameterSet& pset); // legacy
     explicit SimParticleTimeOffset(const std::vector<art::InputTag>& tags);
 
+    // Copies share the loaded maps but start with an empty cache
+    SimParticleTimeOffset(const SimParticleTimeOffset& other);
+    SimParticleTimeOffset& operator=(const SimParticleTimeOffset& other);
+
     void updateMap(const art::Event& evt);
 
     double totalTimeOffset(art::Ptr<SimParticle> p) const;
@@ -48,8 +55,33 @@ namespace mu2e {
   private:
     std::vector<art::InputTag> inputs_;
 
-    typedef std::vector<SimParticleTimeMap> Maps;
-    mutable Maps offsets_;
+    typedef std::vector<SimParticleTimeMap const*> Maps;
+    Maps offsets_;
+
+    // The total offset of a particle, summed over all maps and
+    // inherited from the primary when needed, is resolved on first
+    // use and then kept in a dense array indexed by the SimParticle
+    // key.  The array is paged so that the sparse keys of mixed or
+    // filtered collections do not allocate the whole key range.
+    // Pages are stamped with the event they were filled in, so
+    // updateMap() invalidates the cache without touching it.
+    static constexpr unsigned kPageBits = 8;
+    static constexpr unsigned kPageSize = 1u<<kPageBits;
+    struct Page {
+      unsigned event;
+      std::array<bool,kPageSize> resolved;
+      std::array<double,kPageSize> offset;
+    };
+    struct KeyCache {
+      art::ProductID pid;
+      std::vector<std::unique_ptr<Page> > pages;
+    };
+
+    mutable std::vector<KeyCache> cache_;
+    unsigned event_ = 0;
+
+    Page& cachePage(art::Ptr<SimParticle> const& p, unsigned& index) const;
+    double resolveOffset(art::Ptr<SimParticle> const& p) const;
   };
 }
 
@@ -49,27 +49,19 @@
 
 #include "MCDataProducts/inc/SimParticleCollection.hh"
 #include "MCDataProducts/inc/SimParticleRemapping.hh"
+#include "Mu2eUtilities/inc/PtrHash.hh"
 
 #include "canvas/Persistency/Provenance/ProductID.h"
 #include "canvas/Persistency/Common/EDProductGetter.h"
 
 namespace mu2e {
 
-  typedef std::map<cet::map_vector_key, cet::map_vector_key> KeyRemap;
+  typedef std::unordered_map<cet::map_vector_key, cet::map_vector_key, MapVectorKeyHash> KeyRemap;
 
   // Pass in the old key to check if it's already added to keyRemap, if it hasn't been then use nextNewKey for the next key
-  cet::map_vector_key getNewKey(const cet::map_vector_key& oldKey, KeyRemap* keyRemap, const unsigned int& nextNewKey) {
-    cet::map_vector_key nextKey;
-
-    if ( keyRemap->find(oldKey) == keyRemap->end() ) { // might have already added the key since parents have a position reserved before they are added to the output
-      nextKey = cet::map_vector_key(nextNewKey);
-      keyRemap->insert( std::make_pair(oldKey, nextKey) ); // update the map
-    }
-    else {
-      nextKey = keyRemap->at(oldKey);
-    }
-
-    return nextKey;
+  inline cet::map_vector_key getNewKey(const cet::map_vector_key& oldKey, KeyRemap* keyRemap, const unsigned int& nextNewKey) {
+    // might have already added the key since parents have a position reserved before they are added to the output
+    return keyRemap->emplace(oldKey, cet::map_vector_key(nextNewKey)).first->second;
   }
 
 
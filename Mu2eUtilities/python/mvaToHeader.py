@@ -0,0 +1,135 @@
+#!/usr/bin/env python
+################################################################################
+# Convert a TMVA MLP weight file into a C++ header with the weights as
+# constexpr arrays and an inline evaluation function, for MVAs evaluated in
+# hot (trigger) loops.  The network is read the same way as MVATools does.
+#
+#   Mu2eUtilities/python/mvaToHeader.py -w TrkPatRec/data/xxx.weights.xml \
+#        -n HelixHitMVA -o TrkPatRec/inc/HelixHitMVA_weights.hh
+#
+# The generated function is
+#   float mu2e::<name>::evalMVA(const float* v)
+# with v holding nInputs values in the order of the weight file variables.
+#
+import sys
+import re
+import struct
+import xml.etree.ElementTree as ET
+from argparse import ArgumentParser
+
+# round to single precision, as the C++ code reads the file with strtof
+def f32(x):
+    return struct.unpack('f', struct.pack('f', x))[0]
+
+def readNetwork(fname):
+    root = ET.parse(fname).getroot()
+
+    net = {'oldMVA': False, 'isNorm': False, 'activation': None}
+    for info in root.iter('Info'):
+        if 'TMVA Release' in info.get('name', ''):
+            m = re.search(r'\[(\d+)\]', info.get('value', ''))
+            if m and int(m.group(1)) < 262657: net['oldMVA'] = True
+
+    for opt in root.find('Options').iter('Option'):
+        name = opt.get('name', '')
+        val = opt.text or ''
+        if 'NeuronType' in name:
+            if 'tanh' in val: net['activation'] = 'tanh'
+            if 'sigmoid' in val: net['activation'] = 'sigmoid'
+            if 'ReLU' in val: net['activation'] = 'relu'
+        if 'VarTransform' in name:
+            if 'Yes' in opt.get('modified', ''): net['isNorm'] = True
+            if net['isNorm'] and 'N' not in val:
+                raise RuntimeError('unknown normalization mode ' + val)
+    if net['activation'] is None:
+        raise RuntimeError('unknown activation function')
+
+    offset, scale, titles = [], [], []
+    for var in root.find('Variables').iter('Variable'):
+        vmin = f32(float(var.get('Min')))
+        vmax = f32(float(var.get('Max')))
+        offset.append(vmin)
+        scale.append(f32(2.0/f32(vmax-vmin)))
+        titles.append(var.get('Title', ''))
+    net['offset'], net['scale'], net['titles'] = offset, scale, titles
+
+    # neuron weights per layer: wtemp[layer][neuron] = weights to the next layer
+    layers = []
+    for layer in root.find('Weights').find('Layout').iter('Layer'):
+        neurons = []
+        for neuron in layer.iter('Neuron'):
+            nsyn = int(neuron.get('NSynapses'))
+            # keep the text, so the compiler rounds it to float exactly as strtof does
+            w = (neuron.text or '').split()
+            if len(w) != nsyn: raise RuntimeError('inconsistent number of synapses')
+            neurons.append(w)
+        layers.append(neurons)
+
+    # transpose into W[out][in], the last input being the bias neuron
+    mats = []
+    for neurons in layers[:-1]:
+        nout = len(neurons[0])
+        mats.append([[neurons[i][j] for i in range(len(neurons))] for j in range(nout)])
+    if len(mats[0][0]) != len(offset)+1:
+        raise RuntimeError('mismatch input dimension and network architecture')
+    net['layers'] = mats
+    return net
+
+def fmt(x):
+    if isinstance(x, str): return x + 'f' if ('.' in x or 'e' in x or 'E' in x) else x + '.f'
+    return repr(x) + 'f'
+
+def writeHeader(net, name, source, out):
+    guard = name + '_weights_HH'
+    act = {'tanh': 'tanh', 'sigmoid': 'sigmoid', 'relu': 'relu'}[net['activation']]
+    old = 'true' if net['oldMVA'] else 'false'
+    nvar = len(net['offset'])
+    L = net['layers']
+
+    out.write('#ifndef %s\n#define %s\n' % (guard, guard))
+    out.write('//\n//  Generated by Mu2eUtilities/python/mvaToHeader.py from\n//    %s\n//  Do not edit.\n//\n' % source)
+    out.write('//  Inputs:\n')
+    for i, t in enumerate(net['titles']): out.write('//    %d %s\n' % (i, t))
+    out.write('//\n#include "Mu2eUtilities/inc/MVAStaticNetwork.hh"\n\n')
+    out.write('namespace mu2e\n{\n  namespace %s\n  {\n' % name)
+    out.write('    constexpr unsigned nInputs = %d;\n' % nvar)
+    out.write('    constexpr bool isNorm = %s;\n' % ('true' if net['isNorm'] else 'false'))
+    out.write('    constexpr float offset[nInputs] = {%s};\n' % ', '.join(fmt(x) for x in net['offset']))
+    out.write('    constexpr float scale[nInputs] = {%s};\n' % ', '.join(fmt(x) for x in net['scale']))
+    for k, W in enumerate(L):
+        out.write('    constexpr float w%d[%d][%d] = {\n' % (k, len(W), len(W[0])))
+        out.write(',\n'.join('      {%s}' % ', '.join(fmt(x) for x in row) for row in W))
+        out.write('};\n')
+
+    out.write('\n    inline float evalMVA(const float* v)\n    {\n')
+    out.write('      float x0[%d];\n' % (nvar+1))
+    out.write('      for (unsigned i=0;i<nInputs;++i) x0[i] = isNorm ? (v[i]-offset[i])*scale[i] - 1.0 : v[i];\n')
+    out.write('      x0[nInputs] = 1.0;\n')
+    for k in range(len(L)-1):
+        out.write('      float x%d[%d];\n' % (k+1, len(L[k])+1))
+        out.write('      MVAStatic::hiddenLayer<MVAStatic::Activation::%s,%s>(w%d,x%d,x%d);\n' % (act, old, k, k, k+1))
+    last = len(L)-1
+    if len(L[last]) != 1:
+        out.write('      // only the first output neuron is used, as in MVATools\n')
+        out.write('      const float (&wout)[1][%d] = *reinterpret_cast<const float (*)[1][%d]>(&w%d[0]);\n' % (len(L[last][0]), len(L[last][0]), last))
+        out.write('      return MVAStatic::outputLayer<%s>(wout,x%d);\n' % (old, last))
+    else:
+        out.write('      return MVAStatic::outputLayer<%s>(w%d,x%d);\n' % (old, last, last))
+    out.write('    }\n  }\n}\n#endif\n')
+
+def main():
+    parser = ArgumentParser(description='Convert a TMVA MLP weight file into a constexpr C++ header')
+    parser.add_argument('-w', '--weights', required=True, help='TMVA weights xml file')
+    parser.add_argument('-n', '--name', required=True, help='namespace of the generated network')
+    parser.add_argument('-o', '--output', help='output header (default: stdout)')
+    args = parser.parse_args()
+
+    net = readNetwork(args.weights)
+    if args.output:
+        with open(args.output, 'w') as out:
+            writeHeader(net, args.name, args.weights, out)
+    else:
+        writeHeader(net, args.name, args.weights, sys.stdout)
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,129 @@
+//
+// Philox4x32-10 counter-based random number engine.
+//
+
+#include "Mu2eUtilities/inc/CounterRandomEngine.hh"
+
+// C++ includes
+#include <fstream>
+#include <iostream>
+
+#include "cetlib_except/exception.h"
+
+namespace {
+
+  // Philox4x32 multipliers and Weyl key increments
+  const uint32_t philoxM0 = 0xD2511F53;
+  const uint32_t philoxM1 = 0xCD9E8D57;
+  const uint32_t philoxW0 = 0x9E3779B9;
+  const uint32_t philoxW1 = 0xBB67AE85;
+
+  // 2^-53
+  const double twoToMinus53 = 1.0/9007199254740992.0;
+
+}
+
+namespace mu2e {
+
+  CounterRandomEngine::CounterRandomEngine(uint64_t key)
+    : _ctr{{0,0,0,0}}
+  {
+    setKey(key);
+  }
+
+  void CounterRandomEngine::setKey(uint64_t key) {
+    _key[0] = static_cast<uint32_t>(key);
+    _key[1] = static_cast<uint32_t>(key >> 32);
+    restart();
+  }
+
+  void CounterRandomEngine::setStream(uint32_t stream, uint32_t substream) {
+    _ctr[2] = stream;
+    _ctr[3] = substream;
+    restart();
+  }
+
+  void CounterRandomEngine::restart() {
+    _ctr[0] = _ctr[1] = 0;
+    _next = 2;
+  }
+
+  void CounterRandomEngine::philox(Counter& ctr, Key key) {
+    for(int iround=0; iround<10; ++iround) {
+      if(iround > 0) {
+        key[0] += philoxW0;
+        key[1] += philoxW1;
+      }
+      const uint64_t p0 = uint64_t(philoxM0)*ctr[0];
+      const uint64_t p1 = uint64_t(philoxM1)*ctr[2];
+      ctr = {{ uint32_t(p1 >> 32) ^ ctr[1] ^ key[0], uint32_t(p1),
+               uint32_t(p0 >> 32) ^ ctr[3] ^ key[1], uint32_t(p0) }};
+    }
+  }
+
+  double CounterRandomEngine::flat() {
+    if(_next == 2) {
+      _block = _ctr;
+      philox(_block, _key);
+      if(++_ctr[0] == 0) ++_ctr[1];
+      _next = 0;
+    }
+    // 27 + 26 bits of a pair of words, centered in their interval so 0 and 1 are never returned
+    const uint32_t hi = _block[2*_next] >> 5;
+    const uint32_t lo = _block[2*_next+1] >> 6;
+    ++_next;
+    return ((uint64_t(hi) << 26 | lo) + 0.5)*twoToMinus53;
+  }
+
+  void CounterRandomEngine::flatArray(const int size, double* vect) {
+    for(int i=0; i<size; ++i) vect[i] = flat();
+  }
+
+  void CounterRandomEngine::setSeed(long seed, int) {
+    setKey(static_cast<uint64_t>(seed));
+  }
+
+  // The first two seeds give the low and high words of the key.  A
+  // non-positive size means a zero-terminated list.
+  void CounterRandomEngine::setSeeds(const long* seeds, int size) {
+    uint64_t key = static_cast<uint32_t>(seeds[0]);
+    if(size > 1 || (size <= 0 && seeds[0] != 0)) {
+      key |= uint64_t(static_cast<uint32_t>(seeds[1])) << 32;
+    }
+    setKey(key);
+  }
+
+  std::ostream& CounterRandomEngine::write(std::ostream& os) const {
+    os << engineName() << " " << _key[0] << " " << _key[1];
+    for(auto word : _ctr) os << " " << word;
+    return os << " " << _next << "\n";
+  }
+
+  void CounterRandomEngine::saveStatus(const char filename[]) const {
+    std::ofstream os(filename);
+    if(!os) {
+      throw cet::exception("RANDOM") << "CounterRandomEngine: can not write " << filename << "\n";
+    }
+    write(os);
+  }
+
+  void CounterRandomEngine::restoreStatus(const char filename[]) {
+    std::ifstream is(filename);
+    std::string name;
+    is >> name >> _key[0] >> _key[1] >> _ctr[0] >> _ctr[1] >> _ctr[2] >> _ctr[3] >> _next;
+    if(!is || name != engineName() || _next > 2) {
+      throw cet::exception("RANDOM") << "CounterRandomEngine: can not restore the status from " << filename << "\n";
+    }
+    // regenerate the current block, the one before the counter
+    if(_next < 2) {
+      _block = _ctr;
+      if(_block[0]-- == 0) --_block[1];
+      philox(_block, _key);
+    }
+  }
+
+  void CounterRandomEngine::showStatus() const {
+    write(std::cout);
+  }
+
+}
@@ -189,3 +189,24 @@ double LsqSums4::chi2DofLine() {
   
   return chi2;
 }
+
+//-----------------------------------------------------------------------------
+// same as chi2DofLine() after removePoint(X[i],Y[i],W[i]); the loop has no
+// dependence between the points and is vectorized by the compiler
+//-----------------------------------------------------------------------------
+void LsqSums4::chi2DofLineWithout(int N, const float* X, const float* Y, const float* W, float* Chi2) const {
+  for (int i=0; i<N; ++i) {
+    double x   = X[i]-fX0;
+    double y   = Y[i]-fY0;
+    double w   = W[i];
+    double qn  = _qn-1;
+    double sw1 = sw-w;
+    double mx  = (sx -x*w  )/sw1;
+    double my  = (sy -y*w  )/sw1;
+    double sigxx = (sx2-x*x*w)/sw1 - mx*mx;
+    double sigxy = (sxy-x*y*w)/sw1 - mx*my;
+    double sigyy = (sy2-y*y*w)/sw1 - my*my;
+
+    Chi2[i] = (sigyy*sigxx - sigxy*sigxy)/sigxx*sw1/qn;
+  }
+}
@@ -8,6 +8,8 @@
 #include <xercesc/parsers/XercesDOMParser.hpp>
 #include <xercesc/dom/DOM.hpp>
 #include <xercesc/sax/HandlerBase.hpp>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <iomanip>
 #include <string>
@@ -24,9 +26,7 @@ namespace mu2e
 MVATools::MVATools(const Config& config) : 
   mvaWgtsFile_(), 
   wgts_(), 
-  x_(), 
-  y_(),
-  fv_(), 
+  layers_(), 
   layerToNeurons_(), 
   synapsessPerLayer_(),
   voffset_(), 
@@ -46,9 +46,7 @@ MVATools::MVATools(const Config& config) :
 MVATools::MVATools(fhicl::ParameterSet const& pset) : 
   mvaWgtsFile_(), 
   wgts_(), 
-  x_(), 
-  y_(),
-  fv_(), 
+  layers_(), 
   layerToNeurons_(), 
   synapsessPerLayer_(),
   voffset_(), 
@@ -100,6 +98,7 @@ void MVATools::initMVA()
     getOpts(xmlDoc);
     getNorm(xmlDoc);
     getWgts(xmlDoc);
+    compile();
 }
 
 void MVATools::getGen(xercesc::DOMDocument* xmlDoc)
@@ -317,13 +316,6 @@ void MVATools::getWgts(xercesc::DOMDocument* xmlDoc)
 	}
     }
     
-    unsigned maxSynapses=*std::max_element(layerToNeurons_.begin(),layerToNeurons_.end());
-    for (unsigned i=0;i<layerToNeurons_[1];++i) x_.push_back(1);
-    for (unsigned i=0;i<=maxSynapses;++i) y_.push_back(0);
-    
-    for (unsigned i=0;i<layerToNeurons_[1]-1;++i) fv_.push_back(0);
-    
-    
     XMLString::release(&ATT_INDEX);
     XMLString::release(&ATT_NSYNAPSES);    
 }
@@ -331,72 +323,208 @@ void MVATools::getWgts(xercesc::DOMDocument* xmlDoc)
 
 
 
+// Pack the weights of each layer into a contiguous, zero-padded row-major matrix
+void MVATools::compile()
+{
+    layers_.clear();
+    unsigned idxWeight(0);
+    for (unsigned k=0;k<synapsessPerLayer_.size();++k)
+    {
+      Layer layer;
+      layer.nout   = synapsessPerLayer_[k];
+      layer.nin    = wgts_[idxWeight].size();
+      layer.stride = ((layer.nin+simdWidth_-1)/simdWidth_)*simdWidth_;
+      layer.w.assign(layer.nout*layer.stride,0.0);
+      for (unsigned j=0;j<layer.nout;++j)
+      {
+        if (wgts_[idxWeight].size() != layer.nin) 
+          throw cet::exception("RECO")<<"mu2e::MVATools: inconsistent layer size" << std::endl;
+        std::copy(wgts_[idxWeight].begin(),wgts_[idxWeight].end(),layer.w.begin()+j*layer.stride);
+        ++idxWeight;
+      }
+      if (k>0 && layer.nin != layers_.back().nout+1) 
+        throw cet::exception("RECO")<<"mu2e::MVATools: layer dimensions do not match" << std::endl;
+      layers_.push_back(std::move(layer));
+    }
+    if (layers_.empty() || layers_.front().nin != voffset_.size()+1)
+      throw cet::exception("RECO")<<"mu2e::MVATools: mismatch input dimension and network architecture" << std::endl;
+}
+
+
+namespace {
+  inline float hsum(const float* a) { return ((a[0]+a[4])+(a[1]+a[5]))+((a[2]+a[6])+(a[3]+a[7])); }
+
+  // four input rows against all weight rows: each weight row is loaded once for the 4 inputs,
+  // and the 8 partial sums per dot product map onto SIMD lanes.  Rows are zero-padded, stride
+  // is a multiple of 8
+  inline void block4(const float* __restrict__ w, unsigned nout, unsigned stride,
+                     const float* __restrict__ x0, const float* __restrict__ x1,
+                     const float* __restrict__ x2, const float* __restrict__ x3,
+                     float* __restrict__ y0, float* __restrict__ y1,
+                     float* __restrict__ y2, float* __restrict__ y3)
+  {
+     for (unsigned j=0;j<nout;++j)
+     {
+        const float* wj = w+j*stride;
+        float a0[8] = {0,0,0,0,0,0,0,0}, a1[8] = {0,0,0,0,0,0,0,0};
+        float a2[8] = {0,0,0,0,0,0,0,0}, a3[8] = {0,0,0,0,0,0,0,0};
+        for (unsigned i=0;i<stride;i+=8)
+        {
+           for (unsigned l=0;l<8;++l)
+           {
+              const float wl = wj[i+l];
+              a0[l] += wl*x0[i+l];
+              a1[l] += wl*x1[i+l];
+              a2[l] += wl*x2[i+l];
+              a3[l] += wl*x3[i+l];
+           }
+        }
+        y0[j] = hsum(a0);
+        y1[j] = hsum(a1);
+        y2[j] = hsum(a2);
+        y3[j] = hsum(a3);
+     }
+  }
+
+  // y[r*ystride+j] = w_j . x_r for nrows input rows.  The last partial block is padded with
+  // its first row, writing into scratch, so every row goes through the same code and batched and single evaluations
+  // give identical results.  Not inlined, so a constant nrows=1 can not give a specialized
+  // copy with different floating-point contraction
+  __attribute__((noinline)) void gemm(const float* w, unsigned nout, unsigned stride,
+            const float* x, size_t nrows, float* y, unsigned ystride, std::vector<float>& scratch)
+  {
+     for (size_t r=0;r<nrows;r+=4)
+     {
+        const float* xb[4];
+        float* yb[4];
+        for (unsigned l=0;l<4;++l)
+        {
+           if (r+l < nrows)
+           {
+              xb[l] = x+(r+l)*stride;
+              yb[l] = y+(r+l)*ystride;
+           } else {
+              if (scratch.size() < 4*nout) scratch.resize(4*nout);
+              xb[l] = xb[0];
+              yb[l] = scratch.data()+l*nout;
+           }
+        }
+        block4(w,nout,stride,xb[0],xb[1],xb[2],xb[3],yb[0],yb[1],yb[2],yb[3]);
+     }
+  }
+}
+
+
 float MVATools::evalMVA(const std::vector<double >& v,MVAMask mask) const 
 {
-   for (size_t i=0;i<v.size();++i)  fv_[i] = static_cast<float>(v[i]);   
-   return evalMVA(fv_,mask);
+   thread_local Workspace ws;
+   ws.in_.assign(v.begin(),v.end());
+   float out(0);
+   evalMVA(ws.in_.data(),1,ws.in_.size(),&out,ws,mask);
+   return out;
 }
 
 float MVATools::evalMVA(const std::vector<float>& v,MVAMask mask) const 
 {
-    // Normalize the bias node is 
-    // skip variables not masked
-    size_t ival(0);
+   thread_local Workspace ws;
+   return evalMVA(v,ws,mask);
+}
+
+float MVATools::evalMVA(const std::vector<float>& v,Workspace& ws,MVAMask mask) const 
+{
+   float out(0);
+   evalMVA(v.data(),1,v.size(),&out,ws,mask);
+   return out;
+}
+
+void MVATools::evalMVA(const std::vector<float>& inputs, size_t ncols, std::vector<float>& outputs,
+                       Workspace& ws, MVAMask mask) const
+{
+   size_t nrows = ncols > 0 ? inputs.size()/ncols : 0;
+   outputs.resize(nrows);
+   evalMVA(inputs.data(),nrows,ncols,outputs.data(),ws,mask);
+}
+
+void MVATools::evalMVA(const float* inputs, size_t nrows, size_t ncols, float* outputs,
+                       Workspace& ws, MVAMask mask) const
+{
+    if (layers_.empty()) throw cet::exception("RECO")<<"mu2e::MVATools: not initialized" << std::endl;
+
+    // Normalize the inputs, skipping variables not masked, and add the bias node
     unsigned vsize = voffset_.size();
-    for (size_t ivar=0; ivar < v.size(); ivar++){
-      if( (mask&(1<<ivar))){
-	x_[ival]= isNorm_ ? (v[ivar]-voffset_[ival])*vscale_[ival] - 1.0 : v[ivar];
-	ival++;
+    const Layer& first = layers_.front();
+    ws.x_.assign(nrows*first.stride,0.0);
+    for (size_t r=0;r<nrows;++r)
+    {
+      const float* v = inputs+r*ncols;
+      float* x = ws.x_.data()+r*first.stride;
+      size_t ival(0);
+      for (size_t ivar=0; ivar < ncols; ivar++){
+        if( (mask&(1<<ivar))){
+          if (ival < vsize) x[ival]= isNorm_ ? (v[ivar]-voffset_[ival])*vscale_[ival] - 1.0 : v[ivar];
+          ival++;
+        }
       }
+      if (ival != vsize) 
+        throw cet::exception("RECO")<<"mu2e::MVATools: mismatch input dimension and network architecture" << std::endl;
+      x[vsize] = 1.0;
     }
-    x_[vsize] = 1.0;
-        
+
     //forward propagation of internal layers
-    unsigned idxWeight(0);
-    for (unsigned k=0;k<synapsessPerLayer_.size()-1;++k)
-    {          
-      for (unsigned j=0;j<synapsessPerLayer_[k];++j)
+    for (unsigned k=0;k+1<layers_.size();++k)
+    {
+      const Layer& layer = layers_[k];
+      const unsigned ystride = layers_[k+1].stride;
+      ws.y_.assign(nrows*ystride,0.0);
+      gemm(layer.w.data(),layer.nout,layer.stride,ws.x_.data(),nrows,ws.y_.data(),ystride,ws.pad_);
+      for (size_t r=0;r<nrows;++r)
       {
-	y_[j]=0.0;
-	for (unsigned i=0;i<wgts_[idxWeight].size();++i) y_[j] += wgts_[idxWeight][i]*x_[i];
-        y_[j] = activation(y_[j]);
-        ++idxWeight;
-      }      
-            
-      x_.swap(y_); //faster than assignment
-      x_[synapsessPerLayer_[k]] = 1.0; //add bias neuron
-    }   
-    
-    //output layer
-    float y(0.0);
-    for (unsigned i=0;i<wgts_[idxWeight].size();++i) y += wgts_[idxWeight][i]*x_[i];
+        float* y = ws.y_.data()+r*ystride;
+        activate(y,layer.nout);
+        y[layer.nout] = 1.0; //add bias neuron
+      }
+      ws.x_.swap(ws.y_); 
+    }
 
-    if (ival != layerToNeurons_[1]-1) 
-      throw cet::exception("RECO")<<"mu2e::MVATools: mismatch input dimension and network architecture" << std::endl;
+    //output layer: only the first output neuron is used
+    const Layer& last = layers_.back();
+    gemm(last.w.data(),1,last.stride,ws.x_.data(),nrows,outputs,1,ws.pad_);
 
-  if (oldMVA_) return y;
-    return  1.0/(1.0+expf(-y));
+    if (oldMVA_) return;
+    for (size_t r=0;r<nrows;++r) outputs[r] = 1.0/(1.0+expf(-outputs[r]));
 }
 
 
 
 
-float MVATools::activation(float arg) const
+void MVATools::activate(float* y, size_t n) const
 {
-   if (activeType_== aType::tanh)
+   switch (activeType_)
    {
-     if (oldMVA_) return std::tanh(arg);
-     if (arg > 4.97) return 1.0;
-     if (arg < -4.97) return -1.0;
-     float arg2 = arg * arg;
-     float a = arg * (135135.0f + arg2 * (17325.0f + arg2 * (378.0f + arg2)));
-     float b = 135135.0f + arg2 * (62370.0f + arg2 * (3150.0f + arg2 * 28.0f));
-     return a/b;
+     case aType::tanh:
+       if (oldMVA_)
+       {
+         for (size_t i=0;i<n;++i) y[i] = std::tanh(y[i]);
+         break;
+       }
+       for (size_t i=0;i<n;++i)
+       {
+         float arg = y[i];
+         float arg2 = arg * arg;
+         float a = arg * (135135.0f + arg2 * (17325.0f + arg2 * (378.0f + arg2)));
+         float b = 135135.0f + arg2 * (62370.0f + arg2 * (3150.0f + arg2 * 28.0f));
+         y[i] = arg > 4.97 ? 1.0f : (arg < -4.97 ? -1.0f : a/b);
+       }
+       break;
+     case aType::sigmoid:
+       for (size_t i=0;i<n;++i) y[i] = 1.0/(1.0+expf(-y[i]));
+       break;
+     case aType::relu:
+       for (size_t i=0;i<n;++i) y[i] = std::max(0.0f,y[i]);
+       break;
+     default:
+       for (size_t i=0;i<n;++i) y[i] = -999.0;
    }
-   if (activeType_== aType::sigmoid) return 1.0/(1.0+expf(-arg));
-   if (activeType_== aType::relu) return std::max(0.0f,arg);
-   
-   return -999.0;
 }
 
 
@@ -0,0 +1,120 @@
+#include "Mu2eUtilities/inc/MappedRecordStore.hh"
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "cetlib_except/exception.h"
+
+namespace mu2e {
+
+  namespace {
+    const char storeMagic[8] = { 'M','U','2','E','R','T','S','1' };
+  }
+
+  const std::string& MappedRecordStore::extension() {
+    static const std::string ext(".rts");
+    return ext;
+  }
+
+  bool MappedRecordStore::isStoreFileName(const std::string& fileName) {
+    const std::string& ext = extension();
+    return (fileName.size() > ext.size()) &&
+      (fileName.compare(fileName.size() - ext.size(), ext.size(), ext) == 0);
+  }
+
+  //================================================================
+  MappedRecordStore::MappedRecordStore(const std::string& fileName)
+    : fileName_(fileName)
+    , map_(nullptr)
+    , mapSize_(0)
+  {
+    const int fd = ::open(fileName.c_str(), O_RDONLY);
+    if(fd < 0) {
+      throw cet::exception("BADINPUT")<<"MappedRecordStore: can not open \""<<fileName
+                                      <<"\": "<<std::strerror(errno)<<"\n";
+    }
+
+    struct stat st;
+    if(::fstat(fd, &st) != 0) {
+      const int err = errno;
+      ::close(fd);
+      throw cet::exception("BADINPUT")<<"MappedRecordStore: can not stat \""<<fileName
+                                      <<"\": "<<std::strerror(err)<<"\n";
+    }
+
+    mapSize_ = st.st_size;
+    if(mapSize_ < sizeof(Header)) {
+      ::close(fd);
+      throw cet::exception("BADINPUT")<<"MappedRecordStore: file \""<<fileName
+                                      <<"\" is too short for a record store header\n";
+    }
+
+    map_ = ::mmap(nullptr, mapSize_, PROT_READ, MAP_SHARED, fd, 0);
+    const int err = errno;
+    // The mapping stays valid after the descriptor is closed
+    ::close(fd);
+    if(map_ == MAP_FAILED) {
+      map_ = nullptr;
+      throw cet::exception("BADINPUT")<<"MappedRecordStore: mmap of \""<<fileName
+                                      <<"\" failed: "<<std::strerror(err)<<"\n";
+    }
+
+    const Header& h = header();
+    std::string problem;
+    if(std::memcmp(h.magic, storeMagic, sizeof(storeMagic)) != 0) {
+      problem = "not a record store (bad magic)";
+    }
+    else if(h.version != currentVersion) {
+      problem = "unsupported version " + std::to_string(h.version);
+    }
+    else if(h.recordSize == 0 ||
+            mapSize_ != sizeof(Header) + h.numRecords*h.recordSize) {
+      problem = "file size does not match the header";
+    }
+    if(!problem.empty()) {
+      ::munmap(map_, mapSize_);
+      map_ = nullptr;
+      throw cet::exception("BADINPUT")<<"MappedRecordStore: file \""<<fileName
+                                      <<"\": "<<problem<<"\n";
+    }
+
+    // Sampling is random access: do not read ahead.
+    ::madvise(map_, mapSize_, MADV_RANDOM);
+  }
+
+  MappedRecordStore::~MappedRecordStore() {
+    if(map_) {
+      ::munmap(map_, mapSize_);
+    }
+  }
+
+  //================================================================
+  void MappedRecordStore::write(std::ostream& os,
+                                const void* records,
+                                std::size_t recordSize,
+                                std::size_t numRecords,
+                                unsigned numBranchLeaves,
+                                const std::string& description)
+  {
+    Header h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, storeMagic, sizeof(storeMagic));
+    h.version = currentVersion;
+    h.recordSize = recordSize;
+    h.numBranchLeaves = numBranchLeaves;
+    h.numRecords = numRecords;
+    std::strncpy(h.description, description.c_str(), sizeof(h.description)-1);
+
+    os.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    os.write(static_cast<const char*>(records), recordSize*numRecords);
+    if(!os) {
+      throw cet::exception("IO")<<"MappedRecordStore: error writing record store\n";
+    }
+  }
+
+}
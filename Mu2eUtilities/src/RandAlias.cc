@@ -0,0 +1,110 @@
+//
+// Walker/Vose alias table sampling of a binned distribution.
+//
+
+#include "Mu2eUtilities/inc/RandAlias.hh"
+
+// C++ includes
+#include <algorithm>
+
+#include "cetlib_except/exception.h"
+
+namespace mu2e {
+
+  RandAlias::RandAlias(CLHEP::HepRandomEngine& engine,
+                       const double* pdf,
+                       std::size_t nBins,
+                       Interpolation interpolation)
+    : engine_(&engine)
+    , interpolation_(interpolation)
+    , pdf_(pdf, pdf+nBins)
+  {
+    build();
+  }
+
+  RandAlias::RandAlias(CLHEP::HepRandomEngine& engine,
+                       const std::vector<double>& pdf,
+                       Interpolation interpolation)
+    : engine_(&engine)
+    , interpolation_(interpolation)
+    , pdf_(pdf)
+  {
+    build();
+  }
+
+  RandAlias::Interpolation RandAlias::interpolationFromName(const std::string& name) {
+    if(name == "flat"    ) return flat;
+    if(name == "discrete") return discrete;
+    if(name == "linear"  ) return linear;
+    throw cet::exception("BADCONFIG")<<"RandAlias: unknown interpolation "<<name<<"\n";
+  }
+
+  //================================================================
+  void RandAlias::build() {
+    const std::size_t n = pdf_.size();
+    if(n == 0) {
+      throw cet::exception("BADCONFIG")<<"RandAlias: empty pdf\n";
+    }
+
+    double sum = 0.;
+    for(std::size_t i=0; i<n; ++i) {
+      if(!(pdf_[i] >= 0.) || std::isinf(pdf_[i])) {
+        throw cet::exception("BADCONFIG")<<"RandAlias: invalid pdf value "<<pdf_[i]
+                                         <<" in bin "<<i<<"\n";
+      }
+      sum += pdf_[i];
+    }
+    if(!(sum > 0.)) {
+      throw cet::exception("BADCONFIG")<<"RandAlias: pdf integral is zero\n";
+    }
+    for(auto& p : pdf_) p /= sum;
+
+    // Vose's algorithm: each of the n columns holds probability 1/n,
+    // shared between the column's own bin and at most one alias.
+    prob_.assign(n, 1.);
+    alias_.resize(n);
+    std::vector<double> scaled(n);
+    std::vector<unsigned> small, large;
+    small.reserve(n);
+    large.reserve(n);
+    for(std::size_t i=0; i<n; ++i) {
+      alias_[i] = i;
+      scaled[i] = pdf_[i]*n;
+      (scaled[i] < 1. ? small : large).push_back(i);
+    }
+    while(!small.empty() && !large.empty()) {
+      const unsigned l = small.back(); small.pop_back();
+      const unsigned g = large.back(); large.pop_back();
+      prob_[l]  = scaled[l];
+      alias_[l] = g;
+      scaled[g] = (scaled[g] + scaled[l]) - 1.;
+      (scaled[g] < 1. ? small : large).push_back(g);
+    }
+    // Whatever is left is 1 up to rounding: those columns keep their own bin
+    for(auto i : small) prob_[i] = 1.;
+    for(auto i : large) prob_[i] = 1.;
+
+    if(interpolation_ == linear) {
+      // Slope per bin relative to the bin content, from the neighbours.
+      // |b|<=2 keeps the density non-negative over the bin.
+      slope_.assign(n, 0.);
+      for(std::size_t i=0; (n > 1) && (i<n); ++i) {
+        if(pdf_[i] <= 0.) continue;
+        const double d = (i == 0)   ? pdf_[1] - pdf_[0]
+          :              (i == n-1) ? pdf_[n-1] - pdf_[n-2]
+          :              0.5*(pdf_[i+1] - pdf_[i-1]);
+        slope_[i] = std::max(-2., std::min(2., d/pdf_[i]));
+      }
+    }
+  }
+
+  //================================================================
+  void RandAlias::fireN(std::size_t n, double* out) {
+    flats_.resize(2*n);
+    engine_->flatArray(static_cast<int>(2*n), flats_.data());
+    for(std::size_t i=0; i<n; ++i) {
+      out[i] = shoot(flats_[2*i], flats_[2*i+1]);
+    }
+  }
+
+}
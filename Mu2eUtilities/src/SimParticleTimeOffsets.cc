@@ -33,58 +33,130 @@ namespace mu2e {
     }
   }
 
+  SimParticleTimeOffset::SimParticleTimeOffset(const SimParticleTimeOffset& other)
+    : inputs_(other.inputs_)
+    , offsets_(other.offsets_)
+    , event_(other.event_)
+  {}
+
+  SimParticleTimeOffset& SimParticleTimeOffset::operator=(const SimParticleTimeOffset& other) {
+    if(this != &other) {
+      inputs_ = other.inputs_;
+      offsets_ = other.offsets_;
+      event_ = other.event_;
+      cache_.clear();
+    }
+    return *this;
+  }
+
   void SimParticleTimeOffset::updateMap(const art::Event& evt) {
     offsets_.clear();
     for(const auto& tag: inputs_) {
       auto m = evt.getValidHandle<SimParticleTimeMap>(tag);
-      offsets_.emplace_back(*m);
+      offsets_.emplace_back(m.product());
     }
+    // invalidate all cached offsets
+    ++event_;
   }
 
-  double SimParticleTimeOffset::totalTimeOffset(art::Ptr<SimParticle> p) const {
-
-    if(offsets_.size() != inputs_.size()) {
-      throw cet::exception("INVOCATION_ERROR")
-        <<"SimParticleTimeOffset::totalTimeOffset():"
-        <<" the number of loaded time maps "<<offsets_.size()
-        <<" does not match the number of requested maps "<<inputs_.size()
-        <<". Did you forget to call SimParticleTimeOffset::updateMap()?\n"
-        ;
+  SimParticleTimeOffset::Page&
+  SimParticleTimeOffset::cachePage(art::Ptr<SimParticle> const& p, unsigned& index) const {
+    KeyCache* kc = nullptr;
+    for(auto& c : cache_) {
+      if(c.pid == p.id()) {
+        kc = &c;
+        break;
+      }
+    }
+    if(kc == nullptr) {
+      cache_.emplace_back();
+      kc = &cache_.back();
+      kc->pid = p.id();
     }
 
-    double dt = 0;
-
-    // Look up the particle in all the maps, and add up the offsets
-    for(auto& m : offsets_) {
+    const auto ipage = p.key() >> kPageBits;
+    if(ipage >= kc->pages.size()) {
+      kc->pages.resize(ipage+1);
+    }
+    auto& page = kc->pages[ipage];
+    if(!page) {
+      page.reset(new Page());
+      page->event = event_ - 1;
+    }
+    if(page->event != event_) {
+      page->event = event_;
+      page->resolved.fill(false);
+    }
+    index = p.key() & (kPageSize-1);
+    return *page;
+  }
 
-      auto it = m.find(p);
+  double SimParticleTimeOffset::resolveOffset(art::Ptr<SimParticle> const& p) const {
 
-      if(it == m.end()) { // no cached record for this particle
+    double dt = 0;
+    unsigned nfound = 0;
+    for(const auto* m : offsets_) {
+      auto it = m->find(p);
+      if(it != m->end()) {
+        dt += it->second;
+        ++nfound;
+      }
+    }
+    if(nfound == offsets_.size()) {
+      return dt;
+    }
 
-        const auto orig(p);
+    // Navigate to the primary
+    auto primary(p);
+    while(primary->parent()) {
+      primary = primary->parent();
+    }
 
-        // Navigate to the primary
-        while(p->parent()) {
-          p = p->parent();
-        }
+    // The common case: the particle inherits all of its offsets from
+    // the primary, whose total is cached for its other descendants.
+    if((nfound == 0) && (primary != p)) {
+      return totalTimeOffset(primary);
+    }
 
-        it = m.find(p);
-        if(it != m.end()) {
-          // cache the result
-          m[orig] = it->second;
-        }
-        else { // The ultimate parent must be in the map
+    for(const auto* m : offsets_) {
+      if(m->find(p) == m->end()) {
+        auto it = m->find(primary);
+        if(it == m->end()) { // The ultimate parent must be in the map
           throw cet::exception("BADINPUTS")
-            <<"SimParticleTimeOffset::totalTimeOffset(): the primary "<<p
+            <<"SimParticleTimeOffset::totalTimeOffset(): the primary "<<primary
             <<" is not in an input map\n";
         }
-      } // caching
+        dt += it->second;
+      }
+    }
 
-      dt += it->second;
+    return dt;
+  }
 
-    } // loop over offsets_ maps
+  double SimParticleTimeOffset::totalTimeOffset(art::Ptr<SimParticle> p) const {
 
-    return dt;
+    if(offsets_.size() != inputs_.size()) {
+      throw cet::exception("INVOCATION_ERROR")
+        <<"SimParticleTimeOffset::totalTimeOffset():"
+        <<" the number of loaded time maps "<<offsets_.size()
+        <<" does not match the number of requested maps "<<inputs_.size()
+        <<". Did you forget to call SimParticleTimeOffset::updateMap()?\n"
+        ;
+    }
+
+    if(offsets_.empty()) {
+      return 0.;
+    }
+
+    // Pages are heap allocated, so the reference stays valid while
+    // resolveOffset() fills in the cache for the primary.
+    unsigned index(0);
+    Page& page = cachePage(p, index);
+    if(!page.resolved[index]) {
+      page.offset[index] = resolveOffset(p);
+      page.resolved[index] = true;
+    }
+    return page.offset[index];
   }
 
   double SimParticleTimeOffset::totalTimeOffset(const StepPointMC& s) const {
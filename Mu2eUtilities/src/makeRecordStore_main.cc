@@ -0,0 +1,127 @@
+//
+// Convert a stopped (or in-flight) particle ntuple into a
+// MappedRecordStore file that RootTreeSampler can memory map.
+// This is a one time conversion; the output is in host byte order.
+//
+
+#include "TFile.h"
+#include "TTree.h"
+#include "TBranch.h"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "cetlib_except/exception.h"
+
+#include "GeneralUtilities/inc/RSNTIO.hh"
+#include "Mu2eUtilities/inc/MappedRecordStore.hh"
+
+void makeRecordStore_usage() {
+
+  std::cout <<
+"  \n"
+"      makeRecordStore RECORDTYPE INFILE TREENAME BRANCHNAME OUTFILE\n"
+"  \n"
+"  Copy all entries of a RootTreeSampler input branch into a record\n"
+"  store.  RECORDTYPE is one of\n"
+"    StoppedParticleF  StoppedParticleTauNormF  InFlightParticleD\n"
+"  OUTFILE should end in .rts so that RootTreeSampler recognizes it.\n"
+"  \n"
+"  Example:\n"
+"    makeRecordStore StoppedParticleF nts.mu2e.DS-TGTstops.root \\\n"
+"        stoppedMuonDumper/stops stops DS-TGTstops.rts\n"
+"  \n"
+            << std::endl;
+}
+
+template<class Record>
+long convert(TTree* tree, const std::string& branchName, const std::string& outName) {
+
+  TBranch *bb = tree->GetBranch(branchName.c_str());
+  if(!bb) {
+    throw cet::exception("BADINPUT")<<"makeRecordStore: no branch \""<<branchName
+                                    <<"\" in tree \""<<tree->GetName()<<"\"\n";
+  }
+  if(unsigned(bb->GetNleaves()) != Record::numBranchLeaves()) {
+    throw cet::exception("BADINPUT")<<"makeRecordStore: wrong number of leaves: expect "
+                                    <<Record::numBranchLeaves()<<", but branch \""<<branchName
+                                    <<"\" has "<<bb->GetNleaves()<<"\n";
+  }
+
+  Record rec;
+  bb->SetAddress(&rec);
+
+  const Long64_t nentries = tree->GetEntries();
+  std::vector<Record> records;
+  records.reserve(nentries);
+  for(Long64_t i=0; i<nentries; ++i) {
+    bb->GetEntry(i);
+    records.push_back(rec);
+  }
+
+  std::ofstream os(outName, std::ios::binary | std::ios::trunc);
+  if(!os) {
+    throw cet::exception("IO")<<"makeRecordStore: can not open \""<<outName<<"\" for writing\n";
+  }
+  mu2e::MappedRecordStore::write(os, records.data(), sizeof(Record), records.size(),
+                                 Record::numBranchLeaves(), Record::branchDescription());
+  return records.size();
+}
+
+int main(int argc, char** argv) {
+
+  if(argc != 6) {
+    makeRecordStore_usage();
+    return 1;
+  }
+
+  const std::string recordType(argv[1]);
+  const std::string inName(argv[2]);
+  const std::string treeName(argv[3]);
+  const std::string branchName(argv[4]);
+  const std::string outName(argv[5]);
+
+  if(!mu2e::MappedRecordStore::isStoreFileName(outName)) {
+    std::cerr<<"makeRecordStore: warning: output file name does not end in "
+             <<mu2e::MappedRecordStore::extension()
+             <<", RootTreeSampler will treat it as a ROOT file"<<std::endl;
+  }
+
+  try {
+    TFile infile(inName.c_str(), "READ");
+    if(infile.IsZombie()) {
+      throw cet::exception("BADINPUT")<<"makeRecordStore: can not open \""<<inName<<"\"\n";
+    }
+    TTree *tree = dynamic_cast<TTree*>(infile.Get(treeName.c_str()));
+    if(!tree) {
+      throw cet::exception("BADINPUT")<<"makeRecordStore: could not get tree \""<<treeName
+                                      <<"\" from file \""<<inName<<"\"\n";
+    }
+
+    long n = 0;
+    if(recordType == "StoppedParticleF") {
+      n = convert<mu2e::IO::StoppedParticleF>(tree, branchName, outName);
+    }
+    else if(recordType == "StoppedParticleTauNormF") {
+      n = convert<mu2e::IO::StoppedParticleTauNormF>(tree, branchName, outName);
+    }
+    else if(recordType == "InFlightParticleD") {
+      n = convert<mu2e::IO::InFlightParticleD>(tree, branchName, outName);
+    }
+    else {
+      std::cerr<<"makeRecordStore: unknown record type \""<<recordType<<"\""<<std::endl;
+      makeRecordStore_usage();
+      return 1;
+    }
+
+    std::cout<<"makeRecordStore: wrote "<<n<<" records to "<<outName<<std::endl;
+  }
+  catch(cet::exception const& e) {
+    std::cerr<<e.what()<<std::endl;
+    return 2;
+  }
+
+  return 0;
+}
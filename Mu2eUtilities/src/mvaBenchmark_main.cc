@@ -0,0 +1,69 @@
+//
+// Throughput of MVATools: single evaluations against the batched interface,
+// for a given weights file.  Also checks that both give the same results.
+//
+//   mvaBenchmark TrkHitReco/test/StereoMVA.weights.xml [nrows] [batchsize]
+//
+
+#include "Mu2eUtilities/inc/MVATools.hh"
+
+#include "fhiclcpp/ParameterSet.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+
+  if(argc < 2) {
+    std::cout << "Usage: mvaBenchmark WEIGHTSFILE [nrows] [batchsize]" << std::endl;
+    return 1;
+  }
+  const size_t nrows = argc > 2 ? std::atol(argv[2]) : 1000000;
+  const size_t batch = argc > 3 ? std::atol(argv[3]) : 256;
+
+  fhicl::ParameterSet pset;
+  pset.put<std::string>("MVAWeights", argv[1]);
+  mu2e::MVATools mva(pset);
+  mva.initMVA();
+
+  const size_t ncols = mva.nInputs();
+  std::mt19937 gen(12345);
+  std::uniform_real_distribution<float> flat(0.,10.);
+  std::vector<float> inputs(nrows*ncols);
+  for(auto& x : inputs) x = flat(gen);
+
+  std::vector<float> single(nrows), batched(nrows);
+  std::vector<float> row(ncols);
+  mu2e::MVATools::Workspace ws;
+
+  auto now = [](){ return std::chrono::steady_clock::now(); };
+  typedef std::chrono::duration<double> seconds;
+
+  auto t0 = now();
+  for(size_t r=0; r<nrows; ++r) {
+    row.assign(inputs.begin()+r*ncols, inputs.begin()+(r+1)*ncols);
+    single[r] = mva.evalMVA(row);
+  }
+  auto t1 = now();
+  for(size_t r=0; r<nrows; r+=batch) {
+    size_t n = std::min(batch, nrows-r);
+    mva.evalMVA(inputs.data()+r*ncols, n, ncols, batched.data()+r, ws);
+  }
+  auto t2 = now();
+
+  size_t ndiff(0);
+  for(size_t r=0; r<nrows; ++r) ndiff += (single[r] != batched[r]);
+
+  std::cout << "mvaBenchmark: " << argv[1] << ", " << ncols << " inputs, " << nrows << " rows" << std::endl
+            << "  single  evaluations/second: " << nrows/seconds(t1-t0).count() << std::endl
+            << "  batched evaluations/second: " << nrows/seconds(t2-t1).count()
+            << " (batch size " << batch << ")" << std::endl
+            << "  rows with different results: " << ndiff << std::endl;
+
+  return ndiff == 0 ? 0 : 2;
+}
@@ -0,0 +1,138 @@
+//
+// Test of CounterRandomEngine:
+//  - the Philox4x32-10 known answers of the Random123 distribution;
+//  - a stream gives the same numbers whatever was drawn before, from
+//    this or any other stream, and after a save/restore of the status;
+//  - different streams and substreams of a key are not correlated;
+//  - the flat numbers are in (0,1) with the right mean and variance;
+//  - flat numbers/second, compared to MixMaxRng.
+//
+// Returns a non-zero status if any of the checks fails.
+//
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+#include "CLHEP/Random/MixMaxRng.h"
+
+#include "Mu2eUtilities/inc/CounterRandomEngine.hh"
+
+using namespace std;
+using mu2e::CounterRandomEngine;
+
+namespace {
+
+  int nfail = 0;
+
+  void check(bool ok, const char* what) {
+    cout << (ok ? "  ok    " : "  FAIL  ") << what << endl;
+    if(!ok) ++nfail;
+  }
+
+  bool knownAnswer(CounterRandomEngine::Counter ctr, CounterRandomEngine::Key key,
+                   CounterRandomEngine::Counter expected) {
+    CounterRandomEngine::philox(ctr, key);
+    return ctr == expected;
+  }
+
+  vector<double> draw(CounterRandomEngine& engine, size_t n) {
+    vector<double> v(n);
+    engine.flatArray(n, v.data());
+    return v;
+  }
+
+  double correlation(const vector<double>& a, const vector<double>& b) {
+    double sab(0.), sa(0.), sb(0.), saa(0.), sbb(0.);
+    for(size_t i=0; i<a.size(); ++i) {
+      sa += a[i]; sb += b[i];
+      sab += a[i]*b[i]; saa += a[i]*a[i]; sbb += b[i]*b[i];
+    }
+    const double n = a.size();
+    return (sab/n - sa*sb/(n*n))/sqrt((saa/n - sa*sa/(n*n))*(sbb/n - sb*sb/(n*n)));
+  }
+
+  template<class Engine>
+  double flatsPerSecond(Engine& engine, size_t n, double& sum) {
+    auto start = chrono::steady_clock::now();
+    for(size_t i=0; i<n; ++i) sum += engine.flat();
+    chrono::duration<double> dt = chrono::steady_clock::now() - start;
+    return n/dt.count();
+  }
+
+}
+
+int main() {
+
+  cout << "Philox4x32-10 known answers" << endl;
+  check(knownAnswer({{0,0,0,0}}, {{0,0}},
+                    {{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}}), "zero counter and key");
+  check(knownAnswer({{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}}, {{0xffffffff, 0xffffffff}},
+                    {{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}}), "all-ones counter and key");
+  check(knownAnswer({{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}}, {{0xa4093822, 0x299f31d0}},
+                    {{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}}), "digits of pi");
+
+  cout << "Streams" << endl;
+  const uint64_t key = 0x0123456789abcdefULL;
+  const size_t n = 1000003; // odd, so streams end in the middle of a block
+  CounterRandomEngine engine(key);
+  engine.setStream(17, 2);
+  const vector<double> ref = draw(engine, n);
+  engine.setStream(5, 0);
+  draw(engine, 12345);
+  engine.setStream(17, 2);
+  check(draw(engine, n) == ref, "a stream restarts with the same numbers");
+  CounterRandomEngine other(key + 1);
+  other.setKey(key);
+  other.setStream(17, 2);
+  check(draw(other, n) == ref, "a stream is the same in any engine");
+  engine.setStream(17, 2);
+  draw(engine, 1001);
+  engine.saveStatus("counterRandomEngine_test.conf");
+  const vector<double> cont = draw(engine, 1000);
+  other.restoreStatus("counterRandomEngine_test.conf");
+  remove("counterRandomEngine_test.conf");
+  check(draw(other, 1000) == cont, "save and restore the status mid-block");
+
+  engine.setStream(18, 2);
+  const vector<double> nextStream = draw(engine, n);
+  engine.setStream(17, 3);
+  const vector<double> nextSubstream = draw(engine, n);
+  engine.setKey(key + 1);
+  engine.setStream(17, 2);
+  const vector<double> nextKey = draw(engine, n);
+  const double climit = 5./sqrt(double(n));
+  cout << "  correlations " << correlation(ref, nextStream) << " " << correlation(ref, nextSubstream)
+       << " " << correlation(ref, nextKey) << ", limit " << climit << endl;
+  check(fabs(correlation(ref, nextStream)) < climit &&
+        fabs(correlation(ref, nextSubstream)) < climit &&
+        fabs(correlation(ref, nextKey)) < climit, "neighbouring streams, substreams and keys are uncorrelated");
+
+  cout << "Flat numbers" << endl;
+  double sum(0.), sum2(0.), vmin(1.), vmax(0.);
+  for(double v : ref) {
+    sum += v; sum2 += v*v;
+    vmin = min(vmin, v); vmax = max(vmax, v);
+  }
+  const double mean = sum/n;
+  const double var = sum2/n - mean*mean;
+  cout << "  mean " << mean << " variance " << var << " range " << vmin << " " << vmax << endl;
+  check(vmin > 0. && vmax < 1., "in (0,1)");
+  check(fabs(mean - 0.5) < 5.*sqrt(1./12./n), "mean");
+  check(fabs(var - 1./12.) < 5.*sqrt(1./180./n), "variance");
+
+  cout << "Speed" << endl;
+  const size_t nspeed = 50000000;
+  double s1(0.), s2(0.);
+  CLHEP::MixMaxRng mixmax(1);
+  engine.setStream(0, 0);
+  const double rmix = flatsPerSecond(mixmax, nspeed, s1);
+  const double rphilox = flatsPerSecond(engine, nspeed, s2);
+  cout << "  MixMaxRng " << rmix*1e-6 << " M/s, CounterRandomEngine " << rphilox*1e-6 << " M/s"
+       << " (" << s1 + s2 << ")" << endl;
+
+  cout << (nfail == 0 ? "All checks passed" : "Some checks FAILED") << endl;
+  return nfail;
+}
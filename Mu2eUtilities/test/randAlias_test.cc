@@ -0,0 +1,158 @@
+//
+// Test of the RandAlias sampler:
+//  - statistical equivalence with CLHEP::RandGeneral, as a two-sample
+//    chi2 of finely binned histograms, for spectra shaped like the ones
+//    used by the BinnedSpectrum generators;
+//  - the linear mode reproduces the input bin contents;
+//  - fireN() gives the same numbers as successive fire() calls;
+//  - draws/second for RandGeneral, RandAlias::fire and RandAlias::fireN.
+//
+// Returns a non-zero status if any of the checks fails.
+//
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "CLHEP/Random/MixMaxRng.h"
+#include "CLHEP/Random/RandGeneral.h"
+
+#include "Mu2eUtilities/inc/RandAlias.hh"
+
+using namespace std;
+
+namespace {
+
+  // Shapes loosely following the DIO tail, the conversion endpoint
+  // with a radiative tail, and a smooth capture spectrum.
+  vector<double> dioLike(size_t n) {
+    vector<double> v(n);
+    for(size_t i=0; i<n; ++i) { double x = (i+0.5)/n; v[i] = std::pow(1.-x, 5)*(1.+3.*x); }
+    return v;
+  }
+  vector<double> endpointLike(size_t n) {
+    vector<double> v(n);
+    for(size_t i=0; i<n; ++i) { double x = (i+0.5)/n; v[i] = std::exp(-60.*(1.-x)) + 1e-3/(1.+x); }
+    return v;
+  }
+  vector<double> captureLike(size_t n) {
+    vector<double> v(n);
+    for(size_t i=0; i<n; ++i) { double x = (i+0.5)/n; v[i] = x*x*std::exp(-8.*x); }
+    return v;
+  }
+
+  // Two-sample chi2 per degree of freedom for equal sample sizes
+  double chi2ndf(const vector<double>& a, const vector<double>& b) {
+    double chi2 = 0.;
+    int ndf = 0;
+    for(size_t i=0; i<a.size(); ++i) {
+      if(a[i] + b[i] > 0.) {
+        chi2 += (a[i]-b[i])*(a[i]-b[i])/(a[i]+b[i]);
+        ++ndf;
+      }
+    }
+    return ndf > 1 ? chi2/(ndf-1) : 0.;
+  }
+
+  template<class Sampler>
+  vector<double> histogram(Sampler& s, size_t nDraws, size_t nHistBins) {
+    vector<double> h(nHistBins, 0.);
+    for(size_t i=0; i<nDraws; ++i) {
+      size_t ib = s.fire()*nHistBins;
+      if(ib < nHistBins) ++h[ib];
+    }
+    return h;
+  }
+
+  template<class F>
+  double drawsPerSecond(size_t nDraws, F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double> dt = std::chrono::steady_clock::now() - start;
+    return nDraws/dt.count();
+  }
+
+}
+
+int main() {
+
+  const size_t nBins = 1000;
+  const size_t nDraws = 4000000;
+  const size_t nHistBins = 4*nBins; // resolve the in-bin distribution as well
+  int failures = 0;
+
+  struct Shape { const char* name; vector<double> pdf; };
+  vector<Shape> shapes = { {"dio", dioLike(nBins)}, {"endpoint", endpointLike(nBins)}, {"capture", captureLike(nBins)} };
+
+  for(auto const& shape : shapes) {
+    CLHEP::MixMaxRng eng1(1234), eng2(5678);
+    CLHEP::RandGeneral general(eng1, shape.pdf.data(), nBins);
+    mu2e::RandAlias alias(eng2, shape.pdf);
+
+    double r = chi2ndf(histogram(general, nDraws, nHistBins), histogram(alias, nDraws, nHistBins));
+    bool ok = r < 1.2;
+    failures += !ok;
+    cout << "equivalence " << setw(9) << shape.name << ": chi2/ndf = " << r << (ok ? "  OK" : "  FAIL") << endl;
+
+    // Linear interpolation must keep the content of every bin
+    CLHEP::MixMaxRng eng3(91011);
+    mu2e::RandAlias linear(eng3, shape.pdf, mu2e::RandAlias::linear);
+    vector<double> h = histogram(linear, nDraws, nBins);
+    double chi2 = 0.;
+    int ndf = 0;
+    for(size_t i=0; i<nBins; ++i) {
+      double expected = nDraws*linear.binProbability(i);
+      if(expected > 0.) { chi2 += (h[i]-expected)*(h[i]-expected)/expected; ++ndf; }
+    }
+    r = chi2/ndf;
+    ok = r < 1.2;
+    failures += !ok;
+    cout << "linear bins " << setw(9) << shape.name << ": chi2/ndf = " << r << (ok ? "  OK" : "  FAIL") << endl;
+  }
+
+  // Batched and single draws must agree
+  {
+    CLHEP::MixMaxRng eng1(42), eng2(42);
+    mu2e::RandAlias a1(eng1, shapes[0].pdf, mu2e::RandAlias::linear);
+    mu2e::RandAlias a2(eng2, shapes[0].pdf, mu2e::RandAlias::linear);
+    vector<double> batch;
+    a2.fireN(10000, batch);
+    size_t nbad = 0;
+    for(size_t i=0; i<batch.size(); ++i) nbad += (a1.fire() != batch[i]);
+    failures += (nbad != 0);
+    cout << "fireN vs fire: " << nbad << " mismatches" << (nbad ? "  FAIL" : "  OK") << endl;
+  }
+
+  // Throughput
+  {
+    const size_t nBench = 20000000;
+    CLHEP::MixMaxRng eng(7);
+    CLHEP::RandGeneral general(eng, shapes[0].pdf.data(), nBins);
+    mu2e::RandAlias alias(eng, shapes[0].pdf);
+    mu2e::RandAlias linear(eng, shapes[0].pdf, mu2e::RandAlias::linear);
+    double sink = 0.;
+    vector<double> buf(4096);
+
+    double g = drawsPerSecond(nBench, [&](){ for(size_t i=0; i<nBench; ++i) sink += general.fire(); });
+    double a = drawsPerSecond(nBench, [&](){ for(size_t i=0; i<nBench; ++i) sink += alias.fire(); });
+    double l = drawsPerSecond(nBench, [&](){ for(size_t i=0; i<nBench; ++i) sink += linear.fire(); });
+    double b = drawsPerSecond(nBench, [&](){
+        for(size_t i=0; i<nBench; i+=buf.size()) {
+          alias.fireN(buf.size(), buf.data());
+          for(auto x : buf) sink += x;
+        }
+      });
+
+    cout << "draws/second, " << nBins << " bins:" << endl
+         << "  RandGeneral::fire      " << g << endl
+         << "  RandAlias::fire        " << a << endl
+         << "  RandAlias::fire linear " << l << endl
+         << "  RandAlias::fireN       " << b << endl
+         << "  (checksum " << sink << ")" << endl;
+  }
+
+  cout << (failures ? "randAlias_test: FAILED" : "randAlias_test: passed") << endl;
+  return failures;
+}
@@ -88,6 +88,27 @@ namespace mu2e {
     StrawIdMask _mask; // mask for valid StrawId fields
     StrawEnd _tend; // end used to define time measruement
   };
+  class ComboHitCollection;
+  // Flattened (CSR) map from each ComboHit of a collection to the StrawHits it ultimately references.
+  // This is built once per event, so that repeated lookups don't need to search the event for parent
+  // collections or allocate per-hit vectors.  This is a transient object, it is not persisted
+  class StrawHitIndexMap {
+    public:
+      typedef std::vector<StrawHitIndex>::const_iterator SHIIter;
+      StrawHitIndexMap() : _offsets(1,0) {}
+      // fill from the given collection, resolving the full parent chain
+      void fill(art::Event const& event, ComboHitCollection const& chcol);
+      void clear() { _offsets.assign(1,0); _shids.clear(); }
+      // accessors: the StrawHit indices of ComboHit 'chindex' are in [begin(chindex),end(chindex))
+      size_t size() const { return _offsets.size()-1; }
+      SHIIter begin(size_t chindex) const { return _shids.begin() + _offsets[chindex]; }
+      SHIIter end(size_t chindex) const { return _shids.begin() + _offsets[chindex+1]; }
+      size_t nStrawHits(size_t chindex) const { return _offsets[chindex+1]-_offsets[chindex]; }
+      std::vector<StrawHitIndex> const& strawHitIndices() const { return _shids; }
+    private:
+      std::vector<size_t> _offsets; // start of each ComboHit's range in _shids, size = nComboHits+1
+      std::vector<StrawHitIndex> _shids; // concatenated StrawHit indices
+  };
   // ComboHitCollection is a non-trivial subclass of vector which includes navigation of nested ComboHits
   class ComboHitCollection : public std::vector<mu2e::ComboHit> {
     public:
@@ -100,6 +121,10 @@ namespace mu2e {
       void fillStrawHitIndices(art::Event const& event, uint16_t chindex, std::vector<StrawHitIndex>& shids) const;
       // do this for all the hits in the collection
       void fillStrawHitIndices(art::Event const& event, std::vector<std::vector<StrawHitIndex> >& shids) const;
+      // same, into a flat map.  This resolves the parent chain only once, so prefer this in production code
+      void fillStrawHitIndices(art::Event const& event, StrawHitIndexMap& shmap) const { shmap.fill(event,*this); }
+      // fill the chain of collections from this one down to the StrawHit level (this collection first)
+      void fillParentChain(art::Event const& event, std::vector<ComboHitCollection const*>& chain) const;
       // translate a collection of ComboHits into the lowest-level (straw) combo hits.  This function is recursive
       void fillComboHits(art::Event const& event, std::vector<uint16_t> const& indices, CHCIter& iters) const;
       // fill a vector of iterators to the ComboHits 1 layer below a given ComboHit.  This is NOT RECURSIVE
@@ -0,0 +1,80 @@
+#ifndef RecoDataProducts_TrackerHitIndex_hh
+#define RecoDataProducts_TrackerHitIndex_hh
+//
+// Per-event index of a ComboHitCollection, shared by the pattern recognition
+// modules which otherwise each rebuild it: the hits in time order, the hits
+// bucketed by (unique) panel, and a copy of the hit flags.  The z-ordered
+// station/face/panel numbering is the one of the pattern recognition
+// 'orderID' functions.  The index refers to the hits by their position in
+// the indexed collection, whose product ID it records.
+//
+// Mu2e includes
+#include "DataProducts/inc/StrawId.hh"
+#include "RecoDataProducts/inc/StrawHitFlag.hh"
+#include "RecoDataProducts/inc/StrawHitIndex.hh"
+// art includes
+#include "canvas/Persistency/Provenance/ProductID.h"
+// C++ includes
+#include <vector>
+namespace mu2e {
+
+  class ComboHitCollection;
+
+  class TrackerHitIndex {
+    public:
+      constexpr static unsigned NOrderedFaces = 4; // z-ordered faces per station
+      constexpr static unsigned NOrderedPanels = 3; // panels per z-ordered face
+      typedef std::vector<ComboHitIndex>::const_iterator CHIIter;
+
+      TrackerHitIndex() {}
+      // index the given collection, identified by chid
+      void fill(ComboHitCollection const& chcol, art::ProductID const& chid);
+      void clear();
+
+      // the indexed collection
+      art::ProductID const& comboHits() const { return _chid; }
+      bool indexes(art::ProductID const& chid) const { return _chid == chid; }
+      size_t size() const { return _upanel.size(); }
+
+      // per hit
+      uint16_t uniquePanel(size_t ich) const { return _upanel[ich]; }
+      StrawHitFlag const& flag(size_t ich) const { return _flags[ich]; }
+      // position of the hit in (unique panel, collection index) order
+      ComboHitIndex panelRank(size_t ich) const { return _panelRank[ich]; }
+
+      // hits in time order.  The hits with time in [tmin,tmax) have time ranks
+      // [lowerTimeRank(tmin),lowerTimeRank(tmax))
+      std::vector<ComboHitIndex> const& timeOrder() const { return _timeOrder; }
+      size_t lowerTimeRank(float time) const;
+      float minTime() const { return _times.empty() ? 0.0 : _times.front(); }
+      float maxTime() const { return _times.empty() ? 0.0 : _times.back(); }
+
+      // hits of a unique panel, in collection order
+      CHIIter panelBegin(uint16_t upanel) const { return _panelHits.begin() + _panelBegin[upanel]; }
+      CHIIter panelEnd(uint16_t upanel) const { return _panelHits.begin() + _panelBegin[upanel+1]; }
+      size_t nPanelHits(uint16_t upanel) const { return _panelBegin[upanel+1] - _panelBegin[upanel]; }
+
+      // z range of the hits
+      float zMin() const { return _zmin; }
+      float zMax() const { return _zmax; }
+
+      // z-ordered location of a unique panel
+      static uint16_t station(uint16_t upanel) { return upanel/(StrawId::_npanels*2); }
+      static uint16_t orderedFace(uint16_t upanel);
+      static uint16_t orderedPanel(uint16_t upanel) { return (upanel%StrawId::_npanels)/2; }
+      // face number over the whole tracker, in z order
+      static uint16_t faceId(uint16_t upanel) { return station(upanel)*NOrderedFaces + orderedFace(upanel); }
+
+    private:
+      art::ProductID _chid; // indexed ComboHitCollection
+      std::vector<uint16_t> _upanel; // unique panel of each hit
+      std::vector<StrawHitFlag> _flags; // flag of each hit
+      std::vector<ComboHitIndex> _panelRank; // rank of each hit in panel order
+      std::vector<ComboHitIndex> _timeOrder; // hit indices in time order
+      std::vector<float> _times; // hit times, in time order
+      std::vector<unsigned> _panelBegin; // start of each panel's range in _panelHits, size = nupanels+1
+      std::vector<ComboHitIndex> _panelHits; // hit indices in panel order
+      float _zmin = 0.0, _zmax = 0.0;
+  };
+}
+#endif
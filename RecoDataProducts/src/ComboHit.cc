@@ -165,6 +165,49 @@ namespace mu2e {
     }
   }
 
+  void ComboHitCollection::fillParentChain(art::Event const& event, vector<ComboHitCollection const*>& chain) const {
+    chain.clear();
+    chain.push_back(this);
+    while(chain.back()->parent().isValid()){
+      art::Handle<ComboHitCollection> ph;
+      chain.back()->setParentHandle(event,ph);
+      if(ph.isValid())
+	chain.push_back(ph.product());
+      else
+	throw cet::exception("RECO")<<"mu2e::ComboHitCollection: Can't find parent collection" << std::endl;
+    }
+  }
+
+  void StrawHitIndexMap::fill(art::Event const& event, ComboHitCollection const& chcol) {
+    clear();
+    // resolve the parent collections once for the whole event
+    vector<ComboHitCollection const*> chain;
+    chcol.fillParentChain(event,chain);
+    size_t nch = chcol.size();
+    _offsets.reserve(nch+1);
+    _shids.reserve(chcol.nStrawHits());
+    // work stack of (level, index) pairs; the depth is bounded by the number of levels times MaxNCombo
+    vector<std::pair<size_t,uint16_t> > stack;
+    stack.reserve(chain.size()*ComboHit::MaxNCombo);
+    for(size_t ich=0;ich < nch; ++ich){
+      stack.emplace_back(0,ich);
+      while(!stack.empty()){
+	auto entry = stack.back();
+	stack.pop_back();
+	if(entry.first+1 < chain.size()){
+	  // push in reverse so the output has the same order as the recursive methods
+	  ComboHit const& ch = (*chain[entry.first])[entry.second];
+	  for(uint16_t iind = ch.nCombo(); iind > 0; --iind)
+	    stack.emplace_back(entry.first+1,ch.index(iind-1));
+	} else {
+	  // bottom level: the combo hit index is the StrawHit index
+	  _shids.push_back(entry.second);
+	}
+      }
+      _offsets.push_back(_shids.size());
+    }
+  }
+
   void ComboHitCollection::fillComboHits(art::Event const& event, std::vector<uint16_t> const& indices, CHCIter& iters) const {
     if(_parent.isValid()){
     // get the parent handle
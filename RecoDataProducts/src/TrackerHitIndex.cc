@@ -0,0 +1,72 @@
+//
+// Per-event index of a ComboHitCollection
+//
+// Mu2e includes
+#include "RecoDataProducts/inc/TrackerHitIndex.hh"
+#include "RecoDataProducts/inc/ComboHit.hh"
+// C++ includes
+#include <algorithm>
+#include <numeric>
+namespace mu2e {
+
+  uint16_t TrackerHitIndex::orderedFace(uint16_t upanel) {
+    uint16_t panel = upanel%StrawId::_npanels;
+    uint16_t plane = (upanel/StrawId::_npanels)%2; // plane within the station
+    uint16_t face = panel%2;
+    if(station(upanel)%2 == 0)
+      return plane == 0 ? 1 - face : face + 2;
+    else
+      return plane == 0 ? face : 3 - face;
+  }
+
+  void TrackerHitIndex::clear() {
+    _chid = art::ProductID();
+    _upanel.clear();
+    _flags.clear();
+    _panelRank.clear();
+    _timeOrder.clear();
+    _times.clear();
+    _panelBegin.assign(StrawId::_nupanels+1,0);
+    _panelHits.clear();
+    _zmin = _zmax = 0.0;
+  }
+
+  void TrackerHitIndex::fill(ComboHitCollection const& chcol, art::ProductID const& chid) {
+    clear();
+    _chid = chid;
+    size_t nch = chcol.size();
+    _upanel.reserve(nch);
+    _flags.reserve(nch);
+    if(nch > 0) _zmin = _zmax = chcol.front().pos().z();
+    // count the hits in each panel, then fill the buckets in collection order
+    for(auto const& ch : chcol) {
+      uint16_t upanel = ch.strawId().uniquePanel();
+      _upanel.push_back(upanel);
+      _flags.push_back(ch.flag());
+      ++_panelBegin[upanel+1];
+      _zmin = std::min(_zmin,float(ch.pos().z()));
+      _zmax = std::max(_zmax,float(ch.pos().z()));
+    }
+    std::partial_sum(_panelBegin.begin(),_panelBegin.end(),_panelBegin.begin());
+    std::vector<unsigned> next(_panelBegin.begin(),_panelBegin.end()-1);
+    _panelHits.resize(nch);
+    _panelRank.resize(nch);
+    for(size_t ich=0;ich<nch;++ich){
+      unsigned rank = next[_upanel[ich]]++;
+      _panelHits[rank] = ich;
+      _panelRank[ich] = rank;
+    }
+    // time order; ties keep the collection order
+    _timeOrder.resize(nch);
+    std::iota(_timeOrder.begin(),_timeOrder.end(),0);
+    std::stable_sort(_timeOrder.begin(),_timeOrder.end(),
+	[&chcol](ComboHitIndex a, ComboHitIndex b) { return chcol[a].time() < chcol[b].time(); });
+    _times.reserve(nch);
+    for(auto ich : _timeOrder)
+      _times.push_back(chcol[ich].time());
+  }
+
+  size_t TrackerHitIndex::lowerTimeRank(float time) const {
+    return std::lower_bound(_times.begin(),_times.end(),time) - _times.begin();
+  }
+}
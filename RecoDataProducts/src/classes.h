@@ -24,6 +24,7 @@
 #include "RecoDataProducts/inc/StrawDigi.hh"
 #include "RecoDataProducts/inc/StrawDigiFlag.hh"
 #include "RecoDataProducts/inc/ComboHit.hh"
+#include "RecoDataProducts/inc/TrackerHitIndex.hh"
 
 // tracking intermediate products
 #include "RecoDataProducts/inc/HelixHit.hh"
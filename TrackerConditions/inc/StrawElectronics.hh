@@ -44,6 +44,13 @@ namespace mu2e {
 	_sigma(sigma), _t0(t0) {};
     };
 
+    // interpolation between the wire distance points bracketing a distance
+    struct WireDistanceBin {
+      int _index; // lower point
+      double _frac; // weight of the lower point
+      WireDistanceBin() : _index(0), _frac(1.0) {}
+    };
+
     typedef std::shared_ptr<StrawElectronics> ptr_t;
     typedef std::shared_ptr<const StrawElectronics> cptr_t;
 
@@ -102,11 +109,18 @@ namespace mu2e {
     // linear response to a charge pulse.  This does NOT include saturation effects,
     // since those are cumulative and cannot be computed for individual charges
     double linearResponse(StrawId sid, Path ipath, double time,double charge,double distance,bool forsaturation=false) const; // mvolts per pCoulomb
+    // same, for a response bin and a wire distance bin computed beforehand
+    double linearResponse(StrawId sid, Path ipath, int index, double charge, WireDistanceBin const& wbin, bool forsaturation=false) const;
+    // response bin of a time relative to the charge arrival, and wire distance bin of a distance
+    int responseIndex(double time) const;
+    int nResponseBins() const { return _responseBins; }
+    WireDistanceBin wireDistanceBin(double distance) const;
     double adcImpulseResponse(StrawId sid, double time, double charge) const;
     // Given a (linear) total voltage, compute the saturated voltage
     double saturatedResponse(double lineearresponse) const;
     // relative time when linear response is maximal
     double maxResponseTime(Path ipath,double distance) const;
+    double maxResponseTime(Path ipath,WireDistanceBin const& wbin) const;
     // digization
     TrkTypes::ADCValue adcResponse(StrawId id, double mvolts) const; // ADC response to analog inputs
     TrkTypes::TDCValue tdcResponse(double time) const; // TDC response to a signal input to electronics at a given time (in ns since eventWindowMarker)
@@ -146,6 +160,7 @@ namespace mu2e {
     
     double currentToVoltage(StrawId sid, Path ipath) const { return _dVdI[ipath][sid.getStraw()]; }
     double maxLinearResponse(StrawId sid, Path ipath,double distance,double charge=1.0) const;
+    double maxLinearResponse(StrawId sid, Path ipath,WireDistanceBin const& wbin,double charge=1.0) const;
     double normalization(Path ipath) const { return 1.;} //FIXME
     double fallTime(Path ipath) const { return 22.;} //FIXME
     double clusterLookbackTime() const { return _clusterLookbackTime;}
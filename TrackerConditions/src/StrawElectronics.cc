@@ -70,33 +70,44 @@ namespace mu2e {
       response[i] *= 1 / gain_160;
   }
 
-  double StrawElectronics::linearResponse(StrawId sid, Path ipath, double time, double charge, double distance, bool forsaturation) const {
+  int StrawElectronics::responseIndex(double time) const {
     int index = time*_sampleRate + _responseBins/2.;
     if ( index >= _responseBins)
       index = _responseBins-1;
     if (index < 0)
       index = 0;
-    int  distIndex = 0;
-    for (size_t i=1;i<_wPoints.size()-1;i++){
-      if (distance < _wPoints[i]._distance)
-        break;
-      distIndex = i;
-    }
-    double distFrac = 1 - (distance - _wPoints[distIndex]._distance)/(_wPoints[distIndex+1]._distance - _wPoints[distIndex]._distance);
+    return index;
+  }
+
+  StrawElectronics::WireDistanceBin StrawElectronics::wireDistanceBin(double distance) const {
+    // the last point below the distance, excluding the first and last points
+    WireDistanceBin wbin;
+    auto ibin = std::upper_bound(_wPoints.begin()+1,_wPoints.end()-1,distance,
+	[](double dist, WireDistancePoint const& wpoint) { return dist < wpoint._distance; });
+    wbin._index = std::max(int(ibin - _wPoints.begin()) - 1, 0);
+    wbin._frac = 1 - (distance - _wPoints[wbin._index]._distance)/(_wPoints[wbin._index+1]._distance - _wPoints[wbin._index]._distance);
+    return wbin;
+  }
+
+  double StrawElectronics::linearResponse(StrawId sid, Path ipath, double time, double charge, double distance, bool forsaturation) const {
+    return linearResponse(sid,ipath,responseIndex(time),charge,wireDistanceBin(distance),forsaturation);
+  }
+
+  double StrawElectronics::linearResponse(StrawId sid, Path ipath, int index, double charge, WireDistanceBin const& wbin, bool forsaturation) const {
     double p0, p1;
     if (ipath == thresh){
       if (forsaturation){
-        p0 = _wPoints[distIndex]._preampToAdc1Response[index];
-        p1 = _wPoints[distIndex + 1]._preampToAdc1Response[index];
+        p0 = _wPoints[wbin._index]._preampToAdc1Response[index];
+        p1 = _wPoints[wbin._index + 1]._preampToAdc1Response[index];
       }else{
-        p0 = _wPoints[distIndex]._preampResponse[index];
-        p1 = _wPoints[distIndex + 1]._preampResponse[index];
+        p0 = _wPoints[wbin._index]._preampResponse[index];
+        p1 = _wPoints[wbin._index + 1]._preampResponse[index];
       }
     }else{
-      p0 = _wPoints[distIndex]._adcResponse[index];
-      p1 = _wPoints[distIndex + 1]._adcResponse[index];
+      p0 = _wPoints[wbin._index]._adcResponse[index];
+      p1 = _wPoints[wbin._index + 1]._adcResponse[index];
     }
-    return charge * ( p0 * distFrac + p1 * (1 - distFrac)) * _dVdI[ipath][sid.getStraw()];
+    return charge * ( p0 * wbin._frac + p1 * (1 - wbin._frac)) * _dVdI[ipath][sid.getStraw()];
   }
 
   double StrawElectronics::adcImpulseResponse(StrawId sid, double time, double charge) const {
@@ -116,31 +127,25 @@ namespace mu2e {
   }
 
   double StrawElectronics::maxResponseTime(Path ipath,double distance) const {
-    int  distIndex = 0;
-    for (size_t i=1;i<_wPoints.size()-1;i++){
-      if (distance < _wPoints[i]._distance)
-        break;
-      distIndex = i;
-    }
-    double distFrac = 1 - (distance - _wPoints[distIndex]._distance)/(_wPoints[distIndex+1]._distance - _wPoints[distIndex]._distance);
-    double p0 = _wPoints[distIndex]._tmax[ipath];
-    double p1 = _wPoints[distIndex + 1]._tmax[ipath];
+    return maxResponseTime(ipath,wireDistanceBin(distance));
+  }
+
+  double StrawElectronics::maxResponseTime(Path ipath,WireDistanceBin const& wbin) const {
+    double p0 = _wPoints[wbin._index]._tmax[ipath];
+    double p1 = _wPoints[wbin._index + 1]._tmax[ipath];
     
-    return p0 * distFrac + p1 * (1 - distFrac);
+    return p0 * wbin._frac + p1 * (1 - wbin._frac);
   }
 
   double StrawElectronics::maxLinearResponse(StrawId sid, Path ipath,double distance,double charge) const {
-    int  distIndex = 0;
-    for (size_t i=1;i<_wPoints.size()-1;i++){
-      if (distance < _wPoints[i]._distance)
-        break;
-      distIndex = i;
-    }
-    double distFrac = 1 - (distance - _wPoints[distIndex]._distance)/(_wPoints[distIndex+1]._distance - _wPoints[distIndex]._distance);
-    double p0 = _wPoints[distIndex]._linmax[ipath];
-    double p1 = _wPoints[distIndex + 1]._linmax[ipath];
+    return maxLinearResponse(sid,ipath,wireDistanceBin(distance),charge);
+  }
+
+  double StrawElectronics::maxLinearResponse(StrawId sid, Path ipath,WireDistanceBin const& wbin,double charge) const {
+    double p0 = _wPoints[wbin._index]._linmax[ipath];
+    double p1 = _wPoints[wbin._index + 1]._linmax[ipath];
  
-    return charge * (p0 * distFrac + p1 * (1 - distFrac)) * _dVdI[ipath][sid.getStraw()];
+    return charge * (p0 * wbin._frac + p1 * (1 - wbin._frac)) * _dVdI[ipath][sid.getStraw()];
   }
 
   ADCValue StrawElectronics::adcResponse(StrawId sid, double mvolts) const {
@@ -8,14 +8,14 @@
 
 // C++ includes
 #include <iostream>
-#include <list>
+#include <vector>
 // Mu2e includes
 #include "TrackerMC/inc/StrawCluster.hh"
 #include "DataProducts/inc/StrawId.hh"
 
 namespace mu2e {
   namespace TrackerMC {
-    typedef std::list<StrawCluster> ClusterList;
+    typedef std::vector<StrawCluster> ClusterList;
     class StrawClusterSequence {
       public:
 	// constructors
@@ -26,11 +26,20 @@ namespace mu2e {
 	StrawClusterSequence& operator =(StrawClusterSequence const& other);
 	// accessors: just hand over the list!
 	ClusterList const& clustList() const { return _clist; }
-	// insert a new clust, in time order.
+	// insert a new clust, in time order.  This invalidates iterators to later clusts
 	ClusterList::iterator insert(StrawCluster const& clust);
+	// add a new clust at the end, without ordering.  sort() must be called once all
+	// the clusts are added, before the sequence is used
+	void append(StrawCluster const& clust);
+	// order the appended clusts in time.  Clusts with the same time end up latest-added
+	// first, as if they had been insert()ed one by one
+	void sort();
+	// remove all the clusts, keeping the straw, end and memory
+	void clear(StrawId const& sid, StrawEnd end);
 	StrawId const& strawId() const { return _strawId; }
 	StrawEnd const& strawEnd() const { return _end; }
       private:
+	void checkClust(StrawCluster const& clust) const;
 	StrawId _strawId;
 	StrawEnd _end;
 	ClusterList _clist; // time-ordered sequence of clusts
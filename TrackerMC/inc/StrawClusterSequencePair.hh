@@ -17,6 +17,10 @@ namespace mu2e {
 	StrawClusterSequence& clustSequence(StrawEnd end) { return _scseq[end]; }
 	StrawClusterSequence const& clustSequence(StrawEnd end) const { return _scseq[end]; }
 	void insert(StrawClusterPair const& hpair);
+	// order both sequences in time, after appending clusts
+	void sort();
+	// empty both sequences, keeping their memory, and assign them to a straw
+	void clear(StrawId sid);
 	StrawId strawId() const { return _scseq[0].strawId(); }
       private:
 	StrawClusterSequence _scseq[2];
@@ -3,7 +3,10 @@
 //
 // StrawWaveform integrates post-amplification voltage as a function of time at one end of a
 // a straw, over the time period of 1 microbunch.  It includes all physical and electronics
-// effects prior to digitization.
+// effects prior to digitization.  The wire distance bin, peak response and peak time of each
+// clust are computed once, at construction.  The clusts far enough in the past of a sampling
+// time only contribute the asymptotic (last bin) response, which is kept as a running sum
+// over the clusts, so that a sample only loops over the clusts within the response window.
 //
 // Original author David Brown, LBNL
 //
@@ -40,7 +43,7 @@ namespace mu2e {
     class StrawWaveform{
       public:
 	// construct from a clust sequence and response object.  Scale affects the voltage
-	StrawWaveform(StrawClusterSequence const& hseqq, XTalk const& xtalk);
+	StrawWaveform(StrawClusterSequence const& hseqq, StrawElectronics const& strawele, XTalk const& xtalk);
 	// disallow copy and assignment
 	StrawWaveform() = delete; // don't allow default constructor, references can't be assigned empty
 	StrawWaveform(StrawWaveform const& other);
@@ -68,7 +71,20 @@ namespace mu2e {
 	void returnCrossing(StrawElectronics const& strawele, double threshold, WFX& wfx) const;
 	bool roughCrossing(StrawElectronics const& strawele, double threshold, WFX& wfx) const;
 	bool fineCrossing(StrawElectronics const& strawele, double threshold, double vmax, WFX& wfx) const;
-	double maxLinearResponse(StrawElectronics const& strawele,ClusterList::const_iterator const& iclust) const;
+	double maxLinearResponse(ClusterList::const_iterator const& iclust) const;
+	size_t clustIndex(ClusterList::const_iterator const& iclust) const { return iclust - _cseq.clustList().begin(); }
+	// index of the first clust not contributing at the given time, searching from ibegin
+	size_t endClust(double time, size_t ibegin=0) const;
+	// linear response at the given time of the clusts [ibegin,iend)
+	double linearResponse(StrawElectronics const& strawele,StrawElectronics::Path ipath,double time,
+	    size_t ibegin, size_t iend, bool forsaturation=false) const;
+	// per-clust caches, in the clust order
+	std::vector<double> _tstart; // time from which the clust contributes
+	std::vector<StrawElectronics::WireDistanceBin> _wbins; // wire distance bin
+	std::vector<double> _maxresp; // maximum threshold path linear response, including x-talk
+	std::vector<double> _tmax; // time of the maximum threshold path response, relative to the clust time
+	// running sums of the last response bin of the clusts before each clust: thresh, adc and saturation paths
+	std::array<std::vector<double>,StrawElectronics::npaths+1> _tailsum;
     };
 
     struct WFX { // waveform crossing
@@ -6,6 +6,7 @@
 // mu2e includes
 #include "TrackerMC/inc/StrawClusterSequence.hh"
 #include "cetlib_except/exception.h"
+#include <algorithm>
 
 using namespace std;
 
@@ -35,14 +36,11 @@ namespace mu2e {
       }
       return *this;
     }
-    // insert a new clust.  This is the only non-trivial function
-    ClusterList::iterator StrawClusterSequence::insert(StrawCluster const& clust) {
-      ClusterList::iterator retval = _clist.end();
+    void StrawClusterSequence::checkClust(StrawCluster const& clust) const {
       if(clust.type() == StrawCluster::unknown){
 	throw cet::exception("SIM")
 	  << "mu2e::StrawClusterSequence: tried to add unknown clust type"
 	  << endl;
-	return retval;
       }
       // make sure the straw and end are the same
       if(!_clist.empty() && (clust.strawId() != strawId()
@@ -50,21 +48,48 @@ namespace mu2e {
 	throw cet::exception("SIM")
 	  << "mu2e::StrawClusterSequence: tried to add clust from a different straw/end to a sequence"
 	  << endl;
-	return retval;
       }
+    }
+
+    // insert a new clust.  This is the only non-trivial function
+    ClusterList::iterator StrawClusterSequence::insert(StrawCluster const& clust) {
+      ClusterList::iterator retval = _clist.end();
+      checkClust(clust);
       if(_clist.empty()){
-	_clist.push_front(clust);
+	_clist.push_back(clust);
 	_strawId = clust.strawId();
 	_end = clust.strawEnd();
 	retval = _clist.begin();
       } else {
-	// loop over the contents and insert in the correct place
-	ClusterList::iterator ibefore = _clist.begin();
-	while(ibefore != _clist.end() && ibefore->time() < clust.time())
-	  ++ibefore;
+	// find the correct place: before the first clust which is not earlier
+	ClusterList::iterator ibefore = std::lower_bound(_clist.begin(),_clist.end(),clust,
+	    [](StrawCluster const& a, StrawCluster const& b) { return a.time() < b.time(); });
 	retval = _clist.insert(ibefore,clust);
       }
       return retval;
     }
+
+    void StrawClusterSequence::append(StrawCluster const& clust) {
+      checkClust(clust);
+      if(_clist.empty()){
+	_strawId = clust.strawId();
+	_end = clust.strawEnd();
+      }
+      _clist.push_back(clust);
+    }
+
+    void StrawClusterSequence::sort() {
+      // insert() puts a clust before the earlier clusts with the same time; reproduce that
+      // order by reversing the appended clusts before the stable sort
+      std::reverse(_clist.begin(),_clist.end());
+      std::stable_sort(_clist.begin(),_clist.end(),
+	  [](StrawCluster const& a, StrawCluster const& b) { return a.time() < b.time(); });
+    }
+
+    void StrawClusterSequence::clear(StrawId const& sid, StrawEnd end) {
+      _strawId = sid;
+      _end = end;
+      _clist.clear();
+    }
   }
 }
@@ -32,6 +32,7 @@
 // utiliities
 #include "Mu2eUtilities/inc/TwoLinePCA.hh"
 #include "Mu2eUtilities/inc/SimParticleTimeOffset.hh"
+#include "Mu2eUtilities/inc/CounterRandomEngine.hh"
 #include "DataProducts/inc/TrkTypes.hh"
 // data
 #include "DataProducts/inc/EventWindowMarker.hh"
@@ -47,7 +48,6 @@
 //CLHEP
 #include "CLHEP/Random/RandGaussQ.h"
 #include "CLHEP/Random/RandFlat.h"
-#include "CLHEP/Random/RandExponential.h"
 #include "CLHEP/Random/RandPoisson.h"
 #include "CLHEP/Vector/LorentzVector.h"
 // root
@@ -57,14 +57,34 @@
 #include "TGraph.h"
 #include "TMarker.h"
 #include "TTree.h"
+// tbb
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
 // C++
 #include <map>
 #include <algorithm>
 #include <array>
 #include <iostream>
 #include <limits>
+#include <mutex>
 using namespace std;
 using CLHEP::Hep3Vector;
+namespace {
+  // splitmix64 finalizer
+  uint64_t mixBits(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+  // random number key of an event: depends on the module seed and the event id only
+  uint64_t eventKey(uint64_t baseSeed, art::EventID const& id) {
+    uint64_t h = mixBits(baseSeed);
+    h = mixBits(h ^ id.run());
+    h = mixBits(h ^ id.subRun());
+    return mixBits(h ^ id.event());
+  }
+}
 namespace mu2e {
   namespace TrackerMC {
     using namespace TrkTypes;
@@ -84,15 +104,41 @@ namespace mu2e {
       double _wdist; // propagation distance from the point of collection to the end
     };
 
+    struct StrawStep { // a step selected for digitization, with what is needed from its SimParticle
+      art::Ptr<StepPointMC> _spmc;
+      double _time; // step time with the time offsets applied
+      double _charge; // particle charge, 0 if the particle isn't in the particle data table
+      double _mass; // particle mass, < 0 if the particle isn't in the particle data table
+    };
+
+    // Random numbers for the digitization of one straw.  The engine is counter-based, keyed by the event,
+    // with a stream for each straw and purpose, so the numbers used for a straw don't depend on the other
+    // straws, or on the order and the thread in which the straws are digitized.
+    struct StrawRandom {
+      enum Purpose {eventWindowMarker=0, ionization, threshold, crosstalk}; // crosstalk: one substream per coupled straw
+      explicit StrawRandom(uint64_t key) : _engine(key), _randgauss(_engine), _randflat(_engine), _randP(_engine) {}
+      void setStream(StrawId const& sid, unsigned purpose) { _engine.setStream(sid.uniqueStraw(),purpose); }
+      CounterRandomEngine _engine;
+      CLHEP::RandGaussQ _randgauss;
+      CLHEP::RandFlat _randflat;
+      CLHEP::RandPoisson _randP;
+    };
+
+    struct StrawDigiOutput { // digis made from the clusts of one straw, including cross-talk to other straws
+      StrawDigiCollection _digis;
+      StrawDigiMCCollection _mcdigis;
+      PtrStepPointMCVectorCollection _mcptrs;
+      void clear() { _digis.clear(); _mcdigis.clear(); _mcptrs.clear(); }
+    };
+
     class StrawDigisFromStepPointMCs : public art::EDProducer {
 
     public:
-      typedef map<StrawId,StrawClusterSequencePair> StrawClusterMap;  // clusts by straw
       typedef vector<art::Ptr<StepPointMC> > StrawSPMCPV; // vector of associated StepPointMCs for a single straw/particle
       // work with pairs of waveforms, one for each straw end
       typedef std::array<StrawWaveform,2> SWFP;
       typedef std::array<WFX,2> WFXP;
-      typedef list<WFXP> WFXPList;
+      typedef vector<WFXP> WFXPList;
       typedef WFXPList::const_iterator WFXPI;
 
       explicit StrawDigisFromStepPointMCs(fhicl::ParameterSet const& pset);
@@ -116,6 +162,7 @@ namespace mu2e {
       string _trackerStepPoints;
 
       // Parameters
+      bool   _parallelStraws; // digitize the straws in parallel; only without diagnostics
       bool   _addXtalk; // should we add cross talk hits?
       double _ctMinCharge; // minimum charge to add cross talk (for performance issues)
       bool   _addNoise; // should we add noise hits?
@@ -135,12 +182,9 @@ namespace mu2e {
       ProditionsHandle<StrawElectronics> _strawele_h;
       SimParticleTimeOffset _toff;
       StrawElectronics::Path _diagpath; // electronics path for waveform diagnostics
-      // Random number distributions
-      art::RandomNumberGenerator::base_engine_t& _engine;
-      CLHEP::RandGaussQ _randgauss;
-      CLHEP::RandFlat _randflat;
-      CLHEP::RandExponential _randexp;
-      CLHEP::RandPoisson _randP;
+      // Random numbers: the key of the current event is derived from this seed and the event id
+      SeedService::seed_t _baseSeed;
+      uint64_t _eventKey;
       // A category for the error logger.
       const string _messageCategory;
       // Give some informationation messages only on the first event.
@@ -183,43 +227,62 @@ namespace mu2e {
       TTree* _sdiag;
       Float_t _steplen, _stepE, _qsum, _esum, _eesum, _qe, _partP, _steptime;
       Int_t _nclusd, _netot, _partPDG;
-      vector<IonCluster> _clusters;
+      vector<IonCluster> _clusters; // clusters of the step
+      // selected steps and clust sequences of all the straws, indexed by unique straw, and the straws
+      // touched in this event.  These are emptied through the touched list and keep their memory across events
+      vector<vector<StrawStep> > _strawSteps;
+      vector<StrawClusterSequencePair> _strawClusters;
+      vector<StrawId> _touched;
+      vector<bool> _isTouched;
+      // digis of each touched straw, merged in straw order
+      vector<StrawDigiOutput> _strawDigis;
+      // digis of the straws digitized before the current one (diagnostics, serial only)
+      size_t _ndigiBefore;
+      // the BField caches are not thread safe
+      std::mutex _bfieldMutex;
       Float_t _ewMarkerOffset;
       array<Float_t, StrawId::_nupanels> _ewMarkerROCdt;
 
       //  helper functions
-      void fillClusterMap(art::Event const& event, StrawClusterMap & hmap);
+      void fillStepMap(art::Event const& event);
+      vector<StrawStep>& strawSteps(StrawId const& sid);
+      void digitizeStraw(StrawPhysics const& strawphys,
+                         StrawElectronics const& strawele,
+                         Tracker const& tracker, size_t itouched);
       void addStep(StrawPhysics const& strawphys,
             StrawElectronics const& strawele,
-            art::Ptr<StepPointMC> const& spmcptr,
-            Straw const& straw, StrawClusterSequencePair& shsp);
+            StrawStep const& sstep,
+            Straw const& straw, StrawRandom& rand,
+            vector<IonCluster>& clusters, StrawClusterSequencePair& shsp);
       void divideStep(StrawPhysics const& strawphys,
                       StrawElectronics const& strawele,
-                      StepPointMC const& step, vector<IonCluster>& clusters);
+                      StrawStep const& sstep, Straw const& straw,
+                      StrawRandom& rand, vector<IonCluster>& clusters);
       void driftCluster(StrawPhysics const& strawphys, Straw const& straw,
-                        IonCluster const& cluster, WireCharge& wireq);
+                        IonCluster const& cluster, StrawRandom& rand, WireCharge& wireq);
       void propagateCharge(StrawPhysics const& strawphys, Straw const& straw,
                  WireCharge const& wireq, StrawEnd end, WireEndCharge& weq);
       double microbunchTime(StrawElectronics const& strawele, double globaltime) const;
       void addGhosts(StrawElectronics const& strawele, StrawCluster const& clust,StrawClusterSequence& shs);
-      void addNoise(StrawClusterMap& hmap);
-      void findThresholdCrossings(StrawElectronics const& strawele, SWFP const& swfp, WFXPList& xings);
+      void addNoise();
+      void findThresholdCrossings(StrawElectronics const& strawele, SWFP const& swfp, StrawRandom& rand, WFXPList& xings);
       void createDigis(StrawPhysics const& strawphys,
                        StrawElectronics const& strawele,
                        StrawClusterSequencePair const& hsp,
-                       XTalk const& xtalk,
+                       XTalk const& xtalk, StrawRandom& rand,
                        StrawDigiCollection* digis, StrawDigiMCCollection* mcdigis,
                        PtrStepPointMCVectorCollection* mcptrs );
       void fillDigis(StrawPhysics const& strawphys,
                      StrawElectronics const& strawele,
                      WFXPList const& xings,SWFP const& swfp , StrawId sid,
+                     StrawRandom& rand,
                      StrawDigiCollection* digis, StrawDigiMCCollection* mcdigis,
                      PtrStepPointMCVectorCollection* mcptrs );
-      bool createDigi(StrawElectronics const& strawele,WFXP const& xpair, SWFP const& wf, StrawId sid, StrawDigiCollection* digis);
+      bool createDigi(StrawElectronics const& strawele,WFXP const& xpair, SWFP const& wf, StrawId sid, StrawRandom& rand, StrawDigiCollection* digis);
       void findCrossTalkStraws(Straw const& straw,vector<XTalk>& xtalk);
-      void fillClusterNe(StrawPhysics const& strawphys,std::vector<unsigned>& me);
-      void fillClusterPositions(Straw const& straw, StepPointMC const& step, std::vector<Hep3Vector>& cpos);
-      void fillClusterMinion(StrawPhysics const& strawphys, StepPointMC const& step, std::vector<unsigned>& me, std::vector<double>& cen);
+      void fillClusterNe(StrawPhysics const& strawphys, StrawRandom& rand, std::vector<unsigned>& me);
+      void fillClusterPositions(Straw const& straw, StepPointMC const& step, double charge, StrawRandom& rand, std::vector<Hep3Vector>& cpos);
+      void fillClusterMinion(StrawPhysics const& strawphys, StepPointMC const& step, StrawRandom& rand, std::vector<unsigned>& me, std::vector<double>& cen);
       bool readAll(StrawId const& sid) const;
       // diagnostic functions
       void waveformHist(StrawElectronics const& strawele,
@@ -243,6 +306,7 @@ namespace mu2e {
     // Parameters
     _maxFullPrint(pset.get<int>("maxFullPrint",2)),
     _trackerStepPoints(pset.get<string>("trackerStepPoints","tracker")),
+    _parallelStraws(pset.get<bool>("parallelStraws",false)),
     _addXtalk(pset.get<bool>("addCrossTalk",false)),
     _ctMinCharge(pset.get<double>("xtalkMinimumCharge",0)),
     _addNoise(pset.get<bool>("addNoise",false)),
@@ -257,17 +321,14 @@ namespace mu2e {
     _allPlanes(pset.get<std::vector<uint16_t>>("AllHitsPlanes",std::vector<uint16_t>{})), // planes to read all hits
     _toff(pset.get<fhicl::ParameterSet>("TimeOffsets", {})),
     _diagpath(static_cast<StrawElectronics::Path>(pset.get<int>("WaveformDiagPath",StrawElectronics::thresh))),
-    // Random number distributions
-    _engine(createEngine( art::ServiceHandle<SeedService>()->getSeed())),
-    _randgauss( _engine ),
-    _randflat( _engine ),
-    _randexp( _engine),
-    _randP( _engine),
+    // Random numbers
+    _baseSeed(art::ServiceHandle<SeedService>()->getSeed()),
     _messageCategory("HITS"),
     _firstEvent(true),      // Control some information messages.
     _ptfac(pset.get<double>("PtFactor", 2.0)), // factor for defining curling in a straw
     _maxnclu(pset.get<unsigned>("MaxNClusters", 10)), // max # of clusters for low-PT steps
-    _sort(pset.get<bool>("SortClusterEnergy",false))
+    _sort(pset.get<bool>("SortClusterEnergy",false)),
+    _ndigiBefore(0)
     {
       // Tell the framework what we consume.
       consumesMany<StepPointMCCollection>();
@@ -282,6 +343,10 @@ namespace mu2e {
       produces<StrawDigiCollection>();
       produces<PtrStepPointMCVectorCollection>();
       produces<StrawDigiMCCollection>();
+      // one step list and clust sequence pair per straw
+      _strawSteps.resize(StrawId::_nustraws);
+      _strawClusters.resize(StrawId::_nustraws);
+      _isTouched.assign(StrawId::_nustraws,false);
     }
 
     void StrawDigisFromStepPointMCs::beginJob(){
@@ -414,9 +479,13 @@ namespace mu2e {
       event.getByLabel(_ewMarkerTag, ewMarkerHandle);
       const EventWindowMarker& ewMarker(*ewMarkerHandle);
       _ewMarkerOffset = ewMarker.timeOffset();
+      // random numbers of this event
+      _eventKey = eventKey(_baseSeed,event.id());
       // calculate event window marker jitter for this microbunch for each panel
+      StrawRandom rand(_eventKey);
+      rand._engine.setStream(0,StrawRandom::eventWindowMarker);
       for (size_t i=0;i<StrawId::_nupanels;i++){
-        _ewMarkerROCdt.at(i) = _randgauss.fire(0,strawele.eventWindowMarkerROCJitter());
+        _ewMarkerROCdt.at(i) = rand._randgauss.fire(0,strawele.eventWindowMarkerROCJitter());
       }
       const Tracker& tracker = *GeomHandle<Tracker>();
       // make the microbunch buffer long enough to get the full waveform
@@ -426,35 +495,40 @@ namespace mu2e {
       unique_ptr<StrawDigiCollection> digis(new StrawDigiCollection);
       unique_ptr<StrawDigiMCCollection> mcdigis(new StrawDigiMCCollection);
       unique_ptr<PtrStepPointMCVectorCollection> mcptrs(new PtrStepPointMCVectorCollection);
-      // create the StrawCluster map
-      StrawClusterMap hmap;
-      // fill this from the event
-      fillClusterMap(event,hmap);
+      // select the steps of each straw from the event
+      fillStepMap(event);
       // add noise clusts
-      if(_addNoise)addNoise(hmap);
-      // loop over the clust sequences
-      for(auto ihsp=hmap.begin();ihsp!= hmap.end();++ihsp){
-        StrawClusterSequencePair const& hsp = ihsp->second;
-        // create primary digis from this clust sequence
-        XTalk self(hsp.strawId()); // this object represents the straws coupling to itself, ie 100%
-        createDigis(strawphys,strawele,hsp,self,digis.get(),mcdigis.get(),mcptrs.get());
-        // if we're applying x-talk, look for nearby coupled straws
-        if(_addXtalk) {
-          // only apply if the charge is above a threshold
-          double totalCharge = 0;
-          for(auto ih=hsp.clustSequence(StrawEnd::cal).clustList().begin();ih!= hsp.clustSequence(StrawEnd::cal).clustList().end();++ih){
-            totalCharge += ih->charge();
-          }
-          if( totalCharge > _ctMinCharge){
-            vector<XTalk> xtalk;
-            Straw const& straw = tracker.getStraw(hsp.strawId());
-            findCrossTalkStraws(straw,xtalk);
-            for(auto ixtalk=xtalk.begin();ixtalk!=xtalk.end();++ixtalk){
-              createDigis(strawphys,strawele,hsp,*ixtalk,digis.get(),mcdigis.get(),mcptrs.get());
-            }
-          }
+      if(_addNoise)addNoise();
+      // order the straws by id
+      std::sort(_touched.begin(),_touched.end());
+      // digitize the straws.  They are independent of each other, so they can be digitized in parallel.
+      // The diagnostics fill shared trees and histograms, so use them only serially
+      _strawDigis.resize(_touched.size());
+      if(_parallelStraws && _diag == 0){
+        tbb::parallel_for(tbb::blocked_range<size_t>(0,_touched.size()),
+            [&](const tbb::blocked_range<size_t>& range) {
+              for(size_t itouched=range.begin();itouched!=range.end();++itouched)
+                digitizeStraw(strawphys,strawele,tracker,itouched);
+            });
+      } else {
+        _ndigiBefore = 0;
+        for(size_t itouched=0;itouched<_touched.size();++itouched){
+          digitizeStraw(strawphys,strawele,tracker,itouched);
+          _ndigiBefore += _strawDigis[itouched]._digis.size();
         }
       }
+      // merge the digis in straw order; the cross-talk digis follow the primary digis of the straw they come from
+      size_t ndigi(0);
+      for(auto const& sdigis : _strawDigis)
+        ndigi += sdigis._digis.size();
+      digis->reserve(ndigi);
+      mcdigis->reserve(ndigi);
+      mcptrs->reserve(ndigi);
+      for(auto const& sdigis : _strawDigis){
+        digis->insert(digis->end(),sdigis._digis.begin(),sdigis._digis.end());
+        mcdigis->insert(mcdigis->end(),sdigis._mcdigis.begin(),sdigis._mcdigis.end());
+        mcptrs->insert(mcptrs->end(),sdigis._mcptrs.begin(),sdigis._mcptrs.end());
+      }
       // store the digis in the event
       event.put(move(digis));
       // store MC truth match
@@ -465,39 +539,91 @@ namespace mu2e {
       _firstEvent = false;
     } // end produce
 
+    void StrawDigisFromStepPointMCs::digitizeStraw(StrawPhysics const& strawphys,
+          StrawElectronics const& strawele,
+          Tracker const& tracker, size_t itouched) {
+      StrawId const& sid = _touched[itouched];
+      StrawClusterSequencePair& hsp = _strawClusters[sid.uniqueStraw()];
+      StrawDigiOutput& sdigis = _strawDigis[itouched];
+      sdigis.clear();
+      Straw const& straw = tracker.getStraw(sid);
+      StrawRandom rand(_eventKey);
+      // create the clusts of the selected steps, and order them in time
+      rand.setStream(sid,StrawRandom::ionization);
+      vector<IonCluster> clusters;
+      for(auto const& sstep : _strawSteps[sid.uniqueStraw()])
+        addStep(strawphys,strawele,sstep,straw,rand,clusters,hsp);
+      hsp.sort();
+      // create primary digis from this clust sequence
+      XTalk self(sid); // this object represents the straws coupling to itself, ie 100%
+      rand.setStream(sid,StrawRandom::threshold);
+      createDigis(strawphys,strawele,hsp,self,rand,&sdigis._digis,&sdigis._mcdigis,&sdigis._mcptrs);
+      // if we're applying x-talk, look for nearby coupled straws
+      if(_addXtalk) {
+        // only apply if the charge is above a threshold
+        double totalCharge = 0;
+        for(auto ih=hsp.clustSequence(StrawEnd::cal).clustList().begin();ih!= hsp.clustSequence(StrawEnd::cal).clustList().end();++ih){
+          totalCharge += ih->charge();
+        }
+        if( totalCharge > _ctMinCharge){
+          vector<XTalk> xtalk;
+          findCrossTalkStraws(straw,xtalk);
+          for(size_t ixtalk=0;ixtalk<xtalk.size();++ixtalk){
+            rand.setStream(sid,StrawRandom::crosstalk+ixtalk);
+            createDigis(strawphys,strawele,hsp,xtalk[ixtalk],rand,&sdigis._digis,&sdigis._mcdigis,&sdigis._mcptrs);
+          }
+        }
+      }
+    }
+
     void StrawDigisFromStepPointMCs::createDigis(
           StrawPhysics const& strawphys,
           StrawElectronics const& strawele,
           StrawClusterSequencePair const& hsp, XTalk const& xtalk,
+          StrawRandom& rand,
           StrawDigiCollection* digis, StrawDigiMCCollection* mcdigis,
           PtrStepPointMCVectorCollection* mcptrs ) {
       // instantiate waveforms for both ends of this straw
-      SWFP waveforms  ={ StrawWaveform(hsp.clustSequence(StrawEnd::cal),xtalk),
-        StrawWaveform(hsp.clustSequence(StrawEnd::hv),xtalk) };
+      SWFP waveforms  ={ StrawWaveform(hsp.clustSequence(StrawEnd::cal),strawele,xtalk),
+        StrawWaveform(hsp.clustSequence(StrawEnd::hv),strawele,xtalk) };
       // find the threshold crossing points for these waveforms
       WFXPList xings;
       // find the threshold crossings
-      findThresholdCrossings(strawele,waveforms,xings);
-      // convert the crossing points into digis, and add them to the event data
-      fillDigis(strawphys,strawele,xings,waveforms,xtalk._dest,digis,mcdigis,mcptrs);
+      findThresholdCrossings(strawele,waveforms,rand,xings);
+      // convert the crossing points into digis, and add them to the straw digis
+      fillDigis(strawphys,strawele,xings,waveforms,xtalk._dest,rand,digis,mcdigis,mcptrs);
       // waveform diagnostics
       if (_diag >1 && (
                        waveforms[0].clusts().clustList().size() > 0 ||
                        waveforms[1].clusts().clustList().size() > 0 ) ) {
-        // waveform xing diagnostics
-        _ndigi = digis->size();
+        // waveform xing diagnostics; digis of the event so far
+        _ndigi = _ndigiBefore + digis->size();
         waveformDiag(strawele,waveforms,xings);
         // waveform histograms
         if(_diag > 2 )waveformHist(strawele,waveforms,xings);
       }
     }
 
-    void StrawDigisFromStepPointMCs::fillClusterMap(art::Event const& event, StrawClusterMap & hmap){
+    vector<StrawStep>& StrawDigisFromStepPointMCs::strawSteps(StrawId const& sid) {
+      uint16_t istraw = sid.uniqueStraw();
+      if(!_isTouched[istraw]){
+        _isTouched[istraw] = true;
+        _touched.push_back(sid);
+        _strawSteps[istraw].clear();
+        _strawClusters[istraw].clear(sid);
+      }
+      return _strawSteps[istraw];
+    }
+
+    void StrawDigisFromStepPointMCs::fillStepMap(art::Event const& event){
+      // forget the straws of the previous event
+      for(auto const& sid : _touched)
+        _isTouched[sid.uniqueStraw()] = false;
+      _touched.clear();
       // get conditions
       DeadStraw const& deadStraw = _deadStraw_h.get(event.id());
-      StrawPhysics const& strawphys = _strawphys_h.get(event.id());
-      StrawElectronics const& strawele = _strawele_h.get(event.id());
       const Tracker& tracker = *GeomHandle<Tracker>();
+      GlobalConstantsHandle<ParticleDataTable> pdt;
       // Get all of the tracker StepPointMC collections from the event:
       typedef vector< art::Handle<StepPointMCCollection> > HandleVector;
       // This selector will select only data products with the given instance name.
@@ -536,10 +662,16 @@ namespace mu2e {
             if(wpos <  straw.activeHalfLength() &&
                deadStraw.isAlive(sid,wpos) &&
                steps[ispmc].ionizingEdep() > _minstepE){
-              // create ptr to MC truth, used for references
-              art::Ptr<StepPointMC> spmcptr(handle,ispmc);
-              // create a clust from this step, and add it to the clust map
-              addStep(strawphys,strawele,spmcptr,straw,hmap[sid]);
+              // create ptr to MC truth, used for references.  The time offsets and the particle
+              // data are looked up here, as the straws are digitized independently
+              StrawStep sstep{art::Ptr<StepPointMC>(handle,ispmc),_toff.timeWithOffsetsApplied(steps[ispmc]),0.0,-1.0};
+              auto pinfo = pdt->particle(steps[ispmc].simParticle()->pdgId());
+              if(pinfo.isValid()){
+                sstep._charge = pinfo.ref().charge();
+                sstep._mass = pinfo.ref().mass();
+              }
+              // record this step for the straw; it's turned into clusts when the straw is digitized
+              strawSteps(sid).push_back(sstep);
             }
           }
         }
@@ -548,40 +680,42 @@ namespace mu2e {
 
     void StrawDigisFromStepPointMCs::addStep(StrawPhysics const& strawphys,
                 StrawElectronics const& strawele,
-                art::Ptr<StepPointMC> const& spmcptr,
-                Straw const& straw, StrawClusterSequencePair& shsp) {
+                StrawStep const& sstep,
+                Straw const& straw, StrawRandom& rand,
+                vector<IonCluster>& clusters, StrawClusterSequencePair& shsp) {
+      art::Ptr<StepPointMC> const& spmcptr = sstep._spmc;
       StepPointMC const& step = *spmcptr;
       StrawId sid = straw.id();
-     // get time offset for this step
-      double tstep = _toff.timeWithOffsetsApplied(step);
+     // time offset for this step
+      double tstep = sstep._time;
       // test if this step point is roughly in the digitization window
       double mbtime = microbunchTime(strawele,tstep);
       if( (mbtime > strawele.flashEnd() - _steptimebuf
             && mbtime <  strawele.flashStart())
           || readAll(sid)) {
         // Subdivide the StepPointMC into ionization clusters
-        _clusters.clear();
-        divideStep(strawphys,strawele,step,_clusters);
+        clusters.clear();
+        divideStep(strawphys,strawele,sstep,straw,rand,clusters);
         // check
         if(_debug > 1){
           double ec(0.0);
           double ee(0.0);
           double eq(0.0);
-          for (auto const& cluster : _clusters) {
+          for (auto const& cluster : clusters) {
             ec += cluster._eion;
             ee += strawphys.ionizationEnergy(cluster._ne);
             eq += strawphys.ionizationEnergy(cluster._charge);
           }
           cout << "step with ionization edep = " << step.ionizingEdep()
-            << " creates " << _clusters.size()
+            << " creates " << clusters.size()
             << " clusters with total cluster energy = " << ec
             << " electron count energy = " << ee
             << " charge energy = " << eq << endl;
         }
         // drift these clusters to the wire, and record the charge at the wire
-        for(auto iclu = _clusters.begin(); iclu != _clusters.end(); ++iclu){
+        for(auto iclu = clusters.begin(); iclu != clusters.end(); ++iclu){
           WireCharge wireq;
-          driftCluster(strawphys,straw,*iclu,wireq);
+          driftCluster(strawphys,straw,*iclu,rand,wireq);
           // propagate this charge to each end of the wire
           for(size_t iend=0;iend<2;++iend){
             StrawEnd end(static_cast<StrawEnd::End>(iend));
@@ -596,8 +730,8 @@ namespace mu2e {
             StrawCluster clust(StrawCluster::primary,sid,end,ctime,weq._charge,wireq._dd,wireq._phi,weq._wdist,wireq._time,weq._time,
                                spmcptr,CLHEP::HepLorentzVector(iclu->_pos,mbtime)); //JB: + wireq._phi
 
-            // add the clusts to the appropriate sequence.
-            shsp.clustSequence(end).insert(clust);
+            // add the clusts to the appropriate sequence.  They are ordered in time once all are added
+            shsp.clustSequence(end).append(clust);
             // if required, add a 'ghost' copy of this clust
             addGhosts(strawele,clust,shsp.clustSequence(end));
           }
@@ -607,23 +741,17 @@ namespace mu2e {
 
     void StrawDigisFromStepPointMCs::divideStep(StrawPhysics const& strawphys,
                 StrawElectronics const& strawele,
-                StepPointMC const& step, vector<IonCluster>& clusters) {
-      // get particle charge
-      double charge(0.0);
-      GlobalConstantsHandle<ParticleDataTable> pdt;
-      if(pdt->particle(step.simParticle()->pdgId()).isValid()){
-        charge = pdt->particle(step.simParticle()->pdgId()).ref().charge();
-      }
-
-      // get tracker information
-      const Tracker& tracker = *GeomHandle<Tracker>(); //JB
-      const Straw& straw = tracker.getStraw(step.strawId());//JB
+                StrawStep const& sstep, Straw const& straw,
+                StrawRandom& rand, vector<IonCluster>& clusters) {
+      StepPointMC const& step = *sstep._spmc;
+      // particle charge
+      double charge = sstep._charge;
       // if the step length is small compared to the mean free path, or this is an
       // uncharged particle, put all the energy in a single cluster
       if (charge == 0.0 || step.stepLength() < strawphys.meanFreePath()){
         double cen = step.ionizingEdep();
         double fne = cen/strawphys.meanElectronEnergy();
-        unsigned ne = std::max( static_cast<unsigned>(_randP(fne)),(unsigned)1);
+        unsigned ne = std::max( static_cast<unsigned>(rand._randP(fne)),(unsigned)1);
 
         Hep3Vector cdir = (step.position()-straw.getMidPoint());//JB
         cdir -= straw.getDirection()*(cdir.dot(straw.getDirection()));//JB
@@ -636,8 +764,8 @@ namespace mu2e {
       else {
         // use beta-gamma to decide if this is a min-ion particle or not
         bool minion(false);
-        if(pdt->particle(step.simParticle()->pdgId()).isValid()){
-          double mass = pdt->particle(step.simParticle()->pdgId()).ref().mass();
+        if(sstep._mass >= 0.0){
+          double mass = sstep._mass;
           double mom = step.momentum().mag();
           // approximate pt
           double apt = 0.;
@@ -650,23 +778,23 @@ namespace mu2e {
         // compute the number of clusters for this step from the mean free path
         double fnc = step.stepLength()/strawphys.meanFreePath();
         // use a truncated Poisson distribution; this keeps both the mean and variance physical
-        unsigned nc = std::max(static_cast<unsigned>(_randP.fire(fnc)),(unsigned)1);
+        unsigned nc = std::max(static_cast<unsigned>(rand._randP.fire(fnc)),(unsigned)1);
         if(!minion)nc = std::min(nc,_maxnclu);
         // require clusters not exceed the energy sum required for single-electron clusters
         nc = std::min(nc,static_cast<unsigned>(floor(step.ionizingEdep()/strawphys.ionizationEnergy((unsigned)1))));
         // generate random positions for the clusters
         std::vector<Hep3Vector> cpos(nc);
-        fillClusterPositions(straw,step,cpos);
+        fillClusterPositions(straw,step,charge,rand,cpos);
         // generate electron counts and energies for these clusters: minion model is more detailed
         std::vector<unsigned> ne(nc);
         std::vector<double> cen(nc);
         if(minion){
-          fillClusterMinion(strawphys,step,ne,cen);
+          fillClusterMinion(strawphys,step,rand,ne,cen);
         } else {
           // get Poisson distribution of # of electrons for the average energy
           double fne = step.ionizingEdep()/(nc*strawphys.meanElectronEnergy()); // average # of electrons/cluster for non-minion clusters
           for(unsigned ic=0;ic<nc;++ic){
-            ne[ic] = static_cast<unsigned>(std::max(_randP.fire(fne),(long)1));
+            ne[ic] = static_cast<unsigned>(std::max(rand._randP.fire(fne),(long)1));
             cen[ic] = ne[ic]*strawphys.meanElectronEnergy(); // average energy per electron, works for large numbers of electrons
           }
         }
@@ -687,7 +815,7 @@ namespace mu2e {
       if(_diag > 0){
         _steplen = step.stepLength();
         _stepE = step.ionizingEdep();
-        _steptime = microbunchTime(strawele,_toff.timeWithOffsetsApplied(step));
+        _steptime = microbunchTime(strawele,sstep._time);
         _partP = step.momentum().mag();
         _partPDG = step.simParticle()->pdgId();
         _nclusd = (int)clusters.size();
@@ -700,24 +828,25 @@ namespace mu2e {
           _eesum += strawphys.meanElectronEnergy()*iclust->_ne;
         }
         _qe = strawphys.ionizationEnergy(_qsum);
+        _clusters = clusters;
         _sdiag->Fill();
       }
     }
 
     void StrawDigisFromStepPointMCs::driftCluster(
                 StrawPhysics const& strawphys,Straw const& straw,
-                IonCluster const& cluster, WireCharge& wireq ) {
+                IonCluster const& cluster, StrawRandom& rand, WireCharge& wireq ) {
       // Compute the vector from the cluster to the wire
       Hep3Vector cpos = cluster._pos-straw.getMidPoint();
       // drift distance perp to wire, and angle WRT magnetic field (for Lorentz effect)
       double dd = min(cpos.perp(straw.getDirection()),straw.innerRadius());
       // sample the gain for this cluster
-      double gain = strawphys.clusterGain(_randgauss, _randflat, cluster._ne);
+      double gain = strawphys.clusterGain(rand._randgauss, rand._randflat, cluster._ne);
       wireq._charge = cluster._charge*(gain);
       // compute drift time for this cluster
       double dt = strawphys.driftDistanceToTime(dd,cluster._phi); //JB: this is now from the lorentz corrected r-component of the drift
       wireq._phi = cluster._phi; //JB
-      wireq._time = _randgauss.fire(dt,strawphys.driftTimeSpread(dd));
+      wireq._time = rand._randgauss.fire(dt,strawphys.driftTimeSpread(dd));
       wireq._dd = dd;
       // position along wire
       wireq._wpos = cpos.dot(straw.getDirection());
@@ -751,18 +880,18 @@ namespace mu2e {
     void StrawDigisFromStepPointMCs::addGhosts(StrawElectronics const& strawele,StrawCluster const& clust,StrawClusterSequence& shs) {
       // add enough buffer to cover both the flash blanking and the ADC waveform
       if(clust.time() < strawele.flashStart() - _mbtime + _mbbuffer)
-        shs.insert(StrawCluster(clust,_mbtime));
-      if(clust.time() > _mbtime - _mbbuffer) shs.insert(StrawCluster(clust,-_mbtime));
+        shs.append(StrawCluster(clust,_mbtime));
+      if(clust.time() > _mbtime - _mbbuffer) shs.append(StrawCluster(clust,-_mbtime));
     }
 
-    void StrawDigisFromStepPointMCs::findThresholdCrossings(StrawElectronics const& strawele, SWFP const& swfp, WFXPList& xings){
+    void StrawDigisFromStepPointMCs::findThresholdCrossings(StrawElectronics const& strawele, SWFP const& swfp, StrawRandom& rand, WFXPList& xings){
       //randomize the threshold to account for electronics noise; this includes parts that are coherent
       // for both ends (coming from the straw itself)
       // Keep track of crossings on each end to keep them in sequence
-      double strawnoise = _randgauss.fire(0,strawele.strawNoise());
+      double strawnoise = rand._randgauss.fire(0,strawele.strawNoise());
       // add specifics for each end
-      double thresh[2] = {_randgauss.fire(strawele.threshold(swfp[0].strawId(),static_cast<StrawEnd::End>(0))+strawnoise,strawele.analogNoise(StrawElectronics::thresh)),
-        _randgauss.fire(strawele.threshold(swfp[0].strawId(),static_cast<StrawEnd::End>(1))+strawnoise,strawele.analogNoise(StrawElectronics::thresh))};
+      double thresh[2] = {rand._randgauss.fire(strawele.threshold(swfp[0].strawId(),static_cast<StrawEnd::End>(0))+strawnoise,strawele.analogNoise(StrawElectronics::thresh)),
+        rand._randgauss.fire(strawele.threshold(swfp[0].strawId(),static_cast<StrawEnd::End>(1))+strawnoise,strawele.analogNoise(StrawElectronics::thresh))};
       // Initialize search when the electronics becomes enabled:
       double tstart =strawele.flashEnd() - 10.0; // this buffer should be a parameter FIXME!
       // for reading all hits, make sure we start looking for clusters at the minimum possible cluster time
@@ -785,14 +914,14 @@ namespace mu2e {
           if(std::min(wfx[0]._time,wfx[1]._time) > 0.0 )xings.push_back(wfx);
           // search for next crossing:
           // update threshold for straw noise
-          strawnoise = _randgauss.fire(0,strawele.strawNoise());
+          strawnoise = rand._randgauss.fire(0,strawele.strawNoise());
           for(unsigned iend=0;iend<2;++iend){
             // insure a minimum time buffer between crossings
             wfx[iend]._time += strawele.deadTimeAnalog();
             // skip to the next clust
             ++(wfx[iend]._iclust);
             // update threshold for incoherent noise
-            thresh[iend] = _randgauss.fire(strawele.threshold(swfp[0].strawId(),static_cast<StrawEnd::End>(iend)),strawele.analogNoise(StrawElectronics::thresh));
+            thresh[iend] = rand._randgauss.fire(strawele.threshold(swfp[0].strawId(),static_cast<StrawEnd::End>(iend)),strawele.analogNoise(StrawElectronics::thresh));
             // find next crossing
             crosses[iend] = swfp[iend].crossesThreshold(strawele,thresh[iend],wfx[iend]);
           }
@@ -809,14 +938,14 @@ namespace mu2e {
     void StrawDigisFromStepPointMCs::fillDigis(StrawPhysics const& strawphys,
                                                StrawElectronics const& strawele,
         WFXPList const& xings, SWFP const& wf,
-        StrawId sid,
+        StrawId sid, StrawRandom& rand,
         StrawDigiCollection* digis, StrawDigiMCCollection* mcdigis,
         PtrStepPointMCVectorCollection* mcptrs ){
       // loop over crossings
       for(auto xpair : xings) {
         // create a digi from this pair.  This also performs a finial test
         // on whether the pair should make a digi
-        if(createDigi(strawele,xpair,wf,sid,digis)){
+        if(createDigi(strawele,xpair,wf,sid,rand,digis)){
           // fill associated MC truth matching. Only count the same step once
           set<art::Ptr<StepPointMC> > xmcsp;
           double wetime[2] = {-100.,-100.};
@@ -862,7 +991,7 @@ namespace mu2e {
     }
 
     bool StrawDigisFromStepPointMCs::createDigi(StrawElectronics const& strawele, WFXP const& xpair, SWFP const& waveform,
-                                                StrawId sid, StrawDigiCollection* digis){
+                                                StrawId sid, StrawRandom& rand, StrawDigiCollection* digis){
       // initialize the float variables that we later digitize
       TDCTimes xtimes = {0.0,0.0};
       TrkTypes::TOTValues tot;
@@ -879,10 +1008,10 @@ namespace mu2e {
         WFX const& wfx = xpair[iend];
         // record the crossing time for this end, including clock jitter  These already include noise effects
         // add noise for TDC on each side
-        double tdc_jitter = _randgauss.fire(0.0,strawele.TDCResolution());
+        double tdc_jitter = rand._randgauss.fire(0.0,strawele.TDCResolution());
         xtimes[iend] = wfx._time+dt+tdc_jitter;
         // randomize threshold using the incoherent noise
-        double threshold = _randgauss.fire(wfx._vcross,strawele.analogNoise(StrawElectronics::thresh));
+        double threshold = rand._randgauss.fire(wfx._vcross,strawele.analogNoise(StrawElectronics::thresh));
         // find TOT
         tot[iend] = waveform[iend].digitizeTOT(strawele,threshold,wfx._time + dt);
         // sample ADC
@@ -893,7 +1022,7 @@ namespace mu2e {
       // add ends and add noise
       ADCVoltages wfsum; wfsum.reserve(adctimes.size());
       for(unsigned isamp=0;isamp<adctimes.size();++isamp){
-        wfsum.push_back(wf[0][isamp]+wf[1][isamp]+_randgauss.fire(0.0,strawele.analogNoise(StrawElectronics::adc)));
+        wfsum.push_back(wf[0][isamp]+wf[1][isamp]+rand._randgauss.fire(0.0,strawele.analogNoise(StrawElectronics::adc)));
       }
       // digitize, and make final test.  This call includes the clock error WRT the proton pulse
       TrkTypes::TDCValues tdcs;
@@ -933,7 +1062,7 @@ namespace mu2e {
 
     // functions that need implementing:: FIXME!!!!!!
     // Could also fold in beam-off random trigger hits from real data
-    void StrawDigisFromStepPointMCs::addNoise(StrawClusterMap& hmap){
+    void StrawDigisFromStepPointMCs::addNoise(){
       // create random noise clusts and add them to the sequences of random straws.
     }
     // diagnostic functions
@@ -1162,13 +1291,8 @@ namespace mu2e {
 
 
 
-    void StrawDigisFromStepPointMCs::fillClusterPositions(Straw const& straw, StepPointMC const& step, std::vector<Hep3Vector>& cpos) {
-      // basic info
-      double charge(0.0);
-      GlobalConstantsHandle<ParticleDataTable> pdt;
-      if(pdt->particle(step.simParticle()->pdgId()).isValid()){
-        charge = pdt->particle(step.simParticle()->pdgId()).ref().charge();
-      }
+    void StrawDigisFromStepPointMCs::fillClusterPositions(Straw const& straw, StepPointMC const& step, double charge,
+        StrawRandom& rand, std::vector<Hep3Vector>& cpos) {
       static const double r2 = straw.innerRadius()*straw.innerRadius();
       // decide how we step; straight or helix, depending on the Pt
       Hep3Vector const& mom = step.momentum();
@@ -1192,15 +1316,19 @@ namespace mu2e {
         // generate random cluster positions
         for(unsigned ic=0;ic < cpos.size();++ic){
           //
-          cpos[ic] = step.position() +_randflat.fire(slen) *mdir;
+          cpos[ic] = step.position() +rand._randflat.fire(slen) *mdir;
         }
       } else {
         // Use a helix to model particles which curl on the scale of the straws
-        GeomHandle<BFieldManager> bfmgr;
-        GeomHandle<DetectorSystem> det;
         // find the local field vector at this step
-        Hep3Vector vpoint_mu2e = det->toMu2e(step.position());
-        Hep3Vector bf = bfmgr->getBField(vpoint_mu2e);
+        Hep3Vector bf;
+        {
+          std::lock_guard<std::mutex> lock(_bfieldMutex);
+          GeomHandle<BFieldManager> bfmgr;
+          GeomHandle<DetectorSystem> det;
+          Hep3Vector vpoint_mu2e = det->toMu2e(step.position());
+          bf = bfmgr->getBField(vpoint_mu2e);
+        }
         // compute transverse radius of particle
         double rcurl = fabs(charge*(mom.perpPart(bf).mag())/BField::mmTeslaToMeVc*bf.mag());
         // basis using local Bfield direction
@@ -1219,7 +1347,7 @@ namespace mu2e {
         unsigned ntries(0);
         unsigned nclus = cpos.size();
         while(iclu < nclus && ntries < 10*nclus){
-          double zclu = _randflat.fire(zlen);
+          double zclu = rand._randflat.fire(zlen);
           double phi = zclu*omega;
           // build cluster position from these
           Hep3Vector cp = hcent + rcurl*(-rdir*cos(phi) + pdir*sin(phi)) + zclu*bfdir;
@@ -1244,7 +1372,7 @@ namespace mu2e {
       }
     }
 
-    void StrawDigisFromStepPointMCs::fillClusterMinion(StrawPhysics const& strawphys, StepPointMC const& step, std::vector<unsigned>& ne, std::vector<double>& cen) {
+    void StrawDigisFromStepPointMCs::fillClusterMinion(StrawPhysics const& strawphys, StepPointMC const& step, StrawRandom& rand, std::vector<unsigned>& ne, std::vector<double>& cen) {
       // Loop until we've assigned energy + electrons to every cluster
       unsigned mc(0);
       double esum(0.0);
@@ -1253,7 +1381,7 @@ namespace mu2e {
       while(mc < nc){
         std::vector<unsigned> me(nc);
         // fill an array of random# of electrons according to the measured distribution.  These are returned sorted lowest-highest.
-        fillClusterNe(strawphys,me);
+        fillClusterNe(strawphys,rand,me);
         for(auto ie : me) {
           // maximum energy for this cluster requires at least 1 electron for the rest of the cluster
           double emax = etot - esum - (nc -mc -1)*strawphys.ionizationEnergy((unsigned)1);
@@ -1271,12 +1399,12 @@ namespace mu2e {
       // distribute any residual energy randomly to these clusters.  This models delta rays
       unsigned ns;
       do{
-        unsigned me = strawphys.nePerIon(_randflat.fire());
+        unsigned me = strawphys.nePerIon(rand._randflat.fire());
         double emax = etot - esum;
         double eele = strawphys.ionizationEnergy(me);
         if(eele < emax){
           // choose a random cluster to assign this energy to
-          unsigned mc = std::min(nc-1,static_cast<unsigned>(floor(_randflat.fire(nc))));
+          unsigned mc = std::min(nc-1,static_cast<unsigned>(floor(rand._randflat.fire(nc))));
           ne[mc] += me;
           cen[mc] += eele;
           esum += eele;
@@ -1286,9 +1414,9 @@ namespace mu2e {
       } while(ns > 0);
     }
 
-    void StrawDigisFromStepPointMCs::fillClusterNe(StrawPhysics const& strawphys,std::vector<unsigned>& me) {
+    void StrawDigisFromStepPointMCs::fillClusterNe(StrawPhysics const& strawphys, StrawRandom& rand, std::vector<unsigned>& me) {
       for(size_t ie=0;ie < me.size(); ++ie){
-        me[ie] = strawphys.nePerIon(_randflat.fire());
+        me[ie] = strawphys.nePerIon(rand._randflat.fire());
       }
       if(_sort)std::sort(me.begin(),me.end());
     }
@@ -7,18 +7,45 @@
 //
 #include "TrackerMC/inc/StrawWaveform.hh"
 #include <math.h>
+#include <algorithm>
 #include <boost/math/special_functions/binomial.hpp>
 
 using namespace std;
 namespace mu2e {
   using namespace TrkTypes;
   namespace TrackerMC {
-    StrawWaveform::StrawWaveform(StrawClusterSequence const& hseq, XTalk const& xtalk) :
+    StrawWaveform::StrawWaveform(StrawClusterSequence const& hseq, StrawElectronics const& strawele, XTalk const& xtalk) :
       _cseq(hseq), _xtalk(xtalk), _sid(hseq.strawId())
-    {}
+    {
+      ClusterList const& clist = _cseq.clustList();
+      size_t nclust = clist.size();
+      _tstart.reserve(nclust);
+      _wbins.reserve(nclust);
+      _maxresp.reserve(nclust);
+      _tmax.reserve(nclust);
+      for(auto& tailsum : _tailsum){
+	tailsum.reserve(nclust+1);
+	tailsum.push_back(0.0);
+      }
+      int ilast = strawele.nResponseBins()-1;
+      for(auto const& clust : clist){
+	auto wbin = strawele.wireDistanceBin(clust.wireDistance());
+	_tstart.push_back(clust.time()-strawele.clusterLookbackTime());
+	_wbins.push_back(wbin);
+	_maxresp.push_back(strawele.maxLinearResponse(_sid,StrawElectronics::thresh,wbin,clust.charge())*(_xtalk._preamp + _xtalk._postamp));
+	_tmax.push_back(strawele.maxResponseTime(StrawElectronics::thresh,wbin));
+	_tailsum[StrawElectronics::thresh].push_back(_tailsum[StrawElectronics::thresh].back() +
+	    strawele.linearResponse(_sid,StrawElectronics::thresh,ilast,clust.charge(),wbin));
+	_tailsum[StrawElectronics::adc].push_back(_tailsum[StrawElectronics::adc].back() +
+	    strawele.linearResponse(_sid,StrawElectronics::adc,ilast,clust.charge(),wbin));
+	_tailsum[StrawElectronics::npaths].push_back(_tailsum[StrawElectronics::npaths].back() +
+	    strawele.linearResponse(_sid,StrawElectronics::thresh,ilast,clust.charge(),wbin,true));
+      }
+    }
 
     StrawWaveform::StrawWaveform(StrawWaveform const& other) : _cseq(other._cseq),
-    _xtalk(other._xtalk), _sid(other._sid)
+    _xtalk(other._xtalk), _sid(other._sid), _tstart(other._tstart), _wbins(other._wbins),
+    _maxresp(other._maxresp), _tmax(other._tmax), _tailsum(other._tailsum)
     {}
 
     bool StrawWaveform::crossesThreshold(StrawElectronics const& strawele,double threshold,WFX& wfx) const {
@@ -43,7 +70,7 @@ namespace mu2e {
 	    //// check if this clust could cross threshold
 	    //if(wfx._vstart + maxLinearResponse(wfx._iclust) > threshold){
 	      // check the actual response
-	      double maxtime = wfx._iclust->time()+strawele.maxResponseTime(StrawElectronics::thresh,wfx._iclust->wireDistance());
+	      double maxtime = wfx._iclust->time()+_tmax[clustIndex(wfx._iclust)];
 	      double maxresp = sampleWaveform(strawele,StrawElectronics::thresh,maxtime);
 	      if(maxresp > threshold){
 		// interpolate to find the precise crossing
@@ -64,7 +91,7 @@ namespace mu2e {
     void StrawWaveform::returnCrossing(StrawElectronics const& strawele, double threshold, WFX& wfx) const {
       while(wfx._iclust != _cseq.clustList().end() && wfx._vstart > threshold) {
 	// move forward in time at least as twice the time to the maxium for this clust
-	double time = wfx._iclust->time()+strawele.clusterLookbackTime() + 2*strawele.maxResponseTime(StrawElectronics::thresh,wfx._iclust->wireDistance());
+	double time = wfx._iclust->time()+strawele.clusterLookbackTime() + 2*_tmax[clustIndex(wfx._iclust)];
 	while(wfx._iclust != _cseq.clustList().end() &&
 	    wfx._iclust->time()-strawele.clusterLookbackTime() < time){
 	  ++(wfx._iclust);
@@ -81,7 +108,7 @@ namespace mu2e {
       // for actually crossing threshold
       double resp = wfx._vstart;
       while(wfx._iclust != _cseq.clustList().end()){
-	resp += maxLinearResponse(strawele,wfx._iclust);
+	resp += maxLinearResponse(wfx._iclust);
 	if(resp > threshold)break;
 	++(wfx._iclust);
       }
@@ -95,7 +122,7 @@ namespace mu2e {
     bool StrawWaveform::fineCrossing(StrawElectronics const& strawele, double threshold,double maxresp, WFX& wfx) const {
       static double timestep(0.020); // interpolation minimum to use linear threshold crossing calculation
       double pretime = wfx._iclust->time()-strawele.clusterLookbackTime();
-      double posttime = pretime + strawele.clusterLookbackTime() + strawele.maxResponseTime(StrawElectronics::thresh,wfx._iclust->wireDistance());
+      double posttime = pretime + strawele.clusterLookbackTime() + _tmax[clustIndex(wfx._iclust)];
       double presample = wfx._vstart;
       double postsample = maxresp;
       static const unsigned maxstep(10); // 10 steps max
@@ -139,24 +166,36 @@ namespace mu2e {
       return dt < timestep;
     }
 
-    double StrawWaveform::maxLinearResponse(StrawElectronics const& strawele,ClusterList::const_iterator const& iclust) const {
+    double StrawWaveform::maxLinearResponse(ClusterList::const_iterator const& iclust) const {
       // ignore saturation effects
-      double linresp = strawele.maxLinearResponse(_sid,StrawElectronics::thresh,iclust->wireDistance(),iclust->charge());
-      linresp *= (_xtalk._preamp + _xtalk._postamp);
-      return linresp;
+      return _maxresp[clustIndex(iclust)];
     }
 
-    double StrawWaveform::sampleWaveform(StrawElectronics const& strawele,StrawElectronics::Path ipath,double time) const {
-      // loop over all clusts and add their response at this time
+    size_t StrawWaveform::endClust(double time, size_t ibegin) const {
+      return std::lower_bound(_tstart.begin()+ibegin,_tstart.end(),time) - _tstart.begin();
+    }
+
+    double StrawWaveform::linearResponse(StrawElectronics const& strawele,StrawElectronics::Path ipath,double time,
+	size_t ibegin, size_t iend, bool forsaturation) const {
       ClusterList const& hlist = _cseq.clustList();
-      double linresp(0.0);
-      auto iclust = hlist.begin();
-      while(iclust != hlist.end() && iclust->time()-strawele.clusterLookbackTime() < time){
+      // clusts far enough in the past are in the last response bin: take them from the running sum
+      int ilast = strawele.nResponseBins()-1;
+      size_t iwin = std::partition_point(hlist.begin()+ibegin,hlist.begin()+iend,
+	  [&strawele,time,ilast](StrawCluster const& clust) { return strawele.responseIndex(time-clust.time()) >= ilast; }) - hlist.begin();
+      auto const& tailsum = _tailsum[forsaturation ? StrawElectronics::npaths : ipath];
+      double linresp = tailsum[iwin] - tailsum[ibegin];
+      // add the clusts within the response window
+      for(size_t iclust=iwin;iclust<iend;++iclust){
 	// compute the linear straw electronics response to this charge.  This is pre-saturation
-	linresp += strawele.linearResponse(_sid,ipath,time-iclust->time(),iclust->charge(),iclust->wireDistance());
-	// move to next clust
-	++iclust;
+	StrawCluster const& clust = hlist[iclust];
+	linresp += strawele.linearResponse(_sid,ipath,strawele.responseIndex(time-clust.time()),clust.charge(),_wbins[iclust],forsaturation);
       }
+      return linresp;
+    }
+
+    double StrawWaveform::sampleWaveform(StrawElectronics const& strawele,StrawElectronics::Path ipath,double time) const {
+      // add the response of all the clusts before this time
+      double linresp = linearResponse(strawele,ipath,time,0,endClust(time));
       double totresp = linresp * _xtalk._postamp;
       if(_xtalk._preamp>0.0)
 	totresp += _xtalk._preamp*linresp;
@@ -177,7 +216,7 @@ namespace mu2e {
       // check if going to be saturated
       double max_possible_voltage = 0;
       for (auto iclust = _cseq.clustList().begin();iclust != _cseq.clustList().end();++iclust){
-        max_possible_voltage += maxLinearResponse(strawele,iclust);
+        max_possible_voltage += maxLinearResponse(iclust);
       }
       if (max_possible_voltage > strawele.saturationVoltage()){
         // create waveform of threshold circuit output
@@ -185,10 +224,10 @@ namespace mu2e {
         // for each time, get contribution from each step in waveform using impulse response
 
         // skip to the first cluster that matters for the first adc time
-        auto iclust = _cseq.clustList().begin();
-        while (iclust != _cseq.clustList().end()){
-          double time = iclust->time()-strawele.clusterLookbackTime();
-          if (time + strawele.truncationTime(StrawElectronics::thresh) > times[0])
+        size_t nclust = _tstart.size();
+        size_t iclust = 0;
+        while (iclust < nclust){
+          if (_tstart[iclust] + strawele.truncationTime(StrawElectronics::thresh) > times[0])
             break;
           else
             ++iclust;
@@ -198,18 +237,17 @@ namespace mu2e {
         for (size_t j=0;j<times.size();j++){
           volts.push_back(0);
         }
+        if (iclust == nclust) return;
 
-        int num_steps = (int)ceil((times[times.size()-1]-iclust->time()-strawele.clusterLookbackTime())/strawele.saturationTimeStep());
+        double tclust = _cseq.clustList()[iclust].time();
+        int num_steps = (int)ceil((times[times.size()-1]-tclust-strawele.clusterLookbackTime())/strawele.saturationTimeStep());
 
+        size_t jclust = iclust;
         for (int i=0;i<num_steps;i++){
-          double time = iclust->time()-strawele.clusterLookbackTime() + i*strawele.saturationTimeStep();
+          double time = tclust-strawele.clusterLookbackTime() + i*strawele.saturationTimeStep();
           // sum up the preamp response at this step
-          double response = 0;
-          auto jclust = iclust;
-          while(jclust != _cseq.clustList().end() && jclust->time()-strawele.clusterLookbackTime() < time){
-            response += strawele.linearResponse(_sid,StrawElectronics::thresh,time-jclust->time(),jclust->charge(),jclust->wireDistance(),true);
-            ++jclust;
-          }
+          jclust = endClust(time,jclust);
+          double response = linearResponse(strawele,StrawElectronics::thresh,time,iclust,jclust,true);
           // now saturate it
           double sat_response = strawele.saturatedResponse(response);
           // then calculate the impulse response at each of the adctimes and add it to that
@@ -0,0 +1,36 @@
+#! /bin/bash
+#
+# Scaling of the straw digitization (makeSD) with the number of threads, with the
+# straws digitized in parallel (TrackerMC/test/digiScaling.fcl), and a check that the
+# digis are the same for every number of threads.
+#
+# Usage: TrackerMC/test/digiThreadScaling.sh [nevents] [thread counts...]
+# Run from the base of a built Offline, after setup.sh.
+# The logs are written to digiscaling_<N>.log, the printed digis to digiscaling_<N>.txt;
+# the summary is printed.
+#
+
+nevents=${1:-200}
+shift
+threads=${@:-1 2 4 8 16 32}
+
+ref=""
+for n in $threads; do
+  log=digiscaling_${n}.log
+  mu2e -c TrackerMC/test/digiScaling.fcl -n $nevents --nthreads $n --nschedules 1 >& $log
+  # mean time per event of the module, from the TimeTracker summary
+  sdtime=$(grep -m1 " makeSD " $log | awk '{print $(NF-4)}')
+  evtime=$(grep -m1 "Full event" $log | awk '{print $4}')
+  # print the digis; the module times and the file names are the only expected differences
+  mv dig.digiScaling.art dig.digiScaling_${n}.art
+  mu2e -c Print/fcl/print.fcl -s dig.digiScaling_${n}.art 2>&1 | grep -v -i "time\|file" > digiscaling_${n}.txt
+  if [ -z "$ref" ]; then
+    ref=digiscaling_${n}.txt
+    same="reference"
+  elif cmp -s $ref digiscaling_${n}.txt; then
+    same="same digis"
+  else
+    same="DIFFERENT digis"
+  fi
+  printf "%4s threads  makeSD mean time %-10s  mean event time %-10s  %s\n" $n "$sdtime" "$evtime" "$same"
+done
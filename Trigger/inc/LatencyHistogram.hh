@@ -0,0 +1,67 @@
+#ifndef Trigger_LatencyHistogram_hh
+#define Trigger_LatencyHistogram_hh
+//
+// Fixed-size histogram of processing times, cheap enough to fill for every
+// module of every event.  Bins are log-spaced, 8 per factor of 2, from ~1 us to
+// ~128 s, so quantiles have a relative resolution of about 10%; the count, sum,
+// min and max are exact.  Times are in seconds.
+//
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+namespace mu2e {
+
+  class LatencyHistogram {
+  public:
+
+    LatencyHistogram();
+
+    void fill(double t) {
+      ++n_;
+      sum_ += t;
+      if(t > max_) max_ = t;
+      if(t < min_) min_ = t;
+      ++counts_[bin(t)];
+    }
+
+    // add the contents of another histogram
+    void merge(LatencyHistogram const& other);
+
+    unsigned long count() const { return n_; }
+    double mean() const { return n_ > 0 ? sum_/n_ : 0.; }
+    double min() const { return n_ > 0 ? min_ : 0.; }
+    double max() const { return n_ > 0 ? max_ : 0.; }
+
+    // q in [0,1], linearly interpolated within the bin and clamped to [min,max]
+    double quantile(double q) const;
+
+  private:
+
+    static constexpr int subBins_ = 8;
+    static constexpr int minExp_  = -19; // frexp exponent of the first octave: [2^-20,2^-19) s
+    static constexpr int maxExp_  = 7;   // last octave: [2^6,2^7) s
+    // underflow, octaves, overflow
+    static constexpr std::size_t nBins_ = (maxExp_-minExp_+1)*subBins_ + 2;
+
+    static std::size_t bin(double t) {
+      int e;
+      double m = std::frexp(t, &e); // t = m*2^e, m in [0.5,1)
+      if(!(t > 0.) || e < minExp_) return 0;
+      if(e > maxExp_) return nBins_-1;
+      return 1 + (e-minExp_)*subBins_ + static_cast<int>((2.*m-1.)*subBins_);
+    }
+    // lower edge of a regular bin
+    static double lowEdge(std::size_t ibin);
+
+    std::array<unsigned long, nBins_> counts_;
+    unsigned long n_;
+    double sum_;
+    double min_;
+    double max_;
+  };
+
+}
+
+#endif /* Trigger_LatencyHistogram_hh */
@@ -0,0 +1,72 @@
+#!/usr/bin/env python
+################################################################################
+# Compare two latency reports written by the TriggerLatency service, e.g. from
+# Trigger/fcl/runTriggerLatency.fcl run with two releases on the same input.
+#
+#   Trigger/python/compareLatency.py old/triggerLatency.txt new/triggerLatency.txt
+#
+# Entries (event, paths and modules) whose chosen statistic grew by more than
+# both the relative and the absolute tolerance are flagged as regressions, and
+# the script returns a non-zero status if there are any.
+#
+from __future__ import print_function
+import sys
+from argparse import ArgumentParser
+
+COLUMNS = ['count', 'mean', 'p50', 'p90', 'p99', 'max', 'budget', 'overruns']
+
+def readReport(fname):
+    entries = {}
+    order = []
+    for line in open(fname):
+        words = line.split()
+        if len(words) == 0 or words[0].startswith('#'):
+            continue
+        if len(words) != 2 + len(COLUMNS):
+            raise RuntimeError('%s: malformed line: %s' % (fname, line.strip()))
+        key = (words[0], words[1])
+        entries[key] = dict(zip(COLUMNS, [float(w) for w in words[2:]]))
+        order.append(key)
+    return entries, order
+
+def main():
+    parser = ArgumentParser(description='Compare two TriggerLatency reports')
+    parser.add_argument('old', help='reference report')
+    parser.add_argument('new', help='report to check')
+    parser.add_argument('-s', '--stat', default='p99', choices=COLUMNS[1:6],
+                        help='statistic to compare (default p99)')
+    parser.add_argument('-r', '--relative', type=float, default=0.10,
+                        help='relative increase flagged as a regression (default 0.10)')
+    parser.add_argument('-a', '--absolute', type=float, default=0.05,
+                        help='minimum increase in ms flagged as a regression (default 0.05)')
+    parser.add_argument('-q', '--quiet', action='store_true',
+                        help='only print regressions')
+    args = parser.parse_args()
+
+    old, _ = readReport(args.old)
+    new, order = readReport(args.new)
+
+    nreg = 0
+    print('%-6s %-40s %10s %10s %8s' % ('kind', 'name', 'old ' + args.stat, 'new ' + args.stat, 'change'))
+    for key in order:
+        if key not in old:
+            if not args.quiet:
+                print('%-6s %-40s %10s %10.3f %8s' % (key[0], key[1], '-', new[key][args.stat], 'new'))
+            continue
+        o = old[key][args.stat]
+        n = new[key][args.stat]
+        diff = n - o
+        regression = diff > args.absolute and diff > args.relative * o
+        nreg += regression
+        if regression or not args.quiet:
+            change = '%+7.1f%%' % (100. * diff / o) if o > 0. else '-'
+            print('%-6s %-40s %10.3f %10.3f %8s%s' % (key[0], key[1], o, n, change, '  REGRESSION' if regression else ''))
+    for key in old:
+        if key not in new and not args.quiet:
+            print('%-6s %-40s %10.3f %10s %8s' % (key[0], key[1], old[key][args.stat], '-', 'removed'))
+
+    print('%d regression(s) in %s' % (nreg, args.stat))
+    return 1 if nreg > 0 else 0
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,54 @@
+//
+// Fixed-size histogram of processing times.
+//
+
+#include "Trigger/inc/LatencyHistogram.hh"
+
+#include <algorithm>
+#include <limits>
+
+namespace mu2e {
+
+  LatencyHistogram::LatencyHistogram()
+    : n_(0)
+    , sum_(0.)
+    , min_(std::numeric_limits<double>::max())
+    , max_(0.)
+  {
+    counts_.fill(0);
+  }
+
+  void LatencyHistogram::merge(LatencyHistogram const& other) {
+    for(std::size_t i=0; i<nBins_; ++i) counts_[i] += other.counts_[i];
+    n_   += other.n_;
+    sum_ += other.sum_;
+    min_  = std::min(min_, other.min_);
+    max_  = std::max(max_, other.max_);
+  }
+
+  double LatencyHistogram::lowEdge(std::size_t ibin) {
+    const int i = ibin-1;
+    return std::ldexp(0.5*(1. + double(i%subBins_)/subBins_), minExp_ + i/subBins_);
+  }
+
+  double LatencyHistogram::quantile(double q) const {
+    if(n_ == 0) return 0.;
+    const double target = std::max(0., std::min(1., q))*n_;
+    double cum = 0.;
+    for(std::size_t ibin=0; ibin<nBins_; ++ibin) {
+      if(counts_[ibin] == 0) continue;
+      if(cum + counts_[ibin] >= target) {
+        // the under- and overflow bins have no width: use the exact extremes
+        if(ibin == 0) return min();
+        if(ibin == nBins_-1) return max();
+        const double lo = lowEdge(ibin);
+        const double hi = (ibin+1 < nBins_-1) ? lowEdge(ibin+1) : std::ldexp(1., maxExp_);
+        const double t = lo + (hi-lo)*(target-cum)/counts_[ibin];
+        return std::max(min(), std::min(max(), t));
+      }
+      cum += counts_[ibin];
+    }
+    return max();
+  }
+
+}
@@ -0,0 +1,277 @@
+//
+// Latency monitoring for trigger jobs: distributions of the wall-clock time per
+// event, per path and per module, with optional budgets and overrun counters.
+//
+// The callbacks only read the clock and fill a fixed-size histogram, so the
+// service can stay on in online running.  Each schedule keeps its own
+// histograms, merged at end of job.  Paths of a schedule, and so their modules,
+// may run concurrently, so their start times are kept by path name and module
+// label and the path and module data of a schedule are guarded by a mutex.  At
+// end of job a summary (count, mean, p50, p90, p99, max and budget overruns, in
+// ms) is printed and optionally written to a text report.  Reports from two
+// releases can be compared with Trigger/python/compareLatency.py.
+//
+// Parameters:
+//   eventBudget        : ms allowed per event, 0 for none
+//   pathBudgets        : table of ms allowed per path, by path name
+//   moduleBudgets      : table of ms allowed per module, by module label
+//   maxOverrunMessages : number of overruns reported as they happen
+//   printSummary       : print the summary at end of job
+//   reportFile         : text report file name, empty for none
+//
+
+#include "art/Framework/Principal/Event.h"
+#include "art/Framework/Services/Registry/ActivityRegistry.h"
+#include "art/Framework/Services/Registry/ServiceMacros.h"
+#include "art/Persistency/Provenance/ModuleContext.h"
+#include "art/Persistency/Provenance/PathContext.h"
+#include "art/Persistency/Provenance/ScheduleContext.h"
+#include "art/Utilities/Globals.h"
+#include "canvas/Persistency/Common/HLTPathStatus.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+#include "Trigger/inc/LatencyHistogram.hh"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mu2e {
+
+  class TriggerLatency {
+  public:
+
+    TriggerLatency(fhicl::ParameterSet const& pset, art::ActivityRegistry& registry);
+
+  private:
+
+    typedef std::chrono::steady_clock Clock;
+
+    struct Entry {
+      explicit Entry(double budget=0.) : budget(budget), overruns(0) {}
+      LatencyHistogram hist;
+      double budget; // s, 0 for none
+      unsigned long overruns;
+    };
+    typedef std::unordered_map<std::string,Entry> EntryMap;
+
+    typedef std::unordered_map<std::string,Clock::time_point> StartMap;
+
+    // one event at a time per schedule, but its paths may run concurrently
+    struct ScheduleData {
+      Clock::time_point eventStart;
+      Entry event;
+      std::mutex mutex; // guards the rest
+      StartMap pathStarts, moduleStarts;
+      EntryMap paths;
+      EntryMap modules;
+    };
+
+    void preEvent (art::Event const&, art::ScheduleContext);
+    void postEvent(art::Event const&, art::ScheduleContext);
+    void prePath  (art::PathContext const&);
+    void postPath (art::PathContext const&, art::HLTPathStatus const&);
+    void preModule (art::ModuleContext const&);
+    void postModule(art::ModuleContext const&);
+    void postEndJob();
+
+    Entry& entry(EntryMap& entries, std::map<std::string,double> const& budgets, std::string const& name);
+    void record(Entry& entry, double t, char const* kind, std::string const& name);
+    void summary(std::ostream& os, char const* kind, std::map<std::string,Entry> const& entries) const;
+
+    static double elapsed(Clock::time_point start) {
+      return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+    static std::map<std::string,double> readBudgets(fhicl::ParameterSet const& pset);
+
+    double _eventBudget;
+    std::map<std::string,double> _pathBudgets;
+    std::map<std::string,double> _moduleBudgets;
+    unsigned _maxOverrunMessages;
+    bool _printSummary;
+    std::string _reportFile;
+
+    std::vector<ScheduleData> _schedules;
+    std::atomic<unsigned> _nOverrunMessages;
+  };
+
+  TriggerLatency::TriggerLatency(fhicl::ParameterSet const& pset, art::ActivityRegistry& registry)
+    : _eventBudget(pset.get<double>("eventBudget",0.)*1.e-3)
+    , _pathBudgets(readBudgets(pset.get<fhicl::ParameterSet>("pathBudgets",fhicl::ParameterSet())))
+    , _moduleBudgets(readBudgets(pset.get<fhicl::ParameterSet>("moduleBudgets",fhicl::ParameterSet())))
+    , _maxOverrunMessages(pset.get<unsigned>("maxOverrunMessages",10))
+    , _printSummary(pset.get<bool>("printSummary",true))
+    , _reportFile(pset.get<std::string>("reportFile",""))
+    , _schedules(art::Globals::instance()->nschedules())
+    , _nOverrunMessages(0)
+  {
+    for(auto& sched : _schedules) sched.event.budget = _eventBudget;
+
+    registry.sPreProcessEvent.watch (this, &TriggerLatency::preEvent  );
+    registry.sPostProcessEvent.watch(this, &TriggerLatency::postEvent );
+    registry.sPreProcessPath.watch  (this, &TriggerLatency::prePath   );
+    registry.sPostProcessPath.watch (this, &TriggerLatency::postPath  );
+    registry.sPreModule.watch       (this, &TriggerLatency::preModule );
+    registry.sPostModule.watch      (this, &TriggerLatency::postModule);
+    registry.sPostEndJob.watch      (this, &TriggerLatency::postEndJob);
+  }
+
+  std::map<std::string,double> TriggerLatency::readBudgets(fhicl::ParameterSet const& pset) {
+    std::map<std::string,double> budgets;
+    for(auto const& name : pset.get_names()) {
+      double budget = pset.get<double>(name);
+      if(budget < 0.) {
+        throw cet::exception("CONFIG")<<"TriggerLatency: negative budget for "<<name<<"\n";
+      }
+      budgets[name] = budget*1.e-3;
+    }
+    return budgets;
+  }
+
+  //================================================================
+  void TriggerLatency::preEvent(art::Event const&, art::ScheduleContext sc) {
+    _schedules[sc.id().id()].eventStart = Clock::now();
+  }
+
+  void TriggerLatency::postEvent(art::Event const& event, art::ScheduleContext sc) {
+    ScheduleData& sched = _schedules[sc.id().id()];
+    double t = elapsed(sched.eventStart);
+    sched.event.hist.fill(t);
+    if(sched.event.budget > 0. && t > sched.event.budget) {
+      ++sched.event.overruns;
+      if(_nOverrunMessages++ < _maxOverrunMessages) {
+        mf::LogWarning("TriggerLatency")<<"event "<<event.id()<<" took "<<t*1.e3
+                                        <<" ms, budget "<<sched.event.budget*1.e3<<" ms";
+      }
+    }
+  }
+
+  void TriggerLatency::prePath(art::PathContext const& pc) {
+    ScheduleData& sched = _schedules[pc.scheduleID().id()];
+    std::lock_guard<std::mutex> lock(sched.mutex);
+    sched.pathStarts[pc.pathName()] = Clock::now();
+  }
+
+  void TriggerLatency::postPath(art::PathContext const& pc, art::HLTPathStatus const&) {
+    Clock::time_point end = Clock::now();
+    ScheduleData& sched = _schedules[pc.scheduleID().id()];
+    std::lock_guard<std::mutex> lock(sched.mutex);
+    double t = std::chrono::duration<double>(end - sched.pathStarts[pc.pathName()]).count();
+    record(entry(sched.paths,_pathBudgets,pc.pathName()), t, "path", pc.pathName());
+  }
+
+  // a module runs once per event, even if it is on several paths
+  void TriggerLatency::preModule(art::ModuleContext const& mc) {
+    ScheduleData& sched = _schedules[mc.scheduleID().id()];
+    std::lock_guard<std::mutex> lock(sched.mutex);
+    sched.moduleStarts[mc.moduleLabel()] = Clock::now();
+  }
+
+  void TriggerLatency::postModule(art::ModuleContext const& mc) {
+    Clock::time_point end = Clock::now();
+    ScheduleData& sched = _schedules[mc.scheduleID().id()];
+    std::lock_guard<std::mutex> lock(sched.mutex);
+    double t = std::chrono::duration<double>(end - sched.moduleStarts[mc.moduleLabel()]).count();
+    record(entry(sched.modules,_moduleBudgets,mc.moduleLabel()), t, "module", mc.moduleLabel());
+  }
+
+  TriggerLatency::Entry& TriggerLatency::entry(EntryMap& entries,
+                                               std::map<std::string,double> const& budgets,
+                                               std::string const& name) {
+    auto ient = entries.find(name);
+    if(ient == entries.end()) {
+      auto ibud = budgets.find(name);
+      ient = entries.emplace(name, Entry(ibud != budgets.end() ? ibud->second : 0.)).first;
+    }
+    return ient->second;
+  }
+
+  void TriggerLatency::record(Entry& entry, double t, char const* kind, std::string const& name) {
+    entry.hist.fill(t);
+    if(entry.budget > 0. && t > entry.budget) {
+      ++entry.overruns;
+      if(_nOverrunMessages++ < _maxOverrunMessages) {
+        mf::LogWarning("TriggerLatency")<<kind<<" "<<name<<" took "<<t*1.e3
+                                        <<" ms, budget "<<entry.budget*1.e3<<" ms";
+      }
+    }
+  }
+
+  //================================================================
+  void TriggerLatency::postEndJob() {
+    // merge the schedules, sorted by name for the report
+    Entry event(_eventBudget);
+    std::map<std::string,Entry> paths, modules;
+    for(auto const& sched : _schedules) {
+      event.hist.merge(sched.event.hist);
+      event.overruns += sched.event.overruns;
+      for(auto const& p : sched.paths) {
+        Entry& e = paths.emplace(p.first, Entry(p.second.budget)).first->second;
+        e.hist.merge(p.second.hist);
+        e.overruns += p.second.overruns;
+      }
+      for(auto const& m : sched.modules) {
+        Entry& e = modules.emplace(m.first, Entry(m.second.budget)).first->second;
+        e.hist.merge(m.second.hist);
+        e.overruns += m.second.overruns;
+      }
+    }
+    std::map<std::string,Entry> events;
+    events.emplace("all", event);
+
+    if(_printSummary) {
+      std::cout << "\nTriggerLatency summary (ms):" << std::endl;
+      summary(std::cout, "event",  events);
+      summary(std::cout, "path",   paths);
+      summary(std::cout, "module", modules);
+      std::cout << std::endl;
+    }
+    if(!_reportFile.empty()) {
+      std::ofstream os(_reportFile);
+      if(!os) {
+        throw cet::exception("CONFIG")<<"TriggerLatency: can't open report file "<<_reportFile<<"\n";
+      }
+      summary(os, "event",  events);
+      summary(os, "path",   paths);
+      summary(os, "module", modules);
+    }
+  }
+
+  // one line per entry, in the format read by Trigger/python/compareLatency.py
+  void TriggerLatency::summary(std::ostream& os, char const* kind, std::map<std::string,Entry> const& entries) const {
+    std::ios::fmtflags flags(os.flags());
+    std::streamsize precision(os.precision());
+    os << "# " << std::left << std::setw(6) << kind << " " << std::setw(40) << "name" << std::right
+       << std::setw(10) << "count" << std::setw(10) << "mean" << std::setw(10) << "p50"
+       << std::setw(10) << "p90" << std::setw(10) << "p99" << std::setw(10) << "max"
+       << std::setw(10) << "budget" << std::setw(10) << "overruns" << std::endl;
+    for(auto const& e : entries) {
+      LatencyHistogram const& h = e.second.hist;
+      os << "  " << std::left << std::setw(6) << kind << " " << std::setw(40) << e.first << std::right
+         << std::fixed << std::setprecision(3)
+         << std::setw(10) << h.count()
+         << std::setw(10) << h.mean()*1.e3
+         << std::setw(10) << h.quantile(0.5)*1.e3
+         << std::setw(10) << h.quantile(0.9)*1.e3
+         << std::setw(10) << h.quantile(0.99)*1.e3
+         << std::setw(10) << h.max()*1.e3
+         << std::setw(10) << e.second.budget*1.e3
+         << std::setw(10) << e.second.overruns << std::endl;
+    }
+    os.flags(flags);
+    os.precision(precision);
+  }
+
+}
+
+DECLARE_ART_SERVICE(mu2e::TriggerLatency, SHARED)
+DEFINE_ART_SERVICE(mu2e::TriggerLatency)
@@ -78,6 +78,7 @@ namespace mu2e
     bool _savebkg;
     StrawHitFlag _bkgmsk, _stereo;
     const ComboHitCollection* _chcol;
+    StrawHitIndexMap _shmap; // reused across events to avoid reallocating
     BkgClusterer* _clusterer;
     float        _cperr2;
     bool         _useMVA;
@@ -206,13 +207,12 @@ namespace mu2e
       // first, copy over the original flags
       unsigned nsh = shcol->size();
       auto shfcol = std::make_unique<StrawHitFlagCollection>(nsh);
-      std::vector<std::vector<StrawHitIndex> > shids;
-      _chcol->fillStrawHitIndices(event,shids);
+      _chcol->fillStrawHitIndices(event,_shmap);
       for(size_t ich = 0;ich < _chcol->size();++ich) {
         StrawHitFlag flag = chfcol[ich];
         flag.merge((*_chcol)[ich].flag());
-        for(auto ish : shids[ich])
-          (*shfcol)[ish] = flag;
+        for(auto ish = _shmap.begin(ich); ish != _shmap.end(ich); ++ish)
+          (*shfcol)[*ish] = flag;
       }
 
       event.put(std::move(shfcol),"StrawHits");
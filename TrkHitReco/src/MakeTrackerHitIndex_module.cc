@@ -0,0 +1,62 @@
+//
+// A module to index a ComboHitCollection once per event (time order, panel
+// buckets, flags), so that the downstream pattern recognition modules
+// (TimeCluster/Helix finders, CalTimePeakFinder, DeltaFinder) don't each
+// sort and bucket the same hits.
+//
+
+// Mu2e includes.
+#include "RecoDataProducts/inc/ComboHit.hh"
+#include "RecoDataProducts/inc/TrackerHitIndex.hh"
+// art includes.
+#include "art/Framework/Core/EDProducer.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Principal/Event.h"
+#include "art/Framework/Principal/Handle.h"
+
+// From the art tool-chain
+#include "fhiclcpp/ParameterSet.h"
+// C++ includes.
+#include <iostream>
+#include <memory>
+
+using namespace std;
+
+namespace mu2e {
+
+  class MakeTrackerHitIndex : public art::EDProducer {
+
+  public:
+    explicit MakeTrackerHitIndex(fhicl::ParameterSet const& pset);
+
+    void produce( art::Event& e);
+
+  private:
+    // configuration
+    int _debug;
+    // event object Tags
+    art::InputTag _chTag;
+  };
+
+  MakeTrackerHitIndex::MakeTrackerHitIndex(fhicl::ParameterSet const& pset) :
+    art::EDProducer{pset},
+    _debug(pset.get<int>("debugLevel",0)),
+    _chTag(pset.get<art::InputTag>("ComboHitCollection"))
+  {
+    consumes<ComboHitCollection>(_chTag);
+    produces<TrackerHitIndex>();
+  }
+
+  void MakeTrackerHitIndex::produce(art::Event& event) {
+    auto chH = event.getValidHandle<ComboHitCollection>(_chTag);
+    auto thi = std::make_unique<TrackerHitIndex>();
+    thi->fill(*chH,chH.id());
+    if(_debug > 0)
+      std::cout << "MakeTrackerHitIndex: indexed " << thi->size() << " hits of " << _chTag
+	<< ", time range " << thi->minTime() << " " << thi->maxTime()
+	<< ", z range " << thi->zMin() << " " << thi->zMax() << std::endl;
+    event.put(std::move(thi));
+  }
+}
+
+DEFINE_ART_MODULE(mu2e::MakeTrackerHitIndex)
@@ -0,0 +1,114 @@
+//
+// Compare the throughput of hit loops written against the ComboHit AoS collection with the same
+// loops written against the ComboHitSoA view.  The circle and phi-z parameters are fixed, so
+// only the memory access pattern and vectorization differ.  Results are printed at end of job.
+//
+// framework
+#include "art/Framework/Principal/Event.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Core/ModuleMacros.h"
+// Mu2e
+#include "Mu2eUtilities/inc/polyAtan2.hh"
+#include "RecoDataProducts/inc/ComboHit.hh"
+#include "TrkReco/inc/ComboHitSoA.hh"
+// C++
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace mu2e {
+
+  class ComboHitSoABenchmark : public art::EDAnalyzer {
+    public:
+      explicit ComboHitSoABenchmark(fhicl::ParameterSet const& pset);
+      void analyze(art::Event const& event) override;
+      void endJob() override;
+
+    private:
+      typedef std::chrono::high_resolution_clock Clock;
+      art::ProductToken<ComboHitCollection> const _chToken;
+      unsigned _nrep; // number of times each loop is repeated per event, to reduce timer granularity effects
+      float _cx, _cy, _radius, _phi0, _dfdz; // fixed helix parameters
+      float _t0, _maxdt; // time window
+      StrawHitFlag _hsel, _hbkg;
+      ComboHitSoA _soa;
+      std::vector<float> _resid;
+      std::vector<StrawHitIndex> _indices;
+      double _aosTime, _soaFillTime, _soaTime; // accumulated ns
+      unsigned long _nhits;
+      double _sum; // prevents the compiler from optimizing away the loops
+  };
+
+  ComboHitSoABenchmark::ComboHitSoABenchmark(fhicl::ParameterSet const& pset) :
+    art::EDAnalyzer{pset},
+    _chToken{consumes<ComboHitCollection>(pset.get<art::InputTag>("ComboHitCollection"))},
+    _nrep(pset.get<unsigned>("NRepeat",100)),
+    _cx(pset.get<float>("CenterX",100.0)),
+    _cy(pset.get<float>("CenterY",-100.0)),
+    _radius(pset.get<float>("Radius",250.0)),
+    _phi0(pset.get<float>("Phi0",0.0)),
+    _dfdz(pset.get<float>("DPhiDz",0.004)),
+    _t0(pset.get<float>("T0",800.0)),
+    _maxdt(pset.get<float>("DtMax",25.0)),
+    _hsel(pset.get<std::vector<std::string> >("HitSelectionBits",std::vector<std::string>{"EnergySelection","TimeSelection","RadiusSelection"})),
+    _hbkg(pset.get<std::vector<std::string> >("HitBackgroundBits",std::vector<std::string>{"Background"})),
+    _aosTime(0.0), _soaFillTime(0.0), _soaTime(0.0), _nhits(0), _sum(0.0)
+  {}
+
+  void ComboHitSoABenchmark::analyze(art::Event const& event) {
+    auto const& chcol = *event.getValidHandle(_chToken);
+    size_t nch = chcol.size();
+    if(nch==0) return; // nothing to time, and the checksum reads a residual
+    _resid.resize(nch);
+    _nhits += nch*_nrep;
+    // AoS reference loops
+    auto start = Clock::now();
+    for(unsigned irep=0;irep < _nrep; ++irep){
+      for(size_t ich=0;ich < nch; ++ich){
+	ComboHit const& ch = chcol[ich];
+	float dx = ch.pos().x()-_cx;
+	float dy = ch.pos().y()-_cy;
+	_resid[ich] = sqrtf(dx*dx+dy*dy)-_radius;
+      }
+      for(size_t ich=0;ich < nch; ++ich){
+	ComboHit const& ch = chcol[ich];
+	float dphi = polyAtan2(ch.pos().y()-_cy,ch.pos().x()-_cx) - (_phi0 + _dfdz*ch.pos().z());
+	_resid[ich] = dphi - ComboHitSoAKernels::twoPi*nearbyintf(dphi*ComboHitSoAKernels::invTwoPi);
+      }
+      _indices.clear();
+      for(size_t ich=0;ich < nch; ++ich){
+	ComboHit const& ch = chcol[ich];
+	if(fabsf(ch.time()-_t0) < _maxdt && ch.flag().hasAllProperties(_hsel) && !ch.flag().hasAnyProperty(_hbkg))
+	  _indices.push_back(ich);
+      }
+      _sum += _resid[irep%nch] + _indices.size();
+    }
+    auto aosend = Clock::now();
+    // SoA: fill once per event, as a module would
+    _soa.fill(chcol);
+    auto fillend = Clock::now();
+    for(unsigned irep=0;irep < _nrep; ++irep){
+      ComboHitSoAKernels::circleResiduals(_soa,_cx,_cy,_radius,_resid.data());
+      ComboHitSoAKernels::phiZResiduals(_soa,_cx,_cy,_phi0,_dfdz,_resid.data());
+      ComboHitSoAKernels::timeWindow(_soa,_t0,_maxdt,_hsel,_hbkg,_indices);
+      _sum += _resid[irep%nch] + _indices.size();
+    }
+    auto soaend = Clock::now();
+    _aosTime += std::chrono::duration<double,std::nano>(aosend-start).count();
+    _soaFillTime += std::chrono::duration<double,std::nano>(fillend-aosend).count();
+    _soaTime += std::chrono::duration<double,std::nano>(soaend-fillend).count();
+  }
+
+  void ComboHitSoABenchmark::endJob() {
+    if(_nhits == 0) return;
+    std::cout << "ComboHitSoABenchmark: " << _nhits << " hit-iterations (checksum " << _sum << ")" << std::endl
+      << "  AoS loops       : " << _aosTime/_nhits << " ns/hit" << std::endl
+      << "  SoA fill        : " << _soaFillTime*_nrep/_nhits << " ns/hit (once per event)" << std::endl
+      << "  SoA kernels     : " << _soaTime/_nhits << " ns/hit" << std::endl;
+  }
+}
+
+using mu2e::ComboHitSoABenchmark;
+DEFINE_ART_MODULE(ComboHitSoABenchmark);
@@ -15,6 +15,7 @@
 #include "art/Framework/Core/EDProducer.h"
 #include "art/Framework/Core/ModuleMacros.h"
 #include "art_root_io/TFileService.h"
+#include "cetlib_except/exception.h"
 #include "GeneralUtilities/inc/Angles.hh"
 #include "Mu2eUtilities/inc/MVATools.hh"
 
@@ -24,6 +25,7 @@
 #include "RecoDataProducts/inc/StrawHitFlagCollection.hh"
 #include "RecoDataProducts/inc/StereoHit.hh"
 #include "RecoDataProducts/inc/TimeCluster.hh"
+#include "RecoDataProducts/inc/TrackerHitIndex.hh"
 #include "RecoDataProducts/inc/HelixSeed.hh"
 #include "RecoDataProducts/inc/TrkFitFlag.hh"
 
@@ -78,10 +80,6 @@ namespace {
     bool operator()(mu2e::ComboHit const& p1, mu2e::ComboHit const& p2) { return p1._pos.z() < p2._pos.z(); }
   };
 
-  // comparison functor for sorting byuniquePanel ID
-  struct panelcomp : public std::binary_function<mu2e::ComboHit,mu2e::ComboHit,bool> {
-    bool operator()(mu2e::ComboHit const& p1, mu2e::ComboHit const& p2) { return p1.strawId().uniquePanel() < p2.strawId().uniquePanel(); }
-  };
   struct HelixHitMVA
   {
     std::vector <float> _pars,_pars2;
@@ -143,6 +141,7 @@ namespace mu2e {
 
     art::ProductToken<ComboHitCollection> const _chToken;
     art::ProductToken<TimeClusterCollection> const _tcToken;
+    art::InputTag _thiTag; // shared hit index; if empty or missing the hits are indexed here
 
     StrawHitFlag  _hsel, _hbkg;
 
@@ -162,6 +161,9 @@ namespace mu2e {
     std::unique_ptr<ModuleHistToolBase>   _hmanager;
     RobustHelixFinderTypes::Data_t        _data;
     RobustHelixFinderData                 _hfResult;
+    TrackerHitIndex                       _localIndex;
+    const TrackerHitIndex*                _thi;
+    std::vector<ComboHitIndex>            _ordHits; // selected hits of a time cluster, in panel order
 
     void     findHelices(ComboHitCollection& chcol, const TimeClusterCollection& tccol);    
     void     prefilterHits(RobustHelixFinderData& helixData, int& nFilteredStrawHits); 
@@ -185,8 +187,6 @@ namespace mu2e {
     void     updateChi2HelixInfo(RobustHelixFinderData& helixData);
     void     updateHelixXYInfo  (RobustHelixFinderData& helixData);
     void     updateHelixZPhiInfo(RobustHelixFinderData& helixData);
-    void     searchWorstHitXY   (RobustHelixFinderData& helixData, HitInfo_t& hitInfo);
-    void     searchWorstHitZPhi (RobustHelixFinderData& helixData, HitInfo_t& hitInfo);
   };
 
   RobustHelixFinder::RobustHelixFinder(fhicl::ParameterSet const& pset) :
@@ -221,6 +221,7 @@ namespace mu2e {
     _minmva      (pset.get<float> ("MinMVA",0.1)), // min MVA output to define an outlier
     _chToken{consumes<ComboHitCollection>(pset.get<art::InputTag>("ComboHitCollection"))},
     _tcToken{consumes<TimeClusterCollection>(pset.get<art::InputTag>("TimeClusterCollection"))},
+    _thiTag      (pset.get<art::InputTag>("TrackerHitIndex",art::InputTag())),
     _hsel        (pset.get<std::vector<std::string> >("HitSelectionBits",std::vector<string>{"TimeDivision"})),
     _hbkg        (pset.get<std::vector<std::string> >("HitBackgroundBits",std::vector<std::string>{"Background"})),
     _stmva       (pset.get<fhicl::ParameterSet>("HelixStereoHitMVA",fhicl::ParameterSet())),
@@ -231,6 +232,8 @@ namespace mu2e {
     _outlier     (StrawHitFlag::outlier),
     _updateStereo    (pset.get<bool>("UpdateStereo",false))
   {
+    if (!_thiTag.label().empty()) consumes<TrackerHitIndex>(_thiTag);
+
     std::vector<int> helvals = pset.get<std::vector<int> >("Helicities",vector<int>{Helicity::neghel,Helicity::poshel});
     for(auto hv : helvals) {
       Helicity hel(hv);
@@ -294,6 +297,18 @@ namespace mu2e {
     auto const& chH = event.getValidHandle(_chToken);
     const ComboHitCollection& chcol(*chH);
 
+    // hit index: shared if the event has it, built here otherwise
+    art::Handle<TrackerHitIndex> thiH;
+    if (!_thiTag.label().empty()) event.getByLabel(_thiTag,thiH);
+    if (thiH.isValid()) {
+      _thi = thiH.product();
+      if (!_thi->indexes(chH.id()))
+	throw cet::exception("RECO")<<"mu2e::RobustHelixFinder: TrackerHitIndex " << _thiTag << " doesn't index the input ComboHitCollection" << endl;
+    } else {
+      _localIndex.fill(chcol,chH.id());
+      _thi = &_localIndex;
+    }
+
     // create output: seperate by helicity
     std::map<Helicity,unique_ptr<HelixSeedCollection>> helcols;
     int counter(0);
@@ -609,7 +624,7 @@ namespace mu2e {
 	worstHit.panelHitIndex = -1;
 	//	worstHit.weightXY      =  0;
 
-	searchWorstHitXY(helixData, worstHit);
+	_chi2hfit.searchWorstHitXY(helixData, worstHit, _maxrpull*_maxrpull);
 	
 	if (worstHit.face >=0){//check if a bad was found or not
 	  hit    = &helixData._chHitsToProcess[worstHit.panelHitIndex];
@@ -680,7 +695,7 @@ namespace mu2e {
 	worstHit.panel         = -1;
 	worstHit.panelHitIndex = -1;
 	
-	searchWorstHitZPhi(helixData, worstHit);
+	_chi2hfit.searchWorstHitZPhi(helixData, worstHit);
 	
 	if (worstHit.face >=0){//check if a bad was found or not
 	  hit    = &helixData._chHitsToProcess[worstHit.panelHitIndex];
@@ -1004,27 +1019,19 @@ namespace mu2e {
   void     RobustHelixFinder::fillFaceOrderedHits(RobustHelixFinderData& HelixData){
   
     const vector<StrawHitIndex>& shIndices = HelixData._timeCluster->hits();
-    mu2e::RobustHelixFinderData::ChannelID cx, co;
 
-    int     size  = shIndices.size();
     int     nFiltComboHits(0), nFiltStrawHits(0);
-    // int nTotalStations = _tracker->nStations();
     //--------------------------------------------------------------------------------
-    int loc;
-    StrawHitFlag flag;
-
-    //sort the hits by z coordinate
-    ComboHitCollection ordChCol;
-    ordChCol.reserve(size);
-    
-    for (int i=0; i<size; ++i) {
-      loc = shIndices[i];
-      const ComboHit& ch  = (*_hfResult._chcol)[loc];
-      if(ch.flag().hasAnyProperty(_hsel) && !ch.flag().hasAnyProperty(_hbkg) ) {
-	ordChCol.push_back(ComboHit(ch));
+    // select the hits and sort them by panel, using the hit index
+    _ordHits.clear();
+    for (auto loc : shIndices) {
+      const StrawHitFlag& flag = _thi->flag(loc);
+      if(flag.hasAnyProperty(_hsel) && !flag.hasAnyProperty(_hbkg) ) {
+	_ordHits.push_back(loc);
       }
     }
-    std::sort(ordChCol.begin(), ordChCol.end(),panelcomp());//zcomp());
+    std::sort(_ordHits.begin(), _ordHits.end(),
+	      [this](ComboHitIndex a, ComboHitIndex b) { return _thi->panelRank(a) < _thi->panelRank(b); });
 
 
     if (_debug>0){
@@ -1033,39 +1040,25 @@ namespace mu2e {
       printf("[RobustHelixFinder::FillHits]-----------------------------------------------------------\n");
     }
     
-    for (unsigned i=0; i<ordChCol.size(); ++i) {
-      // loc = shIndices[i];
-      // const ComboHit& ch  = _hfResult._chcol->at(loc);
-      ComboHit& ch = ordChCol[i];
+    for (auto loc : _ordHits) {
+      const ComboHit& ch = (*_hfResult._chcol)[loc];
 
-      //    if(ch.flag().hasAnyProperty(_hsel) && !ch.flag().hasAnyProperty(_hbkg) ) {
       ComboHit hhit(ch);
       hhit._flag.clear(StrawHitFlag::resolvedphi);
 	
       _hfResult._chHitsToProcess.push_back(hhit);
 
-      cx.Station                 = ch.strawId().station();//straw.id().getStation();
-      cx.Plane                   = ch.strawId().plane() % 2;//straw.id().getPlane() % 2;
-      cx.Face                    = ch.strawId().face();
-      cx.Panel                   = ch.strawId().panel();//straw.id().getPanel();
-
       // get Z-ordered location
-      HelixData.orderID(&cx, &co);
-     
-      int os       = co.Station; 
-      int of       = co.Face;
-      int op       = co.Panel;
+      uint16_t  upanel    = _thi->uniquePanel(loc);
+      int       of        = TrackerHitIndex::orderedFace(upanel);
+      int       op        = TrackerHitIndex::orderedPanel(upanel);
 
       _hfResult._chHitsWPos.push_back(XYWVec(hhit.pos(),  of, hhit.nStrawHits()));
 
-      int       stationId = os;
-      int       faceId    = of + stationId*StrawId::_nfaces*FaceZ_t::kNPlanesPerStation;//RobustHelixFinderData::kNFaces;
-      // int       panelId   = op + faceId*RobustHelixDataFinderData::kNPanelsPerFace;
+      int       faceId    = TrackerHitIndex::faceId(upanel);
       FaceZ_t* fz        = &HelixData._oTracker[faceId];
       PanelZ_t*pz        = &fz->panelZs[op];
 
-      //	pz->_chHitsToProcess.push_back(hhit);//[fz->fNHits] = hhit;
-      //	pz->fNHits  = pz->fNHits + 1;
       if (pz->idChBegin < 0 ){
 	pz->idChBegin = _hfResult._chHitsToProcess.size() - 1;
 	pz->idChEnd   = _hfResult._chHitsToProcess.size();	
@@ -1084,12 +1077,9 @@ namespace mu2e {
 	printf("[RobustHelixFinder::FillHits] %4i %6i %10i %10.3f %10.3f %10.3f\n", nFiltComboHits, faceId, op, ch.pos().x(), ch.pos().y(), ch.pos().z() );
       }
 	
-      // if (pz->nChHits() > PanelZ_t::kNMaxPanelHits) printf("[RobustHelixDataFinderAlg::fillFaceOrderedHits] number of hits with the panel exceed the limit: NHits =  %i MaxNHits = %i\n", pz->fNHits, PanelZ_t::kNMaxPanelHits);
       ++nFiltComboHits;
       nFiltStrawHits += ch.nStrawHits();
-      //      }
     }
-    // }
     
     HelixData._nFiltComboHits = nFiltComboHits;  //ComboHit counter
     HelixData._nFiltStrawHits = nFiltStrawHits;  //StrawHit counter
@@ -1627,100 +1617,6 @@ namespace mu2e {
     helix._lambda = 1./(helixData._szphi.dfdz());
     helix._fz0    = helixData._szphi.phi0();
   }
-
-  //----------------------------------------------------------------------------------------------------
-  void     RobustHelixFinder::searchWorstHitXY(RobustHelixFinderData& helixData, HitInfo_t& hitInfo){
-    hitInfo.face          = -1;
-    hitInfo.panel         = -1;
-    hitInfo.panelHitIndex = -1;
-    
-    float          dr, wt, hitChi2;
-    XYVec          centerXY     = XYVec(helixData._hseed._helix.center().x(), helixData._hseed._helix.center().y());
-    XYZVec         center       = helixData._hseed._helix.center();
-    float          helix_radius = helixData._hseed._helix.radius();
-    float          hitChi2Worst = _maxrpull*_maxrpull;
-
-    ComboHit*      hit(0);
-    FaceZ_t*       facez(0);
-    int            nhitsFace(0);
-    
-    for (int f=0; f<StrawId::_ntotalfaces; ++f){
-      facez     = &helixData._oTracker[f];
-      nhitsFace = facez->nChHits();
-      
-      if (nhitsFace == 0)                          continue;
-
-      for (int ip=0; ip<nhitsFace; ++ip){
-	hit = &helixData._chHitsToProcess[facez->idChBegin + ip];
-	
-	if (hit->_flag.hasAnyProperty(_outlier))   continue;
-	
-	XYZVec  cvec  = PerpVector(hit->pos() - center,Geom::ZDir());
-	dr    = sqrtf(cvec.mag2()) - helix_radius;
-	wt    = _chi2hfit.evalWeightXY(*hit, centerXY);
-
-	hitChi2 = dr*dr*wt;
-
-	if (hitChi2 > hitChi2Worst) {
-	  hitChi2Worst          = hitChi2;
-	  hitInfo.face          = f;
-	  hitInfo.panel         = hit->strawId().uniquePanel();
-	  hitInfo.panelHitIndex = facez->idChBegin + ip;
-	  hit->_xyWeight        = wt;
-	}
-      }//end loop of the hits within the face
-    }//end faces loop
-  }
-  
-  //----------------------------------------------------------------------------------------------------
-  void     RobustHelixFinder::searchWorstHitZPhi(RobustHelixFinderData& helixData, HitInfo_t& hitInfo){
-    hitInfo.face          = -1;
-    hitInfo.panel         = -1;
-    hitInfo.panelHitIndex = -1;
-    
-    // XYZVec         center       = helixData._hseed._helix.center();
-    XYVec          centerXY     = XYVec(helixData._hseed._helix.center().x(), helixData._hseed._helix.center().y());
-    float          helix_radius = helixData._hseed._helix.radius();
-
-    ComboHit*      hit(0);
-    FaceZ_t*       facez(0);
-    int            nhitsFace(0);
-    
-    float          chi2min(1e10), chi2;
-    ::LsqSums4     szphi;
-
-    for (int f=0; f<StrawId::_ntotalfaces; ++f){
-      facez     = &helixData._oTracker[f];
-      nhitsFace = facez->nChHits();
-
-      if (nhitsFace == 0)                          continue;
-
-      for (int ip=0; ip<nhitsFace; ++ip){
-	hit = &helixData._chHitsToProcess[facez->idChBegin + ip];
-	
-	if (hit->_flag.hasAnyProperty(_outlier))   continue;
-	
-	szphi.init(helixData._szphi);
-
-	// XYZVec  cvec  = PerpVector(hit->pos() - center,Geom::ZDir());
-	float   phi   = hit->helixPhi();
-	float   wt    = _chi2hfit.evalWeightZPhi(*hit, centerXY, helix_radius);
-
-	szphi.removePoint(hit->pos().z(), phi, wt);
-	chi2 = szphi.chi2DofLine();
-
-	if (chi2 < chi2min) {
-	  chi2min               = chi2;
-	  hitInfo.face          = f;
-	  hitInfo.panel         = hit->strawId().uniquePanel();
-	  hitInfo.panelHitIndex = facez->idChBegin + ip;
-
-	  hit->_zphiWeight      = wt;
-	  //	    hitInfo.weightZPhi    = wt;
-	}
-      }//end loop pver the hits within a face
-    }//end faces loop
-  }
 }
 using mu2e::RobustHelixFinder;
 DEFINE_ART_MODULE(RobustHelixFinder);
@@ -26,6 +26,7 @@
 // tracking
 #include "TrkReco/inc/TrkUtilities.hh"
 #include "TrkReco/inc/TrkTimeCalculator.hh"
+#include "TrkReco/inc/ComboHitSoA.hh"
 // root
 #include "TH1F.h"
 // boost
@@ -88,6 +89,7 @@ namespace mu2e {
       const StrawHitFlagCollection *_shfcol;
       const ComboHitCollection *_chcol;
       const CaloClusterCollection *_cccol;
+      ComboHitSoA       _chsoa; // SoA copy of the event's ComboHits, with corrected times
       StrawHitFlag      _hsel, _hbkg;
       float             _maxdt;
       unsigned          _minnhits;
@@ -182,6 +184,7 @@ namespace mu2e {
 
     auto const& chH = event.getValidHandle(_chToken);
     _chcol = chH.product();
+    _chsoa.fill(*_chcol,_ttcalc,_pitch);
 
     art::Handle<CaloClusterCollection> ccH{}; // need to cache for later Ptr creation 
     if(_usecc){
@@ -270,20 +273,17 @@ namespace mu2e {
   //--------------------------------------------------------------------------------------------------------------
   void TimeClusterFinder::fillTimeSpectrum() {
     _timespec.Reset();
-    for (unsigned istr=0; istr<_chcol->size();++istr) {
+    for (unsigned istr=0; istr<_chsoa.size();++istr) {
       if (_testflag && !goodHit((*_shfcol)[istr])) continue;
-      ComboHit const& ch = (*_chcol)[istr];
-      float time = _ttcalc.comboHitTime((*_chcol)[istr],_pitch);
-      _timespec.Fill(time,ch.nStrawHits());
+      _timespec.Fill(_chsoa._ctime[istr],_chsoa._nsh[istr]);
     }
   }
 
   void TimeClusterFinder::assignHits(TimeClusterCollection& tccol ) {
   // assign hits to the closest time peak
-    for(size_t istr=0; istr<_chcol->size(); ++istr) {
+    for(size_t istr=0; istr<_chsoa.size(); ++istr) {
       if ((!_testflag) || goodHit((*_shfcol)[istr])) {
-	ComboHit const& ch =(*_chcol)[istr];
-	float time = _ttcalc.comboHitTime(ch,_pitch);
+	float time = _chsoa._ctime[istr];
 	float mindt(1e5);
 	auto besttc = tccol.end();
 	// find the closest seed (if any)
@@ -348,18 +348,15 @@ namespace mu2e {
     tc._nsh = 0;
     for(auto ish :tc._strawHitIdxs) {
       if (_testflag && !goodHit((*_shfcol)[ish])) continue;
-      ComboHit const& ch = (*_chcol)[ish];
-      unsigned nsh = ch.nStrawHits();
-      tc._nsh += nsh;
-      const XYZVec& pos = ch.pos();
-      float htime = _ttcalc.comboHitTime(ch,_pitch);
-      float hwt = ch.nStrawHits();
+      tc._nsh += (*_chcol)[ish].nStrawHits();
+      float hwt = _chsoa._nsh[ish];
+      float htime = _chsoa._ctime[ish];
       tmin(htime);
       tmax(htime);
       tacc(htime,weight=hwt);
-      xacc(pos.x(),weight=hwt);
-      yacc(pos.y(),weight=hwt);
-      zacc(pos.z(),weight=hwt);
+      xacc(_chsoa._x[ish],weight=hwt);
+      yacc(_chsoa._y[ish],weight=hwt);
+      zacc(_chsoa._z[ish],weight=hwt);
     }
 
     if (tc.hasCaloCluster()) {
@@ -390,8 +387,7 @@ namespace mu2e {
       auto iworst = tc._strawHitIdxs.end();
       float maxadPhi(_maxdPhi);
       for( auto ips = tc._strawHitIdxs.begin(); ips != tc._strawHitIdxs.end(); ++ips){
-	ComboHit const& ch = (*_chcol)[*ips];
-	float phi   = polyAtan2(ch.pos().y(), ch.pos().x()); 
+	float phi   = _chsoa._phi[*ips];
 	float dphi  = Angles::deltaPhi(phi,pphi);
 	float adphi = std::abs(dphi);
 	if(adphi > maxadPhi ){
@@ -411,32 +407,31 @@ namespace mu2e {
     while (changed) {
       changed = false;
       float pphi = polyAtan2(tc._pos.y(), tc._pos.x());
-      for(size_t ich=0;ich < _chcol->size(); ++ich){
+      for(size_t ich=0;ich < _chsoa.size(); ++ich){
 	if ((!_testflag) || goodHit((*_shfcol)[ich])) {
-	  if(std::find(tc._strawHitIdxs.begin(),tc._strawHitIdxs.end(),ich) == tc._strawHitIdxs.end()){
+	  // test the cheap time window before searching the cluster hit list
+	  _pmva._dt = fabs(_chsoa._ctime[ich] - tc._t0._t0);
+	  if(_pmva._dt < _maxdt+tc._t0._t0err &&
+	      std::find(tc._strawHitIdxs.begin(),tc._strawHitIdxs.end(),ich) == tc._strawHitIdxs.end()){
 	    ComboHit const& ch = (*_chcol)[ich];
-	    float cht = _ttcalc.comboHitTime(ch,_pitch);
-	    _pmva._dt = fabs(cht - tc._t0._t0);
-	    if(_pmva._dt < _maxdt+tc._t0._t0err){
-	      float phi = polyAtan2(ch.pos().y(), ch.pos().x());//ch.phi();
-	      float dphi = fabs(Angles::deltaPhi(phi,pphi));
-	      if(dphi < _maxdPhi){ 
-		_pmva._dphi = dphi;
-		_pmva._rho = ch.pos().Perp2();
-		_pmva._nsh = ch.nStrawHits();
-		_pmva._plane = ch.strawId().plane();
-		_pmva._werr = ch.wireRes();
-		_pmva._wdist = fabs(ch.wireDist());
-
-		float mvaout(-1.0);
-		if (tc.hasCaloCluster())
-		  mvaout = _tcCaloMVA.evalMVA(_pmva._pars);
-		else
-		  mvaout = _tcMVA.evalMVA(_pmva._pars);
-		if (mvaout > _minaddmva) {
-		  addHit(tc,ich);
-		  changed = true;
-		}
+	    float phi = _chsoa._phi[ich];
+	    float dphi = fabs(Angles::deltaPhi(phi,pphi));
+	    if(dphi < _maxdPhi){ 
+	      _pmva._dphi = dphi;
+	      _pmva._rho = ch.pos().Perp2();
+	      _pmva._nsh = ch.nStrawHits();
+	      _pmva._plane = ch.strawId().plane();
+	      _pmva._werr = ch.wireRes();
+	      _pmva._wdist = fabs(ch.wireDist());
+
+	      float mvaout(-1.0);
+	      if (tc.hasCaloCluster())
+	        mvaout = _tcCaloMVA.evalMVA(_pmva._pars);
+	      else
+	        mvaout = _tcMVA.evalMVA(_pmva._pars);
+	      if (mvaout > _minaddmva) {
+	        addHit(tc,ich);
+	        changed = true;
 	      }
 	    }
 	  }
@@ -451,7 +446,7 @@ namespace mu2e {
     float denom = float(tc._nsh - nsh);
     // update time cluster properties 
     if(!tc.hasCaloCluster()){
-      float cht = _ttcalc.comboHitTime(ch,_pitch);
+      float cht = _chsoa._ctime[*iworst];
       float newt0  = (tc._t0._t0*tc._nsh - cht*nsh)/denom;
       tc._t0._t0err = sqrt((tc._t0._t0err*tc._t0._t0err*tc._nsh - (cht-newt0)*(cht-tc._t0._t0)*nsh )/denom);
       tc._t0._t0 = newt0;
@@ -469,7 +464,7 @@ namespace mu2e {
     float denom = float(tc._nsh + nsh);
     // update time cluster properties 
     if(!tc.hasCaloCluster()){
-      float cht = _ttcalc.comboHitTime(ch,_pitch);
+      float cht = _chsoa._ctime[iadd];
       float newt0  = (tc._t0._t0*tc._nsh + cht*nsh)/denom;
       tc._t0._t0err = sqrt((tc._t0._t0err*tc._t0._t0err*tc._nsh + (cht-newt0)*(cht-tc._t0._t0)*nsh )/denom);
       tc._t0._t0 = newt0;
@@ -486,13 +481,11 @@ namespace mu2e {
     accumulator_set<float, stats<tag::weighted_variance(lazy)>, float > terr;
     accumulator_set<float, stats<tag::weighted_mean >,float > xacc, yacc, zacc;
     for(StrawHitIndex ish : tc._strawHitIdxs) {
-      ComboHit const& ch = (*_chcol)[ish];
-      float hwt = ch.nStrawHits();
-      float cht = _ttcalc.comboHitTime(ch,_pitch);
-      terr(cht,weight=hwt);
-      xacc(ch.pos().x(),weight=hwt);
-      yacc(ch.pos().y(),weight=hwt);
-      zacc(ch.pos().z(),weight=hwt);
+      float hwt = _chsoa._nsh[ish];
+      terr(_chsoa._ctime[ish],weight=hwt);
+      xacc(_chsoa._x[ish],weight=hwt);
+      yacc(_chsoa._y[ish],weight=hwt);
+      zacc(_chsoa._z[ish],weight=hwt);
     }
     if (tc.hasCaloCluster()) {
       if(_useccpos){
@@ -519,10 +512,8 @@ namespace mu2e {
       float pphi = polyAtan2(tc._pos.y(), tc._pos.x());
       for (auto ips=tc._strawHitIdxs.begin();ips != tc._strawHitIdxs.end();++ips) {
         ComboHit const& ch = (*_chcol)[*ips];
-        float cht = _ttcalc.comboHitTime(ch,_pitch);
-
-        _pmva._dt = fabs(cht - tc._t0._t0);
-        float phi = polyAtan2(ch.pos().y(), ch.pos().x());//ch.phi();
+        _pmva._dt = fabs(_chsoa._ctime[*ips] - tc._t0._t0);
+        float phi = _chsoa._phi[*ips];
         float dphi = Angles::deltaPhi(phi,pphi);
         _pmva._dphi = fabs(dphi);
 	_pmva._rho = ch.pos().Perp2();
@@ -55,6 +55,12 @@ namespace mu2e
     void  refineFitXY  (RobustHelixFinderData& helixData, bool TargetCon, int weightMode=1);
     void  refineFitZPhi(RobustHelixFinderData& helixData, int weightMode=1);
 
+    //functions used to find the hit to be removed from the XY and ZPhi fits: the
+    //hit with the largest XY pull above MaxChi2 and the hit whose removal gives
+    //the smallest ZPhi chi2 (leave-one-out on the current sums)
+    void  searchWorstHitXY  (RobustHelixFinderData& helixData, HitInfo_t& hitInfo, float MaxChi2);
+    void  searchWorstHitZPhi(RobustHelixFinderData& helixData, HitInfo_t& hitInfo);
+
     void  setTracker    (const Tracker*    Tracker) { _tracker     = Tracker; }
     void  setCalorimeter(const Calorimeter* Cal    ) { _calorimeter = Cal    ; }
     
@@ -75,6 +81,9 @@ namespace mu2e
     bool resolvePhi(ComboHit& hh, RobustHelix const& myhel) const;
     float hitWeight(ComboHit const& hhit) const;
 
+    //load the hits not flagged as outliers into the hit arrays
+    void loadHits(RobustHelixFinderData& helixData);
+
     int _diag;
     int _debug;
     StrawHitFlag _dontuseflag;
@@ -89,6 +98,13 @@ namespace mu2e
 
     RobustHelixFit* _rhfit;
 
+    //hit arrays (one entry per hit, structure-of-arrays) used by the worst-hit
+    //searches, kept across helices to avoid reallocating them
+    std::vector<int>   _hface, _hindex;
+    std::vector<float> _hx, _hy, _hz, _hphi;
+    std::vector<float> _hwx, _hwy, _hwerr2, _hterr2;
+    std::vector<float> _hwt, _hchi2;
+
   };
 }
 #endif
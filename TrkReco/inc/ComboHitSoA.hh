@@ -0,0 +1,75 @@
+//
+//  Structure-of-arrays view of a ComboHitCollection.  Pattern recognition loops typically read
+//  only a few fields (position, time, flag, resolution) of each ComboHit, so copying those into
+//  contiguous, aligned float arrays once per event lets those loops stream through memory and
+//  vectorize.  The view is transient and indexed identically to the collection it was filled from.
+//
+#ifndef TrkReco_ComboHitSoA_HH
+#define TrkReco_ComboHitSoA_HH
+#include "RecoDataProducts/inc/ComboHit.hh"
+#include "RecoDataProducts/inc/StrawHitFlag.hh"
+#include "RecoDataProducts/inc/StrawHitIndex.hh"
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+namespace mu2e {
+  class TrkTimeCalculator;
+  // minimal allocator aligning storage on cache-line boundaries
+  template <class T, size_t ALIGN=64> struct AlignedAllocator {
+    typedef T value_type;
+    template <class U> struct rebind { typedef AlignedAllocator<U,ALIGN> other; };
+    AlignedAllocator() noexcept {}
+    template <class U> AlignedAllocator(AlignedAllocator<U,ALIGN> const&) noexcept {}
+    T* allocate(size_t n) {
+      size_t nbytes = ((n*sizeof(T)+ALIGN-1)/ALIGN)*ALIGN;
+      void* ptr = std::aligned_alloc(ALIGN,nbytes);
+      if(ptr == 0) throw std::bad_alloc();
+      return static_cast<T*>(ptr);
+    }
+    void deallocate(T* ptr, size_t) noexcept { std::free(ptr); }
+    template <class U> bool operator == (AlignedAllocator<U,ALIGN> const&) const { return true; }
+    template <class U> bool operator != (AlignedAllocator<U,ALIGN> const&) const { return false; }
+  };
+
+  struct ComboHitSoA {
+    typedef std::vector<float,AlignedAllocator<float> > FArray;
+    // fill from a collection; the previous content is replaced but the capacity is kept
+    void fill(ComboHitCollection const& chcol);
+    // also fill the time-of-flight corrected time used for time clustering
+    void fill(ComboHitCollection const& chcol, TrkTimeCalculator& ttcalc, float pitch);
+    size_t size() const { return _x.size(); }
+    // hits are selected if they have all the 'sel' bits and none of the 'bkg' bits
+    bool goodHit(size_t ich, StrawHitFlag const& sel, StrawHitFlag const& bkg) const {
+      return _flag[ich].hasAllProperties(sel) && !_flag[ich].hasAnyProperty(bkg); }
+
+    FArray _x, _y, _z; // position
+    FArray _phi; // azimuth of the position (polyAtan2 approximation)
+    FArray _time; // raw time
+    FArray _ctime; // time corrected for drift and time-of-flight, only filled if a TrkTimeCalculator is provided
+    FArray _wdx, _wdy; // transverse components of the wire direction
+    FArray _wres, _tres; // resolution along and transverse to the wire
+    FArray _nsh; // number of straw hits, as a weight
+    std::vector<StrawHitFlag> _flag;
+  };
+
+  // kernels written against the SoA view.  Output arrays must have at least soa.size() entries
+  namespace ComboHitSoAKernels {
+    // 2pi and its inverse in float, as used to fold phi residuals
+    const float twoPi = 2.0*M_PI;
+    const float invTwoPi = 1.0/twoPi;
+    // signed radial distance from a circle, in the transverse plane
+    void circleResiduals(ComboHitSoA const& soa, float cx, float cy, float radius, float* resid);
+    // same, as (squared residual)/(projected variance), using the wire and transverse resolutions.
+    // A hit at the circle center has no radial direction and gets the wire resolution
+    void circleChisq(ComboHitSoA const& soa, float cx, float cy, float radius, float* chisq);
+    // phi residual WRT the linear phi-z model phi = phi0 + dfdz*z, with phi measured about (cx,cy).
+    // Residuals are folded into (-pi,pi]
+    void phiZResiduals(ComboHitSoA const& soa, float cx, float cy, float phi0, float dfdz, float* resid);
+    // indices of selected hits whose corrected time is within maxdt of t0
+    void timeWindow(ComboHitSoA const& soa, float t0, float maxdt,
+	StrawHitFlag const& sel, StrawHitFlag const& bkg, std::vector<StrawHitIndex>& indices);
+  }
+}
+#endif
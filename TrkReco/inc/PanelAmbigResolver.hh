@@ -45,6 +45,13 @@ namespace mu2e {
 	bool fillPanelInfo(TrkStrawHitVector const& phits, const KalRep* krep, PanelInfo& pinfo) const;
 	// compute the panel result for a given ambiguity/activity state and the ionput t0
 	void fillResult(PanelInfo const& pinfo,TrkT0 const& t0, PanelResult& result) const;
+	// fill the results for all the states of a panel
+	void enumerateStates(PanelInfo const& pinfo,TrkT0 const& t0, PRV& results) const;
+	// fill the results only for the states within _minsep of the best, using a
+	// branch-and-bound search with incremental chisquared sums
+	void searchStates(PanelInfo const& pinfo,TrkT0 const& t0, PRV& results) const;
+	// move the best result to the front, followed by those within _minsep of it
+	size_t selectResults(PRV& results) const;
 	// parameters
 	double _minsep; // minimum chisquared separation between best solution and the rest to consider a panel resolved
 	double _inactivepenalty; // chisquared penalty for an inactive hit
@@ -57,6 +64,8 @@ namespace mu2e {
 	double _maxhitu; // maximum u value allowed for a hit
 	bool _fixunallowed; // fix the state of any hit whose initial state isn't allowed
 	unsigned _maxnpanel; // max # of hits to consider for a panel
+	bool _search; // use the branch-and-bound search instead of enumerating all states
+	bool _checksearch; // run both the search and the enumeration, and compare the chosen states
 	int _diag; // diagnostic level`
 	// TTree variables, mutable so they don't change const
 	mutable TTree *_padiag, *_pudiag; // diagnostic TTree
@@ -69,6 +78,9 @@ namespace mu2e {
 	mutable TSHUIV _uinfo; // u position of hits in panel
 	mutable Float_t _mctupos;
 	mutable PRV _results;
+	// search check counters
+	mutable unsigned _nfits, _npanels, _nmismatch;
+	mutable double _tsearch, _tenum; // seconds
     };
   } // PanelAmbig namespace
 } // mu2e namespace
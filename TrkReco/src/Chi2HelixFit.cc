@@ -36,6 +36,38 @@ namespace mu2e
  
   typedef std::pair<float,float> WVal;
 
+//-----------------------------------------------------------------------------
+// hit weights for the XY and ZPhi fits as a function of the hit position
+// relative to the helix center (dx,dy), the wire direction (wx,wy) and the
+// errors along and across the wire. Shared by the single-hit functions and
+// the loops over the hit arrays
+//-----------------------------------------------------------------------------
+  namespace {
+    inline float transErr2(const ComboHit& Hit) {
+      float transErr = 5./sqrt(12.);
+      //scale the error based on the number of the strawHits that are within teh ComboHit
+      if (Hit.nStrawHits() > 1) transErr *= 1.5;
+      return transErr*transErr;
+    }
+
+    inline float weightXY(float dx, float dy, float wx, float wy, float WireErr2, float TransErr2) {
+      // sdir = zdir.Cross(wdir)
+      float dxn    = -dx*wy+dy*wx;
+      float costh2 = dxn*dxn/(dx*dx+dy*dy);
+      float sinth2 = 1-costh2;
+      float e2     = WireErr2*sinth2+TransErr2*costh2;
+      return 1./e2;
+    }
+
+    inline float weightZPhi(float dx, float dy, float wx, float wy, float WireErr2, float TransErr2, float Radius) {
+      float dxn    = -dx*wy+dy*wx;
+      float costh2 = dxn*dxn/(dx*dx+dy*dy);
+      float sinth2 = 1-costh2;
+      float e2     = WireErr2*costh2+TransErr2*sinth2;
+      return Radius*Radius/e2;
+    }
+  }
+
   Chi2HelixFit::Chi2HelixFit(fhicl::ParameterSet const& pset) :
     _diag(pset.get<int>("diagLevel",0)),
     _debug(pset.get<int>("debugLevel",0)),
@@ -749,55 +781,133 @@ namespace mu2e
     // float err2 = wdot2*Hit.wireErr2() + tdot2*Hit.transErr2();
     // float wt = 1/err2;// or 1.0/sqrtf(err2); // or 1/err2?
 
-    float    transErr = 5./sqrt(12.);
-    //scale the error based on the number of the strawHits that are within teh ComboHit
-    if (Hit.nStrawHits() > 1) transErr *= 1.5;
-    float    transErr2 = transErr*transErr;
-
-    static const XYZVec _zdir(0.0,0.0,1.0);
-    XYZVec _sdir  = _zdir.Cross(Hit._wdir);
-   
-    float x   = Hit.pos().x();
-    float y   = Hit.pos().y();
-    float dx  = x-Center.x();
-    float dy  = y-Center.y();
-    float dxn = dx*_sdir.x()+dy*_sdir.y();
-
-    float costh2 = dxn*dxn/(dx*dx+dy*dy);
-    float sinth2 = 1-costh2;
-
-    // float e2     = _ew*_ew*sinth2+rs*rs*costh2;
-    float e2     = Hit.wireErr2()*sinth2+transErr2*costh2;
-    float wt     = 1./e2;
-      
-    return wt;
+    float dx  = Hit.pos().x()-Center.x();
+    float dy  = Hit.pos().y()-Center.y();
+
+    return weightXY(dx, dy, Hit._wdir.x(), Hit._wdir.y(), Hit.wireErr2(), transErr2(Hit));
   }
 
   float Chi2HelixFit::evalWeightZPhi(const ComboHit& Hit, XYVec& Center, float Radius){
-    float    transErr = 5./sqrt(12.);
-    //scale the error based on the number of the strawHits that are within teh ComboHit
-    if (Hit.nStrawHits() > 1) transErr *= 1.5;
-    float    transErr2 = transErr*transErr;
-
-    float x  = Hit.pos().x();
-    float y  = Hit.pos().y();
-    float dx = x-Center.x();
-    float dy = y-Center.y();
-    
-    static const XYZVec _zdir(0.0,0.0,1.0);
-    XYZVec _sdir  = _zdir.Cross(Hit._wdir);
-    
-    float dxn    = dx*_sdir.x()+dy*_sdir.y();
+    float dx = Hit.pos().x()-Center.x();
+    float dy = Hit.pos().y()-Center.y();
+
+    return weightZPhi(dx, dy, Hit._wdir.x(), Hit._wdir.y(), Hit.wireErr2(), transErr2(Hit), Radius);
+  }
+
+//-----------------------------------------------------------------------------
+// copy the position, wire direction and errors of the hits still used into the
+// hit arrays, so that the searches below run over contiguous floats
+//-----------------------------------------------------------------------------
+  void Chi2HelixFit::loadHits(RobustHelixFinderData& HelixData){
+    static const StrawHitFlag outlier(StrawHitFlag::outlier);
+
+    _hface.clear(); _hindex.clear();
+    _hx.clear(); _hy.clear(); _hz.clear(); _hphi.clear();
+    _hwx.clear(); _hwy.clear(); _hwerr2.clear(); _hterr2.clear();
+
+    for (int f=0; f<StrawId::_ntotalfaces; ++f){
+      FaceZ_t* facez = &HelixData._oTracker[f];
+      int      nhits = facez->nChHits();
+      for (int ip=0; ip<nhits; ++ip){
+	const ComboHit& hit = HelixData._chHitsToProcess[facez->idChBegin + ip];
+	if (hit._flag.hasAnyProperty(outlier))   continue;
+
+	_hface  .push_back(f);
+	_hindex .push_back(facez->idChBegin + ip);
+	_hx     .push_back(hit.pos().x());
+	_hy     .push_back(hit.pos().y());
+	_hz     .push_back(hit.pos().z());
+	_hphi   .push_back(hit.helixPhi());
+	_hwx    .push_back(hit._wdir.x());
+	_hwy    .push_back(hit._wdir.y());
+	_hwerr2 .push_back(hit.wireErr2());
+	_hterr2 .push_back(transErr2(hit));
+      }
+    }
+    _hwt  .resize(_hx.size());
+    _hchi2.resize(_hx.size());
+  }
+
+//-----------------------------------------------------------------------------
+// XY: the hit with the largest chi2 = dr^2*wt, if above MaxChi2
+//-----------------------------------------------------------------------------
+  void Chi2HelixFit::searchWorstHitXY(RobustHelixFinderData& HelixData, HitInfo_t& HitInfo, float MaxChi2){
+    HitInfo.face          = -1;
+    HitInfo.panel         = -1;
+    HitInfo.panelHitIndex = -1;
 
-    float costh2 = dxn*dxn/(dx*dx+dy*dy);
-    float sinth2 = 1-costh2;
+    loadHits(HelixData);
 
-    // float e2     = _ew*_ew*costh2+rs*rs*sinth2;
-    float e2     = Hit.wireErr2()*costh2+transErr2*sinth2;
-    float wt     = Radius*Radius/e2;
-    //    wt           *= 0.025;//_weightZPhi;
+    RobustHelix& rhel   = HelixData._hseed._helix;
+    float        x0     = rhel.centerx();
+    float        y0     = rhel.centery();
+    float        radius = rhel.radius();
+    int          nhits  = _hx.size();
+
+    for (int i=0; i<nhits; ++i){
+      float dx  = _hx[i]-x0;
+      float dy  = _hy[i]-y0;
+      float dr  = sqrtf(dx*dx+dy*dy) - radius;
+      _hwt  [i] = weightXY(dx, dy, _hwx[i], _hwy[i], _hwerr2[i], _hterr2[i]);
+      _hchi2[i] = dr*dr*_hwt[i];
+    }
 
-    return wt;
+    int   worst(-1);
+    float chi2Worst(MaxChi2);
+    for (int i=0; i<nhits; ++i){
+      if (_hchi2[i] > chi2Worst) {
+	chi2Worst = _hchi2[i];
+	worst     = i;
+      }
+    }
+
+    if (worst >= 0){
+      ComboHit* hit = &HelixData._chHitsToProcess[_hindex[worst]];
+      HitInfo.face          = _hface[worst];
+      HitInfo.panel         = hit->strawId().uniquePanel();
+      HitInfo.panelHitIndex = _hindex[worst];
+      hit->_xyWeight        = _hwt[worst];
+    }
+  }
+
+//-----------------------------------------------------------------------------
+// ZPhi: the hit whose removal from the current sums gives the smallest chi2
+//-----------------------------------------------------------------------------
+  void Chi2HelixFit::searchWorstHitZPhi(RobustHelixFinderData& HelixData, HitInfo_t& HitInfo){
+    HitInfo.face          = -1;
+    HitInfo.panel         = -1;
+    HitInfo.panelHitIndex = -1;
+
+    loadHits(HelixData);
+
+    RobustHelix& rhel   = HelixData._hseed._helix;
+    float        x0     = rhel.centerx();
+    float        y0     = rhel.centery();
+    float        radius = rhel.radius();
+    int          nhits  = _hx.size();
+
+    for (int i=0; i<nhits; ++i){
+      _hwt[i] = weightZPhi(_hx[i]-x0, _hy[i]-y0, _hwx[i], _hwy[i], _hwerr2[i], _hterr2[i], radius);
+    }
+
+    HelixData._szphi.chi2DofLineWithout(nhits, _hz.data(), _hphi.data(), _hwt.data(), _hchi2.data());
+
+    int   best(-1);
+    float chi2min(1e10);
+    for (int i=0; i<nhits; ++i){
+      if (_hchi2[i] < chi2min) {
+	chi2min = _hchi2[i];
+	best    = i;
+      }
+    }
+
+    if (best >= 0){
+      ComboHit* hit = &HelixData._chHitsToProcess[_hindex[best]];
+      HitInfo.face          = _hface[best];
+      HitInfo.panel         = hit->strawId().uniquePanel();
+      HitInfo.panelHitIndex = _hindex[best];
+      hit->_zphiWeight      = _hwt[best];
+    }
   }
 
 }
@@ -0,0 +1,98 @@
+//
+//  Structure-of-arrays view of a ComboHitCollection, and kernels using it
+//
+#include "TrkReco/inc/ComboHitSoA.hh"
+#include "TrkReco/inc/TrkTimeCalculator.hh"
+#include "Mu2eUtilities/inc/polyAtan2.hh"
+#include <cmath>
+
+namespace mu2e {
+
+  void ComboHitSoA::fill(ComboHitCollection const& chcol) {
+    size_t nch = chcol.size();
+    for(auto arr : {&_x,&_y,&_z,&_phi,&_time,&_ctime,&_wdx,&_wdy,&_wres,&_tres,&_nsh})
+      arr->resize(nch);
+    _flag.resize(nch);
+    for(size_t ich=0;ich < nch; ++ich){
+      ComboHit const& ch = chcol[ich];
+      _x[ich] = ch.pos().x();
+      _y[ich] = ch.pos().y();
+      _z[ich] = ch.pos().z();
+      _phi[ich] = polyAtan2(ch.pos().y(),ch.pos().x());
+      _time[ich] = ch.time();
+      _ctime[ich] = ch.time();
+      _wdx[ich] = ch.wdir().x();
+      _wdy[ich] = ch.wdir().y();
+      _wres[ich] = ch.wireRes();
+      _tres[ich] = ch.transRes();
+      _nsh[ich] = ch.nStrawHits();
+      _flag[ich] = ch.flag();
+    }
+  }
+
+  void ComboHitSoA::fill(ComboHitCollection const& chcol, TrkTimeCalculator& ttcalc, float pitch) {
+    fill(chcol);
+    for(size_t ich=0;ich < chcol.size(); ++ich)
+      _ctime[ich] = ttcalc.comboHitTime(chcol[ich],pitch);
+  }
+
+  namespace ComboHitSoAKernels {
+
+    void circleResiduals(ComboHitSoA const& soa, float cx, float cy, float radius, float* resid) {
+      size_t nch = soa.size();
+      float const* __restrict__ x = soa._x.data();
+      float const* __restrict__ y = soa._y.data();
+      for(size_t ich=0;ich < nch; ++ich){
+	float dx = x[ich]-cx;
+	float dy = y[ich]-cy;
+	resid[ich] = sqrtf(dx*dx+dy*dy) - radius;
+      }
+    }
+
+    void circleChisq(ComboHitSoA const& soa, float cx, float cy, float radius, float* chisq) {
+      size_t nch = soa.size();
+      float const* __restrict__ x = soa._x.data();
+      float const* __restrict__ y = soa._y.data();
+      float const* __restrict__ wdx = soa._wdx.data();
+      float const* __restrict__ wdy = soa._wdy.data();
+      float const* __restrict__ wres = soa._wres.data();
+      float const* __restrict__ tres = soa._tres.data();
+      for(size_t ich=0;ich < nch; ++ich){
+	float dx = x[ich]-cx;
+	float dy = y[ich]-cy;
+	float rho = sqrtf(dx*dx+dy*dy);
+	float resid = rho - radius;
+	// project the wire and transverse errors on the radial direction
+	float invrho = rho > 0.0f ? 1.0f/rho : 0.0f;
+	float wdot = (dx*wdx[ich] + dy*wdy[ich])*invrho;
+	float tdot = (dy*wdx[ich] - dx*wdy[ich])*invrho;
+	float var = rho > 0.0f ? wres[ich]*wres[ich]*wdot*wdot + tres[ich]*tres[ich]*tdot*tdot
+	  : wres[ich]*wres[ich];
+	chisq[ich] = resid*resid/var;
+      }
+    }
+
+    void phiZResiduals(ComboHitSoA const& soa, float cx, float cy, float phi0, float dfdz, float* resid) {
+      size_t nch = soa.size();
+      float const* __restrict__ x = soa._x.data();
+      float const* __restrict__ y = soa._y.data();
+      float const* __restrict__ z = soa._z.data();
+      for(size_t ich=0;ich < nch; ++ich){
+	float dphi = polyAtan2(y[ich]-cy,x[ich]-cx) - (phi0 + dfdz*z[ich]);
+	// fold into (-pi,pi] without branching on the number of turns
+	resid[ich] = dphi - twoPi*nearbyintf(dphi*invTwoPi);
+      }
+    }
+
+    void timeWindow(ComboHitSoA const& soa, float t0, float maxdt,
+	StrawHitFlag const& sel, StrawHitFlag const& bkg, std::vector<StrawHitIndex>& indices) {
+      indices.clear();
+      size_t nch = soa.size();
+      float const* __restrict__ ctime = soa._ctime.data();
+      for(size_t ich=0;ich < nch; ++ich){
+	if(fabsf(ctime[ich]-t0) < maxdt && soa.goodHit(ich,sel,bkg))
+	  indices.push_back(ich);
+      }
+    }
+  }
+}
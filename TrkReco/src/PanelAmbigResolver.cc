@@ -20,6 +20,9 @@
 #include <algorithm>
 #include <functional>
 #include <iostream>
+#include <chrono>
+#include <cmath>
+#include <limits>
 // art
 #include "art_root_io/TFileService.h"
 #include "art/Framework/Services/Registry/ServiceHandle.h"
@@ -41,6 +44,77 @@ namespace mu2e {
     typedef TrkStrawHitVector::iterator TSHI;
     typedef TrkStrawHitVector::const_iterator TSHCI;
 
+    // sums entering the panel chisquared.  Contributions are added hit by hit in the same
+    // order as fillResult, so the sums of a complete state are identical to fillResult's
+    struct StateSums {
+      double _wsum, _uwsum, _vwsum, _uuwsum, _vvwsum, _uvwsum, _penalty;
+      StateSums() : _wsum(0.0), _uwsum(0.0), _vwsum(0.0), _uuwsum(0.0), _vvwsum(0.0), _uvwsum(0.0), _penalty(0.0) {}
+      void add(StateSums const& other) {
+	_wsum += other._wsum;
+	_uwsum += other._uwsum;
+	_vwsum += other._vwsum;
+	_uuwsum += other._uuwsum;
+	_vvwsum += other._vvwsum;
+	_uvwsum += other._uvwsum;
+	_penalty += other._penalty;
+      }
+      // chisquared minimized over u and t0, including the t0 and track position constraints.
+      // This is the closed form of the 2X2 solution in fillResult.  Returns false if the system is singular
+      bool chisq(double t0wt, double tuwt, double& chi2) const {
+	double g11 = _wsum + tuwt;
+	double g22 = _vvwsum + t0wt;
+	double g12 = _vwsum;
+	double det = g11*g22 - g12*g12;
+	if(!(det > 0.0))return false;
+	chi2 = _uuwsum - (g22*_uwsum*_uwsum - 2.0*g12*_uwsum*_uvwsum + g11*_uvwsum*_uvwsum)/det + _penalty;
+	return true;
+      }
+    };
+
+    // depth-first search over the panel states.  Each hit's states are visited alternately
+    // forwards and backwards (reflected Gray code order), so successive states differ by a single
+    // hit and only the sums of the deepest level change.  The chisquared of the hits assigned so far
+    // (plus their penalties) can only grow as hits are added, so it bounds every state below that
+    // node, and subtrees which can't come within minsep of the best state are skipped
+    struct StateSearch {
+      std::vector<PanelState> _states; // states to consider for each hit
+      std::vector<std::vector<StateSums> > _contrib; // sums contribution of each of those states
+      double _t0wt, _tuwt, _minsep;
+      bool _prune;
+      std::vector<StateSums> _sums; // partial sums by depth
+      std::vector<bool> _reverse; // traversal direction by depth
+      PanelState _current;
+      double _best;
+      std::vector<std::pair<double,PanelState> > _cands; // states within minsep of the best when found
+      // allow for the rounding differences between the closed form and fillResult
+      double cut() const { return _best + _minsep + 1.0e-9*(1.0+std::fabs(_best)); }
+      void search(size_t depth) {
+	size_t nhits = _states.size();
+	if(depth == nhits){
+	  double chi2;
+	  if(_sums[depth].chisq(_t0wt,_tuwt,chi2) && chi2 < cut()){
+	    _cands.push_back(std::make_pair(chi2,_current));
+	    if(chi2 < _best)_best = chi2;
+	  }
+	  return;
+	}
+	size_t nstates = _states[depth].size();
+	for(size_t istate=0;istate<nstates;++istate){
+	  size_t jstate = _reverse[depth] ? nstates-1-istate : istate;
+	  _current[depth] = _states[depth][jstate];
+	  _sums[depth+1] = _sums[depth];
+	  _sums[depth+1].add(_contrib[depth][jstate]);
+	  if(_prune && depth+1 < nhits){
+	    double bound;
+	    if(!_sums[depth+1].chisq(_t0wt,_tuwt,bound))bound = _sums[depth+1]._penalty;
+	    if(bound >= cut())continue;
+	  }
+	  search(depth+1);
+	}
+	_reverse[depth] = !_reverse[depth];
+      }
+    };
+
 
     PanelAmbigResolver::PanelAmbigResolver(fhicl::ParameterSet const& pset, double tmpErr, size_t iter): 
       AmbigResolver(tmpErr),
@@ -53,7 +127,10 @@ namespace mu2e {
       _maxhitu(pset.get<double>("MaximumHitU",8.0)),
       _fixunallowed(pset.get<bool>("FixUnallowedHitStates",true)),
       _maxnpanel(pset.get<unsigned>("MaxHitsPerPanel",8)),
-      _diag(pset.get<int>("DiagLevel",0))
+      _search(pset.get<bool>("SearchStates",true)),
+      _checksearch(pset.get<bool>("CheckStateSearch",false)),
+      _diag(pset.get<int>("DiagLevel",0)),
+      _nfits(0), _npanels(0), _nmismatch(0), _tsearch(0.0), _tenum(0.0)
     {
       double nullerr = pset.get<double>("ExtraNullAmbigError",0.0);
       _nullerr2 = nullerr*nullerr;
@@ -84,10 +161,17 @@ namespace mu2e {
       }
     }
 
-    PanelAmbigResolver::~PanelAmbigResolver() {}
+    PanelAmbigResolver::~PanelAmbigResolver() {
+      if(_checksearch && _nfits > 0){
+	std::cout << "PanelAmbigResolver: state search check over " << _nfits << " fits, " << _npanels << " panels: "
+	  << _nmismatch << " panels with a different best state" << std::endl
+	  << "  enumeration " << 1.0e6*_tenum/_nfits << " us/fit, search " << 1.0e6*_tsearch/_nfits << " us/fit" << std::endl;
+      }
+    }
 
     bool PanelAmbigResolver::resolveTrk(KalRep* krep) const {
       bool retval(false); // assume nothing changes
+      if(_checksearch)++_nfits;
       // initialize penalty errors
       initHitErrors(krep);
       // sort by panel
@@ -118,32 +202,45 @@ namespace mu2e {
       // fill panel information
       PanelInfo pinfo;
       if(fillPanelInfo(phits,krep,pinfo)){
-	// loop over all ambiguity/activity states for this panel
-	PanelStateIterator psi(pinfo._uinfo,_allowed);
 	PRV results;
-	do {
-	  // for each state, fill the result of the 1-dimensional optimization
-	  PanelResult result(psi.current());
-	  fillResult(pinfo,krep->t0(),result);
-	  if(result._status == 0)results.push_back(result);
-	} while(psi.increment());
+	if(_checksearch){
+	  // time the exhaustive enumeration against the search, and check they choose the same state
+	  PRV eresults;
+	  auto tstart = std::chrono::steady_clock::now();
+	  enumerateStates(pinfo,krep->t0(),eresults);
+	  std::sort(eresults.begin(),eresults.end(),resultcomp());
+	  auto tenum = std::chrono::steady_clock::now();
+	  searchStates(pinfo,krep->t0(),results);
+	  selectResults(results);
+	  auto tsearch = std::chrono::steady_clock::now();
+	  _tenum += std::chrono::duration<double>(tenum-tstart).count();
+	  _tsearch += std::chrono::duration<double>(tsearch-tenum).count();
+	  ++_npanels;
+	  // exact chisquared ties may be ordered differently; those aren't mismatches
+	  if(results.size() == 0 || eresults.size() == 0){
+	    if(results.size() != eresults.size())++_nmismatch;
+	  } else if(results[0]._state != eresults[0]._state && results[0]._chisq != eresults[0]._chisq)
+	    ++_nmismatch;
+	  // the diagnostics need all the results
+	  if(_diag > 1)results.swap(eresults);
+	} else if(_search && _diag <= 1)
+	  searchStates(pinfo,krep->t0(),results);
+	else
+	  enumerateStates(pinfo,krep->t0(),results);
+	size_t nsel = selectResults(results);
 	if(results.size() > 0){
-	  // sort the results to have lowest chisquard first
-	  std::sort(results.begin(),results.end(),resultcomp());
 	  // for now, set the hit state according to the best result.  In future, maybe we want to treat
 	  // cases with different ambiguities differently from inactive hits
 	  retval |= setHitStates(results[0]._state,phits);
 	  // if the chisq difference between patterns is negligible, inflate the errors of the
 	  // hit which changes
 	  size_t nhits = results[0]._state.size();
-	  size_t ires(1);
-	  while (ires < results.size() && results[ires]._chisq - results[0]._chisq < _minsep){
+	  for(size_t ires=1;ires < nsel;++ires){
 	    for(size_t ihit=0;ihit<nhits;++ihit){
 	      if(results[ires]._state[ihit] != results[0]._state[ihit]){
 		phits[ihit]->setPenalty(_penaltyres);
 	      }
 	    }
-	    ++ires;
 	  }
 	}
 	if( _diag > 1 ) {
@@ -234,6 +331,103 @@ namespace mu2e {
       return retval;
     }
 
+    void PanelAmbigResolver::enumerateStates(PanelInfo const& pinfo,TrkT0 const& t0, PRV& results) const {
+      // loop over all ambiguity/activity states for this panel
+      PanelStateIterator psi(pinfo._uinfo,_allowed);
+      do {
+	// for each state, fill the result of the 1-dimensional optimization
+	PanelResult result(psi.current());
+	fillResult(pinfo,t0,result);
+	if(result._status == 0)results.push_back(result);
+      } while(psi.increment());
+    }
+
+    void PanelAmbigResolver::searchStates(PanelInfo const& pinfo,TrkT0 const& t0, PRV& results) const {
+      // with no usable hits every state fails, as in fillResult
+      if(pinfo._nused == 0)return;
+      size_t nhits = pinfo._uinfo.size();
+      StateSearch ss;
+      ss._t0wt = 1.0/(t0._t0err*t0._t0err);
+      ss._tuwt = (_addtrkpos || pinfo._nused == 1) ? pinfo._tuwt : 0.0;
+      ss._minsep = _minsep;
+      // the bound requires non-negative penalties
+      ss._prune = _inactivepenalty >= 0.0 && _nullpenalty >= 0.0;
+      ss._states.resize(nhits);
+      ss._contrib.resize(nhits);
+      for(size_t itsh=0;itsh<nhits;++itsh){
+	TSHUInfo const& tshui = pinfo._uinfo[itsh];
+	// only free hits change state, as in PanelStateIterator
+	if(tshui._use == TSHUInfo::free)
+	  ss._states[itsh] = _allowed;
+	else
+	  ss._states[itsh] = PanelState(1,tshui._hstate);
+	for(auto const& tshs : ss._states[itsh]){
+	  // same arithmetic as fillResult
+	  StateSums contrib;
+	  if(tshui._use != TSHUInfo::unused){
+	    if(tshs._state != HitState::inactive){
+	      double w = tshui._uwt;
+	      double r = tshui._dr;
+	      double v = tshui._dv;
+	      if(tshs._state == HitState::negambig){
+		r *= -1;
+		v *= -1;
+	      } else if(tshs._state == HitState::noambig){
+		r = 0.;
+		v = 0.;
+		w = 1.0/(1.0/w + _nullerr2);
+		contrib._penalty = _nullpenalty;
+	      }
+	      double u = tshui._upos + r;
+	      contrib._wsum = w;
+	      contrib._uwsum = u*w;
+	      contrib._vwsum = v*w;
+	      contrib._uuwsum = u*u*w;
+	      contrib._vvwsum = v*v*w;
+	      contrib._uvwsum = u*v*w;
+	    } else
+	      contrib._penalty = _inactivepenalty;
+	  }
+	  ss._contrib[itsh].push_back(contrib);
+	}
+      }
+      ss._sums.resize(nhits+1);
+      ss._reverse.assign(nhits,false);
+      ss._current.resize(nhits);
+      ss._best = std::numeric_limits<double>::max();
+      ss.search(0);
+      // compute the full results of the states which survive the final best chisquared.  This
+      // uses fillResult so they are identical to those of the enumeration
+      double cut = ss.cut();
+      for(auto const& cand : ss._cands){
+	if(cand.first < cut){
+	  PanelResult result(cand.second);
+	  fillResult(pinfo,t0,result);
+	  if(result._status == 0)results.push_back(result);
+	}
+      }
+    }
+
+    size_t PanelAmbigResolver::selectResults(PRV& results) const {
+      if(results.size() == 0)return 0;
+      size_t nsel(1);
+      if(_diag > 1){
+	// the diagnostics record all the results in chisquared order
+	std::sort(results.begin(),results.end(),resultcomp());
+	while(nsel < results.size() && results[nsel]._chisq - results[0]._chisq < _minsep)++nsel;
+      } else {
+	// only the best and those within _minsep of it are used, so don't sort the rest
+	std::iter_swap(results.begin(),std::min_element(results.begin(),results.end(),resultcomp()));
+	double best = results[0]._chisq;
+	double minsep = _minsep;
+	auto iend = std::partition(results.begin()+1,results.end(),
+	    [best,minsep](PanelResult const& res){ return res._chisq - best < minsep; });
+	std::sort(results.begin()+1,iend,resultcomp());
+	nsel = iend - results.begin();
+      }
+      return nsel;
+    }
+
     void PanelAmbigResolver::fillResult(PanelInfo const& pinfo,TrkT0 const& t0, PanelResult& result) const {
       // initialize the sums
       double wsum(0.0);